@@ -35,6 +35,9 @@ let package = Package(
             ],
             cSettings: [
                 .define("SWIFT_PACKAGE"),
+            ],
+            linkerSettings: [
+                .linkedLibrary("z"),
             ]
         ),
         .target(
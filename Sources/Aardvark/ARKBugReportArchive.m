@@ -0,0 +1,370 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "ARKBugReportArchive.h"
+
+#import "ARKBugReportAttachment.h"
+
+@import CoreAardvark;
+
+#import <zlib.h>
+
+
+/// The number of bytes read from attachments, and buffered before writing to the archive, at a time.
+static NSUInteger const ARKBugReportArchiveChunkSize = 64 * 1024;
+
+/// Entries set bit 3, since their sizes and checksums follow their data, and bit 11, since their names are UTF-8.
+static uint16_t const ARKBugReportArchiveEntryFlags = 0x0808;
+
+/// Version 2.0 of the zip specification, which introduced DEFLATE.
+static uint16_t const ARKBugReportArchiveVersion = 20;
+
+static uint16_t const ARKBugReportArchiveMethodDeflate = 8;
+
+
+static void ARKBugReportArchiveAppendUInt16(NSMutableData *data, uint16_t value)
+{
+    uint8_t bytes[sizeof(uint16_t)];
+    OSWriteLittleInt16(bytes, 0, value);
+    [data appendBytes:bytes length:sizeof(bytes)];
+}
+
+static void ARKBugReportArchiveAppendUInt32(NSMutableData *data, uint32_t value)
+{
+    uint8_t bytes[sizeof(uint32_t)];
+    OSWriteLittleInt32(bytes, 0, value);
+    [data appendBytes:bytes length:sizeof(bytes)];
+}
+
+
+@interface ARKBugReportArchive ()
+
+@property (nonatomic, copy, readonly) NSURL *fileURL;
+@property (nonatomic, readonly) NSFileHandle *fileHandle;
+
+/// Output waiting to be written to the file.
+@property (nonatomic, readonly) NSMutableData *outputBuffer;
+
+/// The number of bytes of output, including those still in the outputBuffer.
+@property (nonatomic) unsigned long long outputLength;
+
+/// The central directory records of the entries added so far, which are written at the end of the archive.
+@property (nonatomic, readonly) NSMutableData *centralDirectory;
+
+@property (nonatomic, readonly) NSMutableSet<NSString *> *entryNames;
+
+/// The modification time and date of every entry, in MS-DOS format.
+@property (nonatomic, readonly) uint16_t modificationTime;
+@property (nonatomic, readonly) uint16_t modificationDate;
+
+@property (nonatomic) BOOL failed;
+@property (nonatomic) BOOL finished;
+
+@end
+
+
+@implementation ARKBugReportArchive
+
+#pragma mark - Initialization
+
+- (instancetype)initWithFileName:(NSString *)fileName compressionLevel:(NSInteger)compressionLevel;
+{
+    NSString *const archiveFileName = [NSString stringWithFormat:@"ARKBugReportArchive-%@.zip", [NSUUID UUID].UUIDString];
+    NSURL *const fileURL = [[NSFileManager defaultManager].temporaryDirectory URLByAppendingPathComponent:archiveFileName];
+    ARKCheckCondition([[NSFileManager defaultManager] createFileAtPath:fileURL.path contents:nil attributes:nil], nil, @"Could not create bug report archive at %@", fileURL);
+    
+    NSFileHandle *const fileHandle = [NSFileHandle fileHandleForWritingToURL:fileURL error:NULL];
+    ARKCheckCondition(fileHandle != nil, nil, @"Could not open bug report archive at %@", fileURL);
+    
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+    
+    _fileName = [fileName copy];
+    _compressionLevel = (compressionLevel >= Z_NO_COMPRESSION && compressionLevel <= Z_BEST_COMPRESSION) ? compressionLevel : Z_DEFAULT_COMPRESSION;
+    _fileURL = fileURL;
+    _fileHandle = fileHandle;
+    _outputBuffer = [NSMutableData dataWithCapacity:ARKBugReportArchiveChunkSize];
+    _centralDirectory = [NSMutableData new];
+    _entryNames = [NSMutableSet new];
+    
+    NSDateComponents *const dateComponents = [[NSCalendar currentCalendar] components:(NSCalendarUnitYear | NSCalendarUnitMonth | NSCalendarUnitDay | NSCalendarUnitHour | NSCalendarUnitMinute | NSCalendarUnitSecond) fromDate:[NSDate date]];
+    _modificationTime = (uint16_t)((dateComponents.hour << 11) | (dateComponents.minute << 5) | (dateComponents.second / 2));
+    _modificationDate = (uint16_t)((MAX(dateComponents.year - 1980, 0) << 9) | (dateComponents.month << 5) | dateComponents.day);
+    
+    return self;
+}
+
+- (void)dealloc;
+{
+    [_fileHandle closeFile];
+    
+    // Once finished, the file belongs to the returned attachment.
+    if (!_finished) {
+        [[NSFileManager defaultManager] removeItemAtURL:_fileURL error:NULL];
+    }
+}
+
+#pragma mark - Public Methods
+
+- (BOOL)addAttachment:(ARKBugReportAttachment *)attachment;
+{
+    ARKCheckCondition(!self.finished, NO, @"Can not add attachments to a finished archive");
+    if (self.failed) {
+        return NO;
+    }
+    
+    if ([self _isEmptyAttachment:attachment]) {
+        return YES;
+    }
+    
+    NSString *const entryName = [self _uniqueEntryNameForFileName:attachment.fileName];
+    NSData *const entryNameData = [entryName dataUsingEncoding:NSUTF8StringEncoding];
+    unsigned long long const localHeaderOffset = self.outputLength;
+    
+    NSMutableData *const localHeader = [NSMutableData dataWithCapacity:(30 + entryNameData.length)];
+    ARKBugReportArchiveAppendUInt32(localHeader, 0x04034b50);
+    ARKBugReportArchiveAppendUInt16(localHeader, ARKBugReportArchiveVersion);
+    ARKBugReportArchiveAppendUInt16(localHeader, ARKBugReportArchiveEntryFlags);
+    ARKBugReportArchiveAppendUInt16(localHeader, ARKBugReportArchiveMethodDeflate);
+    ARKBugReportArchiveAppendUInt16(localHeader, self.modificationTime);
+    ARKBugReportArchiveAppendUInt16(localHeader, self.modificationDate);
+    // The checksum and sizes are written in the data descriptor that follows the data.
+    ARKBugReportArchiveAppendUInt32(localHeader, 0);
+    ARKBugReportArchiveAppendUInt32(localHeader, 0);
+    ARKBugReportArchiveAppendUInt32(localHeader, 0);
+    ARKBugReportArchiveAppendUInt16(localHeader, (uint16_t)entryNameData.length);
+    ARKBugReportArchiveAppendUInt16(localHeader, 0);
+    [localHeader appendData:entryNameData];
+    
+    z_stream stream = {0};
+    if (deflateInit2(&stream, (int)self.compressionLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        self.failed = YES;
+        return NO;
+    }
+    
+    __block uLong checksum = crc32(0, NULL, 0);
+    __block unsigned long long uncompressedLength = 0;
+    __block unsigned long long compressedLength = 0;
+    z_stream *const streamPointer = &stream;
+    
+    BOOL success = [self _writeData:localHeader];
+    success = success && [self _enumerateChunksOfAttachment:attachment usingBlock:^BOOL(uint8_t const *bytes, NSUInteger length) {
+        checksum = crc32(checksum, bytes, (uInt)length);
+        uncompressedLength += length;
+        return [self _deflateStream:streamPointer bytes:bytes length:length finish:NO compressedLength:&compressedLength];
+    }];
+    success = success && [self _deflateStream:streamPointer bytes:NULL length:0 finish:YES compressedLength:&compressedLength];
+    deflateEnd(&stream);
+    
+    // Without zip64 extensions, every size and offset must fit in 32 bits.
+    success = success && compressedLength <= UINT32_MAX && uncompressedLength <= UINT32_MAX && localHeaderOffset <= UINT32_MAX;
+    
+    if (success) {
+        NSMutableData *const dataDescriptor = [NSMutableData dataWithCapacity:16];
+        ARKBugReportArchiveAppendUInt32(dataDescriptor, 0x08074b50);
+        ARKBugReportArchiveAppendUInt32(dataDescriptor, (uint32_t)checksum);
+        ARKBugReportArchiveAppendUInt32(dataDescriptor, (uint32_t)compressedLength);
+        ARKBugReportArchiveAppendUInt32(dataDescriptor, (uint32_t)uncompressedLength);
+        success = [self _writeData:dataDescriptor];
+    }
+    
+    if (!success) {
+        NSLog(@"ERROR: -[%@ %@] failed to add %@ to bug report archive %@",
+              NSStringFromClass([self class]), NSStringFromSelector(_cmd),
+              attachment.fileName, self.fileURL);
+        self.failed = YES;
+        return NO;
+    }
+    
+    NSMutableData *const centralDirectory = self.centralDirectory;
+    ARKBugReportArchiveAppendUInt32(centralDirectory, 0x02014b50);
+    ARKBugReportArchiveAppendUInt16(centralDirectory, ARKBugReportArchiveVersion);
+    ARKBugReportArchiveAppendUInt16(centralDirectory, ARKBugReportArchiveVersion);
+    ARKBugReportArchiveAppendUInt16(centralDirectory, ARKBugReportArchiveEntryFlags);
+    ARKBugReportArchiveAppendUInt16(centralDirectory, ARKBugReportArchiveMethodDeflate);
+    ARKBugReportArchiveAppendUInt16(centralDirectory, self.modificationTime);
+    ARKBugReportArchiveAppendUInt16(centralDirectory, self.modificationDate);
+    ARKBugReportArchiveAppendUInt32(centralDirectory, (uint32_t)checksum);
+    ARKBugReportArchiveAppendUInt32(centralDirectory, (uint32_t)compressedLength);
+    ARKBugReportArchiveAppendUInt32(centralDirectory, (uint32_t)uncompressedLength);
+    ARKBugReportArchiveAppendUInt16(centralDirectory, (uint16_t)entryNameData.length);
+    // Extra field, comment, and disk number lengths, followed by the internal and external attributes.
+    ARKBugReportArchiveAppendUInt16(centralDirectory, 0);
+    ARKBugReportArchiveAppendUInt16(centralDirectory, 0);
+    ARKBugReportArchiveAppendUInt16(centralDirectory, 0);
+    ARKBugReportArchiveAppendUInt16(centralDirectory, 0);
+    ARKBugReportArchiveAppendUInt32(centralDirectory, 0);
+    ARKBugReportArchiveAppendUInt32(centralDirectory, (uint32_t)localHeaderOffset);
+    [centralDirectory appendData:entryNameData];
+    
+    [self.entryNames addObject:entryName];
+    
+    return YES;
+}
+
+- (ARKBugReportAttachment *)finishArchive;
+{
+    ARKCheckCondition(!self.finished, nil, @"Can not finish an archive twice");
+    if (self.failed || self.entryNames.count == 0 || self.entryNames.count > UINT16_MAX) {
+        return nil;
+    }
+    
+    unsigned long long const centralDirectoryOffset = self.outputLength;
+    if (centralDirectoryOffset > UINT32_MAX) {
+        return nil;
+    }
+    
+    NSMutableData *const endOfCentralDirectory = [NSMutableData dataWithCapacity:22];
+    ARKBugReportArchiveAppendUInt32(endOfCentralDirectory, 0x06054b50);
+    // This disk's number, and the number of the disk with the central directory.
+    ARKBugReportArchiveAppendUInt16(endOfCentralDirectory, 0);
+    ARKBugReportArchiveAppendUInt16(endOfCentralDirectory, 0);
+    ARKBugReportArchiveAppendUInt16(endOfCentralDirectory, (uint16_t)self.entryNames.count);
+    ARKBugReportArchiveAppendUInt16(endOfCentralDirectory, (uint16_t)self.entryNames.count);
+    ARKBugReportArchiveAppendUInt32(endOfCentralDirectory, (uint32_t)self.centralDirectory.length);
+    ARKBugReportArchiveAppendUInt32(endOfCentralDirectory, (uint32_t)centralDirectoryOffset);
+    ARKBugReportArchiveAppendUInt16(endOfCentralDirectory, 0);
+    
+    if (![self _writeData:self.centralDirectory] || ![self _writeData:endOfCentralDirectory] || ![self _flushOutputBuffer]) {
+        self.failed = YES;
+        return nil;
+    }
+    
+    [self.fileHandle closeFile];
+    self.finished = YES;
+    
+    return [[ARKBugReportAttachment alloc] initWithFileName:self.fileName fileURL:self.fileURL dataMIMEType:@"application/zip" deletesFileOnDeallocation:YES];
+}
+
+#pragma mark - Private Methods
+
+/// Checks the size of file-backed attachments without mapping them into memory.
+- (BOOL)_isEmptyAttachment:(ARKBugReportAttachment *)attachment;
+{
+    if (attachment.fileURL == nil) {
+        return attachment.data.length == 0;
+    }
+    
+    NSNumber *fileSize = nil;
+    if (![attachment.fileURL getResourceValue:&fileSize forKey:NSURLFileSizeKey error:NULL]) {
+        // Let reading the file report the failure.
+        return NO;
+    }
+    
+    return fileSize.unsignedLongLongValue == 0;
+}
+
+- (NSString *)_uniqueEntryNameForFileName:(NSString *)fileName;
+{
+    NSString *const baseName = (fileName.length > 0) ? fileName : @"attachment";
+    NSString *entryName = baseName;
+    for (NSUInteger suffix = 2; [self.entryNames containsObject:entryName]; suffix++) {
+        NSString *const extension = baseName.pathExtension;
+        NSString *const suffixedName = [NSString stringWithFormat:@"%@ %@", baseName.stringByDeletingPathExtension, @(suffix)];
+        entryName = (extension.length > 0) ? [suffixedName stringByAppendingPathExtension:extension] : suffixedName;
+    }
+    
+    return entryName;
+}
+
+/// Calls the block with each chunk of the attachment's contents, stopping early if the block returns NO. Returns NO if the contents could not be read or the block returned NO.
+- (BOOL)_enumerateChunksOfAttachment:(ARKBugReportAttachment *)attachment usingBlock:(BOOL (^)(uint8_t const *bytes, NSUInteger length))block;
+{
+    if (attachment.fileURL == nil) {
+        NSData *const data = attachment.data;
+        for (NSUInteger offset = 0; offset < data.length; offset += ARKBugReportArchiveChunkSize) {
+            if (!block((uint8_t const *)data.bytes + offset, MIN(ARKBugReportArchiveChunkSize, data.length - offset))) {
+                return NO;
+            }
+        }
+        
+        return YES;
+    }
+    
+    NSInputStream *const inputStream = [NSInputStream inputStreamWithURL:attachment.fileURL];
+    [inputStream open];
+    
+    uint8_t *const buffer = malloc(ARKBugReportArchiveChunkSize);
+    BOOL success = (buffer != NULL);
+    NSInteger readLength = 0;
+    while (success && (readLength = [inputStream read:buffer maxLength:ARKBugReportArchiveChunkSize]) > 0) {
+        success = block(buffer, (NSUInteger)readLength);
+    }
+    
+    free(buffer);
+    [inputStream close];
+    
+    return success && readLength == 0;
+}
+
+- (BOOL)_deflateStream:(z_stream *)stream bytes:(uint8_t const *)bytes length:(NSUInteger)length finish:(BOOL)finish compressedLength:(unsigned long long *)compressedLength;
+{
+    uint8_t outputBytes[16 * 1024];
+    
+    stream->next_in = (Bytef *)bytes;
+    stream->avail_in = (uInt)length;
+    
+    int status = Z_OK;
+    do {
+        stream->next_out = outputBytes;
+        stream->avail_out = sizeof(outputBytes);
+        
+        status = deflate(stream, finish ? Z_FINISH : Z_NO_FLUSH);
+        if (status == Z_STREAM_ERROR) {
+            return NO;
+        }
+        
+        NSUInteger const producedLength = sizeof(outputBytes) - stream->avail_out;
+        *compressedLength += producedLength;
+        if (producedLength > 0 && ![self _writeData:[NSData dataWithBytesNoCopy:outputBytes length:producedLength freeWhenDone:NO]]) {
+            return NO;
+        }
+        
+    // Until finishing, deflate only needs to be called again while it fills the output buffer.
+    } while (finish ? (status != Z_STREAM_END) : (stream->avail_out == 0));
+    
+    return YES;
+}
+
+- (BOOL)_writeData:(NSData *)data;
+{
+    [self.outputBuffer appendData:data];
+    self.outputLength += data.length;
+    
+    if (self.outputBuffer.length >= ARKBugReportArchiveChunkSize) {
+        return [self _flushOutputBuffer];
+    }
+    
+    return YES;
+}
+
+- (BOOL)_flushOutputBuffer;
+{
+    NSError *error = nil;
+    if (self.outputBuffer.length > 0 && ![self.fileHandle writeData:self.outputBuffer error:&error]) {
+        NSLog(@"ERROR: -[%@ %@] failed to write to bug report archive %@ with error %@",
+              NSStringFromClass([self class]), NSStringFromSelector(_cmd),
+              self.fileURL, error);
+        return NO;
+    }
+    
+    self.outputBuffer.length = 0;
+    return YES;
+}
+
+@end
@@ -17,8 +17,17 @@
 #import "ARKBugReportAttachment.h"
 
 
+@interface ARKBugReportAttachment ()
+
+@property (nonatomic, readonly) BOOL deletesFileOnDeallocation;
+
+@end
+
+
 @implementation ARKBugReportAttachment
 
+@synthesize data = _data;
+
 - (instancetype)initWithFileName:(NSString *)fileName data:(NSData *)data dataMIMEType:(NSString *)dataMIMEType
 {
     self = [super init];
@@ -30,4 +39,35 @@
     return self;
 }
 
+- (instancetype)initWithFileName:(NSString *)fileName fileURL:(NSURL *)fileURL dataMIMEType:(NSString *)dataMIMEType deletesFileOnDeallocation:(BOOL)deletesFileOnDeallocation
+{
+    self = [super init];
+    if (self) {
+        _fileName = [fileName copy];
+        _fileURL = [fileURL copy];
+        _dataMIMEType = [dataMIMEType copy];
+        _deletesFileOnDeallocation = deletesFileOnDeallocation;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    if (self.deletesFileOnDeallocation) {
+        [[NSFileManager defaultManager] removeItemAtURL:self.fileURL error:NULL];
+    }
+}
+
+- (NSData *)data
+{
+    @synchronized(self) {
+        if (_data == nil) {
+            // Mapping keeps the contents out of dirty memory, and stays valid even once the file is deleted.
+            _data = [NSData dataWithContentsOfURL:self.fileURL options:NSDataReadingMappedIfSafe error:NULL] ?: [NSData data];
+        }
+        
+        return _data;
+    }
+}
+
 @end
@@ -16,6 +16,65 @@
 
 #import "ARKLogDistributor+UIAdditions.h"
 
+#import "ARKScreenshotEncoder.h"
+
+@import QuartzCore;
+
+
+NSString *const ARKScreenshotMainThreadDurationParameterKey = @"Main Thread Capture (ms)";
+NSString *const ARKScreenshotProcessingDurationParameterKey = @"Processing (ms)";
+
+
+/// Returns the queue on which screenshots are composited and encoded, one at a time.
+static NSOperationQueue *ARKScreenshotProcessingQueue(void)
+{
+    static NSOperationQueue *processingQueue = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        processingQueue = [NSOperationQueue new];
+        processingQueue.name = @"ARKScreenshotProcessingQueue";
+        processingQueue.maxConcurrentOperationCount = 1;
+        processingQueue.qualityOfService = NSQualityOfServiceUtility;
+    });
+    
+    return processingQueue;
+}
+
+static NSString *ARKScreenshotMillisecondsString(CFTimeInterval duration)
+{
+    return [NSString stringWithFormat:@"%.1f", duration * 1000.0];
+}
+
+/// Draws the window snapshots, back to front, into a single pixel buffer and encodes it.
+static NSData *ARKScreenshotEncodedDataWithWindowSnapshots(NSArray<UIImage *> *windowSnapshots, ARKScreenshotEncoder *encoder)
+{
+    CGImageRef const firstWindowImage = windowSnapshots.firstObject.CGImage;
+    if (firstWindowImage == NULL) {
+        return nil;
+    }
+    
+    // Every snapshot is rendered with the same bounds and scale.
+    size_t const pixelWidth = CGImageGetWidth(firstWindowImage);
+    size_t const pixelHeight = CGImageGetHeight(firstWindowImage);
+    
+    CGColorSpaceRef const colorSpace = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+    CGContextRef const context = CGBitmapContextCreate(NULL, pixelWidth, pixelHeight, 8, 0, colorSpace, (CGBitmapInfo)kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little);
+    CGColorSpaceRelease(colorSpace);
+    if (context == NULL) {
+        return nil;
+    }
+    
+    CGRect const bounds = CGRectMake(0.0, 0.0, pixelWidth, pixelHeight);
+    for (UIImage *windowSnapshot in windowSnapshots) {
+        CGContextDrawImage(context, bounds, windowSnapshot.CGImage);
+    }
+    
+    NSData *const encodedData = [encoder encodedDataWithPixels:CGBitmapContextGetData(context) pixelWidth:pixelWidth pixelHeight:pixelHeight bytesPerRow:CGBitmapContextGetBytesPerRow(context)];
+    CGContextRelease(context);
+    
+    return encodedData;
+}
+
 
 @implementation ARKLogDistributor (UIAdditions)
 
@@ -23,27 +82,73 @@
 
 - (void)logScreenshot;
 {
-    UIImage *screenshot = nil;
+    [self logScreenshotWithEncoder:[ARKScreenshotEncoder new]];
+}
+
+- (void)logScreenshotWithEncoder:(nonnull ARKScreenshotEncoder *)encoder;
+{
+    CFTimeInterval const captureStartTime = CACurrentMediaTime();
+    NSDate *const date = [NSDate date];
+    
+    UIScreen *const screen = [UIScreen mainScreen];
+    CGRect const screenBounds = screen.bounds;
+    
+    // Drawing the view hierarchy is the most expensive part of the capture, so render no more pixels than will be encoded.
+    size_t const screenPixelWidth = (size_t)ceil(CGRectGetWidth(screenBounds) * screen.scale);
+    size_t const screenPixelHeight = (size_t)ceil(CGRectGetHeight(screenBounds) * screen.scale);
+    CGSize const scaledPixelSize = [encoder scaledPixelSizeForPixelWidth:screenPixelWidth pixelHeight:screenPixelHeight];
+    CGFloat const renderScale = (screenPixelWidth > 0) ? screen.scale * scaledPixelSize.width / screenPixelWidth : screen.scale;
     
+    UIGraphicsImageRendererFormat *const format = [UIGraphicsImageRendererFormat preferredFormat];
+    format.scale = renderScale;
+    format.preferredRange = UIGraphicsImageRendererFormatRangeStandard;
+    UIGraphicsImageRenderer *const renderer = [[UIGraphicsImageRenderer alloc] initWithBounds:screenBounds format:format];
+    
+    NSMutableArray<UIImage *> *const windowSnapshots = [NSMutableArray new];
     @try {
-        CGRect const screenBounds = [UIScreen mainScreen].bounds;
-        UIGraphicsBeginImageContextWithOptions(screenBounds.size, NO, 0.0);
         for (UIWindowScene *const scene in [UIApplication sharedApplication].connectedScenes) {
             for (UIWindow *const window in scene.windows) {
-                [window drawViewHierarchyInRect:screenBounds afterScreenUpdates:NO];
+                if (window.hidden) {
+                    continue;
+                }
+                
+                [windowSnapshots addObject:[renderer imageWithActions:^(UIGraphicsImageRendererContext *context) {
+                    [window drawViewHierarchyInRect:screenBounds afterScreenUpdates:NO];
+                }]];
             }
         }
-        
-        screenshot = UIGraphicsGetImageFromCurrentImageContext();
-        UIGraphicsEndImageContext();
     }
     @catch (NSException *exception) {
         [self logWithType:ARKLogTypeError userInfo:nil format:@"Screenshot capture failed due to %@", exception];
+        return;
     }
     
-    if (screenshot != nil) {
-        NSString *logText = @"Screenshot Logged";
-        [self logWithText:logText image:screenshot type:ARKLogTypeScreenshot parameters:@{} userInfo:nil];
+    if (windowSnapshots.count == 0) {
+        return;
     }
+    
+    CFTimeInterval const mainThreadDuration = CACurrentMediaTime() - captureStartTime;
+    Class const logMessageClass = self.logMessageClass;
+    
+    [ARKScreenshotProcessingQueue() addOperationWithBlock:^{
+        CFTimeInterval const processingStartTime = CACurrentMediaTime();
+        
+        NSData *const imageData = ARKScreenshotEncodedDataWithWindowSnapshots(windowSnapshots, encoder);
+        UIImage *const screenshot = (imageData != nil) ? [UIImage imageWithData:imageData scale:renderScale] : nil;
+        if (screenshot == nil) {
+            [self logWithType:ARKLogTypeError userInfo:nil format:@"Screenshot encoding failed"];
+            return;
+        }
+        
+        NSDictionary *const parameters = @{
+            ARKScreenshotMainThreadDurationParameterKey : ARKScreenshotMillisecondsString(mainThreadDuration),
+            ARKScreenshotProcessingDurationParameterKey : ARKScreenshotMillisecondsString(CACurrentMediaTime() - processingStartTime),
+        };
+        
+        // Hand observers the encoded data, so that they needn't re-encode the screenshot to persist it.
+        NSString *logText = @"Screenshot Logged";
+        [self logMessage:[[logMessageClass alloc] initWithText:logText image:screenshot type:ARKLogTypeScreenshot parameters:parameters userInfo:@{ ARKLogMessageImageDataKey : imageData } date:date]];
+    }];
 }
+
 @end
@@ -0,0 +1,134 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "ARKScreenshotEncoder.h"
+
+@import Accelerate;
+@import ImageIO;
+@import UniformTypeIdentifiers;
+
+
+/// Returns YES if ImageIO can write HEIC images on this device.
+static BOOL ARKScreenshotEncoderSupportsHEIC(void)
+{
+    static BOOL supportsHEIC = NO;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSArray *const typeIdentifiers = CFBridgingRelease(CGImageDestinationCopyTypeIdentifiers());
+        supportsHEIC = [typeIdentifiers containsObject:UTTypeHEIC.identifier];
+    });
+    
+    return supportsHEIC;
+}
+
+/// Frees a downscaled pixel buffer once the image drawing from it is released.
+static void ARKScreenshotEncoderFreeScaledPixels(void *info, void const *data, size_t size)
+{
+    free((void *)data);
+}
+
+
+@implementation ARKScreenshotEncoder
+
+#pragma mark - Initialization
+
+- (instancetype)init;
+{
+    self = [super init];
+    
+    _maximumPixelDimension = 1280;
+    _encoding = ARKScreenshotEncodingHEIC;
+    _compressionQuality = 0.6;
+    
+    return self;
+}
+
+#pragma mark - Properties
+
+- (NSString *)encodedDataTypeIdentifier;
+{
+    if (self.encoding == ARKScreenshotEncodingHEIC && ARKScreenshotEncoderSupportsHEIC()) {
+        return UTTypeHEIC.identifier;
+    }
+    
+    return UTTypeJPEG.identifier;
+}
+
+#pragma mark - Public Methods
+
+- (CGSize)scaledPixelSizeForPixelWidth:(size_t)pixelWidth pixelHeight:(size_t)pixelHeight;
+{
+    NSUInteger const maximumPixelDimension = self.maximumPixelDimension;
+    size_t const longestEdge = MAX(pixelWidth, pixelHeight);
+    if (maximumPixelDimension == 0 || longestEdge <= maximumPixelDimension) {
+        return CGSizeMake(pixelWidth, pixelHeight);
+    }
+    
+    CGFloat const scale = (CGFloat)maximumPixelDimension / (CGFloat)longestEdge;
+    return CGSizeMake(MAX(1.0, round(pixelWidth * scale)), MAX(1.0, round(pixelHeight * scale)));
+}
+
+- (NSData *)encodedDataWithPixels:(void const *)pixels pixelWidth:(size_t)pixelWidth pixelHeight:(size_t)pixelHeight bytesPerRow:(size_t)bytesPerRow;
+{
+    if (pixels == NULL || pixelWidth == 0 || pixelHeight == 0 || bytesPerRow < 4 * pixelWidth) {
+        return nil;
+    }
+    
+    // Read the configuration once, so a concurrent change can't produce a mismatched image.
+    CGSize const scaledSize = [self scaledPixelSizeForPixelWidth:pixelWidth pixelHeight:pixelHeight];
+    NSString *const typeIdentifier = self.encodedDataTypeIdentifier;
+    CGFloat const compressionQuality = self.compressionQuality;
+    
+    vImage_Buffer const sourceBuffer = { (void *)pixels, pixelHeight, pixelWidth, bytesPerRow };
+    vImage_Buffer scaledBuffer = sourceBuffer;
+    BOOL const downscales = ((size_t)scaledSize.width != pixelWidth || (size_t)scaledSize.height != pixelHeight);
+    if (downscales) {
+        if (vImageBuffer_Init(&scaledBuffer, (vImagePixelCount)scaledSize.height, (vImagePixelCount)scaledSize.width, 32, kvImageNoFlags) != kvImageNoError) {
+            return nil;
+        }
+        
+        // vImage's ARGB8888 functions treat the four channels alike, so they work for any channel order.
+        if (vImageScale_ARGB8888(&sourceBuffer, &scaledBuffer, NULL, kvImageHighQualityResampling) != kvImageNoError) {
+            free(scaledBuffer.data);
+            return nil;
+        }
+    }
+    
+    NSMutableData *const encodedData = [NSMutableData new];
+    
+    CGColorSpaceRef const colorSpace = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+    CGDataProviderRef const dataProvider = CGDataProviderCreateWithData(NULL, scaledBuffer.data, scaledBuffer.rowBytes * scaledBuffer.height, downscales ? ARKScreenshotEncoderFreeScaledPixels : NULL);
+    CGImageRef const image = CGImageCreate(scaledBuffer.width, scaledBuffer.height, 8, 32, scaledBuffer.rowBytes, colorSpace, (CGBitmapInfo)kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little, dataProvider, NULL, false, kCGRenderingIntentDefault);
+    CGImageDestinationRef const imageDestination = CGImageDestinationCreateWithData((__bridge CFMutableDataRef)encodedData, (__bridge CFStringRef)typeIdentifier, 1, NULL);
+    
+    BOOL success = NO;
+    if (image != NULL && imageDestination != NULL) {
+        NSDictionary *const properties = @{ (__bridge NSString *)kCGImageDestinationLossyCompressionQuality : @(compressionQuality) };
+        CGImageDestinationAddImage(imageDestination, image, (__bridge CFDictionaryRef)properties);
+        success = CGImageDestinationFinalize(imageDestination);
+    }
+    
+    if (imageDestination != NULL) {
+        CFRelease(imageDestination);
+    }
+    CGImageRelease(image);
+    CGDataProviderRelease(dataProvider);
+    CGColorSpaceRelease(colorSpace);
+    
+    return success ? encodedData : nil;
+}
+
+@end
@@ -0,0 +1,49 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+@class ARKBugReportAttachment;
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Compresses bug report attachments into a single zip archive on disk as they are added, so that large reports fit within mail size limits without each attachment being held in memory. Not threadsafe; add attachments from one queue at a time.
+@interface ARKBugReportArchive : NSObject
+
+/// Designated initializer.
+/// @param fileName File name (including extension) of the archive attachment.
+/// @param compressionLevel The zlib compression level, from 0 (no compression) to 9 (smallest). Values outside of this range use zlib's default level.
+- (nullable instancetype)initWithFileName:(NSString *)fileName compressionLevel:(NSInteger)compressionLevel NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+/// File name (including extension) of the archive attachment.
+@property (nonatomic, copy, readonly) NSString *fileName;
+
+/// The zlib compression level of the archive's entries.
+@property (nonatomic, readonly) NSInteger compressionLevel;
+
+/// Compresses the attachment's contents into the archive. Attachments backed by a file are read in chunks rather than loaded into memory. Attachments with empty data are dropped. Returns NO if the attachment could not be written, after which the archive can't be finished.
+- (BOOL)addAttachment:(ARKBugReportAttachment *)attachment;
+
+/// Completes the archive and returns it as a single zip attachment backed by its file, or nil if the archive is empty or could not be written. No attachments can be added once the archive is finished.
+- (nullable ARKBugReportAttachment *)finishArchive;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -27,6 +27,13 @@ NS_ASSUME_NONNULL_BEGIN
 /// @param dataMIMEType MIME type of the data. MIME types are as specified by the IANA: <http://www.iana.org/assignments/media-types/>.
 - (instancetype)initWithFileName:(NSString *)fileName data:(NSData *)data dataMIMEType:(NSString *)dataMIMEType NS_DESIGNATED_INITIALIZER;
 
+/// Creates an attachment whose contents are read from a file, so that large attachments needn't be held in memory. The file is mapped into memory when `data` is first read.
+/// @param fileName File name (including extension) to use when attaching to the email. The file name does not need to be unique among attachments, but should not be empty.
+/// @param fileURL URL of the file containing the attachment's contents.
+/// @param dataMIMEType MIME type of the data. MIME types are as specified by the IANA: <http://www.iana.org/assignments/media-types/>.
+/// @param deletesFileOnDeallocation Whether the attachment owns the file, and should delete it when the attachment is deallocated. Data already read from the file remains valid.
+- (instancetype)initWithFileName:(NSString *)fileName fileURL:(NSURL *)fileURL dataMIMEType:(NSString *)dataMIMEType deletesFileOnDeallocation:(BOOL)deletesFileOnDeallocation NS_DESIGNATED_INITIALIZER;
+
 - (instancetype)init NS_UNAVAILABLE;
 + (instancetype)new NS_UNAVAILABLE;
 
@@ -37,9 +44,12 @@ NS_ASSUME_NONNULL_BEGIN
 
 /// Contents of the attachment.
 ///
-/// Attachments with empty data will be dropped.
+/// Attachments with empty data will be dropped. For attachments backed by a file, this maps the file into memory.
 @property (nonatomic, copy, readonly) NSData *data;
 
+/// URL of the file containing the attachment's contents, if the attachment is backed by a file.
+@property (nonatomic, copy, readonly, nullable) NSURL *fileURL;
+
 /// MIME type of the `data` property.
 ///
 /// MIME types are as specified by the IANA: <http://www.iana.org/assignments/media-types/>.
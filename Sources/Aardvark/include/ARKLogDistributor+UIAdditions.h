@@ -18,9 +18,22 @@
 @import Foundation;
 
 
+@class ARKScreenshotEncoder;
+
+
+/// The log message parameter holding the number of milliseconds spent capturing a screenshot on the main thread.
+OBJC_EXTERN NSString *const _Nonnull ARKScreenshotMainThreadDurationParameterKey;
+
+/// The log message parameter holding the number of milliseconds spent compositing, downscaling, and encoding a screenshot in the background.
+OBJC_EXTERN NSString *const _Nonnull ARKScreenshotProcessingDurationParameterKey;
+
+
 @interface ARKLogDistributor (UIAdditions)
 
-/// Creates a log message with a screenshot and distributes the log to the log observers.
+/// Creates a log message with a screenshot and distributes the log to the log observers. Screenshots are downscaled and encoded with a default ARKScreenshotEncoder.
 - (void)logScreenshot;
 
+/// Snapshots the screen on the main thread, then composites, downscales, and encodes the screenshot with the encoder on a background queue before distributing the log to the log observers. The log message is dated when the screenshot is taken, and its parameters report the capture cost. Must be called on the main thread.
+- (void)logScreenshotWithEncoder:(nonnull ARKScreenshotEncoder *)encoder;
+
 @end
@@ -0,0 +1,52 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import CoreGraphics;
+@import Foundation;
+
+
+/// The image formats that ARKScreenshotEncoder produces.
+typedef NS_ENUM(NSUInteger, ARKScreenshotEncoding) {
+    /// JPEG, which every image viewer can open.
+    ARKScreenshotEncodingJPEG = 0,
+    
+    /// HEIC, which is typically half the size of a JPEG of the same quality. Falls back to JPEG on devices that can't encode HEIC.
+    ARKScreenshotEncodingHEIC,
+};
+
+
+/// Downscales and compresses screenshots. Operates on raw pixel buffers rather than UIKit images, so it is safe to use off of the main thread. All methods and properties on this class are threadsafe.
+@interface ARKScreenshotEncoder : NSObject
+
+/// The longest edge, in pixels, of encoded images. Larger images are downscaled to fit, preserving their aspect ratio. Defaults to 1280. Zero disables downscaling.
+@property (atomic) NSUInteger maximumPixelDimension;
+
+/// The format of encoded images. Defaults to ARKScreenshotEncodingHEIC.
+@property (atomic) ARKScreenshotEncoding encoding;
+
+/// The lossy compression quality of encoded images, from 0.0 (smallest) to 1.0 (best). Defaults to 0.6.
+@property (atomic) CGFloat compressionQuality;
+
+/// The uniform type identifier of the images that will be encoded, after falling back from HEIC if necessary.
+@property (nonnull, atomic, copy, readonly) NSString *encodedDataTypeIdentifier;
+
+/// Returns the size that an image of pixelWidth by pixelHeight pixels is downscaled to.
+- (CGSize)scaledPixelSizeForPixelWidth:(size_t)pixelWidth pixelHeight:(size_t)pixelHeight;
+
+/// Downscales and encodes a buffer of 32-bit pixels in BGRA order with premultiplied alpha, which is the layout of a bitmap context created with kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little. The pixels are only read during this call. Returns nil if the pixels could not be encoded.
+- (nullable NSData *)encodedDataWithPixels:(nonnull void const *)pixels pixelWidth:(size_t)pixelWidth pixelHeight:(size_t)pixelHeight bytesPerRow:(size_t)bytesPerRow;
+
+@end
@@ -25,12 +25,16 @@ FOUNDATION_EXPORT const unsigned char Aardvark_iOSVersionString[];
 
 #if SWIFT_PACKAGE
 #import "ARKBugReporter.h"
+#import "ARKBugReportArchive.h"
 #import "ARKBugReportAttachment.h"
 #import "ARKLogDistributor+UIAdditions.h"
+#import "ARKScreenshotEncoder.h"
 #import "ARKScreenshotLogging.h"
 #else
 #import <Aardvark/ARKBugReporter.h>
+#import <Aardvark/ARKBugReportArchive.h>
 #import <Aardvark/ARKBugReportAttachment.h>
 #import <Aardvark/ARKLogDistributor+UIAdditions.h>
+#import <Aardvark/ARKScreenshotEncoder.h>
 #import <Aardvark/ARKScreenshotLogging.h>
 #endif
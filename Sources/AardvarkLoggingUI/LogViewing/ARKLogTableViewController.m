@@ -31,7 +31,7 @@ typedef NS_ENUM(NSUInteger, ARKLogExportOption) {
     ARKLogExportOptionFile,
 };
 
-@interface ARKLogTableViewController () <UIActionSheetDelegate, UIPopoverControllerDelegate, UISearchControllerDelegate, UISearchResultsUpdating>
+@interface ARKLogTableViewController () <UIActionSheetDelegate, UIPopoverControllerDelegate, UISearchControllerDelegate, UISearchResultsUpdating, UITableViewDataSourcePrefetching>
 
 @property (nonatomic, copy) NSArray *logMessages;
 @property (nonatomic, copy) NSArray *filteredLogs;
@@ -39,6 +39,36 @@ typedef NS_ENUM(NSUInteger, ARKLogExportOption) {
 @property (nonatomic) BOOL viewWillAppearForFirstTimeCalled;
 @property (nonatomic) BOOL hasScrolledToBottom;
 
+/// The observer following the logStore, which applies each change to the table as it comes in.
+@property (nonatomic, strong) id logStoreChangeObserver;
+
+/// Set until the logStoreChangeObserver delivers the initial contents of the logStore.
+@property (nonatomic) BOOL waitingForInitialLogMessages;
+
+/// The date of the last timestamp in logMessages, which appended log messages are separated from.
+@property (nonatomic, copy) NSDate *lastTimestampDate;
+
+/// The date of the last separator in logMessages, which the timestamp deltas of appended log messages are measured from.
+@property (nonatomic, copy) NSDate *lastSeparatorDate;
+
+/// The date of the most recent separator at or before each of the logMessages, so that a row's timestamp delta doesn't depend on the rows around it. Keys are weak, so entries go away with their log messages.
+@property (nonatomic, strong, readonly) NSMapTable<ARKLogMessage *, NSDate *> *separatorDatesByLogMessage;
+
+/// The text shown for each log message that has been displayed or prefetched. Keys are weak, so entries go away with their log messages.
+@property (nonatomic, strong, readonly) NSMapTable<ARKLogMessage *, NSString *> *displayTextsByLogMessage;
+
+/// The prefetches of display text that are still running, keyed by log message.
+@property (nonatomic, strong, readonly) NSMapTable<ARKLogMessage *, NSOperation *> *prefetchOperationsByLogMessage;
+
+/// Formats the display text of prefetched rows off the main queue.
+@property (nonatomic, strong, readonly) NSOperationQueue *prefetchQueue;
+
+/// Indexes the log messages (but not their timestamps) for searching as they come in from the logStore.
+@property (nonatomic, strong, readonly) ARKLogSearchIndex *searchIndex;
+
+/// The search for the searchString, while it's running.
+@property (nonatomic, strong) NSOperation *searchOperation;
+
 @property (nonatomic, weak) UIBarButtonItem *deleteBarButtonItem;
 @property (nonatomic, weak) UIBarButtonItem *shareBarButtonItem;
 
@@ -62,6 +92,16 @@ typedef NS_ENUM(NSUInteger, ARKLogExportOption) {
     _logStore = logStore;
     _logFormatter = logFormatter;
     _minutesBetweenTimestamps = 3;
+    _searchIndex = [ARKLogSearchIndex new];
+    
+    NSPointerFunctionsOptions const weakLogMessageKeyOptions = (NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality);
+    _separatorDatesByLogMessage = [NSMapTable mapTableWithKeyOptions:weakLogMessageKeyOptions valueOptions:NSPointerFunctionsStrongMemory];
+    _displayTextsByLogMessage = [NSMapTable mapTableWithKeyOptions:weakLogMessageKeyOptions valueOptions:NSPointerFunctionsStrongMemory];
+    _prefetchOperationsByLogMessage = [NSMapTable mapTableWithKeyOptions:weakLogMessageKeyOptions valueOptions:NSPointerFunctionsStrongMemory];
+    
+    _prefetchQueue = [NSOperationQueue new];
+    _prefetchQueue.name = [NSString stringWithFormat:@"%@ Prefetch Queue (%p)", [self class], self];
+    _prefetchQueue.qualityOfService = NSQualityOfServiceUserInitiated;
     
     return self;
 }
@@ -78,7 +118,12 @@ typedef NS_ENUM(NSUInteger, ARKLogExportOption) {
 
 - (void)dealloc;
 {
-    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    [_searchOperation cancel];
+    [_prefetchQueue cancelAllOperations];
+    
+    if (_logStoreChangeObserver != nil) {
+        [_logStore removeChangeObserver:_logStoreChangeObserver];
+    }
 }
 
 #pragma mark - UIViewController
@@ -95,25 +140,19 @@ typedef NS_ENUM(NSUInteger, ARKLogExportOption) {
 
 - (void)viewWillAppear:(BOOL)animated;
 {
-    [self _reloadLogs];
+    // Once we're following the log store, the table is kept up to date as logs come in, so there's nothing to reload.
+    if (self.logStoreChangeObserver == nil) {
+        [self _reloadLogs];
+    }
     
     if (!self.viewWillAppearForFirstTimeCalled) {
         [self _viewWillAppearForFirstTime:animated];
         self.viewWillAppearForFirstTimeCalled = YES;
     }
     
-    [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_applicationDidBecomeActive:) name:UIApplicationDidBecomeActiveNotification object:[UIApplication sharedApplication]];
-    
     [super viewWillAppear:animated];
 }
 
-- (void)viewWillDisappear:(BOOL)animated;
-{
-    [[NSNotificationCenter defaultCenter] removeObserver:self name:UIApplicationDidBecomeActiveNotification object:[UIApplication sharedApplication]];
-    
-    [super viewWillDisappear:animated];
-}
-
 - (void)viewDidLoad;
 {
     [super viewDidLoad];
@@ -121,6 +160,7 @@ typedef NS_ENUM(NSUInteger, ARKLogExportOption) {
     self.tableView.separatorStyle = UITableViewCellSeparatorStyleNone;
     self.tableView.rowHeight = 34.0;
     self.tableView.dataSource = self;
+    self.tableView.prefetchDataSource = self;
     self.tableView.delegate = self;
 
     self.searchController = [[UISearchController alloc] initWithSearchResultsController:nil];
@@ -142,7 +182,6 @@ typedef NS_ENUM(NSUInteger, ARKLogExportOption) {
         self.searchString = searchController.searchBar.text;
         searchController.searchBar.placeholder = (self.searchString.length > 0) ? self.searchString : NSLocalizedString(@"Search", @"The default placeholder text for the search bar");
         [self _reloadFilteredLogs];
-        [self.tableView reloadData];
     }
 }
 
@@ -177,54 +216,16 @@ typedef NS_ENUM(NSUInteger, ARKLogExportOption) {
         cell.selectionStyle = UITableViewCellSelectionStyleNone;
     }
     
-    NSInteger index = [indexPath row];
-    ARKLogMessage *currentLog = self.filteredLogs[index];
-    
-    // Find the most recent separator log, or the first log in the list.
-    ARKLogMessage *logForTimestampDelta = nil;
-    for (NSInteger i = index; i >= 0; i--) {
-        logForTimestampDelta = self.filteredLogs[i];
-        if (logForTimestampDelta.type == ARKLogTypeSeparator) {
-            break;
-        }
-    }
-    
-    NSTimeInterval delta = logForTimestampDelta ? [currentLog.date timeIntervalSinceDate:logForTimestampDelta.date] : 0.0;
-    cell.textLabel.text = [NSString stringWithFormat:@"+%.1f\t%@", delta, currentLog.text];
+    ARKLogMessage *currentLog = self.filteredLogs[[indexPath row]];
+    cell.textLabel.text = [self _displayTextForLogMessage:currentLog];
     
     UIColor *textColor = nil;
     UIColor *backgroundColor = nil;
     switch (currentLog.type) {
         case ARKLogTypeSeparator:
-        {
-            NSCalendarUnit dayComponents = (NSCalendarUnitEra | NSCalendarUnitYear | NSCalendarUnitMonth | NSCalendarUnitDay);
-            NSDateComponents *logDateComponents = [[NSCalendar currentCalendar] components:dayComponents fromDate:currentLog.date];
-            NSDateComponents *todayDateComponents = [[NSCalendar currentCalendar] components:dayComponents fromDate:[NSDate date]];
-            
-            BOOL const logWasCreatedToday = [logDateComponents isEqual:todayDateComponents];
-            if ([currentLog isKindOfClass:[ARKTimestampLogMessage class]]) {
-                if (logWasCreatedToday) {
-                    cell.textLabel.text = [NSDateFormatter localizedStringFromDate:currentLog.date dateStyle:NSDateFormatterNoStyle timeStyle:NSDateFormatterShortStyle];
-                } else {
-                    cell.textLabel.text = [NSDateFormatter localizedStringFromDate:currentLog.date dateStyle:NSDateFormatterShortStyle timeStyle:NSDateFormatterShortStyle];
-                }
-                
-            } else {
-                if (logWasCreatedToday) {
-                    cell.textLabel.text = [NSString stringWithFormat:@"%@ -- %@",
-                                           currentLog.text,
-                                           [NSDateFormatter localizedStringFromDate:currentLog.date dateStyle:NSDateFormatterNoStyle timeStyle:NSDateFormatterMediumStyle]];
-                } else {
-                    cell.textLabel.text = [NSString stringWithFormat:@"%@ -- %@",
-                                           currentLog.text,
-                                           [NSDateFormatter localizedStringFromDate:currentLog.date dateStyle:NSDateFormatterShortStyle timeStyle:NSDateFormatterShortStyle]];
-                }
-            }
-            
             textColor = [UIColor whiteColor];
             backgroundColor = [UIColor blueColor];
             break;
-        }
         case ARKLogTypeError:
             textColor = [UIColor whiteColor];
             backgroundColor = [UIColor redColor];
@@ -246,6 +247,58 @@ typedef NS_ENUM(NSUInteger, ARKLogExportOption) {
     return cell;
 }
 
+#pragma mark - UITableViewDataSourcePrefetching
+
+- (void)tableView:(UITableView *)tableView prefetchRowsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
+{
+    for (NSIndexPath *indexPath in indexPaths) {
+        if ((NSUInteger)[indexPath row] >= self.filteredLogs.count) {
+            continue;
+        }
+        
+        ARKLogMessage *const logMessage = self.filteredLogs[[indexPath row]];
+        if ([self.displayTextsByLogMessage objectForKey:logMessage] != nil || [self.prefetchOperationsByLogMessage objectForKey:logMessage] != nil) {
+            continue;
+        }
+        
+        NSDate *const separatorDate = [self.separatorDatesByLogMessage objectForKey:logMessage];
+        
+        __weak typeof(self) weakSelf = self;
+        NSBlockOperation *const prefetchOperation = [NSBlockOperation new];
+        __weak NSBlockOperation *const weakPrefetchOperation = prefetchOperation;
+        [prefetchOperation addExecutionBlock:^{
+            NSString *const displayText = [ARKLogTableViewController _displayTextForLogMessage:logMessage separatorDate:separatorDate];
+            NSBlockOperation *const strongPrefetchOperation = weakPrefetchOperation;
+            
+            [[NSOperationQueue mainQueue] addOperationWithBlock:^{
+                typeof(self) strongSelf = weakSelf;
+                if (strongPrefetchOperation.isCancelled || [strongSelf.prefetchOperationsByLogMessage objectForKey:logMessage] != strongPrefetchOperation) {
+                    return;
+                }
+                
+                [strongSelf.prefetchOperationsByLogMessage removeObjectForKey:logMessage];
+                [strongSelf.displayTextsByLogMessage setObject:displayText forKey:logMessage];
+            }];
+        }];
+        
+        [self.prefetchOperationsByLogMessage setObject:prefetchOperation forKey:logMessage];
+        [self.prefetchQueue addOperation:prefetchOperation];
+    }
+}
+
+- (void)tableView:(UITableView *)tableView cancelPrefetchingForRowsAtIndexPaths:(NSArray<NSIndexPath *> *)indexPaths;
+{
+    for (NSIndexPath *indexPath in indexPaths) {
+        if ((NSUInteger)[indexPath row] >= self.filteredLogs.count) {
+            continue;
+        }
+        
+        ARKLogMessage *const logMessage = self.filteredLogs[[indexPath row]];
+        [[self.prefetchOperationsByLogMessage objectForKey:logMessage] cancel];
+        [self.prefetchOperationsByLogMessage removeObjectForKey:logMessage];
+    }
+}
+
 #pragma mark - UITableViewDelegate
 
 - (void)tableView:(UITableView *)tableView didSelectRowAtIndexPath:(NSIndexPath *)indexPath;
@@ -255,7 +308,8 @@ typedef NS_ENUM(NSUInteger, ARKLogExportOption) {
     }
     
     ARKLogMessage *logMessage = self.filteredLogs[[indexPath row]];
-    if (logMessage.image != nil) {
+    if (logMessage.hasImage) {
+        // The screenshot viewer decodes the image once and holds onto it for as long as it's shown.
         ARKScreenshotViewController *screenshotViewer = [[ARKScreenshotViewController alloc] initWithLogMessage:logMessage];
         
         [self.navigationController pushViewController:screenshotViewer animated:YES];
@@ -383,8 +437,8 @@ typedef NS_ENUM(NSUInteger, ARKLogExportOption) {
     UIAlertAction *deleteLogsAction = [UIAlertAction actionWithTitle:NSLocalizedString(@"Delete All Logs", @"Action sheet button to clear all logs.")
                                                                style:UIAlertActionStyleDestructive
                                                              handler:^(UIAlertAction * _Nonnull action) {
+        // The cleared logs are removed from the table as the change comes in.
         [self.logStore clearLogsWithCompletionHandler:NULL];
-        [self _reloadLogs];
     }];
     [actionSheet addAction:deleteLogsAction];
     
@@ -396,40 +450,180 @@ typedef NS_ENUM(NSUInteger, ARKLogExportOption) {
     [self presentViewController:actionSheet animated:YES completion:nil];
 }
 
-- (void)_applicationDidBecomeActive:(NSNotification *)notification;
+/// Starts following the log store from scratch, reloading the table with its current contents.
+- (void)_reloadLogs;
 {
-    [self _reloadLogs];
+    if (self.logStoreChangeObserver != nil) {
+        [self.logStore removeChangeObserver:self.logStoreChangeObserver];
+    }
+    
+    self.waitingForInitialLogMessages = YES;
+    
+    __weak typeof(self) weakSelf = self;
+    self.logStoreChangeObserver = [self.logStore addChangeObserverWithHandler:^(NSArray<ARKLogMessage *> *appendedLogMessages, NSUInteger trimmedLogMessageCount) {
+        [weakSelf _applyAppendedLogMessages:appendedLogMessages trimmedLogMessageCount:trimmedLogMessageCount];
+    }];
 }
 
-- (void)_reloadLogs;
+/// Updates the logMessages and filteredLogs with a change from the log store, inserting and deleting only the rows that changed.
+- (void)_applyAppendedLogMessages:(NSArray<ARKLogMessage *> *)appendedLogMessages trimmedLogMessageCount:(NSUInteger)trimmedLogMessageCount;
 {
-    [self.logStore retrieveAllLogMessagesWithCompletionHandler:^(NSArray *logMessages) {
-        self.logMessages = [self _logMessagesWithMinuteSeparators:logMessages];
-        [self _reloadFilteredLogs];
+    if (self.waitingForInitialLogMessages) {
+        self.waitingForInitialLogMessages = NO;
+        self.lastTimestampDate = nil;
+        self.lastSeparatorDate = nil;
+        [self.separatorDatesByLogMessage removeAllObjects];
+        [self.displayTextsByLogMessage removeAllObjects];
+        [self.prefetchOperationsByLogMessage removeAllObjects];
+        [self.prefetchQueue cancelAllOperations];
+        self.logMessages = [self _logMessagesWithMinuteSeparators:appendedLogMessages];
         
-        [self.tableView reloadData];
+        [self.searchIndex removeAllLogMessages];
+        [self.searchIndex appendLogMessages:appendedLogMessages];
+        [self _reloadFilteredLogs];
+        return;
+    }
+    
+    [self.searchIndex removeOldestLogMessages:trimmedLogMessageCount];
+    [self.searchIndex appendLogMessages:appendedLogMessages];
+    
+    // Find the first log message that wasn't trimmed. The trimmed log messages are dropped along with their timestamps, except for the timestamp that leads into the first remaining log message.
+    NSUInteger const logMessageCount = self.logMessages.count;
+    NSUInteger firstRemainingIndex = 0;
+    NSUInteger lastTimestampIndex = NSNotFound;
+    for (NSUInteger remainingTrimmedLogMessageCount = trimmedLogMessageCount; firstRemainingIndex < logMessageCount; firstRemainingIndex++) {
+        BOOL const isTimestamp = [self.logMessages[firstRemainingIndex] isKindOfClass:[ARKTimestampLogMessage class]];
+        if (isTimestamp) {
+            lastTimestampIndex = firstRemainingIndex;
+        } else if (remainingTrimmedLogMessageCount == 0) {
+            break;
+        } else {
+            remainingTrimmedLogMessageCount--;
+        }
+    }
+    
+    NSMutableIndexSet *const removedIndexes = [NSMutableIndexSet indexSetWithIndexesInRange:NSMakeRange(0, firstRemainingIndex)];
+    if (firstRemainingIndex < logMessageCount && lastTimestampIndex != NSNotFound) {
+        [removedIndexes removeIndex:lastTimestampIndex];
+    } else if (firstRemainingIndex == logMessageCount) {
+        // Everything was trimmed, so start the timestamps over.
+        self.lastTimestampDate = nil;
+        self.lastSeparatorDate = nil;
+    }
+    
+    // The filtered logs are in the same order as the logMessages, so walk them together to find the removed rows.
+    NSMutableIndexSet *const removedFilteredIndexes = [NSMutableIndexSet new];
+    NSUInteger filteredIndex = 0;
+    for (NSUInteger index = 0; index < firstRemainingIndex && filteredIndex < self.filteredLogs.count; index++) {
+        if (self.filteredLogs[filteredIndex] == self.logMessages[index]) {
+            if ([removedIndexes containsIndex:index]) {
+                [removedFilteredIndexes addIndex:filteredIndex];
+            }
+            filteredIndex++;
+        }
+    }
+    
+    NSArray *const addedLogMessages = [self _logMessagesWithMinuteSeparators:appendedLogMessages];
+    NSMutableArray *const logMessages = [self.logMessages mutableCopy];
+    [logMessages removeObjectsAtIndexes:removedIndexes];
+    [logMessages addObjectsFromArray:addedLogMessages];
+    self.logMessages = logMessages;
+    
+    if (self.searchOperation != nil) {
+        // The running search may have missed this change, so start it over now that the index has it.
+        [self _reloadFilteredLogs];
+        return;
+    }
+    
+    NSArray *const addedFilteredLogs = [self _logMessagesMatchingSearchString:addedLogMessages];
+    if (removedFilteredIndexes.count == 0 && addedFilteredLogs.count == 0) {
+        return;
+    }
+    
+    NSMutableArray *const filteredLogs = [self.filteredLogs mutableCopy];
+    [filteredLogs removeObjectsAtIndexes:removedFilteredIndexes];
+    NSUInteger const firstAddedRow = filteredLogs.count;
+    [filteredLogs addObjectsFromArray:addedFilteredLogs];
+    
+    if (!self.isViewLoaded) {
+        self.filteredLogs = filteredLogs;
+        return;
+    }
+    
+    CGFloat const distanceFromBottom = self.tableView.contentSize.height - self.tableView.contentOffset.y - self.tableView.bounds.size.height + self.tableView.contentInset.bottom;
+    BOOL const wasScrolledToBottom = (distanceFromBottom <= self.tableView.rowHeight);
+    
+    NSMutableArray<NSIndexPath *> *const deletedIndexPaths = [NSMutableArray arrayWithCapacity:removedFilteredIndexes.count];
+    [removedFilteredIndexes enumerateIndexesUsingBlock:^(NSUInteger row, BOOL *stop) {
+        [deletedIndexPaths addObject:[NSIndexPath indexPathForRow:row inSection:0]];
     }];
+    
+    NSMutableArray<NSIndexPath *> *const insertedIndexPaths = [NSMutableArray arrayWithCapacity:addedFilteredLogs.count];
+    for (NSUInteger row = firstAddedRow; row < filteredLogs.count; row++) {
+        [insertedIndexPaths addObject:[NSIndexPath indexPathForRow:row inSection:0]];
+    }
+    
+    [self.tableView performBatchUpdates:^{
+        self.filteredLogs = filteredLogs;
+        [self.tableView deleteRowsAtIndexPaths:deletedIndexPaths withRowAnimation:UITableViewRowAnimationNone];
+        [self.tableView insertRowsAtIndexPaths:insertedIndexPaths withRowAnimation:UITableViewRowAnimationNone];
+    } completion:NULL];
+    
+    if (wasScrolledToBottom) {
+        [self _scrollTableViewToBottomAnimated:NO];
+    }
 }
 
-- (void)_reloadFilteredLogs;
+- (NSArray *)_logMessagesMatchingSearchString:(NSArray *)logMessages;
 {
-    BOOL isSubsetOfPreviousFilter = self.searchStringForFilteredLogs != nil && [self.searchString containsString:self.searchStringForFilteredLogs];
-    self.searchStringForFilteredLogs = self.searchString;
+    if (self.searchStringForFilteredLogs.length == 0) {
+        return logMessages;
+    }
+    
+    // Match the same way the searchIndex does, which leaves out timestamps.
+    NSString *const searchString = self.searchStringForFilteredLogs;
+    return [logMessages filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(ARKLogMessage *logMessage, NSDictionary *bindings) {
+        return (![logMessage isKindOfClass:[ARKTimestampLogMessage class]] && [ARKLogSearchIndex logMessage:logMessage matchesSearchString:searchString]);
+    }]];
+}
 
-    if (self.searchString.length > 0 && isSubsetOfPreviousFilter) {
-        self.filteredLogs = [self.filteredLogs filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"text CONTAINS[c] %@", self.searchString]];
-    } else if (self.searchString.length > 0) {
-        self.filteredLogs = [self.logMessages filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"text CONTAINS[c] %@", self.searchString]];
-    } else {
+/// Filters the logMessages by the searchString and reloads the table. Searches run against the searchIndex off the main queue, replacing any search that's still running.
+- (void)_reloadFilteredLogs;
+{
+    [self.searchOperation cancel];
+    self.searchOperation = nil;
+    
+    NSString *const searchString = [self.searchString copy];
+    if (searchString.length == 0) {
+        self.searchStringForFilteredLogs = nil;
         self.filteredLogs = self.logMessages;
+        
+        if (self.isViewLoaded) {
+            [self.tableView reloadData];
+        }
+        return;
     }
+    
+    __weak typeof(self) weakSelf = self;
+    self.searchOperation = [self.searchIndex searchForLogMessagesMatchingString:searchString completionHandler:^(NSArray<ARKLogMessage *> *matchingLogMessages) {
+        typeof(self) strongSelf = weakSelf;
+        strongSelf.searchOperation = nil;
+        strongSelf.searchStringForFilteredLogs = searchString;
+        strongSelf.filteredLogs = matchingLogMessages;
+        
+        if (strongSelf.isViewLoaded) {
+            [strongSelf.tableView reloadData];
+        }
+    }];
 }
 
+/// Returns the log messages with timestamps between them, continuing on from the lastTimestampDate, and records the separator that each one's timestamp delta is measured from.
 - (NSArray *)_logMessagesWithMinuteSeparators:(NSArray *)logMessages;
 {
     NSMutableArray *logMessagesWithMinuteSeparators = [NSMutableArray new];
     
-    NSDate *previousTimestampDate = nil;
+    NSDate *previousTimestampDate = self.lastTimestampDate;
+    NSDate *separatorDate = self.lastSeparatorDate;
     for (ARKLogMessage *const logMessage in logMessages) {
         NSTimeInterval const secondsPerMinute = 60.0;
         if (!previousTimestampDate || [logMessage.date timeIntervalSinceDate:previousTimestampDate] > self.minutesBetweenTimestamps * secondsPerMinute) {
@@ -440,15 +634,71 @@ typedef NS_ENUM(NSUInteger, ARKLogExportOption) {
             if (timestampLogMessage != nil) {
                 [logMessagesWithMinuteSeparators addObject:timestampLogMessage];
                 previousTimestampDate = timestampDate;
+                separatorDate = timestampDate;
+                [self.separatorDatesByLogMessage setObject:separatorDate forKey:timestampLogMessage];
             }
         }
         
+        if (logMessage.type == ARKLogTypeSeparator) {
+            separatorDate = logMessage.date;
+        }
+        if (separatorDate != nil) {
+            [self.separatorDatesByLogMessage setObject:separatorDate forKey:logMessage];
+        }
+        
         [logMessagesWithMinuteSeparators addObject:logMessage];
     }
     
+    self.lastTimestampDate = previousTimestampDate;
+    self.lastSeparatorDate = separatorDate;
     return logMessagesWithMinuteSeparators;
 }
 
+/// Returns the text to show for the log message, formatting it unless it was already shown or prefetched.
+- (NSString *)_displayTextForLogMessage:(ARKLogMessage *)logMessage;
+{
+    NSString *displayText = [self.displayTextsByLogMessage objectForKey:logMessage];
+    if (displayText == nil) {
+        displayText = [[self class] _displayTextForLogMessage:logMessage separatorDate:[self.separatorDatesByLogMessage objectForKey:logMessage]];
+        [self.displayTextsByLogMessage setObject:displayText forKey:logMessage];
+    }
+    
+    return displayText;
+}
+
+/// Formats the text shown for the log message. Safe to call from any thread.
++ (NSString *)_displayTextForLogMessage:(ARKLogMessage *)logMessage separatorDate:(NSDate *)separatorDate;
+{
+    if (logMessage.type != ARKLogTypeSeparator) {
+        NSTimeInterval const delta = (separatorDate != nil) ? [logMessage.date timeIntervalSinceDate:separatorDate] : 0.0;
+        return [NSString stringWithFormat:@"+%.1f\t%@", delta, logMessage.text];
+    }
+    
+    NSCalendarUnit dayComponents = (NSCalendarUnitEra | NSCalendarUnitYear | NSCalendarUnitMonth | NSCalendarUnitDay);
+    NSDateComponents *logDateComponents = [[NSCalendar currentCalendar] components:dayComponents fromDate:logMessage.date];
+    NSDateComponents *todayDateComponents = [[NSCalendar currentCalendar] components:dayComponents fromDate:[NSDate date]];
+    
+    BOOL const logWasCreatedToday = [logDateComponents isEqual:todayDateComponents];
+    if ([logMessage isKindOfClass:[ARKTimestampLogMessage class]]) {
+        if (logWasCreatedToday) {
+            return [NSDateFormatter localizedStringFromDate:logMessage.date dateStyle:NSDateFormatterNoStyle timeStyle:NSDateFormatterShortStyle];
+        } else {
+            return [NSDateFormatter localizedStringFromDate:logMessage.date dateStyle:NSDateFormatterShortStyle timeStyle:NSDateFormatterShortStyle];
+        }
+        
+    } else {
+        if (logWasCreatedToday) {
+            return [NSString stringWithFormat:@"%@ -- %@",
+                    logMessage.text,
+                    [NSDateFormatter localizedStringFromDate:logMessage.date dateStyle:NSDateFormatterNoStyle timeStyle:NSDateFormatterMediumStyle]];
+        } else {
+            return [NSString stringWithFormat:@"%@ -- %@",
+                    logMessage.text,
+                    [NSDateFormatter localizedStringFromDate:logMessage.date dateStyle:NSDateFormatterShortStyle timeStyle:NSDateFormatterShortStyle]];
+        }
+    }
+}
+
 - (void)_viewWillAppearForFirstTime:(BOOL)animated;
 {
     UIBarButtonItem *shareButton = [[UIBarButtonItem alloc] initWithBarButtonSystemItem:UIBarButtonSystemItemAction target:self action:@selector(_openActivitySheet:)];
@@ -23,6 +23,8 @@
 
 - (void)_reloadLogs;
 
+- (nonnull NSString *)_displayTextForLogMessage:(nonnull ARKLogMessage *)logMessage;
+
 @end
 
 
@@ -127,4 +127,45 @@
     [self waitForExpectationsWithTimeout:5.0 handler:nil];
 }
 
+- (void)test_displayTextForLogMessage_measuresDeltaFromMostRecentSeparator;
+{
+    NSDate *now = [NSDate date];
+    [self.logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:@"Checkpoint" image:nil type:ARKLogTypeSeparator parameters:@{} userInfo:nil date:[NSDate dateWithTimeInterval:-5.0 sinceDate:now]]];
+    [self.logStore observeLogMessage:[[ARKFakeLogMessage alloc] initWithDate:[NSDate dateWithTimeInterval:-2.5 sinceDate:now]]];
+
+    [self.logTableViewController _reloadLogs];
+
+    [self expectationForPredicate:[NSPredicate predicateWithFormat:@"logMessages.@count == 3"] evaluatedWithObject:self.logTableViewController handler:nil];
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+
+    ARKLogMessage *const logMessage = self.logTableViewController.logMessages[2];
+    XCTAssertEqualObjects([self.logTableViewController _displayTextForLogMessage:logMessage], @"+2.5\tFake Log");
+}
+
+- (void)test_reloadLogs_appliesNewLogsWithoutReloading;
+{
+    NSDate *now = [NSDate date];
+    [self.logStore observeLogMessage:[[ARKFakeLogMessage alloc] initWithDate:[NSDate dateWithTimeInterval:-10.0 sinceDate:now]]];
+
+    [self.logTableViewController _reloadLogs];
+
+    [self expectationForPredicate:[NSPredicate predicateWithFormat:@"logMessages.@count == 2"] evaluatedWithObject:self.logTableViewController handler:nil];
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+
+    ARKLogMessage *const firstLogMessage = self.logTableViewController.logMessages[1];
+    [self.logStore observeLogMessage:[[ARKFakeLogMessage alloc] initWithDate:now]];
+
+    [self expectationForPredicate:[NSPredicate predicateWithFormat:@"logMessages.@count == 3"] evaluatedWithObject:self.logTableViewController handler:nil];
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+
+    // The existing log message is kept rather than re-read, and the new one doesn't need a new timestamp.
+    XCTAssertEqual(self.logTableViewController.logMessages[1], firstLogMessage);
+    XCTAssertEqualObjects([self.logTableViewController.logMessages[2] date], now);
+
+    [self.logStore clearLogsWithCompletionHandler:NULL];
+
+    [self expectationForPredicate:[NSPredicate predicateWithFormat:@"logMessages.@count == 0"] evaluatedWithObject:self.logTableViewController handler:nil];
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
 @end
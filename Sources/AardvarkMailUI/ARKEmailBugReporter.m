@@ -78,6 +78,7 @@ NSString *const ARKScreenshotFlashAnimationKey = @"ScreenshotFlashAnimation";
     _numberOfRecentErrorLogsToIncludeInEmailBodyWhenAttachmentsAreUnavailable = 15;
     _emailComposeWindowLevel = UIWindowLevelStatusBar + 3.0;
     _attachesViewHierarchyDescription = YES;
+    _attachmentArchiveCompressionLevel = 6;
 
     _mutableLogStores = [NSMutableArray new];
 
@@ -273,9 +274,20 @@ NSString *const ARKScreenshotFlashAnimationKey = @"ScreenshotFlashAnimation";
     dispatch_group_t logStoreRetrievalDispatchGroup = dispatch_group_create();
     dispatch_group_enter(logStoreRetrievalDispatchGroup);
 
+    BOOL const attachmentsAreAvailable = [MFMailComposeViewController canSendMail];
     NSArray<ARKLogStore *> *const logStores = configuration.logStores;
     for (ARKLogStore *logStore in logStores) {
         dispatch_group_enter(logStoreRetrievalDispatchGroup);
+
+        if (!attachmentsAreAvailable) {
+            // Only the most recent errors make it into the email body, so there's no need to read the rest of the logs.
+            [logStore retrieveLogMessagesFromDate:nil toDate:nil types:ARKLogTypeMaskError limit:self.numberOfRecentErrorLogsToIncludeInEmailBodyWhenAttachmentsAreUnavailable newestFirst:YES completionHandler:^(NSArray *logMessages) {
+                [logStoresToLogMessagesMap setObject:[[logMessages reverseObjectEnumerator] allObjects] forKey:logStore];
+                dispatch_group_leave(logStoreRetrievalDispatchGroup);
+            }];
+            continue;
+        }
+
         [logStore retrieveAllLogMessagesWithCompletionHandler:^(NSArray *logMessages) {
             [logStoresToLogMessagesMap setObject:logMessages forKey:logStore];
 
@@ -291,7 +303,7 @@ NSString *const ARKScreenshotFlashAnimationKey = @"ScreenshotFlashAnimation";
         }];
     }
 
-    if ([MFMailComposeViewController canSendMail]) {
+    if (attachmentsAreAvailable) {
         self.mailComposeViewController = [MFMailComposeViewController new];
 
         [self.mailComposeViewController setToRecipients:@[self.bugReportRecipientEmailAddress]];
@@ -300,6 +312,7 @@ NSString *const ARKScreenshotFlashAnimationKey = @"ScreenshotFlashAnimation";
         // Once all log messages have been retrieved, attach the data and show the compose window.
         dispatch_group_notify(logStoreRetrievalDispatchGroup, dispatch_get_main_queue(), ^{
             NSMutableString *const emailBody = [self _prefilledEmailBodyWithEmailBodyAdditions:emailBodyAdditions];
+            NSMutableArray<ARKBugReportAttachment *> *const attachments = [NSMutableArray new];
 
             for (ARKLogStore *logStore in logStores) {
                 NSArray *const logMessages = [logStoresToLogMessagesMap objectForKey:logStore];
@@ -309,18 +322,14 @@ NSString *const ARKScreenshotFlashAnimationKey = @"ScreenshotFlashAnimation";
                                                                                                                                        logStoreName:[logStore name]];
 
                     if (screenshotAttachment != nil) {
-                        [self.mailComposeViewController addAttachmentData:screenshotAttachment.data
-                                                                 mimeType:screenshotAttachment.dataMIMEType
-                                                                 fileName:screenshotAttachment.fileName];
+                        [attachments addObject:screenshotAttachment];
                     }
                 }
 
                 ARKBugReportAttachment *logsAttachment = [logStoresToLogMessagesAttachmentMap objectForKey:logStore];
 
                 if (logsAttachment != nil) {
-                    [self.mailComposeViewController addAttachmentData:logsAttachment.data
-                                                             mimeType:logsAttachment.dataMIMEType
-                                                             fileName:logsAttachment.fileName];
+                    [attachments addObject:logsAttachment];
                 }
 
                 NSMutableString *const emailBodyForLogStore = [NSMutableString new];
@@ -342,19 +351,17 @@ NSString *const ARKScreenshotFlashAnimationKey = @"ScreenshotFlashAnimation";
             }
 
             if (configuration.includesViewHierarchyDescription && self.viewHierarchyAttachment != nil) {
-                [self.mailComposeViewController addAttachmentData:self.viewHierarchyAttachment.data
-                                                         mimeType:self.viewHierarchyAttachment.dataMIMEType
-                                                         fileName:self.viewHierarchyAttachment.fileName];
+                [attachments addObject:self.viewHierarchyAttachment];
             }
             self.viewHierarchyAttachment = nil;
 
-            for (ARKBugReportAttachment *attachment in configuration.additionalAttachments) {
-                [self.mailComposeViewController addAttachmentData:attachment.data mimeType:attachment.dataMIMEType fileName:attachment.fileName];
-            }
+            [attachments addObjectsFromArray:configuration.additionalAttachments];
 
-            [self.mailComposeViewController setMessageBody:emailBody isHTML:NO];
-            self.mailComposeViewController.mailComposeDelegate = self;
-            [self _showEmailComposeWindow];
+            [self _addAttachments:attachments toMailComposeViewControllerWithCompletion:^{
+                [self.mailComposeViewController setMessageBody:emailBody isHTML:NO];
+                self.mailComposeViewController.mailComposeDelegate = self;
+                [self _showEmailComposeWindow];
+            }];
         });
 
     } else {
@@ -376,6 +383,43 @@ NSString *const ARKScreenshotFlashAnimationKey = @"ScreenshotFlashAnimation";
     dispatch_group_leave(logStoreRetrievalDispatchGroup);
 }
 
+/// Adds the attachments to the mail compose view controller, then calls the completion on the main queue. When bundling attachments, they are compressed into a single archive off the main queue, falling back to attaching them individually if the archive can't be written.
+- (void)_addAttachments:(NSArray<ARKBugReportAttachment *> *)attachments toMailComposeViewControllerWithCompletion:(dispatch_block_t)completion;
+{
+    void (^const addAttachmentsIndividually)(void) = ^{
+        for (ARKBugReportAttachment *attachment in attachments) {
+            [self.mailComposeViewController addAttachmentData:attachment.data mimeType:attachment.dataMIMEType fileName:attachment.fileName];
+        }
+        completion();
+    };
+
+    if (!self.bundlesAttachmentsInCompressedArchive || attachments.count == 0) {
+        addAttachmentsIndividually();
+        return;
+    }
+
+    NSInteger const compressionLevel = self.attachmentArchiveCompressionLevel;
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        ARKBugReportArchive *const archive = [[ARKBugReportArchive alloc] initWithFileName:@"BugReport.zip" compressionLevel:compressionLevel];
+        BOOL archived = (archive != nil);
+        for (ARKBugReportAttachment *attachment in attachments) {
+            archived = archived && [archive addAttachment:attachment];
+        }
+
+        ARKBugReportAttachment *const archiveAttachment = archived ? [archive finishArchive] : nil;
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (archiveAttachment == nil) {
+                addAttachmentsIndividually();
+                return;
+            }
+
+            [self.mailComposeViewController addAttachmentData:archiveAttachment.data mimeType:archiveAttachment.dataMIMEType fileName:archiveAttachment.fileName];
+            completion();
+        });
+    });
+}
+
 - (void)_showEmailComposeWindow;
 {
     self.previousKeyWindow = [ARKEmailBugReporter _keyWindow];
@@ -102,6 +102,12 @@ typedef void (^ARKEmailBugReporterCustomPromptCompletionBlock)(ARKEmailBugReport
 /// Controls whether the bug reporter should generate and attach a description of the view hierarchy. Defaults to YES.
 @property (nonatomic) BOOL attachesViewHierarchyDescription;
 
+/// Controls whether the bug report's attachments are compressed into a single zip archive rather than attached individually, which keeps large logs within mail size limits. Defaults to NO.
+@property (nonatomic) BOOL bundlesAttachmentsInCompressedArchive;
+
+/// The zlib compression level, from 0 to 9, used when bundling attachments into a compressed archive. Defaults to 6.
+@property (nonatomic) NSInteger attachmentArchiveCompressionLevel;
+
 /// Returns an attachment containing the log messages. Defaults to a plain text attachment containing each log message formatted using the bug reporter's `logFormatter`.
 - (nullable ARKBugReportAttachment *)attachmentForLogMessages:(nonnull NSArray<ARKLogMessage *> *)logMessages inLogStoreNamed:(nonnull NSString *)logStoreName __attribute__((deprecated("Use the async version of this method that takes a completion handler: attachmentForLogMessages:inLogStoreNamed:completion: instead.")));
 
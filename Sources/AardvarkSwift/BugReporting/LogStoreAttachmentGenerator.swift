@@ -90,23 +90,34 @@ public final class LogStoreAttachmentGenerator: NSObject {
         in logMessages: [ARKLogMessage],
         logStoreName: String?
     ) -> ARKBugReportAttachment? {
-        guard
-            let screenshotMessage = logMessages.reversed().first(where: { $0.type == .screenshot }),
-            let imageData = screenshotMessage.image?.pngData()
-        else {
+        guard let screenshotMessage = logMessages.reversed().first(where: { $0.type == .screenshot }) else {
+            return nil
+        }
+
+        // Attach the screenshot as it was stored, rather than decoding it and re-encoding it as a PNG.
+        let imageData: Data
+        let imageType: ImageType
+        if let storedImageData = screenshotMessage.imageData, let storedImageType = ImageType(imageData: storedImageData) {
+            imageData = storedImageData
+            imageType = storedImageType
+        } else if let pngData = screenshotMessage.image?.pngData() {
+            imageData = pngData
+            imageType = .png
+        } else {
             return nil
         }
 
         return ARKBugReportAttachment(
-            fileName: screenshotFileName(for: logStoreName),
+            fileName: screenshotFileName(for: logStoreName, pathExtension: imageType.pathExtension),
             data: imageData,
-            dataMIMEType: "image/png"
+            dataMIMEType: imageType.mimeType
         )
     }
 
     /// Generates an attachment containing the log messages formatted using the specified formatter.
     ///
-    /// Returns `nil` if there are no log messages.
+    /// The formatted messages are streamed to a temporary file that backs the attachment, so the formatted log is never
+    /// held in memory as a whole. Returns `nil` if there are no log messages.
     ///
     /// - parameter logMessages: The log messages to be included in the attachment.
     /// - parameter logFormatter: The formatter with which to format the log messages.
@@ -121,18 +132,7 @@ public final class LogStoreAttachmentGenerator: NSObject {
             return nil
         }
 
-        let formattedLogData = logMessages
-            .map(logFormatter.formattedLogMessage(_:))
-            .joined(separator: "\n")
-            .data(using: .utf8)!
-
-        let fileName = logsFileName(for: logStoreName, fileType: "txt")
-
-        return ARKBugReportAttachment(
-            fileName: fileName,
-            data: formattedLogData,
-            dataMIMEType: "text/plain"
-        )
+        return formattedLogsAttachment(for: logMessages, using: logFormatter, logStoreName: logStoreName)
     }
 
     /// Generates an attachment containing the log messages formatted using the specified formatter and return the results asynchronously via a completion handler.
@@ -157,18 +157,7 @@ public final class LogStoreAttachmentGenerator: NSObject {
         }
 
         DispatchQueue.global(qos: .userInitiated).async {
-            let formattedLogData = logMessages
-                .map(logFormatter.formattedLogMessage(_:))
-                .joined(separator: "\n")
-                .data(using: .utf8)!
-
-            let fileName = logsFileName(for: logStoreName, fileType: "txt")
-
-            let attachment = ARKBugReportAttachment(
-                fileName: fileName,
-                data: formattedLogData,
-                dataMIMEType: "text/plain"
-            )
+            let attachment = formattedLogsAttachment(for: logMessages, using: logFormatter, logStoreName: logStoreName)
 
             DispatchQueue.main.async {
                 completion(attachment)
@@ -176,12 +165,217 @@ public final class LogStoreAttachmentGenerator: NSObject {
         }
     }
 
+    /// Writes the log messages, formatted using the specified formatter and separated by newlines, to the stream.
+    ///
+    /// Messages are formatted and written in chunks, so memory use is bounded by the size of a chunk rather than the
+    /// size of the formatted log. When the formatter supports concurrent formatting, chunks are formatted in parallel
+    /// across the available cores and written in order. The stream must already be open.
+    ///
+    /// - parameter logMessages: The log messages to be written.
+    /// - parameter logFormatter: The formatter with which to format the log messages.
+    /// - parameter outputStream: The open stream to which the formatted messages are written.
+    @objc(writeLogMessages:usingLogFormatter:toOutputStream:error:)
+    public static func write(
+        _ logMessages: [ARKLogMessage],
+        using logFormatter: ARKLogFormatter = ARKDefaultLogFormatter(),
+        to outputStream: OutputStream
+    ) throws {
+        let workerCount = ProcessInfo.processInfo.activeProcessorCount
+        if logFormatter.supportsConcurrentFormatting == true, workerCount > 1, logMessages.count > parallelFormattingBatchSize {
+            try writeInParallel(logMessages, using: logFormatter, to: outputStream, workerCount: workerCount)
+            return
+        }
+
+        var chunk = Data()
+        chunk.reserveCapacity(formattedLogChunkByteCount)
+
+        for (index, logMessage) in logMessages.enumerated() {
+            try autoreleasepool {
+                if index > 0 {
+                    chunk.append(UInt8(ascii: "\n"))
+                }
+                chunk.append(contentsOf: logFormatter.formattedLogMessage(logMessage).utf8)
+
+                if chunk.count >= formattedLogChunkByteCount {
+                    try write(chunk, to: outputStream)
+                    chunk.removeAll(keepingCapacity: true)
+                }
+            }
+        }
+
+        try write(chunk, to: outputStream)
+    }
+
+    // MARK: - Private Types
+
+    /// The formats screenshots are stored in, told apart by the signature at the start of their data.
+    private enum ImageType {
+
+        case png
+        case jpeg
+        case heic
+
+        init?(imageData: Data) {
+            let bytes = [UInt8](imageData.prefix(12))
+            if bytes.starts(with: [0x89, 0x50, 0x4E, 0x47]) {
+                self = .png
+            } else if bytes.starts(with: [0xFF, 0xD8, 0xFF]) {
+                self = .jpeg
+            } else if bytes.count == 12, bytes[4..<8].elementsEqual("ftyp".utf8), ["heic", "heix", "mif1"].contains(where: { bytes[8..<12].elementsEqual($0.utf8) }) {
+                self = .heic
+            } else {
+                return nil
+            }
+        }
+
+        var mimeType: String {
+            switch self {
+            case .png:
+                return "image/png"
+            case .jpeg:
+                return "image/jpeg"
+            case .heic:
+                return "image/heic"
+            }
+        }
+
+        var pathExtension: String {
+            switch self {
+            case .png:
+                return "png"
+            case .jpeg:
+                return "jpg"
+            case .heic:
+                return "heic"
+            }
+        }
+
+    }
+
+    // MARK: - Private Static Properties
+
+    /// The number of bytes of formatted messages to accumulate before writing them out.
+    private static let formattedLogChunkByteCount = 64 * 1024
+
+    /// The number of messages each worker formats at a time when formatting in parallel.
+    private static let parallelFormattingBatchSize = 256
 
     // MARK: - Private Static Methods
 
-    private static func screenshotFileName(for logStoreName: String?) -> String {
+    private static func formattedLogsAttachment(
+        for logMessages: [ARKLogMessage],
+        using logFormatter: ARKLogFormatter,
+        logStoreName: String?
+    ) -> ARKBugReportAttachment? {
+        let fileName = logsFileName(for: logStoreName, fileType: "txt")
+        let fileURL = FileManager.default.temporaryDirectory
+            .appendingPathComponent("ARKLogStoreAttachment-\(UUID().uuidString)")
+            .appendingPathExtension("txt")
+
+        if let outputStream = OutputStream(url: fileURL, append: false) {
+            outputStream.open()
+            defer { outputStream.close() }
+
+            do {
+                try write(logMessages, using: logFormatter, to: outputStream)
+
+                return ARKBugReportAttachment(
+                    fileName: fileName,
+                    fileURL: fileURL,
+                    dataMIMEType: "text/plain",
+                    deletesFileOnDeallocation: true
+                )
+
+            } catch {
+                NSLog("ERROR: Failed to write logs attachment to %@ with error %@", fileURL.path, String(describing: error))
+                try? FileManager.default.removeItem(at: fileURL)
+            }
+        }
+
+        // Fall back to formatting into memory, which still avoids building the log as a single string.
+        let memoryStream = OutputStream.toMemory()
+        memoryStream.open()
+        defer { memoryStream.close() }
+
+        guard
+            (try? write(logMessages, using: logFormatter, to: memoryStream)) != nil,
+            let formattedLogData = memoryStream.property(forKey: .dataWrittenToMemoryStreamKey) as? Data
+        else {
+            return nil
+        }
+
+        return ARKBugReportAttachment(
+            fileName: fileName,
+            data: formattedLogData,
+            dataMIMEType: "text/plain"
+        )
+    }
+
+    /// Formats a batch of messages per worker at a time, then writes the batches in order before moving on, so memory use
+    /// is bounded by the number of workers rather than the size of the formatted log.
+    private static func writeInParallel(
+        _ logMessages: [ARKLogMessage],
+        using logFormatter: ARKLogFormatter,
+        to outputStream: OutputStream,
+        workerCount: Int
+    ) throws {
+        let batchSize = parallelFormattingBatchSize
+        let messagesPerPass = batchSize * workerCount * 2
+
+        var passStartIndex = 0
+        while passStartIndex < logMessages.count {
+            let passEndIndex = min(passStartIndex + messagesPerPass, logMessages.count)
+            let batchCount = (passEndIndex - passStartIndex + batchSize - 1) / batchSize
+
+            var formattedBatches = [Data](repeating: Data(), count: batchCount)
+            formattedBatches.withUnsafeMutableBufferPointer { formattedBatches in
+                DispatchQueue.concurrentPerform(iterations: batchCount) { batchIndex in
+                    autoreleasepool {
+                        let startIndex = passStartIndex + batchIndex * batchSize
+                        let endIndex = min(startIndex + batchSize, passEndIndex)
+
+                        var formattedBatch = Data()
+                        for index in startIndex..<endIndex {
+                            if index > 0 {
+                                formattedBatch.append(UInt8(ascii: "\n"))
+                            }
+                            formattedBatch.append(contentsOf: logFormatter.formattedLogMessage(logMessages[index]).utf8)
+                        }
+
+                        // Each worker writes only its own element.
+                        formattedBatches[batchIndex] = formattedBatch
+                    }
+                }
+            }
+
+            for formattedBatch in formattedBatches {
+                try write(formattedBatch, to: outputStream)
+            }
+
+            passStartIndex = passEndIndex
+        }
+    }
+
+    private static func write(_ data: Data, to outputStream: OutputStream) throws {
+        try data.withUnsafeBytes { (buffer: UnsafeRawBufferPointer) in
+            guard let baseAddress = buffer.bindMemory(to: UInt8.self).baseAddress else {
+                return
+            }
+
+            var offset = 0
+            while offset < buffer.count {
+                let writtenCount = outputStream.write(baseAddress + offset, maxLength: buffer.count - offset)
+                guard writtenCount > 0 else {
+                    throw outputStream.streamError ?? CocoaError(.fileWriteUnknown)
+                }
+                offset += writtenCount
+            }
+        }
+    }
+
+    private static func screenshotFileName(for logStoreName: String?, pathExtension: String) -> String {
         var fileName = NSLocalizedString("screenshot", comment: "File name of a screenshot")
-        fileName = URL(fileURLWithPath: fileName).appendingPathExtension("png").lastPathComponent
+        fileName = URL(fileURLWithPath: fileName).appendingPathExtension(pathExtension).lastPathComponent
         if let logStoreName = logStoreName, !logStoreName.isEmpty {
             fileName = "\(logStoreName)_\(fileName)"
         }
@@ -0,0 +1,119 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import Aardvark
+import XCTest
+
+final class ARKBugReportArchiveTests: XCTestCase {
+
+    func testArchiveContainsEachAttachment() throws {
+        let archive = try XCTUnwrap(ARKBugReportArchive(fileName: "BugReport.zip", compressionLevel: 6))
+
+        XCTAssertTrue(archive.addAttachment(ARKBugReportAttachment(fileName: "logs.txt", data: Data("logs".utf8), dataMIMEType: "text/plain")))
+        XCTAssertTrue(archive.addAttachment(ARKBugReportAttachment(fileName: "logs.txt", data: Data("more logs".utf8), dataMIMEType: "text/plain")))
+
+        let attachment = try XCTUnwrap(archive.finishArchive())
+        XCTAssertEqual(attachment.fileName, "BugReport.zip")
+        XCTAssertEqual(attachment.dataMIMEType, "application/zip")
+
+        let data = attachment.data
+        XCTAssertEqual(data.littleEndianUInt32(at: 0), 0x04034b50)
+
+        // The end of central directory record is the last 22 bytes, since the archive has no comment.
+        let endOfCentralDirectoryOffset = data.count - 22
+        XCTAssertEqual(data.littleEndianUInt32(at: endOfCentralDirectoryOffset), 0x06054b50)
+        XCTAssertEqual(data.littleEndianUInt16(at: endOfCentralDirectoryOffset + 10), 2)
+
+        // Entries with duplicate names are renamed rather than overwritten.
+        XCTAssertNotNil(data.range(of: Data("logs 2.txt".utf8)))
+    }
+
+    func testArchiveCompressesFileBackedAttachments() throws {
+        let logs = Data(String(repeating: "2026-01-01 12:00:00 Some repetitive log message\n", count: 10_000).utf8)
+        let fileURL = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        try logs.write(to: fileURL)
+
+        let archive = try XCTUnwrap(ARKBugReportArchive(fileName: "BugReport.zip", compressionLevel: 9))
+        XCTAssertTrue(archive.addAttachment(ARKBugReportAttachment(
+            fileName: "logs.txt",
+            fileURL: fileURL,
+            dataMIMEType: "text/plain",
+            deletesFileOnDeallocation: true
+        )))
+
+        let attachment = try XCTUnwrap(archive.finishArchive())
+        XCTAssertLessThan(attachment.data.count, logs.count / 10)
+
+        // The uncompressed size is recorded in the entry's central directory record.
+        let centralDirectoryOffset = Int(try XCTUnwrap(attachment.data.littleEndianUInt32(at: attachment.data.count - 6)))
+        XCTAssertEqual(attachment.data.littleEndianUInt32(at: centralDirectoryOffset + 24), UInt32(logs.count))
+    }
+
+    func testEmptyArchiveIsNotFinished() throws {
+        let archive = try XCTUnwrap(ARKBugReportArchive(fileName: "BugReport.zip", compressionLevel: 6))
+        XCTAssertNil(archive.finishArchive())
+    }
+
+    func testEmptyAttachmentsAreDropped() throws {
+        let fileURL = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        try Data().write(to: fileURL)
+
+        let archive = try XCTUnwrap(ARKBugReportArchive(fileName: "BugReport.zip", compressionLevel: 6))
+        XCTAssertTrue(archive.addAttachment(ARKBugReportAttachment(fileName: "logs.txt", data: Data(), dataMIMEType: "text/plain")))
+        XCTAssertTrue(archive.addAttachment(ARKBugReportAttachment(
+            fileName: "logs.txt",
+            fileURL: fileURL,
+            dataMIMEType: "text/plain",
+            deletesFileOnDeallocation: true
+        )))
+
+        // An archive holding only empty attachments is as empty as one with no attachments.
+        XCTAssertNil(archive.finishArchive())
+    }
+
+    func testEmptyAttachmentsDoNotClaimEntryNames() throws {
+        let archive = try XCTUnwrap(ARKBugReportArchive(fileName: "BugReport.zip", compressionLevel: 6))
+
+        XCTAssertTrue(archive.addAttachment(ARKBugReportAttachment(fileName: "logs.txt", data: Data(), dataMIMEType: "text/plain")))
+        XCTAssertTrue(archive.addAttachment(ARKBugReportAttachment(fileName: "logs.txt", data: Data("logs".utf8), dataMIMEType: "text/plain")))
+
+        let data = try XCTUnwrap(archive.finishArchive()).data
+        let endOfCentralDirectoryOffset = data.count - 22
+        XCTAssertEqual(data.littleEndianUInt16(at: endOfCentralDirectoryOffset + 10), 1)
+        XCTAssertNil(data.range(of: Data("logs 2.txt".utf8)))
+    }
+
+}
+
+// MARK: -
+
+private extension Data {
+
+    func littleEndianUInt16(at offset: Int) -> UInt16? {
+        guard offset >= 0, offset + 2 <= count else {
+            return nil
+        }
+        return UInt16(self[startIndex + offset]) | UInt16(self[startIndex + offset + 1]) << 8
+    }
+
+    func littleEndianUInt32(at offset: Int) -> UInt32? {
+        guard let low = littleEndianUInt16(at: offset), let high = littleEndianUInt16(at: offset + 2) else {
+            return nil
+        }
+        return UInt32(low) | UInt32(high) << 16
+    }
+
+}
@@ -31,4 +31,23 @@ final class ARKBugReportAttachmentTests: XCTestCase {
         XCTAssertEqual(attachment.dataMIMEType, dataMIMEType)
     }
 
+    func testFileBackedInitialization() throws {
+        let data = Data(base64Encoded: "SGVsbG8gd29ybGQK")!
+        let fileURL = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        try data.write(to: fileURL)
+
+        var attachment: ARKBugReportAttachment? = ARKBugReportAttachment(
+            fileName: "FILE_NAME",
+            fileURL: fileURL,
+            dataMIMEType: "MIME_TYPE",
+            deletesFileOnDeallocation: true
+        )
+
+        XCTAssertEqual(attachment?.fileURL, fileURL)
+        XCTAssertEqual(attachment?.data, data)
+
+        attachment = nil
+        XCTAssertFalse(FileManager.default.fileExists(atPath: fileURL.path))
+    }
+
 }
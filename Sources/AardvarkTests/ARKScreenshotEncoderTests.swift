@@ -0,0 +1,102 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import Aardvark
+import ImageIO
+import UniformTypeIdentifiers
+import XCTest
+
+final class ARKScreenshotEncoderTests: XCTestCase {
+
+    func test_scaledPixelSize_fitsLongestEdgeToMaximumPixelDimension() {
+        let encoder = ARKScreenshotEncoder()
+        encoder.maximumPixelDimension = 100
+
+        XCTAssertEqual(encoder.scaledPixelSize(forPixelWidth: 400, pixelHeight: 200), CGSize(width: 100, height: 50))
+        XCTAssertEqual(encoder.scaledPixelSize(forPixelWidth: 200, pixelHeight: 400), CGSize(width: 50, height: 100))
+        XCTAssertEqual(encoder.scaledPixelSize(forPixelWidth: 80, pixelHeight: 60), CGSize(width: 80, height: 60))
+
+        encoder.maximumPixelDimension = 0
+        XCTAssertEqual(encoder.scaledPixelSize(forPixelWidth: 400, pixelHeight: 200), CGSize(width: 400, height: 200))
+    }
+
+    func test_encodedData_downscalesPixelBuffer() throws {
+        let encoder = ARKScreenshotEncoder()
+        encoder.maximumPixelDimension = 32
+        encoder.encoding = .JPEG
+
+        let data = try XCTUnwrap(encodedData(with: encoder, width: 128, height: 64))
+        let pixelSize = try XCTUnwrap(self.pixelSize(of: data))
+
+        XCTAssertEqual(pixelSize, CGSize(width: 32, height: 16))
+        XCTAssertEqual(encoder.encodedDataTypeIdentifier, UTType.jpeg.identifier)
+    }
+
+    func test_encodedData_matchesEncodedDataTypeIdentifier() throws {
+        let encoder = ARKScreenshotEncoder()
+        encoder.encoding = .HEIC
+
+        let data = try XCTUnwrap(encodedData(with: encoder, width: 16, height: 16))
+        let source = try XCTUnwrap(CGImageSourceCreateWithData(data as CFData, nil))
+
+        XCTAssertEqual(CGImageSourceGetType(source) as String?, encoder.encodedDataTypeIdentifier)
+    }
+
+    func test_encodedData_lowerQualityIsSmaller() throws {
+        let encoder = ARKScreenshotEncoder()
+        encoder.encoding = .JPEG
+
+        encoder.compressionQuality = 1.0
+        let bestData = try XCTUnwrap(encodedData(with: encoder, width: 256, height: 256))
+
+        encoder.compressionQuality = 0.1
+        let smallestData = try XCTUnwrap(encodedData(with: encoder, width: 256, height: 256))
+
+        XCTAssertLessThan(smallestData.count, bestData.count)
+    }
+
+    // MARK: - Private Methods
+
+    /// Encodes a gradient, in the BGRA layout the encoder expects.
+    private func encodedData(with encoder: ARKScreenshotEncoder, width: Int, height: Int) -> Data? {
+        let bytesPerRow = 4 * width
+        var pixels = [UInt8](repeating: 0xFF, count: bytesPerRow * height)
+        for y in 0..<height {
+            for x in 0..<width {
+                let offset = y * bytesPerRow + 4 * x
+                pixels[offset] = UInt8(truncatingIfNeeded: x * 7)
+                pixels[offset + 1] = UInt8(truncatingIfNeeded: y * 5)
+                pixels[offset + 2] = UInt8(truncatingIfNeeded: x ^ y)
+            }
+        }
+
+        return pixels.withUnsafeBytes { buffer in
+            encoder.encodedData(withPixels: buffer.baseAddress!, pixelWidth: width, pixelHeight: height, bytesPerRow: bytesPerRow)
+        }
+    }
+
+    private func pixelSize(of data: Data) -> CGSize? {
+        guard
+            let source = CGImageSourceCreateWithData(data as CFData, nil),
+            let image = CGImageSourceCreateImageAtIndex(source, 0, nil)
+        else {
+            return nil
+        }
+
+        return CGSize(width: image.width, height: image.height)
+    }
+
+}
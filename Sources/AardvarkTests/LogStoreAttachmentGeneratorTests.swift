@@ -68,6 +68,56 @@ final class LogStoreAttachmentGeneratorTests: XCTestCase {
         )
     }
 
+    func testLogMessageAttachmentIsBackedByFile() throws {
+        let logMessages = [
+            ARKLogMessage(text: "Message A", image: nil, type: .default, parameters: [:], userInfo: nil),
+            ARKLogMessage(text: "Message B", image: nil, type: .default, parameters: [:], userInfo: nil),
+        ]
+
+        var attachment = LogStoreAttachmentGenerator.attachment(for: logMessages, using: TestFormatter(), logStoreName: nil)
+        let fileURL = try XCTUnwrap(attachment?.fileURL)
+
+        XCTAssertEqual(try String(contentsOf: fileURL, encoding: .utf8), "Message A\nMessage B")
+
+        // The temporary file is owned by the attachment.
+        attachment = nil
+        XCTAssertFalse(FileManager.default.fileExists(atPath: fileURL.path))
+    }
+
+    func testWriteLogMessagesStreamsMessagesLargerThanAChunk() throws {
+        let text = String(repeating: "a", count: 1000)
+        let logMessages = (0..<200).map { _ in
+            ARKLogMessage(text: text, image: nil, type: .default, parameters: [:], userInfo: nil)
+        }
+
+        let outputStream = OutputStream.toMemory()
+        outputStream.open()
+        try LogStoreAttachmentGenerator.write(logMessages, using: TestFormatter(), to: outputStream)
+        outputStream.close()
+
+        let data = try XCTUnwrap(outputStream.property(forKey: .dataWrittenToMemoryStreamKey) as? Data)
+        XCTAssertEqual(
+            String(data: data, encoding: .utf8),
+            Array(repeating: text, count: 200).joined(separator: "\n")
+        )
+    }
+
+    func testWriteLogMessagesInParallelMatchesSerialFormatting() throws {
+        let formatter = ARKDefaultLogFormatter()
+        let logMessages = Factory.logMessages(count: 2_000)
+
+        let outputStream = OutputStream.toMemory()
+        outputStream.open()
+        try LogStoreAttachmentGenerator.write(logMessages, using: formatter, to: outputStream)
+        outputStream.close()
+
+        let data = try XCTUnwrap(outputStream.property(forKey: .dataWrittenToMemoryStreamKey) as? Data)
+        XCTAssertEqual(
+            String(data: data, encoding: .utf8),
+            logMessages.map(formatter.formattedLogMessage(_:)).joined(separator: "\n")
+        )
+    }
+
     // MARK: - Tests - Screenshot Attachment
 
     func testScreenshotAttachmentName() throws {
@@ -89,6 +139,51 @@ final class LogStoreAttachmentGeneratorTests: XCTestCase {
         )
     }
 
+    func testScreenshotAttachmentUsesStoredImageData() throws {
+        let jpegData = try XCTUnwrap(Factory.fakeScreenshotImage.jpegData(compressionQuality: 0.5))
+        let logMessages = [
+            ARKLogMessage(
+                text: "Message",
+                image: Factory.fakeScreenshotImage,
+                type: .screenshot,
+                parameters: [:],
+                userInfo: [ARKLogMessageImageDataKey: jpegData]
+            ),
+        ]
+
+        let attachment = try XCTUnwrap(LogStoreAttachmentGenerator.attachmentForLatestScreenshot(in: logMessages, logStoreName: nil))
+        XCTAssertEqual(attachment.data, jpegData)
+        XCTAssertEqual(attachment.dataMIMEType, "image/jpeg")
+        XCTAssertEqual(attachment.fileName, "screenshot.jpg")
+    }
+
+    // MARK: - Performance Tests
+
+    /// Measures formatting by joining every formatted message into a single string, as attachments were once generated.
+    func testSerialJoinedFormattingPerformance() {
+        let formatter = ARKDefaultLogFormatter()
+        let logMessages = Factory.logMessages(count: 20_000)
+
+        measure {
+            _ = logMessages
+                .map(formatter.formattedLogMessage(_:))
+                .joined(separator: "\n")
+                .data(using: .utf8)!
+        }
+    }
+
+    func testParallelStreamingFormattingPerformance() {
+        let formatter = ARKDefaultLogFormatter()
+        let logMessages = Factory.logMessages(count: 20_000)
+
+        measure {
+            let outputStream = OutputStream.toMemory()
+            outputStream.open()
+            try? LogStoreAttachmentGenerator.write(logMessages, using: formatter, to: outputStream)
+            outputStream.close()
+        }
+    }
+
 }
 
 // MARK: -
@@ -105,6 +200,19 @@ private final class TestFormatter: NSObject, ARKLogFormatter {
 
 private enum Factory {
 
+    static func logMessages(count: Int) -> [ARKLogMessage] {
+        let types: [ARKLogType] = [.default, .error, .separator]
+        return (0..<count).map { index in
+            ARKLogMessage(
+                text: "Message \(index)",
+                image: nil,
+                type: types[index % types.count],
+                parameters: ["index": "\(index)", "parity": index.isMultiple(of: 2) ? "even" : "odd"],
+                userInfo: nil
+            )
+        }
+    }
+
     static let fakeScreenshotImage: UIImage = {
         let view = UIView(frame: .init(x: 0, y: 0, width: 100, height: 100))
         view.backgroundColor = .black
@@ -20,16 +20,198 @@
 #import "AardvarkDefines.h"
 #import "../private/NSFileHandle+ARKAdditions.h"
 
+#import <sys/file.h>
+
 
 NSUInteger const ARKMaximumChunkSizeForTrimOperation = (1024 * 1024);
 
+/// The default groupCommitThreshold.
+static NSUInteger const ARKDefaultGroupCommitThreshold = (64 * 1024);
+
+/// Identifies a persisted block index file ("ARKI"). Bump the version whenever the layout of the file changes.
+static uint32_t const ARKBlockIndexFileMagic = 0x41524B49;
+static uint32_t const ARKBlockIndexFileVersion = 1;
+
+/// The block index file starts with the magic, the version, the length of the archive file it describes, and the number of blocks (all big-endian), followed by the offset of each block.
+static NSUInteger const ARKBlockIndexFileHeaderLength = (2 * sizeof(uint32_t) + 2 * sizeof(uint64_t));
+
+/// Identifies a circular archive file ("ARKR"). Bump the version whenever the layout of the file changes.
+static uint32_t const ARKCircularArchiveMagic = 0x41524B52;
+static uint32_t const ARKCircularArchiveVersion = 2;
+
+/// The version of circular archives whose blocks were written without checksums.
+static uint32_t const ARKUnchecksummedCircularArchiveVersion = 1;
+
+/// A circular archive file starts with the magic, the version, the capacity of the data region, the positions of the oldest block (the head) and of the next write (the tail) within the data region, and the number of blocks (all big-endian). The data region follows.
+static NSUInteger const ARKCircularArchiveHeaderLength = (2 * sizeof(uint32_t) + 4 * sizeof(uint64_t));
+
+/// Identifies a compressed archive file ("ARKZ"). Bump the version whenever the layout of the file changes.
+static uint32_t const ARKCompressedArchiveMagic = 0x41524B5A;
+static uint32_t const ARKCompressedArchiveVersion = 2;
+
+/// The version of compressed archives whose frames were written without checksums.
+static uint32_t const ARKUnchecksummedCompressedArchiveVersion = 1;
+
+/// A compressed archive file starts with the magic and the version (both big-endian), followed by frames. Each frame is written as a data block.
+static NSUInteger const ARKCompressedArchiveHeaderLength = (2 * sizeof(uint32_t));
+
+/// A frame starts with the number of objects it holds and their uncompressed length (both big-endian), followed by the objects' framed data blocks compressed together. The header lets the archive be indexed without decompressing any frames.
+static NSUInteger const ARKCompressedArchiveFrameHeaderLength = (2 * sizeof(uint32_t));
+
+/// The most uncompressed bytes of data blocks gathered into a frame, unless a single block is larger. Every read of an object decompresses its whole frame.
+static NSUInteger const ARKCompressedArchiveMaximumFrameLength = (64 * 1024);
+
+/// The lock file of a shared archive holds the generation of the archive (bumped whenever an archive rewrites or truncates existing blocks) and the sequence number of its oldest block, so that archives in other processes know when to re-index.
+static NSUInteger const ARKSharedArchiveLockFileLength = (2 * sizeof(uint64_t));
+
+/// The sharedArchiveGeneration of a shared archive that hasn't been opened yet.
+static uint64_t const ARKSharedArchiveGenerationNotIndexed = UINT64_MAX;
+
+/// The number of bytes that store the length of a framed data block, which precede its contents. Blocks are framed this way while they wait to be written, and within the frames of a compressed archive, where the frame's checksum covers them. Archives written before data blocks had checksummed headers framed every block this way.
+static NSUInteger const ARKFramedDataBlockLengthMarkerSize = sizeof(uint32_t);
+
+
+typedef struct {
+    uint64_t capacity;
+    uint64_t headPosition;
+    uint64_t tailPosition;
+    uint64_t blockCount;
+} ARKCircularArchiveHeader;
+
+
+/// Returns the contents of the data block at blockOffset within the mapped archive, as a view onto the mapped bytes rather than a copy. Returns nil and passes back NO if the block is damaged or runs past the end of the archive.
+static NSData *ARKDataBlockInMappedArchive(NSData *mappedArchive, ARKFileOffset blockOffset, BOOL *success)
+{
+    NSUInteger const archiveLength = mappedArchive.length;
+    if (blockOffset > archiveLength) {
+        *success = NO;
+        return nil;
+    }
+    
+    uint8_t const *const blockBytes = (uint8_t const *)mappedArchive.bytes + blockOffset;
+    NSUInteger dataBlockLength = 0;
+    if (!ARKValidateDataBlock(blockBytes, archiveLength - (NSUInteger)blockOffset, &dataBlockLength, NULL)) {
+        *success = NO;
+        return nil;
+    }
+    
+    *success = YES;
+    return [NSData dataWithBytesNoCopy:(void *)(blockBytes + ARKDataBlockHeaderSize) length:dataBlockLength freeWhenDone:NO];
+}
+
+/// Returns the contents of the framed data block at position within framedDataBlocks, as a view onto its bytes rather than a copy. Returns nil if the block is empty or runs past endPosition.
+static NSData *ARKFramedDataBlockInData(NSData *framedDataBlocks, NSUInteger position, NSUInteger endPosition)
+{
+    if (endPosition > framedDataBlocks.length || position > endPosition || endPosition - position < ARKFramedDataBlockLengthMarkerSize) {
+        return nil;
+    }
+    
+    uint8_t const *const blockBytes = (uint8_t const *)framedDataBlocks.bytes + position;
+    NSUInteger const dataBlockLength = OSReadBigInt32(blockBytes, 0);
+    if (dataBlockLength == 0 || dataBlockLength > endPosition - position - ARKFramedDataBlockLengthMarkerSize) {
+        return nil;
+    }
+    
+    return [NSData dataWithBytesNoCopy:(void *)(blockBytes + ARKFramedDataBlockLengthMarkerSize) length:dataBlockLength freeWhenDone:NO];
+}
+
+/// Decompresses a frame of a compressed archive and returns the data blocks it holds, or nil if the frame is corrupted.
+static NSArray<NSData *> *ARKDataBlocksInCompressedFrame(NSData *frame)
+{
+    if (frame.length <= ARKCompressedArchiveFrameHeaderLength) {
+        return nil;
+    }
+    
+    uint8_t const *const frameBytes = frame.bytes;
+    uint32_t const blockCount = OSReadBigInt32(frameBytes, 0);
+    uint32_t const uncompressedLength = OSReadBigInt32(frameBytes, sizeof(uint32_t));
+    
+    NSData *const compressedDataBlocks = [NSData dataWithBytesNoCopy:(void *)(frameBytes + ARKCompressedArchiveFrameHeaderLength) length:(frame.length - ARKCompressedArchiveFrameHeaderLength) freeWhenDone:NO];
+    NSData *const framedDataBlocks = [compressedDataBlocks decompressedDataUsingAlgorithm:NSDataCompressionAlgorithmLZFSE error:NULL];
+    if (framedDataBlocks.length != uncompressedLength) {
+        return nil;
+    }
+    
+    NSMutableArray<NSData *> *const dataBlocks = [NSMutableArray arrayWithCapacity:blockCount];
+    for (NSUInteger position = 0; position < framedDataBlocks.length;) {
+        NSData *const dataBlock = ARKFramedDataBlockInData(framedDataBlocks, position, framedDataBlocks.length);
+        if (dataBlock == nil) {
+            return nil;
+        }
+        
+        // Copy the data block out, since the view onto framedDataBlocks doesn't keep it alive.
+        [dataBlocks addObject:[framedDataBlocks subdataWithRange:NSMakeRange(position + ARKFramedDataBlockLengthMarkerSize, dataBlock.length)]];
+        position += ARKFramedDataBlockLengthMarkerSize + dataBlock.length;
+    }
+    
+    return (dataBlocks.count == blockCount) ? dataBlocks : nil;
+}
+
+
+@interface ARKDataArchiveCursor ()
+
+- (nonnull instancetype)initWithDataArchive:(nonnull ARKDataArchive *)dataArchive objectType:(nonnull Class)objectType options:(ARKDataArchiveReadOptions)options pageSize:(NSUInteger)pageSize NS_DESIGNATED_INITIALIZER;
+
+/// Set once the first page has been read. Only accessed on the dataArchive's fileOperationQueue.
+@property (nonatomic) BOOL hasStarted;
+
+/// The sequence number of the next object to read when reading oldest first, or one past it when reading newest first. Only accessed on the dataArchive's fileOperationQueue.
+@property (nonatomic) uint64_t nextSequenceNumber;
+
+/// The sequence numbers of the objects that have been read and not yet reported as trimmed are [oldestReadSequenceNumber, endOfReadSequenceNumber). Only accessed on the dataArchive's fileOperationQueue.
+@property (nonatomic) uint64_t oldestReadSequenceNumber;
+@property (nonatomic) uint64_t endOfReadSequenceNumber;
+
+@end
+
 
 @interface ARKDataArchive ()
 
 @property (nonnull, nonatomic, readonly) NSFileHandle *fileHandle;
 @property (nonnull, nonatomic, readonly) NSOperationQueue *fileOperationQueue;
 
-@property (nonatomic) NSUInteger objectCount;
+/// The URL of the file that persists blockOffsets between runs, so that re-opening the archive doesn't require walking every block.
+@property (nonnull, nonatomic, copy, readonly) NSURL *blockIndexFileURL;
+
+/// The file offset of each valid block in the archive, stored as ARKFileOffset values. Only accessed on the fileOperationQueue.
+@property (nonnull, nonatomic, readonly) NSMutableData *blockOffsets;
+
+/// The offset at which the last valid block in the archive ends. Only accessed on the fileOperationQueue.
+@property (nonatomic) ARKFileOffset endOfArchiveOffset;
+
+/// Set when the block index file on disk matches the in-memory block index. Only accessed on the fileOperationQueue.
+@property (nonatomic) BOOL persistedBlockIndexIsCurrent;
+
+/// Data blocks that have been appended but not yet written to the file, each preceded by its length. They're given checksummed headers as they're written. Guarded by @synchronized(self).
+@property (nonnull, nonatomic, readonly) NSMutableData *pendingDataBlocks;
+
+/// Set while an operation to write the pendingDataBlocks is on the fileOperationQueue. Guarded by @synchronized(self).
+@property (nonatomic) BOOL pendingWriteIsQueued;
+
+/// Set while waiting for the groupCommitInterval to elapse before queueing a write of the pendingDataBlocks. Guarded by @synchronized(self).
+@property (nonatomic) BOOL pendingWriteTimerIsRunning;
+
+/// The position of the oldest block within the data region of a circular archive. Only accessed on the fileOperationQueue.
+@property (nonatomic) ARKFileOffset circularArchiveHeadPosition;
+
+/// The position within the data region of a circular archive at which the next block will be written, unless it needs to wrap around. Only accessed on the fileOperationQueue.
+@property (nonatomic) ARKFileOffset circularArchiveTailPosition;
+
+/// The sequence number of the oldest block in the archive. Every block's sequence number is one greater than the block before it, so sequence numbers identify blocks as older blocks are trimmed. Each block's sequence number is written into its header, and picked up again from the oldest block when the archive is opened. Only accessed on the fileOperationQueue.
+@property (nonatomic) uint64_t firstObjectSequenceNumber;
+
+/// The file whose advisory lock is held while a shared archive's file is used. Nil unless sharedAcrossProcesses is set.
+@property (nullable, nonatomic, readonly) NSFileHandle *lockFileHandle;
+
+/// The number of nested calls holding the lock on the lockFileHandle. Only accessed on the fileOperationQueue.
+@property (nonatomic) NSUInteger lockDepth;
+
+/// The generation of a shared archive that the blockOffsets were indexed in. Only accessed on the fileOperationQueue.
+@property (nonatomic) uint64_t sharedArchiveGeneration;
+
+@property (nonatomic, readonly) NSUInteger objectCount;
+
+- (void)_readNextPageForCursor:(nonnull ARKDataArchiveCursor *)cursor onQueue:(nonnull NSOperationQueue *)queue completionHandler:(nonnull void (^)(NSArray * _Nonnull objects, NSUInteger trimmedObjectCount, BOOL hasMoreObjects))completionHandler;
 
 @end
 
@@ -38,9 +220,11 @@ NSUInteger const ARKMaximumChunkSizeForTrimOperation = (1024 * 1024);
 
 #pragma mark - Initialization
 
-- (nullable instancetype)initWithURL:(nonnull NSURL *)fileURL maximumObjectCount:(NSUInteger)maximumObjectCount trimmedObjectCount:(NSUInteger)trimmedObjectCount;
+- (nullable instancetype)initWithURL:(nonnull NSURL *)fileURL maximumObjectCount:(NSUInteger)maximumObjectCount trimmedObjectCount:(NSUInteger)trimmedObjectCount format:(ARKDataArchiveFormat)format circularArchiveCapacity:(unsigned long long)circularArchiveCapacity sharedAcrossProcesses:(BOOL)sharedAcrossProcesses;
 {
     ARKCheckCondition([fileURL isFileURL], nil, @"Must provide a file URL!");
+    ARKCheckCondition(format != ARKDataArchiveFormatCircular || circularArchiveCapacity > ARKDataBlockHeaderSize, nil, @"Must provide a circularArchiveCapacity large enough to hold an object");
+    ARKCheckCondition(!sharedAcrossProcesses || format == ARKDataArchiveFormatAppendOnly, nil, @"Archives shared across processes must be append-only");
     NSString *const fileURLPath = fileURL.path;
     ARKCheckCondition(fileURLPath.length > 0, nil, @"No path at file URL");
     
@@ -58,11 +242,30 @@ NSUInteger const ARKMaximumChunkSizeForTrimOperation = (1024 * 1024);
     
     ARKCheckCondition(fileHandle != nil, nil, @"Couldn't create file handle for %@, got error %@", fileURL, error);
     
+    if (sharedAcrossProcesses) {
+        NSURL *const lockFileURL = [fileURL URLByAppendingPathExtension:@"lock"];
+        if (![[NSFileManager defaultManager] fileExistsAtPath:lockFileURL.path]) {
+            [[NSFileManager defaultManager] createFileAtPath:lockFileURL.path contents:nil attributes:nil];
+        }
+        
+        _lockFileHandle = [NSFileHandle fileHandleForUpdatingURL:lockFileURL error:&error];
+        ARKCheckCondition(_lockFileHandle != nil, nil, @"Couldn't create file handle for %@, got error %@", lockFileURL, error);
+    }
+    
     _archiveFileURL = [fileURL copy];
+    _blockIndexFileURL = [fileURL URLByAppendingPathExtension:@"index"];
     _fileHandle = fileHandle;
+    _blockOffsets = [NSMutableData new];
+    _pendingDataBlocks = [NSMutableData new];
+    _groupCommitThreshold = ARKDefaultGroupCommitThreshold;
     
     _maximumObjectCount = maximumObjectCount;
     _trimmedObjectCount = trimmedObjectCount;
+    _format = format;
+    _circularArchiveCapacity = (format == ARKDataArchiveFormatCircular) ? circularArchiveCapacity : 0;
+    _sharedAcrossProcesses = sharedAcrossProcesses;
+    
+    _sharedArchiveGeneration = ARKSharedArchiveGenerationNotIndexed;
     
     _fileOperationQueue = [NSOperationQueue new];
     _fileOperationQueue.name = [NSString stringWithFormat:@"%@ File Operation Queue", self];
@@ -71,78 +274,137 @@ NSUInteger const ARKMaximumChunkSizeForTrimOperation = (1024 * 1024);
     _fileOperationQueue.qualityOfService = NSQualityOfServiceBackground;
     
     [_fileOperationQueue addOperationWithBlock:^{
-        // Count the number of (valid) archived objects.
-        self.objectCount = [self.fileHandle ARK_seekToDataBlockAtIndex:NSUIntegerMax];
-        
-        // Truncate corrupted content (if any).
-        [self.fileHandle truncateFileAtOffset:self.fileHandle.offsetInFile];
-        
-        // If maximumObjectCount is smaller than what was used previously, we may need to trim.
-        [self _trimArchiveIfNecessary_inFileOperationQueue];
+        [self _performWithArchiveLock_inFileOperationQueue:^{
+            // An archive written before data blocks had checksums is rewritten with them, and then opened like any other append-only archive.
+            NSArray<NSData *> *const unchecksummedDataBlocks = [self _readUnchecksummedArchiveDataBlocks_inFileOperationQueue];
+            if (unchecksummedDataBlocks != nil) {
+                [[NSFileManager defaultManager] removeItemAtURL:self.blockIndexFileURL error:NULL];
+                [self _rewriteArchiveWithDataBlocks_inFileOperationQueue:unchecksummedDataBlocks];
+            }
+            
+            switch (self.format) {
+                case ARKDataArchiveFormatAppendOnly:
+                    [self _openAppendOnlyArchive_inFileOperationQueue];
+                    break;
+                
+                case ARKDataArchiveFormatCircular:
+                    [self _openCircularArchive_inFileOperationQueue];
+                    break;
+                
+                case ARKDataArchiveFormatCompressed:
+                    [self _openCompressedArchive_inFileOperationQueue];
+                    break;
+            }
+            
+            [self _adoptSequenceNumberOfOldestBlock_inFileOperationQueue];
+            
+            // If maximumObjectCount is smaller than what was used previously, we may need to trim.
+            [self _trimArchiveIfNecessary_inFileOperationQueue];
+        }];
     }];
     
     return self;
 }
 
+- (nullable instancetype)initWithURL:(nonnull NSURL *)fileURL maximumObjectCount:(NSUInteger)maximumObjectCount trimmedObjectCount:(NSUInteger)trimmedObjectCount format:(ARKDataArchiveFormat)format circularArchiveCapacity:(unsigned long long)circularArchiveCapacity;
+{
+    return [self initWithURL:fileURL maximumObjectCount:maximumObjectCount trimmedObjectCount:trimmedObjectCount format:format circularArchiveCapacity:circularArchiveCapacity sharedAcrossProcesses:NO];
+}
+
+- (nullable instancetype)initWithURL:(nonnull NSURL *)fileURL maximumObjectCount:(NSUInteger)maximumObjectCount trimmedObjectCount:(NSUInteger)trimmedObjectCount;
+{
+    return [self initWithURL:fileURL maximumObjectCount:maximumObjectCount trimmedObjectCount:trimmedObjectCount format:ARKDataArchiveFormatAppendOnly circularArchiveCapacity:0];
+}
+
 #pragma mark - Public Methods
 
 - (void)appendArchiveOfObject:(nonnull id <NSSecureCoding>)object;
 {
-    NSError *error = nil;
-    NSData *data = [NSKeyedArchiver archivedDataWithRootObject:object requiringSecureCoding:NO error:&error];
+    NSData *const data = [self _archivedDataWithObject:object];
+    if (data.length > 0) {
+        void (^const appendedObjectDataHandler)(NSArray<NSData *> *) = self.appendedObjectDataHandler;
+        if (appendedObjectDataHandler != NULL) {
+            appendedObjectDataHandler(@[ data ]);
+        }
+        
+        // Frame the block now, so that all of the pending blocks can be written to the file at once.
+        NSMutableData *const framedDataBlock = [NSMutableData dataWithCapacity:ARKFramedDataBlockLengthMarkerSize + data.length];
+        [self _appendFramedDataBlockWithData:data toData:framedDataBlock];
+        [self _appendPendingFramedDataBlocks:framedDataBlock];
+    }
+}
 
-    ARKCheckCondition(error == nil, , @"Couldn't archive object %@", object);
+- (void)appendArchivesOfObjects:(nonnull NSArray<id <NSSecureCoding>> *)objects;
+{
+    void (^const appendedObjectDataHandler)(NSArray<NSData *> *) = self.appendedObjectDataHandler;
+    NSMutableArray<NSData *> *const appendedObjectData = (appendedObjectDataHandler != NULL) ? [NSMutableArray arrayWithCapacity:objects.count] : nil;
     
-    if (data.length > 0) {
-        [self.fileOperationQueue addOperationWithBlock:^{
-            [self.fileHandle ARK_appendDataBlock:data];
-            self.objectCount++;
+    NSMutableData *const framedDataBlocks = [NSMutableData new];
+    for (id <NSSecureCoding> object in objects) {
+        @autoreleasepool {
+            NSData *const data = [self _archivedDataWithObject:object];
+            if (data.length > 0) {
+                [self _appendFramedDataBlockWithData:data toData:framedDataBlocks];
+                [appendedObjectData addObject:data];
+            }
+        }
+    }
+    
+    if (appendedObjectData.count > 0) {
+        appendedObjectDataHandler(appendedObjectData);
+    }
+    
+    if (framedDataBlocks.length > 0) {
+        [self _appendPendingFramedDataBlocks:framedDataBlocks];
+    }
+}
+
+- (void)appendObjectDataAfterNewestObjectUsingHandler:(nonnull NSArray<NSData *> * _Nonnull (^)(NSData * _Nullable newestObjectData))handler;
+{
+    ARKCheckCondition(handler != NULL, , @"Must provide a handler!");
+    
+    [self.fileOperationQueue addOperationWithBlock:^{
+        [self _performWithArchiveLock_inFileOperationQueue:^{
+            // Objects appended since this operation was queued are still pending, so they're neither passed to the handler nor written ahead of its object data.
+            NSArray<NSData *> *const objectData = handler([self _newestObjectData_inFileOperationQueue]);
+            if (objectData.count == 0) {
+                return;
+            }
             
-            [self _trimArchiveIfNecessary_inFileOperationQueue];
+            NSMutableData *const framedDataBlocks = [NSMutableData new];
+            for (NSData *data in objectData) {
+                if (data.length > 0) {
+                    [self _appendFramedDataBlockWithData:data toData:framedDataBlocks];
+                }
+            }
+            
+            @synchronized(self) {
+                [self.pendingDataBlocks replaceBytesInRange:NSMakeRange(0, 0) withBytes:framedDataBlocks.bytes length:framedDataBlocks.length];
+            }
+            
+            [self _writePendingDataBlocks_inFileOperationQueue];
         }];
-    }
+    }];
 }
 
 - (void)readObjectsFromArchiveOfType:(nonnull Class)objectType completionHandler:(nonnull void (^)(NSArray * _Nonnull unarchivedObjects))completionHandler;
+{
+    [self readObjectsFromArchiveOfType:objectType options:ARKDataArchiveReadOptionsNone limit:0 recordFilter:NULL objectFilter:NULL completionHandler:completionHandler];
+}
+
+- (void)readObjectsFromArchiveOfType:(nonnull Class)objectType options:(ARKDataArchiveReadOptions)options limit:(NSUInteger)limit recordFilter:(nullable BOOL (^)(NSData * _Nonnull objectData))recordFilter objectFilter:(nullable BOOL (^)(id _Nonnull object))objectFilter completionHandler:(nonnull void (^)(NSArray * _Nonnull unarchivedObjects))completionHandler;
 {
     ARKCheckCondition(completionHandler != NULL, , @"Must provide a completionHandler!");
     
     NSBlockOperation *readOperation = [NSBlockOperation blockOperationWithBlock:^{
-        NSMutableArray *unarchivedObjects = [NSMutableArray arrayWithCapacity:self.objectCount];
-        
-        if (self.objectCount > 0) {
-            [self.fileHandle ARK_seekToDataBlockAtIndex:0];
+        [self _performWithArchiveLock_inFileOperationQueue:^{
+            [self _writePendingDataBlocks_inFileOperationQueue];
             
-            while (YES) {
-                BOOL success = NO;
-                NSData *objectData = [self.fileHandle ARK_readDataBlock:&success];
-                
-                if (!success) {
-                    NSLog(@"ERROR: -[%@ %@] corrupted archive at index %@ of %@ in %@.",
-                          NSStringFromClass([self class]), NSStringFromSelector(_cmd),
-                          @(unarchivedObjects.count), @(self.objectCount),
-                          self.archiveFileURL);
-                    
-                    // We can't trust anything in the file from here forward.
-                    [self.fileHandle truncateFileAtOffset:self.fileHandle.offsetInFile];
-                    break;
-                }
-                
-                if (objectData == nil) {
-                    // We're done.
-                    break;
-                }
-
-                id object = [NSKeyedUnarchiver unarchivedObjectOfClass:objectType fromData:objectData error:NULL];
-                
-                if (object != nil) {
-                    [unarchivedObjects addObject:object];
-                }
-            }
-        }
-        
-        [[NSOperationQueue mainQueue] addOperationWithBlock:^{
-            completionHandler(unarchivedObjects);
+            NSArray *const unarchivedObjects = [self _readObjectsOfType:objectType inBlockRange:NSMakeRange(0, self.objectCount) options:options limit:limit recordFilter:recordFilter objectFilter:objectFilter];
+            
+            [[NSOperationQueue mainQueue] addOperationWithBlock:^{
+                completionHandler(unarchivedObjects);
+            }];
         }];
     }];
     
@@ -152,19 +414,66 @@ NSUInteger const ARKMaximumChunkSizeForTrimOperation = (1024 * 1024);
     [self.fileOperationQueue addOperation:readOperation];
 }
 
+- (nonnull ARKDataArchiveCursor *)cursorForObjectsOfType:(nonnull Class)objectType options:(ARKDataArchiveReadOptions)options pageSize:(NSUInteger)pageSize;
+{
+    return [[ARKDataArchiveCursor alloc] initWithDataArchive:self objectType:objectType options:options pageSize:MAX(pageSize, 1)];
+}
+
 - (void)clearArchiveWithCompletionHandler:(nullable dispatch_block_t)completionHandler;
 {
     [self.fileOperationQueue addOperationWithBlock:^{
-        self.objectCount = 0;
-        [self.fileHandle truncateFileAtOffset:0];
-        [self _saveArchive_inFileOperationQueue];
-        
-        if (completionHandler != NULL) {
-            // Declare completionHandler as a non-optional to satisfy the compiler.
-            dispatch_block_t const operationBlock = completionHandler;
-            [[NSOperationQueue mainQueue] addOperationWithBlock:operationBlock];
-        }
+        [self _performWithArchiveLock_inFileOperationQueue:^{
+            [self _writePendingDataBlocks_inFileOperationQueue];
+            [self _truncateArchiveAtBlockIndex:0];
+            [self _saveArchive_inFileOperationQueue];
+            
+            if (completionHandler != NULL) {
+                // Declare completionHandler as a non-optional to satisfy the compiler.
+                dispatch_block_t const operationBlock = completionHandler;
+                [[NSOperationQueue mainQueue] addOperationWithBlock:operationBlock];
+            }
+        }];
+    }];
+}
+
+- (void)removeArchiveWithCompletionHandler:(nullable dispatch_block_t)completionHandler;
+{
+    [self.fileOperationQueue addOperationWithBlock:^{
+        [self _performWithArchiveLock_inFileOperationQueue:^{
+            [self _writePendingDataBlocks_inFileOperationQueue];
+            [self _reportEvictionOfBlocksInRange_inFileOperationQueue:NSMakeRange(0, self.objectCount)];
+            [self _truncateArchiveAtBlockIndex:0];
+            
+            // The file handle stays open until the archive is deallocated, so operations queued behind this one find an empty archive. Treat the removed index as current so that saving doesn't write it back.
+            [[NSFileManager defaultManager] removeItemAtURL:self.archiveFileURL error:NULL];
+            [[NSFileManager defaultManager] removeItemAtURL:self.blockIndexFileURL error:NULL];
+            self.persistedBlockIndexIsCurrent = YES;
+            
+            if (completionHandler != NULL) {
+                // Declare completionHandler as a non-optional to satisfy the compiler.
+                dispatch_block_t const operationBlock = completionHandler;
+                [[NSOperationQueue mainQueue] addOperationWithBlock:operationBlock];
+            }
+        }];
+    }];
+}
+
+- (NSUInteger)countObjectsAndWait;
+{
+    __block NSUInteger objectCount = 0;
+    NSBlockOperation *const countOperation = [NSBlockOperation blockOperationWithBlock:^{
+        [self _performWithArchiveLock_inFileOperationQueue:^{
+            [self _writePendingDataBlocks_inFileOperationQueue];
+            objectCount = self.objectCount;
+        }];
     }];
+    
+    // Set the QoS of this operation to be high, since the calling code is waiting for it.
+    countOperation.qualityOfService = NSQualityOfServiceUserInitiated;
+    
+    [self.fileOperationQueue addOperations:@[ countOperation ] waitUntilFinished:YES];
+    
+    return objectCount;
 }
 
 - (void)saveArchiveAndWait:(BOOL)wait;
@@ -202,47 +511,1577 @@ NSUInteger const ARKMaximumChunkSizeForTrimOperation = (1024 * 1024);
     [self.fileOperationQueue addOperation:completionOperation];
 }
 
+#pragma mark - Cursor Methods
+
+- (void)_readNextPageForCursor:(nonnull ARKDataArchiveCursor *)cursor onQueue:(nonnull NSOperationQueue *)queue completionHandler:(nonnull void (^)(NSArray * _Nonnull objects, NSUInteger trimmedObjectCount, BOOL hasMoreObjects))completionHandler;
+{
+    NSBlockOperation *readOperation = [NSBlockOperation blockOperationWithBlock:^{
+        [self _performWithArchiveLock_inFileOperationQueue:^{
+            [self _writePendingDataBlocks_inFileOperationQueue];
+            
+            uint64_t const firstSequenceNumber = self.firstObjectSequenceNumber;
+            uint64_t const endSequenceNumber = firstSequenceNumber + self.objectCount;
+            BOOL const newestFirst = ((cursor.options & ARKDataArchiveReadOptionsNewestFirst) != 0);
+            
+            if (!cursor.hasStarted) {
+                cursor.nextSequenceNumber = newestFirst ? endSequenceNumber : firstSequenceNumber;
+                cursor.oldestReadSequenceNumber = cursor.nextSequenceNumber;
+                cursor.endOfReadSequenceNumber = cursor.nextSequenceNumber;
+                cursor.hasStarted = YES;
+            }
+            
+            // Objects are only ever trimmed from the start of the archive, so the trimmed objects the cursor has read are the oldest ones.
+            uint64_t const trimmedObjectCount = MIN(MAX(firstSequenceNumber, cursor.oldestReadSequenceNumber), cursor.endOfReadSequenceNumber) - cursor.oldestReadSequenceNumber;
+            cursor.oldestReadSequenceNumber += trimmedObjectCount;
+            
+            // Work out the page from sequence numbers, clamped to the blocks still in the archive.
+            uint64_t pageStart = 0;
+            uint64_t pageEnd = 0;
+            BOOL hasMoreObjects = NO;
+            if (newestFirst) {
+                pageEnd = MAX(MIN(cursor.nextSequenceNumber, endSequenceNumber), firstSequenceNumber);
+                pageStart = MAX(pageEnd - MIN(pageEnd, cursor.pageSize), firstSequenceNumber);
+                cursor.nextSequenceNumber = pageStart;
+                cursor.oldestReadSequenceNumber = MIN(cursor.oldestReadSequenceNumber, pageStart);
+                hasMoreObjects = (pageStart > firstSequenceNumber);
+                
+            } else {
+                pageStart = MIN(MAX(cursor.nextSequenceNumber, firstSequenceNumber), endSequenceNumber);
+                pageEnd = MIN(pageStart + cursor.pageSize, endSequenceNumber);
+                cursor.nextSequenceNumber = pageEnd;
+                if (cursor.oldestReadSequenceNumber == cursor.endOfReadSequenceNumber) {
+                    // Everything read so far has been trimmed, so skip any objects trimmed before they could be read.
+                    cursor.oldestReadSequenceNumber = pageStart;
+                }
+                cursor.endOfReadSequenceNumber = pageEnd;
+                hasMoreObjects = (pageEnd < endSequenceNumber);
+            }
+            
+            NSRange const blockRange = NSMakeRange((NSUInteger)(pageStart - firstSequenceNumber), (NSUInteger)(pageEnd - pageStart));
+            NSArray *const objects = [self _readObjectsOfType:cursor.objectType inBlockRange:blockRange options:cursor.options limit:0 recordFilter:NULL objectFilter:NULL];
+            
+            [queue addOperationWithBlock:^{
+                completionHandler(objects, (NSUInteger)trimmedObjectCount, hasMoreObjects);
+            }];
+        }];
+    }];
+    
+    // Set the QoS of this operation to be high, since pages are typically requested in order to fulfill a user operation.
+    readOperation.qualityOfService = NSQualityOfServiceUserInitiated;
+    
+    [self.fileOperationQueue addOperation:readOperation];
+}
+
 #pragma mark - Testing Methods
 
 - (void)waitUntilAllOperationsAreFinished;
 {
+    [self.fileOperationQueue addOperationWithBlock:^{
+        [self _writePendingDataBlocks_inFileOperationQueue];
+    }];
+    
     [self.fileOperationQueue waitUntilAllOperationsAreFinished];
 }
 
+#pragma mark - Private Properties
+
+- (NSUInteger)objectCount;
+{
+    return self.blockOffsets.length / sizeof(ARKFileOffset);
+}
+
 #pragma mark - Private Methods
 
-- (void)_trimArchiveIfNecessary_inFileOperationQueue;
+- (nullable NSData *)_archivedDataWithObject:(nonnull id <NSSecureCoding>)object;
 {
-    if (self.maximumObjectCount == 0 || self.maximumObjectCount == NSUIntegerMax) {
-        return;
+    NSData *data = nil;
+    if ([object conformsToProtocol:@protocol(ARKDataArchiveRecordCoding)]) {
+        data = [(id <ARKDataArchiveRecordCoding>)object archiveRecordRepresentation];
     }
     
-    NSUInteger objectCount = self.objectCount;
+    if (data == nil) {
+        NSError *error = nil;
+        data = [NSKeyedArchiver archivedDataWithRootObject:object requiringSecureCoding:NO error:&error];
+        
+        ARKCheckCondition(error == nil, nil, @"Couldn't archive object %@", object);
+    }
+    
+    return data;
+}
+
+- (void)_appendFramedDataBlockWithData:(nonnull NSData *)data toData:(nonnull NSMutableData *)framedDataBlocks;
+{
+    uint8_t dataLengthBytes[ARKFramedDataBlockLengthMarkerSize];
+    OSWriteBigInt32(dataLengthBytes, 0, (uint32_t)data.length);
+    
+    [framedDataBlocks appendBytes:dataLengthBytes length:sizeof(dataLengthBytes)];
+    [framedDataBlocks appendData:data];
+}
+
+/// Appends data to checksummedDataBlocks with a checksummed header, exactly as it will be written to the file.
+- (void)_appendChecksummedDataBlockWithData:(nonnull NSData *)data sequenceNumber:(uint64_t)sequenceNumber toData:(nonnull NSMutableData *)checksummedDataBlocks;
+{
+    NSUInteger const blockPosition = checksummedDataBlocks.length;
+    [checksummedDataBlocks increaseLengthBy:ARKDataBlockHeaderSize];
+    [checksummedDataBlocks appendData:data];
+    
+    ARKWriteDataBlockHeader((uint8_t *)checksummedDataBlocks.mutableBytes + blockPosition, data.length, sequenceNumber);
+}
+
+- (void)_appendPendingFramedDataBlocks:(nonnull NSData *)framedDataBlocks;
+{
+    NSTimeInterval const groupCommitInterval = self.groupCommitInterval;
+    NSUInteger const groupCommitThreshold = self.groupCommitThreshold;
+    BOOL queuesWrite = NO;
+    BOOL startsTimer = NO;
+    
+    @synchronized(self) {
+        [self.pendingDataBlocks appendData:framedDataBlocks];
+        
+        if (groupCommitInterval <= 0 || self.pendingDataBlocks.length >= groupCommitThreshold) {
+            queuesWrite = !self.pendingWriteIsQueued;
+            self.pendingWriteIsQueued = YES;
+            
+        } else if (!self.pendingWriteIsQueued && !self.pendingWriteTimerIsRunning) {
+            startsTimer = YES;
+            self.pendingWriteTimerIsRunning = YES;
+        }
+    }
+    
+    if (queuesWrite) {
+        [self _queueWriteOfPendingDataBlocks];
+        
+    } else if (startsTimer) {
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(groupCommitInterval * NSEC_PER_SEC)), dispatch_get_global_queue(QOS_CLASS_BACKGROUND, 0), ^{
+            BOOL queuesDelayedWrite = NO;
+            @synchronized(self) {
+                self.pendingWriteTimerIsRunning = NO;
+                queuesDelayedWrite = (!self.pendingWriteIsQueued && self.pendingDataBlocks.length > 0);
+                self.pendingWriteIsQueued = (self.pendingWriteIsQueued || queuesDelayedWrite);
+            }
+            
+            if (queuesDelayedWrite) {
+                [self _queueWriteOfPendingDataBlocks];
+            }
+        });
+    }
+}
+
+/// Unarchives the objects in blockRange that pass the filters, stopping once limit objects have been found (or never, if limit is 0). A corrupted block truncates the archive; when reading newest first, the objects already read from the truncated blocks are dropped and reading continues with the older blocks that remain.
+- (nonnull NSMutableArray *)_readObjectsOfType:(nonnull Class)objectType inBlockRange:(NSRange)blockRange options:(ARKDataArchiveReadOptions)options limit:(NSUInteger)limit recordFilter:(nullable BOOL (^)(NSData * _Nonnull objectData))recordFilter objectFilter:(nullable BOOL (^)(id _Nonnull object))objectFilter;
+{
+    NSUInteger const objectCount = self.objectCount;
+    NSMutableArray *unarchivedObjects = [NSMutableArray arrayWithCapacity:(limit > 0 ? MIN(limit, blockRange.length) : blockRange.length)];
     
-    if (objectCount > self.maximumObjectCount && objectCount > self.trimmedObjectCount) {
-        NSUInteger blockIndex = objectCount - self.trimmedObjectCount;
-        NSUInteger seekIndex = [self.fileHandle ARK_seekToDataBlockAtIndex:blockIndex];
+    BOOL const decodesRecords = [objectType conformsToProtocol:@protocol(ARKDataArchiveRecordCoding)];
+    BOOL const newestFirst = ((options & ARKDataArchiveReadOptionsNewestFirst) != 0);
+    
+    // Map the archive once and decode each block in place, rather than seeking to and reading every block through the file handle. The mapping must outlive every view of it handed out below.
+    NSData *const mappedArchive __attribute__((objc_precise_lifetime)) = (blockRange.length > 0) ? [NSData dataWithContentsOfURL:self.archiveFileURL options:NSDataReadingMappedAlways error:NULL] : nil;
+    
+    // Each frame of a compressed archive is decompressed once, when its first object is read.
+    NSArray<NSData *> *frameDataBlocks = nil;
+    NSUInteger frameBlockIndex = 0;
+    
+    for (NSUInteger i = 0; i < blockRange.length && (limit == 0 || unarchivedObjects.count < limit); i++) {
+        NSUInteger const blockIndex = newestFirst ? (NSMaxRange(blockRange) - 1 - i) : (blockRange.location + i);
+        if (blockIndex >= self.objectCount) {
+            // Newer blocks were truncated after a corrupted block was found.
+            continue;
+        }
         
-        if (seekIndex == blockIndex) {
-            [self.fileHandle ARK_truncateFileToOffset:self.fileHandle.offsetInFile maximumChunkSize:ARKMaximumChunkSizeForTrimOperation];
-            self.objectCount = self.trimmedObjectCount;
+        ARKFileOffset const *const blockOffsets = self.blockOffsets.bytes;
+        BOOL success = NO;
+        NSData *objectData = nil;
+        
+        if (self.format == ARKDataArchiveFormatCompressed) {
+            objectData = [self _dataBlockAtIndex:blockIndex inCompressedArchive:mappedArchive frameDataBlocks:&frameDataBlocks frameBlockIndex:&frameBlockIndex];
+            success = (objectData != nil);
             
+        } else if (mappedArchive != nil) {
+            objectData = ARKDataBlockInMappedArchive(mappedArchive, blockOffsets[blockIndex], &success);
         } else {
+            [self.fileHandle seekToFileOffset:blockOffsets[blockIndex]];
+            objectData = [self.fileHandle ARK_readDataBlock:&success];
+        }
+        
+        if (!success || objectData == nil) {
             NSLog(@"ERROR: -[%@ %@] corrupted archive at index %@ of %@ in %@.",
                   NSStringFromClass([self class]), NSStringFromSelector(_cmd),
-                  @(seekIndex), @(objectCount),
+                  @(blockIndex), @(objectCount),
                   self.archiveFileURL);
             
-            // Trim from here forward.
-            [self.fileHandle truncateFileAtOffset:self.fileHandle.offsetInFile];
-            self.objectCount = seekIndex;
+            // We can't trust anything in the file from here forward.
+            [self _truncateArchiveAtBlockIndex:blockIndex];
+            
+            if (newestFirst) {
+                // Everything read so far was newer, so it's gone too. Keep reading the older blocks that remain.
+                [unarchivedObjects removeAllObjects];
+                continue;
+            }
+            break;
+        }
+        
+        if (recordFilter != NULL && !recordFilter(objectData)) {
+            continue;
+        }
+        
+        id object = nil;
+        if (decodesRecords) {
+            object = [objectType objectWithArchiveRecordRepresentation:objectData];
+        }
+        
+        if (object == nil) {
+            // Either a keyed archive, or a record written before objectType adopted a binary representation.
+            object = [NSKeyedUnarchiver unarchivedObjectOfClass:objectType fromData:objectData error:NULL];
+        }
+        
+        if (object != nil && (objectFilter == NULL || objectFilter(object))) {
+            [unarchivedObjects addObject:object];
         }
     }
+    
+    return unarchivedObjects;
 }
 
-- (void)_saveArchive_inFileOperationQueue;
+/// Returns the archived data of the newest intact object in the archive, or nil if there are none. A damaged newest block is truncated away, leaving the block before it as the newest.
+- (nullable NSData *)_newestObjectData_inFileOperationQueue;
 {
-    [self.fileHandle synchronizeFile];
+    __block NSData *newestObjectData = nil;
+    while (newestObjectData == nil && self.objectCount > 0) {
+        [self _readObjectsOfType:[NSData class] inBlockRange:NSMakeRange(self.objectCount - 1, 1) options:ARKDataArchiveReadOptionsNone limit:0 recordFilter:^BOOL(NSData *objectData) {
+            // The data is only valid for the duration of the call.
+            newestObjectData = [objectData copy];
+            return NO;
+        } objectFilter:NULL];
+    }
+    
+    return newestObjectData;
+}
+
+- (BOOL)_limitsObjectCount;
+{
+    return (self.maximumObjectCount != 0 && self.maximumObjectCount != NSUIntegerMax);
+}
+
+- (void)_queueWriteOfPendingDataBlocks;
+{
+    [self.fileOperationQueue addOperationWithBlock:^{
+        @synchronized(self) {
+            self.pendingWriteIsQueued = NO;
+        }
+        
+        [self _writePendingDataBlocks_inFileOperationQueue];
+    }];
+}
+
+- (void)_writePendingDataBlocks_inFileOperationQueue;
+{
+    // Blocks are handed out below as views onto these bytes, so keep them alive for the whole method.
+    NSData *framedDataBlocks __attribute__((objc_precise_lifetime)) = nil;
+    @synchronized(self) {
+        if (self.pendingDataBlocks.length == 0) {
+            return;
+        }
+        
+        framedDataBlocks = [self.pendingDataBlocks copy];
+        self.pendingDataBlocks.length = 0;
+    }
+    
+    NSData *const framedBlockPositions = [self _positionsOfFramedDataBlocks:framedDataBlocks];
+    uint8_t const *const framedBytes = framedDataBlocks.bytes;
+    
+    [self _performWithArchiveLock_inFileOperationQueue:^{
+        switch (self.format) {
+            case ARKDataArchiveFormatAppendOnly:
+                [self _appendFramedDataBlocksToAppendOnlyArchive_inFileOperationQueue:framedDataBlocks positions:framedBlockPositions];
+                break;
+                
+            case ARKDataArchiveFormatCompressed:
+                [self _appendFramedDataBlocksToCompressedArchive_inFileOperationQueue:framedDataBlocks positions:framedBlockPositions];
+                break;
+                
+            case ARKDataArchiveFormatCircular: {
+                NSUInteger const *const positions = framedBlockPositions.bytes;
+                NSUInteger const blockCount = framedBlockPositions.length / sizeof(NSUInteger);
+                
+                for (NSUInteger blockIndex = 0; blockIndex < blockCount; blockIndex++) {
+                    uint8_t const *const dataBytes = framedBytes + positions[blockIndex] + ARKFramedDataBlockLengthMarkerSize;
+                    NSData *const data = [NSData dataWithBytesNoCopy:(void *)dataBytes length:OSReadBigInt32(framedBytes, positions[blockIndex]) freeWhenDone:NO];
+                    [self _appendDataBlockToCircularArchive_inFileOperationQueue:data];
+                }
+                break;
+            }
+        }
+        
+        [self _trimArchiveIfNecessary_inFileOperationQueue];
+    }];
+}
+
+/// Returns the position of each framed block within framedDataBlocks, stored as NSUInteger values.
+- (nonnull NSData *)_positionsOfFramedDataBlocks:(nonnull NSData *)framedDataBlocks;
+{
+    NSMutableData *const framedBlockPositions = [NSMutableData new];
+    uint8_t const *const framedBytes = framedDataBlocks.bytes;
+    for (NSUInteger position = 0; position < framedDataBlocks.length; position += ARKFramedDataBlockLengthMarkerSize + OSReadBigInt32(framedBytes, position)) {
+        [framedBlockPositions appendBytes:&position length:sizeof(NSUInteger)];
+    }
+    
+    return framedBlockPositions;
+}
+
+- (void)_appendDataBlockToCircularArchive_inFileOperationQueue:(nonnull NSData *)data;
+{
+    ARKFileOffset const capacity = self.circularArchiveCapacity;
+    ARKFileOffset const blockLength = ARKDataBlockHeaderSize + data.length;
+    
+    if (blockLength > capacity) {
+        NSLog(@"ERROR: -[%@ %@] dropping %@ byte object that doesn't fit in the %@ byte circular archive %@.",
+              NSStringFromClass([self class]), NSStringFromSelector(_cmd),
+              @(data.length), @(capacity),
+              self.archiveFileURL);
+        [self _reportEvictionOfObjectData_inFileOperationQueue:@[data]];
+        return;
+    }
+    
+    NSUInteger const objectCount = self.objectCount;
+    NSUInteger const maximumObjectCount = [self _limitsObjectCount] ? self.maximumObjectCount : NSUIntegerMax;
+    ARKFileOffset const *const blockOffsets = self.blockOffsets.bytes;
+    ARKFileOffset const tailPosition = self.circularArchiveTailPosition;
+    
+    // Evict the oldest blocks until the new block fits, both in the data region and under the maximumObjectCount.
+    BOOL wrapsAround = NO;
+    NSUInteger evictedCount = 0;
+    for (; evictedCount < objectCount; evictedCount++) {
+        if (objectCount - evictedCount >= maximumObjectCount) {
+            continue;
+        }
+        
+        ARKFileOffset const headPosition = blockOffsets[evictedCount] - ARKCircularArchiveHeaderLength;
+        if (tailPosition > headPosition) {
+            // The live blocks are contiguous, so there's free space both after the tail and before the head.
+            if (capacity - tailPosition >= blockLength) {
+                break;
+            } else if (headPosition >= blockLength) {
+                wrapsAround = YES;
+                break;
+            }
+            
+        } else if (headPosition - tailPosition >= blockLength) {
+            // The live blocks wrap around, so the only free space is between the tail and the head.
+            break;
+        }
+    }
+    
+    if (evictedCount > 0) {
+        // Persist the new head before overwriting the evicted blocks, so a crash can't leave the header pointing at a partially overwritten block.
+        [self _evictBlocksFromCircularArchive_inFileOperationQueue:evictedCount];
+    }
+    
+    if (wrapsAround && capacity - tailPosition >= ARKDataBlockHeaderSize) {
+        // Mark the unused space at the end of the data region, so the next walk of the archive knows to continue from the start.
+        [self.fileHandle seekToFileOffset:(ARKCircularArchiveHeaderLength + tailPosition)];
+        [self.fileHandle ARK_writeData:[NSMutableData dataWithLength:ARKDataBlockHeaderSize]];
+    }
+    
+    ARKFileOffset const writePosition = wrapsAround ? 0 : self.circularArchiveTailPosition;
+    ARKFileOffset const blockOffset = ARKCircularArchiveHeaderLength + writePosition;
+    [self.fileHandle seekToFileOffset:blockOffset];
+    
+    if ([self.fileHandle ARK_writeDataBlock:data sequenceNumber:(self.firstObjectSequenceNumber + self.objectCount)]) {
+        [self.blockOffsets appendBytes:&blockOffset length:sizeof(ARKFileOffset)];
+        self.circularArchiveTailPosition = writePosition + blockLength;
+        [self _writeCircularArchiveHeader_inFileOperationQueue];
+    }
+}
+
+- (void)_trimArchiveIfNecessary_inFileOperationQueue;
+{
+    if (![self _limitsObjectCount]) {
+        return;
+    }
+    
+    NSUInteger objectCount = self.objectCount;
+    
+    switch (self.format) {
+        case ARKDataArchiveFormatAppendOnly:
+            if (objectCount > self.maximumObjectCount && objectCount > self.trimmedObjectCount) {
+                [self _trimAppendOnlyArchiveToObjectCount_inFileOperationQueue:self.trimmedObjectCount];
+            }
+            break;
+            
+        case ARKDataArchiveFormatCompressed:
+            if (objectCount > self.maximumObjectCount && objectCount > self.trimmedObjectCount) {
+                [self _trimCompressedArchiveToObjectCount_inFileOperationQueue:self.trimmedObjectCount];
+            }
+            break;
+            
+        case ARKDataArchiveFormatCircular:
+            // Evicting from a circular archive only moves the head, so there's no benefit to trimming more than necessary.
+            if (objectCount > self.maximumObjectCount) {
+                [self _evictBlocksFromCircularArchive_inFileOperationQueue:(objectCount - self.maximumObjectCount)];
+            }
+            break;
+    }
+}
+
+- (void)_truncateArchiveAtBlockIndex:(NSUInteger)blockIndex;
+{
+    NSUInteger const objectCount = self.objectCount;
+    ARKFileOffset const *const blockOffsets = self.blockOffsets.bytes;
+    
+    switch (self.format) {
+        case ARKDataArchiveFormatAppendOnly: {
+            ARKFileOffset const offset = (blockIndex < objectCount) ? blockOffsets[blockIndex] : self.endOfArchiveOffset;
+            
+            [self _invalidatePersistedBlockIndex_inFileOperationQueue];
+            [self.fileHandle truncateFileAtOffset:offset];
+            self.endOfArchiveOffset = offset;
+            break;
+        }
+            
+        case ARKDataArchiveFormatCompressed: {
+            // Frames are dropped whole, so truncate at the start of the frame holding the block.
+            blockIndex = [self _indexOfFirstBlockInFrameOfBlockAtIndex:blockIndex];
+            ARKFileOffset const offset = (blockIndex < objectCount) ? blockOffsets[blockIndex] : self.endOfArchiveOffset;
+            
+            [self.fileHandle truncateFileAtOffset:offset];
+            self.endOfArchiveOffset = offset;
+            break;
+        }
+            
+        case ARKDataArchiveFormatCircular:
+            if (blockIndex == 0) {
+                // Drop everything, including any stale data left in the data region.
+                self.circularArchiveHeadPosition = 0;
+                self.circularArchiveTailPosition = 0;
+                [self.fileHandle truncateFileAtOffset:ARKCircularArchiveHeaderLength];
+                
+            } else if (blockIndex < objectCount) {
+                // The next write picks up right after the last block we're keeping.
+                ARKFileOffset const lastBlockOffset = blockOffsets[blockIndex - 1];
+                NSUInteger const lastBlockLength = [self.fileHandle ARK_readDataBlockLengthAtOffset:lastBlockOffset];
+                self.circularArchiveTailPosition = lastBlockOffset - ARKCircularArchiveHeaderLength + ARKDataBlockHeaderSize + lastBlockLength;
+            }
+            break;
+    }
+    
+    if (blockIndex == 0) {
+        // Number the blocks appended from here on after the dropped ones, so cursors don't mistake them for blocks they've already read.
+        self.firstObjectSequenceNumber += objectCount;
+    }
+    
+    self.blockOffsets.length = MIN(self.blockOffsets.length, blockIndex * sizeof(ARKFileOffset));
+    
+    if (self.format == ARKDataArchiveFormatCircular) {
+        [self _writeCircularArchiveHeader_inFileOperationQueue];
+    }
+}
+
+/// Numbers new blocks on from the oldest block in the file, so that sequence numbers never go backwards within the file, even across runs.
+- (void)_adoptSequenceNumberOfOldestBlock_inFileOperationQueue;
+{
+    if (self.objectCount == 0) {
+        return;
+    }
+    
+    ARKFileOffset const *const blockOffsets = self.blockOffsets.bytes;
+    [self.fileHandle seekToFileOffset:blockOffsets[0]];
+    
+    BOOL success = NO;
+    uint64_t sequenceNumber = 0;
+    if ([self.fileHandle ARK_readDataBlock:&success sequenceNumber:&sequenceNumber] != nil && success) {
+        self.firstObjectSequenceNumber = sequenceNumber;
+    }
+}
+
+/// Reads the blocks in range and passes their data to the evictedObjectDataHandler. Must be called before the blocks are dropped from the index.
+- (void)_reportEvictionOfBlocksInRange_inFileOperationQueue:(NSRange)blockRange;
+{
+    if (blockRange.length == 0 || self.evictedObjectDataHandler == NULL) {
+        return;
+    }
+    
+    if (self.format == ARKDataArchiveFormatCompressed) {
+        [self _reportEvictionOfObjectData_inFileOperationQueue:[self _dataBlocksInRangeOfCompressedArchive_inFileOperationQueue:blockRange]];
+        return;
+    }
+    
+    ARKFileOffset const *const blockOffsets = self.blockOffsets.bytes;
+    NSMutableArray<NSData *> *const evictedObjectData = [NSMutableArray arrayWithCapacity:blockRange.length];
+    
+    for (NSUInteger blockIndex = blockRange.location; blockIndex < NSMaxRange(blockRange) && blockIndex < self.objectCount; blockIndex++) {
+        [self.fileHandle seekToFileOffset:blockOffsets[blockIndex]];
+        
+        BOOL success = NO;
+        NSData *const dataBlock = [self.fileHandle ARK_readDataBlock:&success];
+        if (success && dataBlock != nil) {
+            [evictedObjectData addObject:dataBlock];
+        }
+    }
+    
+    [self _reportEvictionOfObjectData_inFileOperationQueue:evictedObjectData];
+}
+
+- (void)_reportEvictionOfObjectData_inFileOperationQueue:(nonnull NSArray<NSData *> *)evictedObjectData;
+{
+    void (^const evictedObjectDataHandler)(NSArray<NSData *> *) = self.evictedObjectDataHandler;
+    if (evictedObjectData.count > 0 && evictedObjectDataHandler != NULL) {
+        evictedObjectDataHandler(evictedObjectData);
+    }
+}
+
+- (void)_saveArchive_inFileOperationQueue;
+{
+    [self _writePendingDataBlocks_inFileOperationQueue];
+    [self.fileHandle synchronizeFile];
+    
+    // A circular archive's header is kept up to date as it's written, so only append-only archives have an index to persist. A shared archive's index can't account for blocks other processes append.
+    if (self.format == ARKDataArchiveFormatAppendOnly && !self.sharedAcrossProcesses) {
+        [self _persistBlockIndex_inFileOperationQueue];
+    }
+}
+
+#pragma mark - Private Methods: Append-Only Archives
+
+- (void)_appendFramedDataBlocksToAppendOnlyArchive_inFileOperationQueue:(nonnull NSData *)framedDataBlocks positions:(nonnull NSData *)framedBlockPositions;
+{
+    [self _invalidatePersistedBlockIndex_inFileOperationQueue];
+    
+    ARKFileOffset const endOfFileOffset = [self.fileHandle seekToEndOfFile];
+    if (endOfFileOffset != self.endOfArchiveOffset) {
+        NSLog(@"ERROR: -[%@ %@] archive length changed from %@ to %@ outside of %@.",
+              NSStringFromClass([self class]), NSStringFromSelector(_cmd),
+              @(self.endOfArchiveOffset), @(endOfFileOffset),
+              self.archiveFileURL);
+        
+        // The file was modified out from under us, so our block index can't be trusted.
+        [self _indexArchive_inFileOperationQueue];
+    }
+    
+    NSUInteger const *const positions = framedBlockPositions.bytes;
+    NSUInteger const blockCount = framedBlockPositions.length / sizeof(NSUInteger);
+    
+    // Work out which blocks would remain if the pending blocks were appended (and the archive trimmed) one at a time, so we only trim once and never write blocks that would be trimmed right away.
+    NSUInteger keptObjectCount = self.objectCount;
+    NSUInteger firstWrittenBlockIndex = 0;
+    if ([self _limitsObjectCount]) {
+        for (NSUInteger blockIndex = 0; blockIndex < blockCount; blockIndex++) {
+            NSUInteger const writtenBlockCount = blockIndex + 1 - firstWrittenBlockIndex;
+            NSUInteger const objectCount = keptObjectCount + writtenBlockCount;
+            
+            if (objectCount > self.maximumObjectCount && objectCount > self.trimmedObjectCount) {
+                if (writtenBlockCount <= self.trimmedObjectCount) {
+                    keptObjectCount = self.trimmedObjectCount - writtenBlockCount;
+                } else {
+                    keptObjectCount = 0;
+                    firstWrittenBlockIndex = blockIndex + 1 - self.trimmedObjectCount;
+                }
+            }
+        }
+    }
+    
+    if (keptObjectCount < self.objectCount) {
+        [self _trimAppendOnlyArchiveToObjectCount_inFileOperationQueue:keptObjectCount];
+    }
+    
+    if (firstWrittenBlockIndex > 0 && self.evictedObjectDataHandler != NULL) {
+        // Blocks that would have been trimmed right away were never written, but they're evicted all the same.
+        NSMutableArray<NSData *> *const skippedObjectData = [NSMutableArray arrayWithCapacity:firstWrittenBlockIndex];
+        for (NSUInteger blockIndex = 0; blockIndex < firstWrittenBlockIndex && blockIndex < blockCount; blockIndex++) {
+            NSUInteger const dataPosition = positions[blockIndex] + ARKFramedDataBlockLengthMarkerSize;
+            NSUInteger const endPosition = (blockIndex + 1 < blockCount) ? positions[blockIndex + 1] : framedDataBlocks.length;
+            [skippedObjectData addObject:[framedDataBlocks subdataWithRange:NSMakeRange(dataPosition, endPosition - dataPosition)]];
+        }
+        
+        [self _reportEvictionOfObjectData_inFileOperationQueue:skippedObjectData];
+    }
+    
+    if (firstWrittenBlockIndex >= blockCount) {
+        return;
+    }
+    
+    // Give each block its checksummed header, numbering the blocks on from the newest block in the archive.
+    NSMutableData *const writtenDataBlocks = [NSMutableData dataWithCapacity:(framedDataBlocks.length - positions[firstWrittenBlockIndex] + (blockCount - firstWrittenBlockIndex) * ARKDataBlockHeaderSize)];
+    NSMutableData *const writtenBlockPositions = [NSMutableData new];
+    uint64_t const firstSequenceNumber = self.firstObjectSequenceNumber + self.objectCount;
+    for (NSUInteger blockIndex = firstWrittenBlockIndex; blockIndex < blockCount; blockIndex++) {
+        NSUInteger const dataPosition = positions[blockIndex] + ARKFramedDataBlockLengthMarkerSize;
+        NSUInteger const endPosition = (blockIndex + 1 < blockCount) ? positions[blockIndex + 1] : framedDataBlocks.length;
+        NSData *const data = [NSData dataWithBytesNoCopy:((uint8_t *)framedDataBlocks.bytes + dataPosition) length:(endPosition - dataPosition) freeWhenDone:NO];
+        
+        NSUInteger const writtenPosition = writtenDataBlocks.length;
+        [writtenBlockPositions appendBytes:&writtenPosition length:sizeof(NSUInteger)];
+        [self _appendChecksummedDataBlockWithData:data sequenceNumber:(firstSequenceNumber + blockIndex - firstWrittenBlockIndex) toData:writtenDataBlocks];
+    }
+    
+    ARKFileOffset const firstBlockOffset = self.endOfArchiveOffset;
+    [self.fileHandle seekToFileOffset:firstBlockOffset];
+    
+    if ([self.fileHandle ARK_writeData:writtenDataBlocks]) {
+        NSUInteger const *const writtenPositions = writtenBlockPositions.bytes;
+        for (NSUInteger i = 0; i < blockCount - firstWrittenBlockIndex; i++) {
+            ARKFileOffset const blockOffset = firstBlockOffset + writtenPositions[i];
+            [self.blockOffsets appendBytes:&blockOffset length:sizeof(ARKFileOffset)];
+        }
+        
+        self.endOfArchiveOffset = firstBlockOffset + writtenDataBlocks.length;
+        
+    } else if ([self.fileHandle seekToEndOfFile] != firstBlockOffset) {
+        // Partially written blocks were left at the end of the file.
+        [self.fileHandle truncateFileAtOffset:firstBlockOffset];
+    }
+}
+
+/// Removes all but the newest keptObjectCount blocks from the start of the file.
+- (void)_trimAppendOnlyArchiveToObjectCount_inFileOperationQueue:(NSUInteger)keptObjectCount;
+{
+    [self _invalidatePersistedBlockIndex_inFileOperationQueue];
+    
+    NSUInteger const objectCount = self.objectCount;
+    NSUInteger const blockIndex = objectCount - MIN(keptObjectCount, objectCount);
+    ARKFileOffset const *const blockOffsets = self.blockOffsets.bytes;
+    ARKFileOffset const trimOffset = (blockIndex < objectCount) ? blockOffsets[blockIndex] : self.endOfArchiveOffset;
+    
+    [self _reportEvictionOfBlocksInRange_inFileOperationQueue:NSMakeRange(0, blockIndex)];
+    [self.fileHandle ARK_truncateFileToOffset:trimOffset maximumChunkSize:ARKMaximumChunkSizeForTrimOperation];
+    self.firstObjectSequenceNumber += blockIndex;
+    
+    // Drop the trimmed blocks from the index, and shift the remaining offsets to match their new location in the file.
+    [self.blockOffsets replaceBytesInRange:NSMakeRange(0, blockIndex * sizeof(ARKFileOffset)) withBytes:NULL length:0];
+    
+    ARKFileOffset *const shiftedBlockOffsets = self.blockOffsets.mutableBytes;
+    for (NSUInteger i = 0; i < objectCount - blockIndex; i++) {
+        shiftedBlockOffsets[i] -= trimOffset;
+    }
+    
+    self.endOfArchiveOffset -= trimOffset;
+}
+
+- (void)_openAppendOnlyArchive_inFileOperationQueue;
+{
+    ARKCircularArchiveHeader header = { };
+    if ([self _readCircularArchiveHeader_inFileOperationQueue:&header]) {
+        // A previous run wrote a circular archive. Rewrite its blocks, in order, as an append-only archive.
+        NSArray<NSData *> *const dataBlocks = [self _readCircularArchiveDataBlocksWithHeader_inFileOperationQueue:header];
+        
+        [self _rewriteArchiveWithDataBlocks_inFileOperationQueue:dataBlocks];
+        
+    } else if ([self _readCompressedArchiveHeader_inFileOperationQueue]) {
+        [self _rewriteCompressedArchiveAsAppendOnlyArchive_inFileOperationQueue];
+        
+    } else if (self.sharedAcrossProcesses || ![self _loadPersistedBlockIndex_inFileOperationQueue]) {
+        // The block index saved by a previous run doesn't exist or can't be trusted, so count the number of (valid) archived objects by walking the file.
+        [self _indexArchive_inFileOperationQueue];
+    }
+}
+
+/// Replaces the contents of the file with an append-only archive of dataBlocks, oldest first, and indexes it.
+- (void)_rewriteArchiveWithDataBlocks_inFileOperationQueue:(nonnull NSArray<NSData *> *)dataBlocks;
+{
+    [self.fileHandle truncateFileAtOffset:0];
+    for (NSUInteger blockIndex = 0; blockIndex < dataBlocks.count; blockIndex++) {
+        [self.fileHandle ARK_writeDataBlock:dataBlocks[blockIndex] sequenceNumber:(self.firstObjectSequenceNumber + blockIndex)];
+    }
+    
+    [self _indexArchive_inFileOperationQueue];
+}
+
+- (void)_indexArchive_inFileOperationQueue;
+{
+    [self.blockOffsets setLength:0];
+    
+    [self.fileHandle seekToFileOffset:0];
+    [self.fileHandle ARK_indexDataBlocksIntoOffsets:self.blockOffsets];
+    
+    // Truncate corrupted content (if any).
+    self.endOfArchiveOffset = self.fileHandle.offsetInFile;
+    [self.fileHandle truncateFileAtOffset:self.endOfArchiveOffset];
+}
+
+- (BOOL)_loadPersistedBlockIndex_inFileOperationQueue;
+{
+    NSData *const blockIndexData = [NSData dataWithContentsOfURL:self.blockIndexFileURL options:NSDataReadingMappedIfSafe error:NULL];
+    if (blockIndexData.length < ARKBlockIndexFileHeaderLength) {
+        return NO;
+    }
+    
+    uint8_t const *const bytes = blockIndexData.bytes;
+    uint32_t const magic = OSReadBigInt32(bytes, 0);
+    uint32_t const version = OSReadBigInt32(bytes, sizeof(uint32_t));
+    uint64_t const archiveLength = OSReadBigInt64(bytes, 2 * sizeof(uint32_t));
+    uint64_t const blockCount = OSReadBigInt64(bytes, 2 * sizeof(uint32_t) + sizeof(uint64_t));
+    
+    if (magic != ARKBlockIndexFileMagic || version != ARKBlockIndexFileVersion) {
+        return NO;
+    }
+    
+    // The index is only valid for the exact archive it was saved alongside.
+    if (blockCount > (blockIndexData.length - ARKBlockIndexFileHeaderLength) / sizeof(uint64_t)
+        || blockIndexData.length != ARKBlockIndexFileHeaderLength + blockCount * sizeof(uint64_t)
+        || archiveLength != [self.fileHandle seekToEndOfFile]) {
+        return NO;
+    }
+    
+    NSMutableData *const blockOffsets = [NSMutableData dataWithLength:(NSUInteger)blockCount * sizeof(ARKFileOffset)];
+    ARKFileOffset *const offsets = blockOffsets.mutableBytes;
+    for (NSUInteger i = 0; i < blockCount; i++) {
+        offsets[i] = OSReadBigInt64(bytes, ARKBlockIndexFileHeaderLength + i * sizeof(uint64_t));
+        
+        if ((i == 0 && offsets[i] != 0) || (i > 0 && offsets[i] <= offsets[i - 1]) || offsets[i] >= archiveLength) {
+            return NO;
+        }
+    }
+    
+    // Spot check that the last indexed block runs exactly to the end of the file.
+    if (blockCount > 0) {
+        NSMutableData *const lastBlockOffsets = [NSMutableData new];
+        [self.fileHandle seekToFileOffset:offsets[blockCount - 1]];
+        if ([self.fileHandle ARK_indexDataBlocksIntoOffsets:lastBlockOffsets] != 1 || self.fileHandle.offsetInFile != archiveLength) {
+            return NO;
+        }
+    } else if (archiveLength != 0) {
+        return NO;
+    }
+    
+    [self.blockOffsets setData:blockOffsets];
+    self.endOfArchiveOffset = archiveLength;
+    self.persistedBlockIndexIsCurrent = YES;
+    
+    return YES;
+}
+
+- (void)_persistBlockIndex_inFileOperationQueue;
+{
+    if (self.persistedBlockIndexIsCurrent) {
+        return;
+    }
+    
+    NSUInteger const blockCount = self.objectCount;
+    NSMutableData *const blockIndexData = [NSMutableData dataWithLength:ARKBlockIndexFileHeaderLength + blockCount * sizeof(uint64_t)];
+    uint8_t *const bytes = blockIndexData.mutableBytes;
+    
+    OSWriteBigInt32(bytes, 0, ARKBlockIndexFileMagic);
+    OSWriteBigInt32(bytes, sizeof(uint32_t), ARKBlockIndexFileVersion);
+    OSWriteBigInt64(bytes, 2 * sizeof(uint32_t), self.endOfArchiveOffset);
+    OSWriteBigInt64(bytes, 2 * sizeof(uint32_t) + sizeof(uint64_t), blockCount);
+    
+    ARKFileOffset const *const offsets = self.blockOffsets.bytes;
+    for (NSUInteger i = 0; i < blockCount; i++) {
+        OSWriteBigInt64(bytes, ARKBlockIndexFileHeaderLength + i * sizeof(uint64_t), offsets[i]);
+    }
+    
+    NSError *error = nil;
+    if ([blockIndexData writeToURL:self.blockIndexFileURL options:NSDataWritingAtomic error:&error]) {
+        self.persistedBlockIndexIsCurrent = YES;
+    } else {
+        NSLog(@"ERROR: -[%@ %@] unable to persist block index to %@: %@",
+              NSStringFromClass([self class]), NSStringFromSelector(_cmd),
+              self.blockIndexFileURL, error);
+    }
+}
+
+- (void)_invalidatePersistedBlockIndex_inFileOperationQueue;
+{
+    if (!self.persistedBlockIndexIsCurrent) {
+        return;
+    }
+    
+    // Remove the stale index before the archive changes, so a crash can't leave behind an index that doesn't match the archive.
+    [[NSFileManager defaultManager] removeItemAtURL:self.blockIndexFileURL error:NULL];
+    self.persistedBlockIndexIsCurrent = NO;
+}
+
+#pragma mark - Private Methods: Shared Archives
+
+/// Calls block while holding the lock on a shared archive, first picking up the changes archives in other processes have made to the file, and afterwards telling them to re-index if block moved or dropped any blocks. Calls block directly if the archive isn't shared or the lock is already held by an enclosing call.
+- (void)_performWithArchiveLock_inFileOperationQueue:(nonnull dispatch_block_t)block;
+{
+    if (self.lockFileHandle == nil || self.lockDepth > 0) {
+        block();
+        return;
+    }
+    
+    int const lockFileDescriptor = self.lockFileHandle.fileDescriptor;
+    BOOL lockAcquired = YES;
+    while (flock(lockFileDescriptor, LOCK_EX) != 0) {
+        if (errno != EINTR) {
+            NSLog(@"ERROR: -[%@ %@] unable to lock %@: %s",
+                  NSStringFromClass([self class]), NSStringFromSelector(_cmd),
+                  self.archiveFileURL, strerror(errno));
+            lockAcquired = NO;
+            break;
+        }
+    }
+    
+    if (!lockAcquired) {
+        // Carry on as though the archive weren't shared, rather than changing the shared state without holding the lock. Nested calls don't try to lock again.
+        self.lockDepth++;
+        block();
+        self.lockDepth--;
+        return;
+    }
+    
+    self.lockDepth++;
+    [self _synchronizeWithSharedArchive_inFileOperationQueue];
+    
+    NSUInteger const objectCount = self.objectCount;
+    ARKFileOffset const lastBlockOffset = (objectCount > 0) ? ((ARKFileOffset const *)self.blockOffsets.bytes)[objectCount - 1] : 0;
+    ARKFileOffset const endOfArchiveOffset = self.endOfArchiveOffset;
+    uint64_t const firstObjectSequenceNumber = self.firstObjectSequenceNumber;
+    
+    block();
+    
+    // Appending leaves every block where other processes indexed it. Anything else means they have to re-index.
+    BOOL const onlyAppended = (self.firstObjectSequenceNumber == firstObjectSequenceNumber
+                               && self.objectCount >= objectCount
+                               && self.endOfArchiveOffset >= endOfArchiveOffset
+                               && (objectCount == 0 || ((ARKFileOffset const *)self.blockOffsets.bytes)[objectCount - 1] == lastBlockOffset));
+    if (!onlyAppended) {
+        self.sharedArchiveGeneration++;
+        [self _writeSharedArchiveState_inFileOperationQueue];
+    }
+    
+    self.lockDepth--;
+    flock(lockFileDescriptor, LOCK_UN);
+}
+
+/// Brings the block index of a shared archive up to date with the file, which archives in other processes may have appended to, trimmed, or cleared. Must be called while holding the lock.
+- (void)_synchronizeWithSharedArchive_inFileOperationQueue;
+{
+    NSMutableData *const stateData = [NSMutableData dataWithLength:ARKSharedArchiveLockFileLength];
+    if (pread(self.lockFileHandle.fileDescriptor, stateData.mutableBytes, stateData.length, 0) != (ssize_t)stateData.length) {
+        // Nothing has been written to the lock file yet, so no blocks have been moved or dropped.
+        [stateData resetBytesInRange:NSMakeRange(0, stateData.length)];
+    }
+    
+    uint64_t const generation = OSReadBigInt64(stateData.bytes, 0);
+    uint64_t const firstObjectSequenceNumber = OSReadBigInt64(stateData.bytes, sizeof(uint64_t));
+    
+    if (self.sharedArchiveGeneration == ARKSharedArchiveGenerationNotIndexed) {
+        // The archive is being opened, which indexes it.
+        self.sharedArchiveGeneration = generation;
+        self.firstObjectSequenceNumber = firstObjectSequenceNumber;
+        
+    } else if (generation != self.sharedArchiveGeneration) {
+        // Another process moved or dropped blocks, so none of our offsets can be trusted.
+        [self _indexArchive_inFileOperationQueue];
+        self.sharedArchiveGeneration = generation;
+        self.firstObjectSequenceNumber = firstObjectSequenceNumber;
+        
+    } else {
+        ARKFileOffset const endOfFileOffset = [self.fileHandle seekToEndOfFile];
+        if (endOfFileOffset > self.endOfArchiveOffset) {
+            // Index the blocks other processes have appended since we last looked.
+            [self.fileHandle seekToFileOffset:self.endOfArchiveOffset];
+            [self.fileHandle ARK_indexDataBlocksIntoOffsets:self.blockOffsets];
+            self.endOfArchiveOffset = self.fileHandle.offsetInFile;
+            
+            if (self.endOfArchiveOffset != endOfFileOffset) {
+                // Drop a partial block left by a process that crashed while appending.
+                [self.fileHandle truncateFileAtOffset:self.endOfArchiveOffset];
+            }
+            
+        } else if (endOfFileOffset < self.endOfArchiveOffset) {
+            [self _indexArchive_inFileOperationQueue];
+        }
+    }
+}
+
+/// Records the generation and first object sequence number of a shared archive in its lock file. Must be called while holding the lock.
+- (void)_writeSharedArchiveState_inFileOperationQueue;
+{
+    NSMutableData *const stateData = [NSMutableData dataWithLength:ARKSharedArchiveLockFileLength];
+    OSWriteBigInt64(stateData.mutableBytes, 0, self.sharedArchiveGeneration);
+    OSWriteBigInt64(stateData.mutableBytes, sizeof(uint64_t), self.firstObjectSequenceNumber);
+    
+    if (pwrite(self.lockFileHandle.fileDescriptor, stateData.bytes, stateData.length, 0) != (ssize_t)stateData.length) {
+        NSLog(@"ERROR: -[%@ %@] unable to write shared archive state for %@: %s",
+              NSStringFromClass([self class]), NSStringFromSelector(_cmd),
+              self.archiveFileURL, strerror(errno));
+    }
+}
+
+#pragma mark - Private Methods: Circular Archives
+
+- (void)_openCircularArchive_inFileOperationQueue;
+{
+    // Block indexes are only kept for append-only archives, so a leftover one is stale.
+    [[NSFileManager defaultManager] removeItemAtURL:self.blockIndexFileURL error:NULL];
+    
+    ARKCircularArchiveHeader header = { };
+    if (![self _readCircularArchiveHeader_inFileOperationQueue:&header]) {
+        if ([self _readCompressedArchiveHeader_inFileOperationQueue]) {
+            [self _rewriteCompressedArchiveAsAppendOnlyArchive_inFileOperationQueue];
+        }
+        
+        [self _convertAppendOnlyArchiveToCircularArchive_inFileOperationQueue];
+        
+    } else if (header.capacity != self.circularArchiveCapacity) {
+        [self _resizeCircularArchiveWithHeader_inFileOperationQueue:header];
+        
+    } else {
+        ARKFileOffset const endPosition = [self _indexCircularArchiveWithHeader_inFileOperationQueue:header];
+        BOOL const isValid = (self.objectCount == header.blockCount && endPosition == header.tailPosition);
+        
+        if (!isValid) {
+            NSLog(@"ERROR: -[%@ %@] corrupted archive at index %@ of %@ in %@.",
+                  NSStringFromClass([self class]), NSStringFromSelector(_cmd),
+                  @(self.objectCount), @(header.blockCount),
+                  self.archiveFileURL);
+        }
+        
+        // Keep the valid blocks, and pick up writing right after them.
+        self.circularArchiveHeadPosition = (self.objectCount > 0) ? header.headPosition : 0;
+        self.circularArchiveTailPosition = (self.objectCount > 0) ? endPosition : 0;
+        
+        if (!isValid) {
+            [self _writeCircularArchiveHeader_inFileOperationQueue];
+        }
+    }
+}
+
+/// Moves the newest blocks of an append-only archive that fit within the capacity to the data region of a new circular archive.
+- (void)_convertAppendOnlyArchiveToCircularArchive_inFileOperationQueue;
+{
+    [self _indexArchive_inFileOperationQueue];
+    
+    ARKFileOffset const capacity = self.circularArchiveCapacity;
+    NSUInteger const maximumObjectCount = [self _limitsObjectCount] ? self.maximumObjectCount : NSUIntegerMax;
+    NSUInteger const objectCount = self.objectCount;
+    ARKFileOffset const *const blockOffsets = self.blockOffsets.bytes;
+    
+    NSUInteger firstBlockIndex = objectCount;
+    while (firstBlockIndex > 0
+           && objectCount - firstBlockIndex < maximumObjectCount
+           && self.endOfArchiveOffset - blockOffsets[firstBlockIndex - 1] <= capacity) {
+        firstBlockIndex--;
+    }
+    
+    ARKFileOffset const firstBlockOffset = (firstBlockIndex < objectCount) ? blockOffsets[firstBlockIndex] : self.endOfArchiveOffset;
+    ARKFileOffset const dataLength = self.endOfArchiveOffset - firstBlockOffset;
+    
+    [self.fileHandle ARK_moveDataFromOffset:firstBlockOffset toOffset:ARKCircularArchiveHeaderLength length:dataLength maximumChunkSize:ARKMaximumChunkSizeForTrimOperation];
+    [self.fileHandle truncateFileAtOffset:(ARKCircularArchiveHeaderLength + dataLength)];
+    
+    // Drop the blocks that didn't fit from the index, and shift the remaining offsets to match their new location in the file.
+    [self.blockOffsets replaceBytesInRange:NSMakeRange(0, firstBlockIndex * sizeof(ARKFileOffset)) withBytes:NULL length:0];
+    
+    ARKFileOffset *const shiftedBlockOffsets = self.blockOffsets.mutableBytes;
+    for (NSUInteger i = 0; i < objectCount - firstBlockIndex; i++) {
+        shiftedBlockOffsets[i] = shiftedBlockOffsets[i] - firstBlockOffset + ARKCircularArchiveHeaderLength;
+    }
+    
+    self.endOfArchiveOffset = 0;
+    self.circularArchiveHeadPosition = 0;
+    self.circularArchiveTailPosition = dataLength;
+    
+    // Write the header last, so a crash partway through leaves a file that is treated as (corrupted) append-only rather than as a circular archive with bogus contents.
+    [self _writeCircularArchiveHeader_inFileOperationQueue];
+}
+
+/// Rewrites the newest blocks of a circular archive that fit within the current capacity, starting from the beginning of the data region.
+- (void)_resizeCircularArchiveWithHeader_inFileOperationQueue:(ARKCircularArchiveHeader)header;
+{
+    NSArray<NSData *> *const dataBlocks = [self _readCircularArchiveDataBlocksWithHeader_inFileOperationQueue:header];
+    
+    ARKFileOffset const capacity = self.circularArchiveCapacity;
+    NSUInteger const maximumObjectCount = [self _limitsObjectCount] ? self.maximumObjectCount : NSUIntegerMax;
+    
+    NSUInteger firstBlockIndex = dataBlocks.count;
+    ARKFileOffset dataLength = 0;
+    while (firstBlockIndex > 0 && dataBlocks.count - firstBlockIndex < maximumObjectCount) {
+        ARKFileOffset const blockLength = ARKDataBlockHeaderSize + dataBlocks[firstBlockIndex - 1].length;
+        if (dataLength + blockLength > capacity) {
+            break;
+        }
+        
+        dataLength += blockLength;
+        firstBlockIndex--;
+    }
+    
+    [self.blockOffsets setLength:0];
+    [self.fileHandle truncateFileAtOffset:ARKCircularArchiveHeaderLength];
+    [self.fileHandle seekToFileOffset:ARKCircularArchiveHeaderLength];
+    
+    for (NSUInteger blockIndex = firstBlockIndex; blockIndex < dataBlocks.count; blockIndex++) {
+        ARKFileOffset const blockOffset = self.fileHandle.offsetInFile;
+        if (![self.fileHandle ARK_writeDataBlock:dataBlocks[blockIndex] sequenceNumber:(self.firstObjectSequenceNumber + self.objectCount)]) {
+            break;
+        }
+        
+        [self.blockOffsets appendBytes:&blockOffset length:sizeof(ARKFileOffset)];
+    }
+    
+    self.circularArchiveHeadPosition = 0;
+    self.circularArchiveTailPosition = self.fileHandle.offsetInFile - ARKCircularArchiveHeaderLength;
+    [self _writeCircularArchiveHeader_inFileOperationQueue];
+}
+
+/// Walks the blocks described by the header, starting from the head, and stores the offset of each valid block in blockOffsets. Returns the position within the data region at which the last valid block ends.
+- (ARKFileOffset)_indexCircularArchiveWithHeader_inFileOperationQueue:(ARKCircularArchiveHeader)header;
+{
+    [self.blockOffsets setLength:0];
+    
+    ARKFileOffset const fileLength = [self.fileHandle seekToEndOfFile];
+    ARKFileOffset position = header.headPosition;
+    if (position > header.capacity || header.tailPosition > header.capacity) {
+        return 0;
+    }
+    
+    for (uint64_t blockIndex = 0; blockIndex < header.blockCount; blockIndex++) {
+        NSUInteger blockLength = 0;
+        if (header.capacity - position >= ARKDataBlockHeaderSize) {
+            blockLength = [self.fileHandle ARK_readDataBlockLengthAtOffset:(ARKCircularArchiveHeaderLength + position)];
+        }
+        
+        if (blockLength == 0) {
+            // The writer wrapped around to the start of the data region. A zero length at the start of the data region is corruption.
+            if (position == 0) {
+                break;
+            }
+            
+            position = 0;
+            blockLength = [self.fileHandle ARK_readDataBlockLengthAtOffset:ARKCircularArchiveHeaderLength];
+        }
+        
+        ARKFileOffset const endPosition = position + ARKDataBlockHeaderSize + blockLength;
+        if (blockLength == 0 || blockLength == ARKInvalidDataBlockLength || endPosition > header.capacity || ARKCircularArchiveHeaderLength + endPosition > fileLength) {
+            break;
+        }
+        
+        ARKFileOffset const blockOffset = ARKCircularArchiveHeaderLength + position;
+        [self.blockOffsets appendBytes:&blockOffset length:sizeof(ARKFileOffset)];
+        position = endPosition;
+    }
+    
+    return (self.objectCount > 0) ? position : header.headPosition;
+}
+
+- (nonnull NSArray<NSData *> *)_readCircularArchiveDataBlocksWithHeader_inFileOperationQueue:(ARKCircularArchiveHeader)header;
+{
+    [self _indexCircularArchiveWithHeader_inFileOperationQueue:header];
+    
+    NSUInteger const objectCount = self.objectCount;
+    ARKFileOffset const *const blockOffsets = self.blockOffsets.bytes;
+    NSMutableArray<NSData *> *const dataBlocks = [NSMutableArray arrayWithCapacity:objectCount];
+    
+    for (NSUInteger blockIndex = 0; blockIndex < objectCount; blockIndex++) {
+        [self.fileHandle seekToFileOffset:blockOffsets[blockIndex]];
+        
+        BOOL success = NO;
+        NSData *const dataBlock = [self.fileHandle ARK_readDataBlock:&success];
+        if (!success || dataBlock == nil) {
+            break;
+        }
+        
+        [dataBlocks addObject:dataBlock];
+    }
+    
+    [self.blockOffsets setLength:0];
+    
+    return dataBlocks;
+}
+
+/// Drops the oldest blocks from the index, moves the head up to the oldest remaining block, and persists the header.
+- (void)_evictBlocksFromCircularArchive_inFileOperationQueue:(NSUInteger)evictedCount;
+{
+    evictedCount = MIN(evictedCount, self.objectCount);
+    [self _reportEvictionOfBlocksInRange_inFileOperationQueue:NSMakeRange(0, evictedCount)];
+    [self.blockOffsets replaceBytesInRange:NSMakeRange(0, evictedCount * sizeof(ARKFileOffset)) withBytes:NULL length:0];
+    self.firstObjectSequenceNumber += evictedCount;
+    
+    if (self.objectCount > 0) {
+        ARKFileOffset const *const blockOffsets = self.blockOffsets.bytes;
+        self.circularArchiveHeadPosition = blockOffsets[0] - ARKCircularArchiveHeaderLength;
+    } else {
+        // With nothing left to preserve, start over at the beginning of the data region.
+        self.circularArchiveHeadPosition = 0;
+        self.circularArchiveTailPosition = 0;
+    }
+    
+    [self _writeCircularArchiveHeader_inFileOperationQueue];
+}
+
+/// Returns YES if the file starts with a circular archive header, passing back its contents.
+- (BOOL)_readCircularArchiveHeader_inFileOperationQueue:(nonnull ARKCircularArchiveHeader *)header;
+{
+    [self.fileHandle seekToFileOffset:0];
+    NSData *const headerData = [self.fileHandle readDataOfLength:ARKCircularArchiveHeaderLength];
+    if (headerData.length < ARKCircularArchiveHeaderLength) {
+        return NO;
+    }
+    
+    uint8_t const *const bytes = headerData.bytes;
+    if (OSReadBigInt32(bytes, 0) != ARKCircularArchiveMagic || OSReadBigInt32(bytes, sizeof(uint32_t)) != ARKCircularArchiveVersion) {
+        return NO;
+    }
+    
+    header->capacity = OSReadBigInt64(bytes, 2 * sizeof(uint32_t));
+    header->headPosition = OSReadBigInt64(bytes, 2 * sizeof(uint32_t) + sizeof(uint64_t));
+    header->tailPosition = OSReadBigInt64(bytes, 2 * sizeof(uint32_t) + 2 * sizeof(uint64_t));
+    header->blockCount = OSReadBigInt64(bytes, 2 * sizeof(uint32_t) + 3 * sizeof(uint64_t));
+    
+    return YES;
+}
+
+- (void)_writeCircularArchiveHeader_inFileOperationQueue;
+{
+    NSMutableData *const headerData = [NSMutableData dataWithLength:ARKCircularArchiveHeaderLength];
+    uint8_t *const bytes = headerData.mutableBytes;
+    
+    OSWriteBigInt32(bytes, 0, ARKCircularArchiveMagic);
+    OSWriteBigInt32(bytes, sizeof(uint32_t), ARKCircularArchiveVersion);
+    OSWriteBigInt64(bytes, 2 * sizeof(uint32_t), self.circularArchiveCapacity);
+    OSWriteBigInt64(bytes, 2 * sizeof(uint32_t) + sizeof(uint64_t), self.circularArchiveHeadPosition);
+    OSWriteBigInt64(bytes, 2 * sizeof(uint32_t) + 2 * sizeof(uint64_t), self.circularArchiveTailPosition);
+    OSWriteBigInt64(bytes, 2 * sizeof(uint32_t) + 3 * sizeof(uint64_t), self.objectCount);
+    
+    [self.fileHandle seekToFileOffset:0];
+    [self.fileHandle ARK_writeData:headerData];
+}
+
+#pragma mark - Private Methods: Compressed Archives
+
+- (void)_openCompressedArchive_inFileOperationQueue;
+{
+    // Block indexes are only kept for append-only archives, so a leftover one is stale.
+    [[NSFileManager defaultManager] removeItemAtURL:self.blockIndexFileURL error:NULL];
+    
+    if ([self _readCompressedArchiveHeader_inFileOperationQueue]) {
+        [self _indexCompressedArchive_inFileOperationQueue];
+        return;
+    }
+    
+    // A previous run wrote an uncompressed archive (or none at all). Rewrite its blocks, in order, as frames.
+    NSMutableData *const framedDataBlocks = [NSMutableData new];
+    ARKCircularArchiveHeader header = { };
+    if ([self _readCircularArchiveHeader_inFileOperationQueue:&header]) {
+        for (NSData *dataBlock in [self _readCircularArchiveDataBlocksWithHeader_inFileOperationQueue:header]) {
+            [self _appendFramedDataBlockWithData:dataBlock toData:framedDataBlocks];
+        }
+        
+    } else {
+        [self _indexArchive_inFileOperationQueue];
+        
+        ARKFileOffset const *const blockOffsets = self.blockOffsets.bytes;
+        for (NSUInteger blockIndex = 0; blockIndex < self.objectCount; blockIndex++) {
+            [self.fileHandle seekToFileOffset:blockOffsets[blockIndex]];
+            
+            BOOL success = NO;
+            NSData *const dataBlock = [self.fileHandle ARK_readDataBlock:&success];
+            if (success && dataBlock != nil) {
+                [self _appendFramedDataBlockWithData:dataBlock toData:framedDataBlocks];
+            }
+        }
+    }
+    
+    [self.blockOffsets setLength:0];
+    [self.fileHandle truncateFileAtOffset:0];
+    [self _writeCompressedArchiveHeader_inFileOperationQueue];
+    self.endOfArchiveOffset = ARKCompressedArchiveHeaderLength;
+    
+    if (framedDataBlocks.length > 0) {
+        [self _appendFramedDataBlocksToCompressedArchive_inFileOperationQueue:framedDataBlocks positions:[self _positionsOfFramedDataBlocks:framedDataBlocks]];
+    }
+}
+
+/// Walks the frame headers, storing the offset of each frame in blockOffsets once for every block it holds. Truncates the file after the last valid frame.
+- (void)_indexCompressedArchive_inFileOperationQueue;
+{
+    [self.blockOffsets setLength:0];
+    
+    ARKFileOffset const fileLength = [self.fileHandle seekToEndOfFile];
+    ARKFileOffset frameOffset = ARKCompressedArchiveHeaderLength;
+    
+    while (frameOffset < fileLength) {
+        NSUInteger const frameLength = [self.fileHandle ARK_readDataBlockLengthAtOffset:frameOffset];
+        if (frameLength == ARKInvalidDataBlockLength || frameLength <= ARKCompressedArchiveFrameHeaderLength || frameLength > fileLength - frameOffset - ARKDataBlockHeaderSize) {
+            break;
+        }
+        
+        NSData *const frameHeader = [self.fileHandle readDataOfLength:ARKCompressedArchiveFrameHeaderLength];
+        uint32_t const blockCount = (frameHeader.length == ARKCompressedArchiveFrameHeaderLength) ? OSReadBigInt32(frameHeader.bytes, 0) : 0;
+        
+        // Only a frame holding a single block can exceed the maximum frame length, which bounds how many blocks a valid frame holds.
+        if (blockCount == 0 || blockCount > ARKCompressedArchiveMaximumFrameLength / (ARKFramedDataBlockLengthMarkerSize + 1)) {
+            break;
+        }
+        
+        for (uint32_t i = 0; i < blockCount; i++) {
+            [self.blockOffsets appendBytes:&frameOffset length:sizeof(ARKFileOffset)];
+        }
+        
+        frameOffset += ARKDataBlockHeaderSize + frameLength;
+    }
+    
+    if (frameOffset < fileLength) {
+        NSLog(@"ERROR: -[%@ %@] corrupted archive at offset %@ of %@ in %@.",
+              NSStringFromClass([self class]), NSStringFromSelector(_cmd),
+              @(frameOffset), @(fileLength),
+              self.archiveFileURL);
+    }
+    
+    // Truncate corrupted content (if any).
+    self.endOfArchiveOffset = MIN(frameOffset, fileLength);
+    [self.fileHandle truncateFileAtOffset:self.endOfArchiveOffset];
+}
+
+/// Compresses the framed blocks into as many frames as needed, and appends the frames to the file as a single write.
+- (void)_appendFramedDataBlocksToCompressedArchive_inFileOperationQueue:(nonnull NSData *)framedDataBlocks positions:(nonnull NSData *)framedBlockPositions;
+{
+    ARKFileOffset const endOfFileOffset = [self.fileHandle seekToEndOfFile];
+    if (endOfFileOffset != self.endOfArchiveOffset) {
+        NSLog(@"ERROR: -[%@ %@] archive length changed from %@ to %@ outside of %@.",
+              NSStringFromClass([self class]), NSStringFromSelector(_cmd),
+              @(self.endOfArchiveOffset), @(endOfFileOffset),
+              self.archiveFileURL);
+        
+        // The file was modified out from under us, so our block index can't be trusted.
+        [self _indexCompressedArchive_inFileOperationQueue];
+    }
+    
+    NSUInteger const *const positions = framedBlockPositions.bytes;
+    NSUInteger const blockCount = framedBlockPositions.length / sizeof(NSUInteger);
+    NSUInteger const framedDataBlocksLength = framedDataBlocks.length;
+    uint8_t const *const framedBytes = framedDataBlocks.bytes;
+    
+    ARKFileOffset const firstFrameOffset = self.endOfArchiveOffset;
+    NSMutableData *const frames = [NSMutableData new];
+    NSMutableData *const frameBlockOffsets = [NSMutableData new];
+    
+    for (NSUInteger firstBlockIndex = 0, endBlockIndex = 0; firstBlockIndex < blockCount; firstBlockIndex = endBlockIndex) {
+        // Gather as many blocks as fit in a frame, and always at least one.
+        NSUInteger const firstPosition = positions[firstBlockIndex];
+        endBlockIndex = firstBlockIndex + 1;
+        while (endBlockIndex < blockCount && ((endBlockIndex + 1 < blockCount) ? positions[endBlockIndex + 1] : framedDataBlocksLength) - firstPosition <= ARKCompressedArchiveMaximumFrameLength) {
+            endBlockIndex++;
+        }
+        
+        NSUInteger const endPosition = (endBlockIndex < blockCount) ? positions[endBlockIndex] : framedDataBlocksLength;
+        NSData *const uncompressedDataBlocks = [NSData dataWithBytesNoCopy:(void *)(framedBytes + firstPosition) length:(endPosition - firstPosition) freeWhenDone:NO];
+        
+        NSError *error = nil;
+        NSData *const compressedDataBlocks = [uncompressedDataBlocks compressedDataUsingAlgorithm:NSDataCompressionAlgorithmLZFSE error:&error];
+        if (compressedDataBlocks == nil) {
+            NSLog(@"ERROR: -[%@ %@] dropping %@ objects that couldn't be compressed in %@: %@",
+                  NSStringFromClass([self class]), NSStringFromSelector(_cmd),
+                  @(endBlockIndex - firstBlockIndex),
+                  self.archiveFileURL, error);
+            continue;
+        }
+        
+        NSMutableData *const frame = [NSMutableData dataWithLength:ARKCompressedArchiveFrameHeaderLength];
+        OSWriteBigInt32(frame.mutableBytes, 0, (uint32_t)(endBlockIndex - firstBlockIndex));
+        OSWriteBigInt32(frame.mutableBytes, sizeof(uint32_t), (uint32_t)uncompressedDataBlocks.length);
+        [frame appendData:compressedDataBlocks];
+        
+        // Each frame takes the sequence number of the first block it holds.
+        uint64_t const sequenceNumber = self.firstObjectSequenceNumber + self.objectCount + frameBlockOffsets.length / sizeof(ARKFileOffset);
+        ARKFileOffset const frameOffset = firstFrameOffset + frames.length;
+        for (NSUInteger blockIndex = firstBlockIndex; blockIndex < endBlockIndex; blockIndex++) {
+            [frameBlockOffsets appendBytes:&frameOffset length:sizeof(ARKFileOffset)];
+        }
+        
+        [self _appendChecksummedDataBlockWithData:frame sequenceNumber:sequenceNumber toData:frames];
+    }
+    
+    if (frames.length == 0) {
+        return;
+    }
+    
+    [self.fileHandle seekToFileOffset:firstFrameOffset];
+    
+    if ([self.fileHandle ARK_writeData:frames]) {
+        [self.blockOffsets appendData:frameBlockOffsets];
+        self.endOfArchiveOffset = firstFrameOffset + frames.length;
+        
+    } else if ([self.fileHandle seekToEndOfFile] != firstFrameOffset) {
+        // Partially written frames were left at the end of the file.
+        [self.fileHandle truncateFileAtOffset:firstFrameOffset];
+    }
+}
+
+/// Removes whole frames from the start of the file, keeping the newest keptObjectCount blocks along with the older blocks that share their oldest frame. If keeping those older blocks would exceed the maximumObjectCount, their frame is removed as well.
+- (void)_trimCompressedArchiveToObjectCount_inFileOperationQueue:(NSUInteger)keptObjectCount;
+{
+    NSUInteger const objectCount = self.objectCount;
+    ARKFileOffset const *const blockOffsets = self.blockOffsets.bytes;
+    
+    NSUInteger const droppedObjectCount = objectCount - MIN(keptObjectCount, objectCount);
+    
+    NSUInteger blockIndex = [self _indexOfFirstBlockInFrameOfBlockAtIndex:droppedObjectCount];
+    if (objectCount - blockIndex > self.maximumObjectCount) {
+        // Drop the rest of the partially trimmed frame instead.
+        blockIndex = droppedObjectCount;
+        while (blockIndex > 0 && blockIndex < objectCount && blockOffsets[blockIndex] == blockOffsets[blockIndex - 1]) {
+            blockIndex++;
+        }
+    }
+    
+    if (blockIndex == 0) {
+        return;
+    }
+    
+    ARKFileOffset const trimOffset = (blockIndex < objectCount) ? blockOffsets[blockIndex] : self.endOfArchiveOffset;
+    ARKFileOffset const trimmedLength = trimOffset - ARKCompressedArchiveHeaderLength;
+    ARKFileOffset const keptLength = self.endOfArchiveOffset - trimOffset;
+    
+    [self _reportEvictionOfBlocksInRange_inFileOperationQueue:NSMakeRange(0, blockIndex)];
+    [self.fileHandle ARK_moveDataFromOffset:trimOffset toOffset:ARKCompressedArchiveHeaderLength length:keptLength maximumChunkSize:ARKMaximumChunkSizeForTrimOperation];
+    [self.fileHandle truncateFileAtOffset:(ARKCompressedArchiveHeaderLength + keptLength)];
+    self.firstObjectSequenceNumber += blockIndex;
+    
+    // Drop the trimmed blocks from the index, and shift the remaining offsets to match their new location in the file.
+    [self.blockOffsets replaceBytesInRange:NSMakeRange(0, blockIndex * sizeof(ARKFileOffset)) withBytes:NULL length:0];
+    
+    ARKFileOffset *const shiftedBlockOffsets = self.blockOffsets.mutableBytes;
+    for (NSUInteger i = 0; i < objectCount - blockIndex; i++) {
+        shiftedBlockOffsets[i] -= trimmedLength;
+    }
+    
+    self.endOfArchiveOffset -= trimmedLength;
+}
+
+/// Returns the index of the oldest block in the same frame as the block at blockIndex, or blockIndex itself if it is past the last block.
+- (NSUInteger)_indexOfFirstBlockInFrameOfBlockAtIndex:(NSUInteger)blockIndex;
+{
+    NSUInteger const objectCount = self.objectCount;
+    ARKFileOffset const *const blockOffsets = self.blockOffsets.bytes;
+    
+    while (blockIndex > 0 && blockIndex < objectCount && blockOffsets[blockIndex - 1] == blockOffsets[blockIndex]) {
+        blockIndex--;
+    }
+    
+    return blockIndex;
+}
+
+/// Returns the data of the block at blockIndex, reading from mappedArchive when provided and otherwise from the file handle. The decompressed blocks of the frame holding it are passed back, along with the index of the frame's first block, and are reused by the next call if it asks for a block in the same frame. Returns nil if the frame is corrupted.
+- (nullable NSData *)_dataBlockAtIndex:(NSUInteger)blockIndex inCompressedArchive:(nullable NSData *)mappedArchive frameDataBlocks:(NSArray<NSData *> * _Nullable * _Nonnull)frameDataBlocks frameBlockIndex:(nonnull NSUInteger *)frameBlockIndex;
+{
+    ARKFileOffset const *const blockOffsets = self.blockOffsets.bytes;
+    ARKFileOffset const frameOffset = blockOffsets[blockIndex];
+    
+    BOOL const isInCurrentFrame = (*frameDataBlocks != nil && *frameBlockIndex <= blockIndex && blockOffsets[*frameBlockIndex] == frameOffset);
+    if (!isInCurrentFrame) {
+        BOOL success = NO;
+        NSData *frame = nil;
+        if (mappedArchive != nil) {
+            frame = ARKDataBlockInMappedArchive(mappedArchive, frameOffset, &success);
+        } else {
+            [self.fileHandle seekToFileOffset:frameOffset];
+            frame = [self.fileHandle ARK_readDataBlock:&success];
+        }
+        
+        *frameDataBlocks = (success && frame != nil) ? ARKDataBlocksInCompressedFrame(frame) : nil;
+        *frameBlockIndex = [self _indexOfFirstBlockInFrameOfBlockAtIndex:blockIndex];
+    }
+    
+    NSUInteger const indexInFrame = blockIndex - *frameBlockIndex;
+    return (indexInFrame < (*frameDataBlocks).count) ? (*frameDataBlocks)[indexInFrame] : nil;
+}
+
+/// Returns the data of the blocks in range, stopping early at a corrupted frame.
+- (nonnull NSArray<NSData *> *)_dataBlocksInRangeOfCompressedArchive_inFileOperationQueue:(NSRange)blockRange;
+{
+    NSMutableArray<NSData *> *const dataBlocks = [NSMutableArray arrayWithCapacity:blockRange.length];
+    NSArray<NSData *> *frameDataBlocks = nil;
+    NSUInteger frameBlockIndex = 0;
+    
+    for (NSUInteger blockIndex = blockRange.location; blockIndex < NSMaxRange(blockRange) && blockIndex < self.objectCount; blockIndex++) {
+        NSData *const dataBlock = [self _dataBlockAtIndex:blockIndex inCompressedArchive:nil frameDataBlocks:&frameDataBlocks frameBlockIndex:&frameBlockIndex];
+        if (dataBlock == nil) {
+            break;
+        }
+        
+        [dataBlocks addObject:dataBlock];
+    }
+    
+    return dataBlocks;
+}
+
+/// Decompresses every block of a compressed archive, and rewrites them, in order, as an append-only archive.
+- (void)_rewriteCompressedArchiveAsAppendOnlyArchive_inFileOperationQueue;
+{
+    [self _indexCompressedArchive_inFileOperationQueue];
+    NSArray<NSData *> *const dataBlocks = [self _dataBlocksInRangeOfCompressedArchive_inFileOperationQueue:NSMakeRange(0, self.objectCount)];
+    
+    [self _rewriteArchiveWithDataBlocks_inFileOperationQueue:dataBlocks];
+}
+
+/// Returns YES if the file starts with a compressed archive header.
+- (BOOL)_readCompressedArchiveHeader_inFileOperationQueue;
+{
+    [self.fileHandle seekToFileOffset:0];
+    NSData *const headerData = [self.fileHandle readDataOfLength:ARKCompressedArchiveHeaderLength];
+    if (headerData.length < ARKCompressedArchiveHeaderLength) {
+        return NO;
+    }
+    
+    uint8_t const *const bytes = headerData.bytes;
+    return (OSReadBigInt32(bytes, 0) == ARKCompressedArchiveMagic && OSReadBigInt32(bytes, sizeof(uint32_t)) == ARKCompressedArchiveVersion);
+}
+
+- (void)_writeCompressedArchiveHeader_inFileOperationQueue;
+{
+    NSMutableData *const headerData = [NSMutableData dataWithLength:ARKCompressedArchiveHeaderLength];
+    uint8_t *const bytes = headerData.mutableBytes;
+    
+    OSWriteBigInt32(bytes, 0, ARKCompressedArchiveMagic);
+    OSWriteBigInt32(bytes, sizeof(uint32_t), ARKCompressedArchiveVersion);
+    
+    [self.fileHandle seekToFileOffset:0];
+    [self.fileHandle ARK_writeData:headerData];
+}
+
+#pragma mark - Private Methods: Unchecksummed Archives
+
+/// Returns the data blocks of an archive written before data blocks had checksummed headers, oldest first, or nil if the file isn't such an archive.
+- (nullable NSArray<NSData *> *)_readUnchecksummedArchiveDataBlocks_inFileOperationQueue;
+{
+    // This runs on every open, so look at the header alone before reading the whole file.
+    NSUInteger const firstDataBlockLength = [self.fileHandle ARK_readDataBlockLengthAtOffset:0];
+    if (firstDataBlockLength == 0 || firstDataBlockLength != ARKInvalidDataBlockLength) {
+        // The file is empty or starts with a checksummed header.
+        return nil;
+    }
+    
+    [self.fileHandle seekToFileOffset:0];
+    NSData *const headerData = [self.fileHandle readDataOfLength:(2 * sizeof(uint32_t))];
+    if (headerData.length < ARKFramedDataBlockLengthMarkerSize) {
+        return nil;
+    }
+    
+    if (headerData.length == 2 * sizeof(uint32_t)) {
+        uint32_t const magic = OSReadBigInt32(headerData.bytes, 0);
+        uint32_t const version = OSReadBigInt32(headerData.bytes, sizeof(uint32_t));
+        
+        if (magic == ARKCircularArchiveMagic) {
+            return (version == ARKUnchecksummedCircularArchiveVersion) ? [self _dataBlocksInUnchecksummedCircularArchive:[self _contentsOfFile_inFileOperationQueue]] : nil;
+        } else if (magic == ARKCompressedArchiveMagic) {
+            return (version == ARKUnchecksummedCompressedArchiveVersion) ? [self _dataBlocksInUnchecksummedCompressedArchive:[self _contentsOfFile_inFileOperationQueue]] : nil;
+        }
+    }
+    
+    // A checksummed archive whose oldest block is damaged still has intact blocks after it.
+    [self.fileHandle seekToFileOffset:0];
+    if ([self.fileHandle ARK_indexDataBlocksIntoOffsets:[NSMutableData new]] > 0) {
+        return nil;
+    }
+    
+    NSData *const contents = [self _contentsOfFile_inFileOperationQueue];
+    // Otherwise it's an append-only archive if it starts with a framed block. Anything after the last intact framed block is dropped, as it always was.
+    NSMutableArray<NSData *> *const dataBlocks = [NSMutableArray new];
+    for (NSUInteger position = 0; position < contents.length;) {
+        NSData *const dataBlock = ARKFramedDataBlockInData(contents, position, contents.length);
+        if (dataBlock == nil) {
+            break;
+        }
+        
+        // Copy the data block out, since the view onto contents doesn't keep it alive.
+        [dataBlocks addObject:[contents subdataWithRange:NSMakeRange(position + ARKFramedDataBlockLengthMarkerSize, dataBlock.length)]];
+        position += ARKFramedDataBlockLengthMarkerSize + dataBlock.length;
+    }
+    
+    return (dataBlocks.count > 0) ? dataBlocks : nil;
+}
+
+/// Reads the whole file. It's read rather than mapped, since it's about to be rewritten.
+- (nonnull NSData *)_contentsOfFile_inFileOperationQueue;
+{
+    [self.fileHandle seekToFileOffset:0];
+    return [self.fileHandle readDataToEndOfFile];
+}
+
+/// Walks the framed blocks of a circular archive written before data blocks had checksummed headers, starting from the head.
+- (nonnull NSArray<NSData *> *)_dataBlocksInUnchecksummedCircularArchive:(nonnull NSData *)contents;
+{
+    if (contents.length < ARKCircularArchiveHeaderLength) {
+        return @[];
+    }
+    
+    uint8_t const *const bytes = contents.bytes;
+    uint64_t const capacity = OSReadBigInt64(bytes, 2 * sizeof(uint32_t));
+    uint64_t const blockCount = OSReadBigInt64(bytes, 2 * sizeof(uint32_t) + 3 * sizeof(uint64_t));
+    NSUInteger const endOfDataRegion = (NSUInteger)MIN((uint64_t)contents.length, ARKCircularArchiveHeaderLength + capacity);
+    
+    NSMutableArray<NSData *> *const dataBlocks = [NSMutableArray new];
+    NSUInteger position = ARKCircularArchiveHeaderLength + (NSUInteger)MIN(OSReadBigInt64(bytes, 2 * sizeof(uint32_t) + sizeof(uint64_t)), (uint64_t)endOfDataRegion);
+    
+    for (uint64_t blockIndex = 0; blockIndex < blockCount; blockIndex++) {
+        NSData *dataBlock = ARKFramedDataBlockInData(contents, position, endOfDataRegion);
+        if (dataBlock == nil && position > ARKCircularArchiveHeaderLength) {
+            // The writer wrapped around to the start of the data region.
+            position = ARKCircularArchiveHeaderLength;
+            dataBlock = ARKFramedDataBlockInData(contents, position, endOfDataRegion);
+        }
+        
+        if (dataBlock == nil) {
+            break;
+        }
+        
+        [dataBlocks addObject:[contents subdataWithRange:NSMakeRange(position + ARKFramedDataBlockLengthMarkerSize, dataBlock.length)]];
+        position += ARKFramedDataBlockLengthMarkerSize + dataBlock.length;
+    }
+    
+    return dataBlocks;
+}
+
+/// Decompresses the frames of a compressed archive written before frames had checksummed headers, stopping at the first corrupted frame.
+- (nonnull NSArray<NSData *> *)_dataBlocksInUnchecksummedCompressedArchive:(nonnull NSData *)contents;
+{
+    NSMutableArray<NSData *> *const dataBlocks = [NSMutableArray new];
+    for (NSUInteger position = ARKCompressedArchiveHeaderLength; position < contents.length;) {
+        NSData *const frame = ARKFramedDataBlockInData(contents, position, contents.length);
+        NSArray<NSData *> *const frameDataBlocks = (frame != nil) ? ARKDataBlocksInCompressedFrame(frame) : nil;
+        if (frameDataBlocks == nil) {
+            break;
+        }
+        
+        [dataBlocks addObjectsFromArray:frameDataBlocks];
+        position += ARKFramedDataBlockLengthMarkerSize + frame.length;
+    }
+    
+    return dataBlocks;
+}
+
+@end
+
+
+@implementation ARKDataArchiveCursor
+
+#pragma mark - Initialization
+
+- (nonnull instancetype)initWithDataArchive:(nonnull ARKDataArchive *)dataArchive objectType:(nonnull Class)objectType options:(ARKDataArchiveReadOptions)options pageSize:(NSUInteger)pageSize;
+{
+    self = [super init];
+    
+    _dataArchive = dataArchive;
+    _objectType = objectType;
+    _options = options;
+    _pageSize = pageSize;
+    
+    return self;
+}
+
+#pragma mark - Public Methods
+
+- (void)readNextPageOnQueue:(nonnull NSOperationQueue *)queue completionHandler:(nonnull void (^)(NSArray * _Nonnull objects, BOOL hasMoreObjects))completionHandler;
+{
+    ARKCheckCondition(queue != nil, , @"Must provide a queue!");
+    ARKCheckCondition(completionHandler != NULL, , @"Must provide a completionHandler!");
+    
+    [self.dataArchive _readNextPageForCursor:self onQueue:queue completionHandler:^(NSArray *objects, NSUInteger trimmedObjectCount, BOOL hasMoreObjects) {
+        completionHandler(objects, hasMoreObjects);
+    }];
+}
+
+- (void)readNextPageAndTrimmedObjectCountOnQueue:(nonnull NSOperationQueue *)queue completionHandler:(nonnull void (^)(NSArray * _Nonnull objects, NSUInteger trimmedObjectCount, BOOL hasMoreObjects))completionHandler;
+{
+    ARKCheckCondition(queue != nil, , @"Must provide a queue!");
+    ARKCheckCondition(completionHandler != NULL, , @"Must provide a completionHandler!");
+    
+    [self.dataArchive _readNextPageForCursor:self onQueue:queue completionHandler:completionHandler];
 }
 
 @end
@@ -68,4 +68,10 @@
     return [formattedLogMessage copy];
 }
 
+- (BOOL)supportsConcurrentFormatting;
+{
+    // A subclass may format using state of its own, so it has to opt in by overriding this.
+    return ([self class] == [ARKDefaultLogFormatter class]);
+}
+
 @end
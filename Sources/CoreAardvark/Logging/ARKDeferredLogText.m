@@ -0,0 +1,464 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "ARKDeferredLogText.h"
+
+
+typedef NS_ENUM(uint8_t, ARKDeferredLogTextArgumentKind) {
+    ARKDeferredLogTextArgumentKindPercentSign = 0,
+    ARKDeferredLogTextArgumentKindSignedInteger,
+    ARKDeferredLogTextArgumentKindUnsignedInteger,
+    ARKDeferredLogTextArgumentKindCharacter,
+    ARKDeferredLogTextArgumentKindDouble,
+    ARKDeferredLogTextArgumentKindPointer,
+    ARKDeferredLogTextArgumentKindCString,
+    ARKDeferredLogTextArgumentKindObject,
+};
+
+typedef NS_ENUM(uint8_t, ARKDeferredLogTextLengthModifier) {
+    ARKDeferredLogTextLengthModifierNone = 0,
+    ARKDeferredLogTextLengthModifierChar,
+    ARKDeferredLogTextLengthModifierShort,
+    ARKDeferredLogTextLengthModifierLong,
+    ARKDeferredLogTextLengthModifierLongLong,
+    ARKDeferredLogTextLengthModifierLongDouble,
+    ARKDeferredLogTextLengthModifierSize,
+    ARKDeferredLogTextLengthModifierPointerDifference,
+    ARKDeferredLogTextLengthModifierMaximum,
+};
+
+/// A conversion specification within the format, and the argument captured for it.
+typedef struct {
+    /// The range of the specification within the format, from the percent sign through the conversion character.
+    NSRange range;
+    
+    /// The number of flag, width, and precision characters following the percent sign.
+    NSUInteger optionsLength;
+    
+    /// The precision given in the options, or NSNotFound if there isn't one.
+    NSUInteger precision;
+    
+    unichar conversion;
+    ARKDeferredLogTextArgumentKind kind;
+    ARKDeferredLogTextLengthModifier lengthModifier;
+    
+    union {
+        long long signedInteger;
+        unsigned long long unsignedInteger;
+        int character;
+        double floatingPoint;
+        void *pointer;
+    } value;
+    
+    /// The index into capturedObjects for C string and object arguments.
+    NSUInteger objectIndex;
+} ARKDeferredLogTextArgument;
+
+
+/// Returns YES for flag, width, and precision characters.
+static BOOL ARKDeferredLogTextIsOptionCharacter(unichar character)
+{
+    switch (character) {
+        case '-':
+        case '+':
+        case ' ':
+        case '#':
+        case '\'':
+        case '.':
+            return YES;
+        default:
+            return (character >= '0' && character <= '9');
+    }
+}
+
+/// Parses the conversion specifications in format. Returns NO if any of them cannot be captured.
+static BOOL ARKDeferredLogTextParseFormat(NSString *format, NSMutableData *arguments)
+{
+    NSUInteger const length = format.length;
+    unichar *const characters = malloc(length * sizeof(unichar));
+    [format getCharacters:characters range:NSMakeRange(0, length)];
+    
+    BOOL success = YES;
+    NSUInteger index = 0;
+    while (success && index < length) {
+        if (characters[index] != '%') {
+            index++;
+            continue;
+        }
+        
+        ARKDeferredLogTextArgument argument = { .range = NSMakeRange(index, 0), .precision = NSNotFound };
+        NSUInteger position = index + 1;
+        
+        // Flags, width, and precision. Positional and `*` arguments can't be captured without interpreting the whole format.
+        while (position < length && ARKDeferredLogTextIsOptionCharacter(characters[position])) {
+            if (characters[position] == '.') {
+                // Later digits belong to the precision. A precision without digits is zero.
+                argument.precision = 0;
+            } else if (argument.precision != NSNotFound && characters[position] >= '0' && characters[position] <= '9') {
+                argument.precision = MIN(argument.precision, (NSNotFound - 1) / 10) * 10 + (characters[position] - '0');
+            }
+            position++;
+        }
+        argument.optionsLength = position - index - 1;
+        
+        if (position < length) {
+            switch (characters[position]) {
+                case 'h':
+                    position++;
+                    if (position < length && characters[position] == 'h') {
+                        argument.lengthModifier = ARKDeferredLogTextLengthModifierChar;
+                        position++;
+                    } else {
+                        argument.lengthModifier = ARKDeferredLogTextLengthModifierShort;
+                    }
+                    break;
+                case 'l':
+                    position++;
+                    if (position < length && characters[position] == 'l') {
+                        argument.lengthModifier = ARKDeferredLogTextLengthModifierLongLong;
+                        position++;
+                    } else {
+                        argument.lengthModifier = ARKDeferredLogTextLengthModifierLong;
+                    }
+                    break;
+                case 'q':
+                    argument.lengthModifier = ARKDeferredLogTextLengthModifierLongLong;
+                    position++;
+                    break;
+                case 'L':
+                    argument.lengthModifier = ARKDeferredLogTextLengthModifierLongDouble;
+                    position++;
+                    break;
+                case 'z':
+                    argument.lengthModifier = ARKDeferredLogTextLengthModifierSize;
+                    position++;
+                    break;
+                case 't':
+                    argument.lengthModifier = ARKDeferredLogTextLengthModifierPointerDifference;
+                    position++;
+                    break;
+                case 'j':
+                    argument.lengthModifier = ARKDeferredLogTextLengthModifierMaximum;
+                    position++;
+                    break;
+                default:
+                    break;
+            }
+        }
+        
+        if (position >= length) {
+            success = NO;
+            break;
+        }
+        
+        argument.conversion = characters[position];
+        argument.range.length = position + 1 - index;
+        
+        BOOL const hasNoModifier = (argument.lengthModifier == ARKDeferredLogTextLengthModifierNone);
+        switch (argument.conversion) {
+            case '%':
+                argument.kind = ARKDeferredLogTextArgumentKindPercentSign;
+                success = (argument.optionsLength == 0 && hasNoModifier);
+                break;
+            case 'd':
+            case 'i':
+                argument.kind = ARKDeferredLogTextArgumentKindSignedInteger;
+                success = (argument.lengthModifier != ARKDeferredLogTextLengthModifierLongDouble);
+                break;
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+                argument.kind = ARKDeferredLogTextArgumentKindUnsignedInteger;
+                success = (argument.lengthModifier != ARKDeferredLogTextLengthModifierLongDouble);
+                break;
+            case 'c':
+            case 'C':
+                argument.kind = ARKDeferredLogTextArgumentKindCharacter;
+                success = hasNoModifier;
+                break;
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                argument.kind = ARKDeferredLogTextArgumentKindDouble;
+                success = (hasNoModifier || argument.lengthModifier == ARKDeferredLogTextLengthModifierLong);
+                break;
+            case 'p':
+                argument.kind = ARKDeferredLogTextArgumentKindPointer;
+                success = hasNoModifier;
+                break;
+            case 's':
+                argument.kind = ARKDeferredLogTextArgumentKindCString;
+                success = hasNoModifier;
+                break;
+            case '@':
+                argument.kind = ARKDeferredLogTextArgumentKindObject;
+                success = hasNoModifier;
+                break;
+            default:
+                // Includes %n, %S, and the deprecated %D, %O, and %U.
+                success = NO;
+                break;
+        }
+        
+        if (success) {
+            [arguments appendBytes:&argument length:sizeof(argument)];
+        }
+        index = position + 1;
+    }
+    
+    free(characters);
+    return success;
+}
+
+/// Reads a signed integer argument, truncated to its length modifier as printf would.
+static long long ARKDeferredLogTextReadSignedInteger(ARKDeferredLogTextLengthModifier lengthModifier, va_list *argList)
+{
+    switch (lengthModifier) {
+        case ARKDeferredLogTextLengthModifierChar:
+            return (signed char)va_arg(*argList, int);
+        case ARKDeferredLogTextLengthModifierShort:
+            return (short)va_arg(*argList, int);
+        case ARKDeferredLogTextLengthModifierLong:
+            return va_arg(*argList, long);
+        case ARKDeferredLogTextLengthModifierLongLong:
+            return va_arg(*argList, long long);
+        case ARKDeferredLogTextLengthModifierSize:
+            return va_arg(*argList, ssize_t);
+        case ARKDeferredLogTextLengthModifierPointerDifference:
+            return va_arg(*argList, ptrdiff_t);
+        case ARKDeferredLogTextLengthModifierMaximum:
+            return va_arg(*argList, intmax_t);
+        case ARKDeferredLogTextLengthModifierNone:
+        case ARKDeferredLogTextLengthModifierLongDouble:
+            return va_arg(*argList, int);
+    }
+}
+
+/// Reads an unsigned integer argument, truncated to its length modifier as printf would.
+static unsigned long long ARKDeferredLogTextReadUnsignedInteger(ARKDeferredLogTextLengthModifier lengthModifier, va_list *argList)
+{
+    switch (lengthModifier) {
+        case ARKDeferredLogTextLengthModifierChar:
+            return (unsigned char)va_arg(*argList, unsigned int);
+        case ARKDeferredLogTextLengthModifierShort:
+            return (unsigned short)va_arg(*argList, unsigned int);
+        case ARKDeferredLogTextLengthModifierLong:
+            return va_arg(*argList, unsigned long);
+        case ARKDeferredLogTextLengthModifierLongLong:
+            return va_arg(*argList, unsigned long long);
+        case ARKDeferredLogTextLengthModifierSize:
+            return va_arg(*argList, size_t);
+        case ARKDeferredLogTextLengthModifierPointerDifference:
+            return (unsigned long long)va_arg(*argList, ptrdiff_t);
+        case ARKDeferredLogTextLengthModifierMaximum:
+            return va_arg(*argList, uintmax_t);
+        case ARKDeferredLogTextLengthModifierNone:
+        case ARKDeferredLogTextLengthModifierLongDouble:
+            return va_arg(*argList, unsigned int);
+    }
+}
+
+/// Returns an object that will describe itself the same way later, on any thread.
+static id ARKDeferredLogTextCaptureObject(id object)
+{
+    if (object == nil) {
+        return [NSNull null];
+    }
+    
+    if ([object isKindOfClass:[NSString class]]) {
+        return [object copy];
+    }
+    
+    if ([object isKindOfClass:[NSNumber class]] || [object isKindOfClass:[NSDate class]] || [object isKindOfClass:[NSURL class]] || [object isKindOfClass:[NSUUID class]]) {
+        return object;
+    }
+    
+    return [object description] ?: [NSNull null];
+}
+
+
+@interface ARKDeferredLogText ()
+
+@property (nonnull, nonatomic, copy, readonly) NSString *format;
+
+/// The ARKDeferredLogTextArgument for each conversion specification in the format. Released once the text is formatted.
+@property (nullable, nonatomic) NSData *arguments;
+
+/// C strings (as NSData, including their terminator) and objects referenced by the arguments, or NSNull for NULL and nil arguments.
+@property (nullable, nonatomic) NSArray *capturedObjects;
+
+/// Guarded by @synchronized(self).
+@property (nullable, nonatomic, copy) NSString *formattedText;
+
+@end
+
+
+@implementation ARKDeferredLogText
+
+#pragma mark - Initialization
+
+- (instancetype)initWithFormat:(NSString *)format arguments:(va_list)argList;
+{
+    NSMutableData *const arguments = [NSMutableData new];
+    if (!ARKDeferredLogTextParseFormat(format, arguments)) {
+        return nil;
+    }
+    
+    self = [super init];
+    
+    va_list capturedArgList;
+    va_copy(capturedArgList, argList);
+    
+    NSMutableArray *const capturedObjects = [NSMutableArray new];
+    ARKDeferredLogTextArgument *const argumentList = arguments.mutableBytes;
+    NSUInteger const argumentCount = arguments.length / sizeof(ARKDeferredLogTextArgument);
+    for (NSUInteger argumentIndex = 0; argumentIndex < argumentCount; argumentIndex++) {
+        ARKDeferredLogTextArgument *const argument = &argumentList[argumentIndex];
+        
+        switch (argument->kind) {
+            case ARKDeferredLogTextArgumentKindPercentSign:
+                break;
+            case ARKDeferredLogTextArgumentKindSignedInteger:
+                argument->value.signedInteger = ARKDeferredLogTextReadSignedInteger(argument->lengthModifier, &capturedArgList);
+                break;
+            case ARKDeferredLogTextArgumentKindUnsignedInteger:
+                argument->value.unsignedInteger = ARKDeferredLogTextReadUnsignedInteger(argument->lengthModifier, &capturedArgList);
+                break;
+            case ARKDeferredLogTextArgumentKindCharacter:
+                argument->value.character = va_arg(capturedArgList, int);
+                break;
+            case ARKDeferredLogTextArgumentKindDouble:
+                argument->value.floatingPoint = va_arg(capturedArgList, double);
+                break;
+            case ARKDeferredLogTextArgumentKindPointer:
+                argument->value.pointer = va_arg(capturedArgList, void *);
+                break;
+            case ARKDeferredLogTextArgumentKindCString: {
+                // The caller's buffer may not outlive this call, so copy the string. With a precision, the string needn't be terminated within the buffer, so never read past the precision.
+                char const *const string = va_arg(capturedArgList, char const *);
+                argument->objectIndex = capturedObjects.count;
+                if (string != NULL) {
+                    size_t const stringLength = (argument->precision != NSNotFound) ? strnlen(string, argument->precision) : strlen(string);
+                    NSMutableData *const stringData = [NSMutableData dataWithLength:stringLength + 1];
+                    memcpy(stringData.mutableBytes, string, stringLength);
+                    [capturedObjects addObject:stringData];
+                } else {
+                    [capturedObjects addObject:[NSNull null]];
+                }
+                break;
+            }
+            case ARKDeferredLogTextArgumentKindObject: {
+                id const object = va_arg(capturedArgList, id);
+                argument->objectIndex = capturedObjects.count;
+                [capturedObjects addObject:ARKDeferredLogTextCaptureObject(object)];
+                break;
+            }
+        }
+    }
+    
+    va_end(capturedArgList);
+    
+    _format = [format copy];
+    _arguments = arguments;
+    _capturedObjects = capturedObjects;
+    
+    return self;
+}
+
+#pragma mark - Properties
+
+- (NSString *)text;
+{
+    @synchronized(self) {
+        if (self.formattedText == nil) {
+            self.formattedText = [self _formatText];
+            self.arguments = nil;
+            self.capturedObjects = nil;
+        }
+        
+        return self.formattedText;
+    }
+}
+
+#pragma mark - Private Methods
+
+- (nonnull NSString *)_formatText;
+{
+    NSString *const format = self.format;
+    NSMutableString *const text = [NSMutableString stringWithCapacity:format.length];
+    
+    ARKDeferredLogTextArgument const *const argumentList = self.arguments.bytes;
+    NSUInteger const argumentCount = self.arguments.length / sizeof(ARKDeferredLogTextArgument);
+    NSUInteger literalStart = 0;
+    for (NSUInteger argumentIndex = 0; argumentIndex < argumentCount; argumentIndex++) {
+        ARKDeferredLogTextArgument const *const argument = &argumentList[argumentIndex];
+        [text appendString:[format substringWithRange:NSMakeRange(literalStart, argument->range.location - literalStart)]];
+        literalStart = NSMaxRange(argument->range);
+        
+        if (argument->kind == ARKDeferredLogTextArgumentKindPercentSign) {
+            [text appendString:@"%"];
+            continue;
+        }
+        
+        // Rebuild the specification with a length modifier that matches the captured value.
+        NSString *const options = [format substringWithRange:NSMakeRange(argument->range.location + 1, argument->optionsLength)];
+        BOOL const isInteger = (argument->kind == ARKDeferredLogTextArgumentKindSignedInteger || argument->kind == ARKDeferredLogTextArgumentKindUnsignedInteger);
+        NSString *const specification = [NSString stringWithFormat:@"%%%@%@%C", options, isInteger ? @"ll" : @"", argument->conversion];
+        
+        id const capturedObject = (argument->kind == ARKDeferredLogTextArgumentKindCString || argument->kind == ARKDeferredLogTextArgumentKindObject) ? self.capturedObjects[argument->objectIndex] : nil;
+        
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wformat-nonliteral"
+        switch (argument->kind) {
+            case ARKDeferredLogTextArgumentKindPercentSign:
+                break;
+            case ARKDeferredLogTextArgumentKindSignedInteger:
+                [text appendFormat:specification, argument->value.signedInteger];
+                break;
+            case ARKDeferredLogTextArgumentKindUnsignedInteger:
+                [text appendFormat:specification, argument->value.unsignedInteger];
+                break;
+            case ARKDeferredLogTextArgumentKindCharacter:
+                [text appendFormat:specification, argument->value.character];
+                break;
+            case ARKDeferredLogTextArgumentKindDouble:
+                [text appendFormat:specification, argument->value.floatingPoint];
+                break;
+            case ARKDeferredLogTextArgumentKindPointer:
+                [text appendFormat:specification, argument->value.pointer];
+                break;
+            case ARKDeferredLogTextArgumentKindCString:
+                [text appendFormat:specification, (capturedObject != [NSNull null]) ? (char const *)[capturedObject bytes] : NULL];
+                break;
+            case ARKDeferredLogTextArgumentKindObject:
+                [text appendFormat:specification, (capturedObject != [NSNull null]) ? capturedObject : nil];
+                break;
+        }
+#pragma clang diagnostic pop
+    }
+    
+    [text appendString:[format substringFromIndex:literalStart]];
+    
+    return [text copy];
+}
+
+@end
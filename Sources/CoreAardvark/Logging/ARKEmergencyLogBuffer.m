@@ -0,0 +1,241 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "ARKEmergencyLogBuffer.h"
+
+#import "ARKExceptionLogging.h"
+#import "AardvarkDefines.h"
+#import "../private/NSFileHandle+ARKAdditions.h"
+
+#import <fcntl.h>
+#import <stdatomic.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+#import <unistd.h>
+
+
+/// Identifies an emergency log buffer file ('ARKE').
+static uint32_t const ARKEmergencyLogBufferMagic = 0x41524B45;
+
+/// The version of the emergency log buffer file format.
+static uint32_t const ARKEmergencyLogBufferVersion = 1;
+
+/// The length of the magic number and version that begin the file, ahead of the region records are written into.
+static NSUInteger const ARKEmergencyLogBufferHeaderLength = (2 * sizeof(uint32_t));
+
+/// The most emergency log buffers that ARKFlushEmergencyLogBuffers() flushes.
+#define ARKEmergencyLogBufferMaximumCount 32
+
+/// The file descriptor of each open emergency log buffer plus one, so that unused slots are zero. Slots are claimed and released atomically, so they can be read from a crash handler without taking a lock.
+static _Atomic int ARKEmergencyLogBufferFileDescriptors[ARKEmergencyLogBufferMaximumCount];
+
+
+void ARKFlushEmergencyLogBuffers(void)
+{
+    // Only async-signal-safe calls may be made here: no locks, no allocation, and no Objective-C.
+    for (NSUInteger slot = 0; slot < ARKEmergencyLogBufferMaximumCount; slot++) {
+        int const fileDescriptor = atomic_load(&ARKEmergencyLogBufferFileDescriptors[slot]) - 1;
+        if (fileDescriptor >= 0) {
+            // The mapping is shared with the file, so syncing the file writes out the records copied into the mapping.
+            fsync(fileDescriptor);
+        }
+    }
+}
+
+
+@interface ARKEmergencyLogBuffer ()
+
+/// The open file, which is kept open so that it can be flushed from a crash handler.
+@property (nonatomic, readonly) int fileDescriptor;
+
+/// The mapping of the whole file.
+@property (nonnull, nonatomic, readonly) uint8_t *mappedBytes;
+
+/// The slot in ARKEmergencyLogBufferFileDescriptors holding the fileDescriptor, or NSNotFound if every slot was taken.
+@property (nonatomic, readonly) NSUInteger fileDescriptorSlot;
+
+/// The position within the record region at which the next record will be written, unless it needs to wrap around. Guarded by @synchronized(self).
+@property (nonatomic) NSUInteger writePosition;
+
+/// The sequence number written into the header of the next record. Guarded by @synchronized(self).
+@property (nonatomic) uint64_t nextSequenceNumber;
+
+@end
+
+
+@implementation ARKEmergencyLogBuffer
+
+#pragma mark - Initialization
+
+- (nullable instancetype)initWithFileURL:(nonnull NSURL *)fileURL capacity:(NSUInteger)capacity;
+{
+    ARKCheckCondition([fileURL isFileURL], nil, @"Must provide a file URL");
+    ARKCheckCondition(capacity > ARKEmergencyLogBufferHeaderLength + ARKDataBlockHeaderSize, nil, @"capacity must leave room for records");
+    
+    int const fileDescriptor = open(fileURL.fileSystemRepresentation, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    ARKCheckCondition(fileDescriptor >= 0, nil, @"Could not open emergency log buffer at %@, got errno %@", fileURL, @(errno));
+    
+    // Size the file up front, so that the whole buffer can be mapped.
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) != 0 || ((unsigned long long)fileStatus.st_size != capacity && ftruncate(fileDescriptor, (off_t)capacity) != 0)) {
+        NSLog(@"ERROR: -[%@ %@] could not size emergency log buffer at %@, got errno %@", NSStringFromClass([self class]), NSStringFromSelector(_cmd), fileURL, @(errno));
+        close(fileDescriptor);
+        return nil;
+    }
+    
+    void *const mappedBytes = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+    if (mappedBytes == MAP_FAILED) {
+        NSLog(@"ERROR: -[%@ %@] could not map emergency log buffer at %@, got errno %@", NSStringFromClass([self class]), NSStringFromSelector(_cmd), fileURL, @(errno));
+        close(fileDescriptor);
+        return nil;
+    }
+    
+    self = [super init];
+    if (!self) {
+        munmap(mappedBytes, capacity);
+        close(fileDescriptor);
+        return nil;
+    }
+    
+    _fileURL = [fileURL copy];
+    _capacity = capacity;
+    _fileDescriptor = fileDescriptor;
+    _mappedBytes = mappedBytes;
+    _fileDescriptorSlot = NSNotFound;
+    
+    for (NSUInteger slot = 0; slot < ARKEmergencyLogBufferMaximumCount; slot++) {
+        int unusedSlotValue = 0;
+        if (atomic_compare_exchange_strong(&ARKEmergencyLogBufferFileDescriptors[slot], &unusedSlotValue, fileDescriptor + 1)) {
+            _fileDescriptorSlot = slot;
+            break;
+        }
+    }
+    
+    if (_fileDescriptorSlot == NSNotFound) {
+        NSLog(@"ERROR: -[%@ %@] more than %@ emergency log buffers are open, so %@ won't be flushed on crashes", NSStringFromClass([self class]), NSStringFromSelector(_cmd), @(ARKEmergencyLogBufferMaximumCount), fileURL);
+    }
+    
+    if (OSReadBigInt32(_mappedBytes, 0) == ARKEmergencyLogBufferMagic && OSReadBigInt32(_mappedBytes, sizeof(uint32_t)) == ARKEmergencyLogBufferVersion) {
+        // Pick up writing after the newest record left by the previous run.
+        __block uint64_t newestSequenceNumber = 0;
+        __block BOOL foundRecord = NO;
+        [self _enumerateIntactRecordsUsingBlock:^(NSUInteger position, NSUInteger dataLength, uint64_t sequenceNumber) {
+            if (!foundRecord || sequenceNumber > newestSequenceNumber) {
+                foundRecord = YES;
+                newestSequenceNumber = sequenceNumber;
+                self.writePosition = position + ARKDataBlockHeaderSize + dataLength;
+            }
+        }];
+        
+        _nextSequenceNumber = foundRecord ? (newestSequenceNumber + 1) : 0;
+        
+    } else {
+        memset(_mappedBytes, 0, capacity);
+        OSWriteBigInt32(_mappedBytes, 0, ARKEmergencyLogBufferMagic);
+        OSWriteBigInt32(_mappedBytes, sizeof(uint32_t), ARKEmergencyLogBufferVersion);
+    }
+    
+    return self;
+}
+
+- (void)dealloc;
+{
+    // Release the slot before closing the file, so that a crash handler never syncs a file descriptor that has been reused.
+    if (_fileDescriptorSlot != NSNotFound) {
+        atomic_store(&ARKEmergencyLogBufferFileDescriptors[_fileDescriptorSlot], 0);
+    }
+    
+    munmap(_mappedBytes, _capacity);
+    close(_fileDescriptor);
+}
+
+#pragma mark - Public Methods
+
+- (void)appendRecords:(nonnull NSArray<NSData *> *)records;
+{
+    uint8_t *const recordBytes = self.mappedBytes + ARKEmergencyLogBufferHeaderLength;
+    NSUInteger const recordRegionLength = self.capacity - ARKEmergencyLogBufferHeaderLength;
+    
+    @synchronized(self) {
+        for (NSData *record in records) {
+            NSUInteger const blockLength = ARKDataBlockHeaderSize + record.length;
+            if (record.length == 0 || record.length > UINT32_MAX || blockLength > recordRegionLength) {
+                continue;
+            }
+            
+            if (self.writePosition + blockLength > recordRegionLength) {
+                // Records that were overwritten at the start of the region are left partly intact, and fail their checksums.
+                self.writePosition = 0;
+            }
+            
+            // The header's checksum covers the data, so a record torn by a crash partway through this copy is never read back.
+            memcpy(recordBytes + self.writePosition + ARKDataBlockHeaderSize, record.bytes, record.length);
+            ARKWriteDataBlockHeader(recordBytes + self.writePosition, record.length, self.nextSequenceNumber);
+            
+            self.writePosition += blockLength;
+            self.nextSequenceNumber++;
+        }
+    }
+}
+
+- (nonnull NSArray<NSData *> *)records;
+{
+    uint8_t const *const recordBytes = self.mappedBytes + ARKEmergencyLogBufferHeaderLength;
+    NSMutableDictionary<NSNumber *, NSData *> *const recordsBySequenceNumber = [NSMutableDictionary new];
+    
+    @synchronized(self) {
+        [self _enumerateIntactRecordsUsingBlock:^(NSUInteger position, NSUInteger dataLength, uint64_t sequenceNumber) {
+            recordsBySequenceNumber[@(sequenceNumber)] = [NSData dataWithBytes:(recordBytes + position + ARKDataBlockHeaderSize) length:dataLength];
+        }];
+    }
+    
+    // The buffer wraps around, so records are found out of order.
+    NSArray<NSNumber *> *const sequenceNumbers = [recordsBySequenceNumber.allKeys sortedArrayUsingSelector:@selector(compare:)];
+    return [recordsBySequenceNumber objectsForKeys:sequenceNumbers notFoundMarker:[NSData data]];
+}
+
+- (void)removeAllRecords;
+{
+    @synchronized(self) {
+        memset(self.mappedBytes + ARKEmergencyLogBufferHeaderLength, 0, self.capacity - ARKEmergencyLogBufferHeaderLength);
+        self.writePosition = 0;
+    }
+}
+
+#pragma mark - Private Methods
+
+/// Calls the block with the position, data length, and sequence number of each intact record, in the order they're found in the record region. Must be called within @synchronized(self) once the buffer is open.
+- (void)_enumerateIntactRecordsUsingBlock:(nonnull void (^)(NSUInteger position, NSUInteger dataLength, uint64_t sequenceNumber))block;
+{
+    uint8_t const *const recordBytes = self.mappedBytes + ARKEmergencyLogBufferHeaderLength;
+    NSUInteger const recordRegionLength = self.capacity - ARKEmergencyLogBufferHeaderLength;
+    
+    NSUInteger position = 0;
+    while (position + ARKDataBlockHeaderSize <= recordRegionLength) {
+        NSUInteger dataLength = 0;
+        uint64_t sequenceNumber = 0;
+        if (ARKValidateDataBlock(recordBytes + position, recordRegionLength - position, &dataLength, &sequenceNumber)) {
+            block(position, dataLength, sequenceNumber);
+            position += ARKDataBlockHeaderSize + dataLength;
+        
+        } else {
+            // Step over the remains of overwritten and torn records until the next intact header.
+            position++;
+        }
+    }
+}
+
+@end
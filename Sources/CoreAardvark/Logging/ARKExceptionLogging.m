@@ -21,6 +21,8 @@
 #import "ARKLogDistributor_Protected.h"
 #import "ARKLogging.h"
 #import "ARKLogObserver.h"
+#import "ARKLogStore.h"
+#import "ARKLogStore_Protected.h"
 
 
 NSUncaughtExceptionHandler *_Nullable ARKPreviousUncaughtExceptionHandler = nil;
@@ -59,6 +61,11 @@ void ARKHandleUncaughtException(NSException *_Nonnull exception)
         [logDistributor waitUntilAllPendingLogsHaveBeenDistributed];
 
         for (id<ARKLogObserver> observer in logDistributor.logObservers) {
+            // Log stores have already copied the exception's log into their emergency log buffers, which are flushed below and recovered from on the next launch, so there's no need to wait for their archives to be saved.
+            if ([observer isKindOfClass:[ARKLogStore class]] && ((ARKLogStore *)observer).hasEmergencyLogBuffer) {
+                continue;
+            }
+
             if ([observer respondsToSelector:@selector(processAllPendingLogsWithCompletionHandler:)]) {
                 dispatch_group_enter(observerGroup);
                 [observer processAllPendingLogsWithCompletionHandler:^{
@@ -72,6 +79,8 @@ void ARKHandleUncaughtException(NSException *_Nonnull exception)
 
     [logDistributorsLock unlock];
 
+    ARKFlushEmergencyLogBuffers();
+
     // Wait for the logs to finish distributing before continuing, since otherwise the app will terminate and the
     // distribution (which normally happens in the background) won't complete.
     dispatch_group_wait(observerGroup, dispatch_time(DISPATCH_TIME_NOW, 30 * NSEC_PER_SEC));
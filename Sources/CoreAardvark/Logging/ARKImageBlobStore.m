@@ -0,0 +1,346 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "ARKImageBlobStore.h"
+
+#import "AardvarkDefines.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+
+/// The file that records the reference count and size of each blob, in the order the blobs were stored.
+static NSString *const ARKImageBlobStoreManifestFileName = @"Manifest.plist";
+static NSString *const ARKImageBlobStoreManifestKeysKey = @"keys";
+static NSString *const ARKImageBlobStoreManifestReferenceCountsKey = @"referenceCounts";
+static NSString *const ARKImageBlobStoreManifestByteCountsKey = @"byteCounts";
+
+/// Blobs may hold PNG, JPEG, or HEIC data, which UIImage tells apart by their contents.
+static NSString *const ARKImageBlobStorePathExtension = @"image";
+
+/// The number of loaded images to keep in memory.
+static NSUInteger const ARKImageBlobStoreImageCacheCountLimit = 4;
+
+
+/// Returns the hex-encoded SHA-256 digest of data.
+static NSString *ARKImageBlobStoreKeyForData(NSData *data)
+{
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(data.bytes, (CC_LONG)data.length, digest);
+    
+    NSMutableString *const key = [NSMutableString stringWithCapacity:(2 * CC_SHA256_DIGEST_LENGTH)];
+    for (NSUInteger i = 0; i < CC_SHA256_DIGEST_LENGTH; i++) {
+        [key appendFormat:@"%02x", digest[i]];
+    }
+    
+    return key;
+}
+
+/// Returns YES if key could have been returned by ARKImageBlobStoreKeyForData(), so it's safe to use as a file name.
+static BOOL ARKImageBlobStoreKeyIsValid(NSString *key)
+{
+    if (key.length != 2 * CC_SHA256_DIGEST_LENGTH) {
+        return NO;
+    }
+    
+    NSCharacterSet *const nonHexCharacters = [[NSCharacterSet characterSetWithCharactersInString:@"0123456789abcdef"] invertedSet];
+    return [key rangeOfCharacterFromSet:nonHexCharacters].location == NSNotFound;
+}
+
+
+@interface ARKImageBlobStore ()
+
+/// The keys of stored blobs, least recently retained first. Guarded by @synchronized(self).
+@property (nonnull, nonatomic, readonly) NSMutableOrderedSet<NSString *> *keys;
+
+/// Guarded by @synchronized(self).
+@property (nonnull, nonatomic, readonly) NSMutableDictionary<NSString *, NSNumber *> *referenceCounts;
+
+/// Guarded by @synchronized(self).
+@property (nonnull, nonatomic, readonly) NSMutableDictionary<NSString *, NSNumber *> *byteCounts;
+
+@property (nonnull, nonatomic, readonly) NSCache<NSString *, UIImage *> *imageCache;
+
+@end
+
+
+@implementation ARKImageBlobStore
+
+@synthesize maximumByteCount = _maximumByteCount;
+@synthesize byteCount = _byteCount;
+
+#pragma mark - Initialization
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL maximumByteCount:(unsigned long long)maximumByteCount;
+{
+    self = [super init];
+    
+    _directoryURL = [directoryURL copy];
+    _maximumByteCount = maximumByteCount;
+    _keys = [NSMutableOrderedSet new];
+    _referenceCounts = [NSMutableDictionary new];
+    _byteCounts = [NSMutableDictionary new];
+    _imageCache = [NSCache new];
+    _imageCache.countLimit = ARKImageBlobStoreImageCacheCountLimit;
+    
+    [[NSFileManager defaultManager] createDirectoryAtURL:_directoryURL withIntermediateDirectories:YES attributes:nil error:NULL];
+    [self _loadManifest];
+    
+    return self;
+}
+
+#pragma mark - Properties
+
+- (unsigned long long)maximumByteCount;
+{
+    @synchronized(self) {
+        return _maximumByteCount;
+    }
+}
+
+- (void)setMaximumByteCount:(unsigned long long)maximumByteCount;
+{
+    @synchronized(self) {
+        _maximumByteCount = maximumByteCount;
+        if ([self _evictBlobsOverMaximumByteCountPreservingKey:nil]) {
+            [self _saveManifest];
+        }
+    }
+}
+
+- (unsigned long long)byteCount;
+{
+    @synchronized(self) {
+        return _byteCount;
+    }
+}
+
+#pragma mark - Public Methods
+
+- (NSString *)retainBlobWithImage:(UIImage *)image;
+{
+    NSData *const data = UIImagePNGRepresentation(image);
+    if (data == nil) {
+        return nil;
+    }
+    
+    return [self retainBlobWithImageData:data];
+}
+
+- (NSString *)retainBlobWithImageData:(NSData *)data;
+{
+    if (data.length == 0) {
+        return nil;
+    }
+    
+    NSString *const key = ARKImageBlobStoreKeyForData(data);
+    
+    @synchronized(self) {
+        NSUInteger const referenceCount = self.referenceCounts[key].unsignedIntegerValue;
+        if (referenceCount == 0) {
+            NSError *error = nil;
+            if (![data writeToURL:[self _fileURLForKey:key] options:NSDataWritingAtomic error:&error]) {
+                NSLog(@"ERROR: -[%@ %@] failed to write image blob to %@ with error %@",
+                      NSStringFromClass([self class]), NSStringFromSelector(_cmd),
+                      self.directoryURL, error);
+                return nil;
+            }
+            
+            [self.keys addObject:key];
+            self.byteCounts[key] = @(data.length);
+            _byteCount += data.length;
+            
+        } else {
+            // The blob is referenced by the newest log message now, so it's the last to be evicted.
+            [self.keys removeObject:key];
+            [self.keys addObject:key];
+        }
+        
+        self.referenceCounts[key] = @(referenceCount + 1);
+        
+        [self _evictBlobsOverMaximumByteCountPreservingKey:key];
+        [self _saveManifest];
+    }
+    
+    return key;
+}
+
+- (void)releaseBlobsWithKeys:(NSArray<NSString *> *)keys;
+{
+    @synchronized(self) {
+        BOOL manifestChanged = NO;
+        for (NSString *key in keys) {
+            NSUInteger const referenceCount = self.referenceCounts[key].unsignedIntegerValue;
+            if (referenceCount == 0) {
+                // The blob was already evicted to stay under the maximumByteCount.
+                continue;
+            }
+            
+            if (referenceCount > 1) {
+                self.referenceCounts[key] = @(referenceCount - 1);
+            } else {
+                [self _removeBlobWithKey:key];
+            }
+            manifestChanged = YES;
+        }
+        
+        if (manifestChanged) {
+            [self _saveManifest];
+        }
+    }
+}
+
+- (UIImage *)imageWithKey:(NSString *)key scale:(CGFloat)scale;
+{
+    UIImage *image = [self.imageCache objectForKey:key];
+    if (image != nil) {
+        return image;
+    }
+    
+    NSData *const data = [self imageDataWithKey:key];
+    image = (data != nil) ? [UIImage imageWithData:data scale:scale] : nil;
+    if (image != nil) {
+        [self.imageCache setObject:image forKey:key];
+    }
+    
+    return image;
+}
+
+- (NSData *)imageDataWithKey:(NSString *)key;
+{
+    NSURL *const fileURL = [self _fileURLForKey:key];
+    if (fileURL == nil) {
+        return nil;
+    }
+    
+    return [NSData dataWithContentsOfURL:fileURL options:NSDataReadingMappedIfSafe error:NULL];
+}
+
+- (void)removeAllBlobs;
+{
+    @synchronized(self) {
+        for (NSString *key in [self.keys copy]) {
+            [self _removeBlobWithKey:key];
+        }
+        
+        [self _saveManifest];
+    }
+}
+
+#pragma mark - Private Methods
+
+- (nullable NSURL *)_fileURLForKey:(nonnull NSString *)key;
+{
+    if (!ARKImageBlobStoreKeyIsValid(key)) {
+        return nil;
+    }
+    
+    return [[self.directoryURL URLByAppendingPathComponent:key isDirectory:NO] URLByAppendingPathExtension:ARKImageBlobStorePathExtension];
+}
+
+/// Must be called within @synchronized(self).
+- (void)_removeBlobWithKey:(nonnull NSString *)key;
+{
+    NSURL *const fileURL = [self _fileURLForKey:key];
+    if (fileURL != nil) {
+        [[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+    }
+    
+    _byteCount -= MIN(_byteCount, self.byteCounts[key].unsignedLongLongValue);
+    [self.keys removeObject:key];
+    [self.referenceCounts removeObjectForKey:key];
+    [self.byteCounts removeObjectForKey:key];
+    [self.imageCache removeObjectForKey:key];
+}
+
+/// Evicts the oldest blobs, other than preservedKey, until the store fits in maximumByteCount. Returns YES if any blobs were evicted. Must be called within @synchronized(self).
+- (BOOL)_evictBlobsOverMaximumByteCountPreservingKey:(nullable NSString *)preservedKey;
+{
+    BOOL evictedBlobs = NO;
+    while (_byteCount > _maximumByteCount) {
+        NSString *evictedKey = self.keys.firstObject;
+        if ([evictedKey isEqualToString:preservedKey]) {
+            evictedKey = (self.keys.count > 1) ? self.keys[1] : nil;
+        }
+        
+        if (evictedKey == nil) {
+            break;
+        }
+        
+        [self _removeBlobWithKey:evictedKey];
+        evictedBlobs = YES;
+    }
+    
+    return evictedBlobs;
+}
+
+/// Must be called within @synchronized(self).
+- (void)_loadManifest;
+{
+    NSData *const manifestData = [NSData dataWithContentsOfURL:[self.directoryURL URLByAppendingPathComponent:ARKImageBlobStoreManifestFileName isDirectory:NO]];
+    NSDictionary *const manifest = (manifestData != nil) ? [NSPropertyListSerialization propertyListWithData:manifestData options:NSPropertyListImmutable format:NULL error:NULL] : nil;
+    
+    NSArray *const keys = [manifest isKindOfClass:[NSDictionary class]] ? manifest[ARKImageBlobStoreManifestKeysKey] : nil;
+    NSDictionary *const referenceCounts = [manifest isKindOfClass:[NSDictionary class]] ? manifest[ARKImageBlobStoreManifestReferenceCountsKey] : nil;
+    NSDictionary *const byteCounts = [manifest isKindOfClass:[NSDictionary class]] ? manifest[ARKImageBlobStoreManifestByteCountsKey] : nil;
+    
+    if ([keys isKindOfClass:[NSArray class]] && [referenceCounts isKindOfClass:[NSDictionary class]] && [byteCounts isKindOfClass:[NSDictionary class]]) {
+        for (NSString *key in keys) {
+            NSNumber *const referenceCount = referenceCounts[key];
+            NSNumber *const byteCount = byteCounts[key];
+            if (![key isKindOfClass:[NSString class]] || ![referenceCount isKindOfClass:[NSNumber class]] || ![byteCount isKindOfClass:[NSNumber class]] || referenceCount.unsignedIntegerValue == 0) {
+                continue;
+            }
+            
+            NSURL *const fileURL = [self _fileURLForKey:key];
+            if (fileURL == nil || ![[NSFileManager defaultManager] fileExistsAtPath:fileURL.path]) {
+                continue;
+            }
+            
+            [self.keys addObject:key];
+            self.referenceCounts[key] = referenceCount;
+            self.byteCounts[key] = byteCount;
+            _byteCount += byteCount.unsignedLongLongValue;
+        }
+    }
+    
+    // Remove blobs that were written without being recorded in the manifest, e.g. because the app was terminated.
+    NSArray<NSURL *> *const fileURLs = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:self.directoryURL includingPropertiesForKeys:nil options:0 error:NULL];
+    for (NSURL *fileURL in fileURLs) {
+        if ([fileURL.pathExtension isEqualToString:ARKImageBlobStorePathExtension] && ![self.keys containsObject:fileURL.URLByDeletingPathExtension.lastPathComponent]) {
+            [[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+        }
+    }
+}
+
+/// Must be called within @synchronized(self).
+- (void)_saveManifest;
+{
+    NSDictionary *const manifest = @{
+        ARKImageBlobStoreManifestKeysKey : self.keys.array,
+        ARKImageBlobStoreManifestReferenceCountsKey : self.referenceCounts,
+        ARKImageBlobStoreManifestByteCountsKey : self.byteCounts,
+    };
+    
+    NSError *error = nil;
+    NSData *const manifestData = [NSPropertyListSerialization dataWithPropertyList:manifest format:NSPropertyListBinaryFormat_v1_0 options:0 error:&error];
+    if (manifestData == nil || ![manifestData writeToURL:[self.directoryURL URLByAppendingPathComponent:ARKImageBlobStoreManifestFileName isDirectory:NO] options:NSDataWritingAtomic error:&error]) {
+        NSLog(@"ERROR: -[%@ %@] failed to save image blob manifest in %@ with error %@",
+              NSStringFromClass([self class]), NSStringFromSelector(_cmd),
+              self.directoryURL, error);
+    }
+}
+
+@end
@@ -18,16 +18,40 @@
 #import "ARKLogDistributor_Testing.h"
 
 #import "AardvarkDefines.h"
+#import "ARKDeferredLogText.h"
+#import "ARKLogIngestionQueue.h"
 #import "ARKLogMessage.h"
+#import "ARKLogging.h"
 #import "ARKLogStore.h"
 
+#import <stdatomic.h>
 
 
-@interface ARKLogDistributor ()
+/// The number of logs the ingestion queue holds before spilling into its overflow list.
+static NSUInteger const ARKLogDistributorIngestionQueueCapacity = 1024;
+
+/// The maximum number of logs dequeued from the ingestion queue at once.
+static NSUInteger const ARKLogDistributorMaximumDrainBatchSize = 256;
+
+
+@interface ARKLogDistributor () {
+    /// An immutable, retained copy of logObservers, republished whenever logObservers changes so that distributing logs does not require a lock.
+    _Atomic(CFTypeRef) _logObserversSnapshot;
+    
+    /// Storage for enabledCategoriesByLevel, unless this is the default distributor.
+    uint64_t _ownEnabledCategoriesByLevel[ARKLogLevelCount];
+    
+    /// For each log level, a mask of the categories whose logs are distributed. The default distributor uses ARKDefaultLogDistributorEnabledCategoriesByLevel, so that ARKLogIsEnabled() can check it inline.
+    uint64_t *_enabledCategoriesByLevel;
+}
 
 @property (nonatomic, readonly) NSOperationQueue *logDistributingQueue;
+@property (nonatomic, readonly) ARKLogIngestionQueue *ingestionQueue;
 @property (copy, readonly) NSMutableArray *logObservers;
 
+/// A mask of the enabled log categories. Guarded by @synchronized(self).
+@property (nonatomic) uint64_t enabledLogCategories;
+
 @property Class internalLogMessageClass;
 @property (weak) ARKLogStore *weakDefaultLogStore;
 @property (readonly) NSRecursiveLock *defaultLogStorePropertyLock;
@@ -43,6 +67,7 @@
 @implementation ARKLogDistributor
 
 @dynamic defaultLogStore;
+@synthesize minimumLogLevel = _minimumLogLevel;
 
 #pragma mark - Class Methods
 
@@ -53,6 +78,7 @@
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
         ARKDefaultLogDistributor = [[self class] new];
+        [ARKDefaultLogDistributor _setEnabledCategoriesByLevelStorage:ARKDefaultLogDistributorEnabledCategoriesByLevel];
     });
     
     return ARKDefaultLogDistributor;
@@ -70,7 +96,15 @@
 
     [self _setDistributionQualityOfServiceBackground];
     
+    _ingestionQueue = [[ARKLogIngestionQueue alloc] initWithCapacity:ARKLogDistributorIngestionQueueCapacity];
+    
+    _minimumLogLevel = ARKLogLevelDebug;
+    _enabledLogCategories = UINT64_MAX;
+    _enabledCategoriesByLevel = _ownEnabledCategoriesByLevel;
+    [self _updateEnabledCategoriesByLevel];
+    
     _logObservers = [NSMutableArray new];
+    atomic_init(&_logObserversSnapshot, CFBridgingRetain(@[]));
 
     _defaultLogStorePropertyLock = [NSRecursiveLock new];
     _defaultLogStorePropertyLock.name = @"Default Log Store Property Lock";
@@ -81,6 +115,11 @@
     return self;
 }
 
+- (void)dealloc;
+{
+    CFRelease(atomic_load(&_logObserversSnapshot));
+}
+
 #pragma mark - Public Properties
 
 - (ARKLogStore *)defaultLogStore;
@@ -136,6 +175,21 @@
     self.internalLogMessageClass = logMessageClass;
 }
 
+- (ARKLogLevel)minimumLogLevel;
+{
+    @synchronized(self) {
+        return _minimumLogLevel;
+    }
+}
+
+- (void)setMinimumLogLevel:(ARKLogLevel)minimumLogLevel;
+{
+    @synchronized(self) {
+        _minimumLogLevel = minimumLogLevel;
+        [self _updateEnabledCategoriesByLevel];
+    }
+}
+
 - (NSSet *)logStores;
 {
     NSSet *logObservers = nil;
@@ -164,6 +218,7 @@
     @synchronized(self) {
         if (![self.logObservers containsObject:logObserver]) {
             [self.logObservers addObject:logObserver];
+            [self _publishLogObserversSnapshot];
         }
     }
 }
@@ -172,14 +227,46 @@
 {
     logObserver.logDistributor = nil;
     @synchronized(self) {
-        [self.logObservers removeObject:logObserver];
+        if ([self.logObservers containsObject:logObserver]) {
+            [self.logObservers removeObject:logObserver];
+            [self _publishLogObserversSnapshot];
+        }
+    }
+}
+
+#pragma mark - Public Methods - Log Levels
+
+- (void)setLogsEnabled:(BOOL)enabled forCategory:(ARKLogCategory)category;
+{
+    ARKCheckCondition(category < ARKLogCategoryCount, , @"Log categories must be less than %@", @(ARKLogCategoryCount));
+    
+    @synchronized(self) {
+        if (enabled) {
+            self.enabledLogCategories |= (1ULL << category);
+        } else {
+            self.enabledLogCategories &= ~(1ULL << category);
+        }
+        [self _updateEnabledCategoriesByLevel];
+    }
+}
+
+- (BOOL)logsAreEnabledForLevel:(ARKLogLevel)level category:(ARKLogCategory)category;
+{
+    if (level >= ARKLogLevelCount || category >= ARKLogCategoryCount) {
+        return NO;
     }
+    
+    return (__atomic_load_n(&_enabledCategoriesByLevel[level], __ATOMIC_RELAXED) >> category) & 1;
 }
 
+#pragma mark - Public Methods - Distribution
+
 - (void)distributeAllPendingLogsWithCompletionHandler:(dispatch_block_t)completionHandler;
 {
     [self _setDistributionQualityOfServiceUserInitiated];
     [self.logDistributingQueue addOperationWithBlock:^{
+        [self _drainIngestionQueue_inLogDistributingQueue];
+        
         [[NSOperationQueue mainQueue] addOperationWithBlock:completionHandler];
         [self _setDistributionQualityOfServiceBackground];
     }];
@@ -189,20 +276,25 @@
 
 - (void)logMessage:(ARKLogMessage *)logMessage;
 {
-    [self.logDistributingQueue addOperationWithBlock:^{
-        [self _logMessage_inLogDistributingQueue:logMessage];
-    }];
+    if (![self logsAreEnabledForLevel:ARKLogLevelForLogType(logMessage.type) category:ARKLogCategoryDefault]) {
+        return;
+    }
+    
+    if ([self.ingestionQueue enqueueLogMessage:logMessage]) {
+        [self _scheduleDrainOfIngestionQueue];
+    }
 }
 
 - (void)logWithText:(NSString *)text image:(UIImage *)image type:(ARKLogType)type parameters:(NSDictionary<NSString *, NSString *> *)parameters userInfo:(NSDictionary *)userInfo;
 {
-    Class logMessageClass = self.logMessageClass;
+    if (![self logsAreEnabledForLevel:ARKLogLevelForLogType(type) category:ARKLogCategoryDefault]) {
+        return;
+    }
     
-    [self.logDistributingQueue addOperationWithBlock:^{
-        ARKLogMessage *logMessage = [[logMessageClass alloc] initWithText:text image:image type:type parameters:parameters userInfo:userInfo];
-        
-        [self _logMessage_inLogDistributingQueue:logMessage];
-    }];
+    // The log message is created on the log distributing queue, but is dated when it was enqueued.
+    if ([self.ingestionQueue enqueueLogMessageOfClass:self.logMessageClass text:text image:image type:type parameters:parameters userInfo:userInfo]) {
+        [self _scheduleDrainOfIngestionQueue];
+    }
 }
 
 - (void)logWithText:(nonnull NSString *)text image:(nullable UIImage *)image type:(ARKLogType)type userInfo:(nullable NSDictionary *)userInfo;
@@ -212,8 +304,7 @@
 
 - (void)logWithType:(ARKLogType)type userInfo:(NSDictionary *)userInfo format:(NSString *)format arguments:(va_list)argList;
 {
-    NSString *logText = [[NSString alloc] initWithFormat:format arguments:argList];
-    [self logWithText:logText image:nil type:type parameters:@{} userInfo:userInfo];
+    [self _logWithType:type parameters:@{} userInfo:userInfo format:format arguments:argList];
 }
 
 - (void)logWithType:(ARKLogType)type userInfo:(NSDictionary *)userInfo format:(NSString *)format, ...;
@@ -226,8 +317,7 @@
 
 - (void)logWithFormat:(NSString *)format arguments:(va_list)argList;
 {
-    NSString *logText = [[NSString alloc] initWithFormat:format arguments:argList];
-    [self logWithText:logText image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil];
+    [self _logWithType:ARKLogTypeDefault parameters:@{} userInfo:nil format:format arguments:argList];
 }
 
 - (void)logWithFormat:(NSString *)format, ...;
@@ -240,8 +330,7 @@
 
 - (void)logWithParameters:(nonnull NSDictionary<NSString *, NSString *> *)parameters format:(nonnull NSString *)format arguments:(va_list)argList;
 {
-    NSString *logText = [[NSString alloc] initWithFormat:format arguments:argList];
-    [self logWithText:logText image:nil type:ARKLogTypeDefault parameters:parameters userInfo:nil];
+    [self _logWithType:ARKLogTypeDefault parameters:parameters userInfo:nil format:format arguments:argList];
 }
 
 - (void)logWithParameters:(nonnull NSDictionary<NSString *, NSString *> *)parameters format:(nonnull NSString *)format, ... NS_FORMAT_FUNCTION(2,3);
@@ -254,8 +343,7 @@
 
 - (void)logWithType:(ARKLogType)type parameters:(nonnull NSDictionary<NSString *, NSString*> *)parameters format:(nonnull NSString *)format arguments:(va_list)argList;
 {
-    NSString *logText = [[NSString alloc] initWithFormat:format arguments:argList];
-    [self logWithText:logText image:nil type:type parameters:parameters userInfo:nil];
+    [self _logWithType:type parameters:parameters userInfo:nil format:format arguments:argList];
 }
 
 - (void)logWithType:(ARKLogType)type parameters:(nonnull NSDictionary<NSString *, NSString*> *)parameters format:(nonnull NSString *)format, ... NS_FORMAT_FUNCTION(3,4);
@@ -266,10 +354,25 @@
     va_end(argList);
 }
 
+- (void)logWithLevel:(ARKLogLevel)level category:(ARKLogCategory)category format:(NSString *)format arguments:(va_list)argList;
+{
+    ARKLogType const type = (level == ARKLogLevelError) ? ARKLogTypeError : ARKLogTypeDefault;
+    [self _logWithLevel:level category:category type:type parameters:@{} userInfo:nil format:format arguments:argList];
+}
+
+- (void)logWithLevel:(ARKLogLevel)level category:(ARKLogCategory)category format:(NSString *)format, ...;
+{
+    va_list argList;
+    va_start(argList, format);
+    [self logWithLevel:level category:category format:format arguments:argList];
+    va_end(argList);
+}
+
 #pragma mark - Protected Methods
 
 - (void)waitUntilAllPendingLogsHaveBeenDistributed;
 {
+    [self _scheduleDrainOfIngestionQueue];
     [self.logDistributingQueue waitUntilAllOperationsAreFinished];
 }
 
@@ -282,18 +385,94 @@
 
 #pragma mark - Private Methods
 
-- (void)_logMessage_inLogDistributingQueue:(ARKLogMessage *)logMessage;
+- (void)_logWithType:(ARKLogType)type parameters:(nonnull NSDictionary<NSString *, NSString *> *)parameters userInfo:(nullable NSDictionary *)userInfo format:(nonnull NSString *)format arguments:(va_list)argList;
 {
-    NSArray *logObservers = nil;
-    @synchronized(self) {
-        logObservers = [self.logObservers copy];
+    [self _logWithLevel:ARKLogLevelForLogType(type) category:ARKLogCategoryDefault type:type parameters:parameters userInfo:userInfo format:format arguments:argList];
+}
+
+- (void)_logWithLevel:(ARKLogLevel)level category:(ARKLogCategory)category type:(ARKLogType)type parameters:(nonnull NSDictionary<NSString *, NSString *> *)parameters userInfo:(nullable NSDictionary *)userInfo format:(nonnull NSString *)format arguments:(va_list)argList;
+{
+    // Check before capturing or formatting anything.
+    if (![self logsAreEnabledForLevel:level category:category]) {
+        return;
+    }
+    
+    // Capture the format and its arguments so the text is only formatted if an observer reads it. Custom log message classes are initialized with their text, so they are formatted immediately.
+    ARKDeferredLogText *const deferredText = (self.logMessageClass == [ARKLogMessage class]) ? [[ARKDeferredLogText alloc] initWithFormat:format arguments:argList] : nil;
+    if (deferredText == nil) {
+        NSString *logText = [[NSString alloc] initWithFormat:format arguments:argList];
+        if ([self.ingestionQueue enqueueLogMessageOfClass:self.logMessageClass text:logText image:nil type:type parameters:parameters userInfo:userInfo]) {
+            [self _scheduleDrainOfIngestionQueue];
+        }
+        return;
+    }
+    
+    if ([self.ingestionQueue enqueueLogMessageWithDeferredText:deferredText image:nil type:type parameters:parameters userInfo:userInfo]) {
+        [self _scheduleDrainOfIngestionQueue];
+    }
+}
+
+- (void)_scheduleDrainOfIngestionQueue;
+{
+    [self.logDistributingQueue addOperationWithBlock:^{
+        [self _drainIngestionQueue_inLogDistributingQueue];
+    }];
+}
+
+- (void)_drainIngestionQueue_inLogDistributingQueue;
+{
+    NSArray<ARKLogMessage *> *logMessages = nil;
+    while ((logMessages = [self.ingestionQueue dequeueLogMessagesWithMaximumCount:ARKLogDistributorMaximumDrainBatchSize]).count > 0) {
+        @autoreleasepool {
+            [self _logMessages_inLogDistributingQueue:logMessages];
+        }
     }
+}
+
+- (void)_logMessages_inLogDistributingQueue:(NSArray<ARKLogMessage *> *)logMessages;
+{
+    // Snapshots are only released by operations on this queue, so the snapshot outlives this method without being retained.
+    __unsafe_unretained NSArray *const logObservers = (__bridge NSArray *)atomic_load_explicit(&_logObserversSnapshot, memory_order_acquire);
     
     for (id <ARKLogObserver> logObserver in logObservers) {
-        [logObserver observeLogMessage:logMessage];
+        if ([logObserver respondsToSelector:@selector(observeLogMessages:)]) {
+            [logObserver observeLogMessages:logMessages];
+        } else {
+            for (ARKLogMessage *logMessage in logMessages) {
+                [logObserver observeLogMessage:logMessage];
+            }
+        }
+    }
+}
+
+- (void)_setEnabledCategoriesByLevelStorage:(nonnull uint64_t *)enabledCategoriesByLevel;
+{
+    @synchronized(self) {
+        _enabledCategoriesByLevel = enabledCategoriesByLevel;
+        [self _updateEnabledCategoriesByLevel];
+    }
+}
+
+/// Must be called within @synchronized(self).
+- (void)_updateEnabledCategoriesByLevel;
+{
+    for (ARKLogLevel level = 0; level < ARKLogLevelCount; level++) {
+        uint64_t const enabledCategories = (level >= _minimumLogLevel) ? self.enabledLogCategories : 0;
+        __atomic_store_n(&_enabledCategoriesByLevel[level], enabledCategories, __ATOMIC_RELAXED);
     }
 }
 
+/// Must be called within @synchronized(self).
+- (void)_publishLogObserversSnapshot;
+{
+    CFTypeRef const previousSnapshot = atomic_exchange_explicit(&_logObserversSnapshot, CFBridgingRetain([self.logObservers copy]), memory_order_acq_rel);
+    
+    // The log distributing queue may be enumerating the previous snapshot, so release it once the current operation finishes.
+    [self.logDistributingQueue addOperationWithBlock:^{
+        CFRelease(previousSnapshot);
+    }];
+}
+
 - (void)_setDistributionQualityOfServiceUserInitiated;
 {
     self.logDistributingQueue.qualityOfService = NSQualityOfServiceUserInitiated;
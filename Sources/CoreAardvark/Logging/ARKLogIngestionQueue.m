@@ -0,0 +1,280 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "ARKLogIngestionQueue.h"
+
+#import "AardvarkDefines.h"
+#import "ARKDeferredLogText.h"
+#import "ARKLogMessage.h"
+#import "ARKLogMessage_Private.h"
+
+#import <stdatomic.h>
+#import <stdbool.h>
+
+
+/// A slot in the ingestion ring. Object fields are retained while the slot holds a pending log.
+typedef struct {
+    /// Equals the slot's enqueue position while the slot is free, and that position plus one once a pending log has been published to it.
+    _Atomic(NSUInteger) sequence;
+    
+    /// A log message that was enqueued as-is. When NULL, the log message is created from the remaining fields.
+    CFTypeRef logMessage;
+    
+    /// Nil when text is an ARKDeferredLogText, in which case an ARKLogMessage is created.
+    __unsafe_unretained Class logMessageClass;
+    CFTypeRef text;
+    CFTypeRef image;
+    CFTypeRef parameters;
+    CFTypeRef userInfo;
+    ARKLogType type;
+    CFAbsoluteTime date;
+} ARKLogIngestionSlot;
+
+
+@interface ARKLogIngestionQueue () {
+    ARKLogIngestionSlot *_slots;
+    
+    _Atomic(NSUInteger) _enqueuePosition;
+    
+    /// Only accessed by the consumer.
+    NSUInteger _dequeuePosition;
+    
+    /// Set by the first enqueue after a dequeue, so that only one drain is scheduled per batch of logs.
+    _Atomic(bool) _drainRequested;
+    
+    /// While set, producers append to the overflow list rather than the ring so that each thread's logs stay in order.
+    _Atomic(bool) _overflowing;
+}
+
+/// Log messages that did not fit in the ring. Guarded by overflowLock.
+@property (nonnull, nonatomic, readonly) NSMutableArray<ARKLogMessage *> *overflowLogMessages;
+@property (nonnull, nonatomic, readonly) NSLock *overflowLock;
+
+@end
+
+
+@implementation ARKLogIngestionQueue
+
+#pragma mark - Initialization
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+{
+    self = [super init];
+    
+    _capacity = 2;
+    while (_capacity < capacity) {
+        _capacity <<= 1;
+    }
+    
+    _slots = calloc(_capacity, sizeof(ARKLogIngestionSlot));
+    for (NSUInteger position = 0; position < _capacity; position++) {
+        atomic_init(&_slots[position].sequence, position);
+    }
+    
+    atomic_init(&_enqueuePosition, 0);
+    atomic_init(&_drainRequested, false);
+    atomic_init(&_overflowing, false);
+    
+    _overflowLogMessages = [NSMutableArray new];
+    _overflowLock = [NSLock new];
+    _overflowLock.name = @"Log Ingestion Overflow Lock";
+    
+    return self;
+}
+
+- (void)dealloc;
+{
+    // Release the contents of any slots that were never dequeued.
+    [self dequeueLogMessagesWithMaximumCount:NSUIntegerMax];
+    free(_slots);
+}
+
+#pragma mark - Public Methods
+
+- (BOOL)enqueueLogMessage:(ARKLogMessage *)logMessage;
+{
+    NSUInteger position = 0;
+    ARKLogIngestionSlot *const slot = [self _claimSlotWithPosition:&position];
+    if (slot == NULL) {
+        return [self _enqueueOverflowLogMessage:logMessage];
+    }
+    
+    slot->logMessage = CFBridgingRetain(logMessage);
+    
+    return [self _publishSlot:slot atPosition:position];
+}
+
+- (BOOL)enqueueLogMessageOfClass:(Class)logMessageClass text:(NSString *)text image:(UIImage *)image type:(ARKLogType)type parameters:(NSDictionary<NSString *, NSString *> *)parameters userInfo:(NSDictionary *)userInfo;
+{
+    NSUInteger position = 0;
+    ARKLogIngestionSlot *const slot = [self _claimSlotWithPosition:&position];
+    if (slot == NULL) {
+        ARKLogMessage *const logMessage = [[logMessageClass alloc] initWithText:text image:image type:type parameters:parameters userInfo:userInfo];
+        return [self _enqueueOverflowLogMessage:logMessage];
+    }
+    
+    [self _fillSlot:slot withLogMessageClass:logMessageClass text:text image:image type:type parameters:parameters userInfo:userInfo];
+    
+    return [self _publishSlot:slot atPosition:position];
+}
+
+- (BOOL)enqueueLogMessageWithDeferredText:(ARKDeferredLogText *)deferredText image:(UIImage *)image type:(ARKLogType)type parameters:(NSDictionary<NSString *, NSString *> *)parameters userInfo:(NSDictionary *)userInfo;
+{
+    NSUInteger position = 0;
+    ARKLogIngestionSlot *const slot = [self _claimSlotWithPosition:&position];
+    if (slot == NULL) {
+        ARKLogMessage *const logMessage = [[ARKLogMessage alloc] initWithDeferredText:deferredText image:image type:type parameters:parameters userInfo:userInfo date:[NSDate date]];
+        return [self _enqueueOverflowLogMessage:logMessage];
+    }
+    
+    [self _fillSlot:slot withLogMessageClass:Nil text:deferredText image:image type:type parameters:parameters userInfo:userInfo];
+    
+    return [self _publishSlot:slot atPosition:position];
+}
+    
+
+- (NSArray<ARKLogMessage *> *)dequeueLogMessagesWithMaximumCount:(NSUInteger)maximumCount;
+{
+    // Clear the drain request before reading anything, so that a log enqueued after this point either is dequeued below or requests another drain.
+    atomic_store(&_drainRequested, false);
+    
+    NSMutableArray<ARKLogMessage *> *const logMessages = [NSMutableArray new];
+    BOOL ringIsEmpty = NO;
+    while (logMessages.count < maximumCount) {
+        ARKLogIngestionSlot *const slot = &_slots[_dequeuePosition & (_capacity - 1)];
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != _dequeuePosition + 1) {
+            // The next slot has not been published yet.
+            ringIsEmpty = YES;
+            break;
+        }
+        
+        [logMessages addObject:[self _logMessageByEmptyingSlot:slot]];
+        atomic_store_explicit(&slot->sequence, _dequeuePosition + _capacity, memory_order_release);
+        _dequeuePosition++;
+    }
+    
+    // Overflowed logs are newer than everything in the ring, so only take them once the ring is empty.
+    if (ringIsEmpty && logMessages.count < maximumCount && atomic_load(&_overflowing)) {
+        [self.overflowLock lock];
+        {
+            const NSUInteger overflowCount = MIN(self.overflowLogMessages.count, maximumCount - logMessages.count);
+            const NSRange overflowRange = NSMakeRange(0, overflowCount);
+            [logMessages addObjectsFromArray:[self.overflowLogMessages subarrayWithRange:overflowRange]];
+            [self.overflowLogMessages removeObjectsInRange:overflowRange];
+            
+            if (self.overflowLogMessages.count == 0) {
+                atomic_store(&_overflowing, false);
+            }
+        }
+        [self.overflowLock unlock];
+    }
+    
+    return logMessages;
+}
+
+#pragma mark - Private Methods
+
+/// Claims the next free slot in the ring for a producer. Returns NULL if the ring is full or overflowing.
+- (nullable ARKLogIngestionSlot *)_claimSlotWithPosition:(nonnull NSUInteger *)outPosition;
+{
+    if (atomic_load_explicit(&_overflowing, memory_order_acquire)) {
+        return NULL;
+    }
+    
+    NSUInteger position = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+    while (YES) {
+        ARKLogIngestionSlot *const slot = &_slots[position & (_capacity - 1)];
+        const NSUInteger sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        const NSInteger difference = (NSInteger)sequence - (NSInteger)position;
+        
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&_enqueuePosition, &position, position + 1, memory_order_relaxed, memory_order_relaxed)) {
+                *outPosition = position;
+                return slot;
+            }
+            // Another producer claimed the slot; position now holds the current enqueue position.
+            
+        } else if (difference < 0) {
+            // The consumer has not yet freed this slot, so the ring is full.
+            return NULL;
+            
+        } else {
+            position = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+        }
+    }
+}
+
+- (void)_fillSlot:(nonnull ARKLogIngestionSlot *)slot withLogMessageClass:(nullable Class)logMessageClass text:(nonnull id)text image:(nullable UIImage *)image type:(ARKLogType)type parameters:(nullable NSDictionary *)parameters userInfo:(nullable NSDictionary *)userInfo;
+{
+    slot->logMessage = NULL;
+    slot->logMessageClass = logMessageClass;
+    slot->text = CFBridgingRetain(text);
+    slot->image = CFBridgingRetain(image);
+    slot->parameters = CFBridgingRetain(parameters);
+    slot->userInfo = CFBridgingRetain(userInfo);
+    slot->type = type;
+    slot->date = CFAbsoluteTimeGetCurrent();
+}
+
+- (BOOL)_publishSlot:(nonnull ARKLogIngestionSlot *)slot atPosition:(NSUInteger)position;
+{
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+    return !atomic_exchange(&_drainRequested, true);
+}
+
+- (BOOL)_enqueueOverflowLogMessage:(nonnull ARKLogMessage *)logMessage;
+{
+    [self.overflowLock lock];
+    {
+        [self.overflowLogMessages addObject:logMessage];
+        atomic_store(&_overflowing, true);
+    }
+    [self.overflowLock unlock];
+    
+    return !atomic_exchange(&_drainRequested, true);
+}
+
+- (nonnull ARKLogMessage *)_logMessageByEmptyingSlot:(nonnull ARKLogIngestionSlot *)slot;
+{
+    if (slot->logMessage != NULL) {
+        ARKLogMessage *const logMessage = CFBridgingRelease(slot->logMessage);
+        slot->logMessage = NULL;
+        return logMessage;
+    }
+    
+    id const text = CFBridgingRelease(slot->text);
+    UIImage *const image = CFBridgingRelease(slot->image);
+    NSDictionary *const parameters = CFBridgingRelease(slot->parameters);
+    NSDictionary *const userInfo = CFBridgingRelease(slot->userInfo);
+    NSDate *const date = [NSDate dateWithTimeIntervalSinceReferenceDate:slot->date];
+    
+    ARKLogMessage *logMessage = nil;
+    if (slot->logMessageClass == Nil) {
+        logMessage = [[ARKLogMessage alloc] initWithDeferredText:text image:image type:slot->type parameters:parameters userInfo:userInfo date:date];
+    } else {
+        logMessage = [[slot->logMessageClass alloc] initWithText:text image:image type:slot->type parameters:parameters userInfo:userInfo date:date];
+    }
+    
+    slot->logMessageClass = Nil;
+    slot->text = NULL;
+    slot->image = NULL;
+    slot->parameters = NULL;
+    slot->userInfo = NULL;
+    
+    return logMessage;
+}
+
+@end
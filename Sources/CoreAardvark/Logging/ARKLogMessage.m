@@ -16,11 +16,147 @@
 
 #if SWIFT_PACKAGE
 #import "ARKLogMessage.h"
+#import "ARKDataArchive.h"
 #else
 #import <CoreAardvark/ARKLogMessage.h>
+#import <CoreAardvark/ARKDataArchive.h>
 #endif
 
 #import "AardvarkDefines.h"
+#import "ARKDeferredLogText.h"
+#import "ARKImageBlobStore.h"
+#import "ARKLogMessage_Private.h"
+
+
+NSString *const ARKLogMessageImageDataKey = @"ARKLogMessageImageData";
+
+
+/// Identifies a binary ARKLogMessage record ("ARKL"). Bump the version whenever the layout of the record changes.
+/// A record starts with the magic, the version, the image storage, the type, and the date, followed by the text, the number of parameters, each parameter's key and value, and finally the image (if any). Integers and doubles are big-endian, and strings and data are preceded by their 32-bit length.
+static uint32_t const ARKLogMessageRecordMagic = 0x41524B4C;
+static uint8_t const ARKLogMessageRecordVersion = 1;
+
+/// How the image of a log message is stored in its record.
+typedef NS_ENUM(uint8_t, ARKLogMessageRecordImageStorage) {
+    /// The log message has no image.
+    ARKLogMessageRecordImageStorageNone = 0,
+    /// The image's scale, followed by its PNG representation.
+    ARKLogMessageRecordImageStorageInlinePNG = 1,
+    /// The image's scale, followed by the key of the ARKImageBlobStore blob that holds it.
+    ARKLogMessageRecordImageStorageBlobReference = 2,
+};
+
+
+/// Returns the date formatted as by +[NSDateFormatter localizedStringFromDate:dateStyle:timeStyle:] with a short date style and medium time style, using a formatter cached for the calling thread rather than creating a formatter for every date.
+static NSString *ARKLogMessageLocalizedDateString(NSDate *date)
+{
+    static NSString *const ARKLogMessageDateFormatterKey = @"ARKLogMessageDateFormatter";
+    
+    NSMutableDictionary *const threadDictionary = [NSThread currentThread].threadDictionary;
+    NSDateFormatter *dateFormatter = threadDictionary[ARKLogMessageDateFormatterKey];
+    if (dateFormatter == nil) {
+        dateFormatter = [NSDateFormatter new];
+        dateFormatter.locale = [NSLocale autoupdatingCurrentLocale];
+        dateFormatter.timeZone = [NSTimeZone localTimeZone];
+        dateFormatter.dateStyle = NSDateFormatterShortStyle;
+        dateFormatter.timeStyle = NSDateFormatterMediumStyle;
+        threadDictionary[ARKLogMessageDateFormatterKey] = dateFormatter;
+    }
+    
+    return [dateFormatter stringFromDate:date];
+}
+
+
+/// Tracks the position of a decoder within a record.
+typedef struct {
+    uint8_t const *bytes;
+    NSUInteger length;
+    NSUInteger offset;
+} ARKLogMessageRecordReader;
+
+
+static void ARKLogMessageRecordAppendUInt32(NSMutableData *data, uint32_t value)
+{
+    uint8_t bytes[sizeof(uint32_t)];
+    OSWriteBigInt32(bytes, 0, value);
+    [data appendBytes:bytes length:sizeof(bytes)];
+}
+
+static void ARKLogMessageRecordAppendDouble(NSMutableData *data, double value)
+{
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    
+    uint8_t bytes[sizeof(uint64_t)];
+    OSWriteBigInt64(bytes, 0, bits);
+    [data appendBytes:bytes length:sizeof(bytes)];
+}
+
+static void ARKLogMessageRecordAppendString(NSMutableData *data, NSString *string)
+{
+    // Encode directly into the record, rather than into an intermediate NSData.
+    NSUInteger const lengthOffset = data.length;
+    NSUInteger const maximumLength = [string maximumLengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    data.length = lengthOffset + sizeof(uint32_t) + maximumLength;
+    
+    NSUInteger usedLength = 0;
+    [string getBytes:((uint8_t *)data.mutableBytes + lengthOffset + sizeof(uint32_t)) maxLength:maximumLength usedLength:&usedLength encoding:NSUTF8StringEncoding options:NSStringEncodingConversionAllowLossy range:NSMakeRange(0, string.length) remainingRange:NULL];
+    
+    OSWriteBigInt32(data.mutableBytes, lengthOffset, (uint32_t)usedLength);
+    data.length = lengthOffset + sizeof(uint32_t) + usedLength;
+}
+
+static BOOL ARKLogMessageRecordReadUInt8(ARKLogMessageRecordReader *reader, uint8_t *value)
+{
+    if (reader->length - reader->offset < sizeof(uint8_t)) {
+        return NO;
+    }
+    
+    *value = reader->bytes[reader->offset];
+    reader->offset += sizeof(uint8_t);
+    return YES;
+}
+
+static BOOL ARKLogMessageRecordReadUInt32(ARKLogMessageRecordReader *reader, uint32_t *value)
+{
+    if (reader->length - reader->offset < sizeof(uint32_t)) {
+        return NO;
+    }
+    
+    *value = OSReadBigInt32(reader->bytes, reader->offset);
+    reader->offset += sizeof(uint32_t);
+    return YES;
+}
+
+static BOOL ARKLogMessageRecordReadDouble(ARKLogMessageRecordReader *reader, double *value)
+{
+    if (reader->length - reader->offset < sizeof(uint64_t)) {
+        return NO;
+    }
+    
+    uint64_t const bits = OSReadBigInt64(reader->bytes, reader->offset);
+    memcpy(value, &bits, sizeof(bits));
+    reader->offset += sizeof(uint64_t);
+    return YES;
+}
+
+static uint8_t const *ARKLogMessageRecordReadBytes(ARKLogMessageRecordReader *reader, uint32_t *length)
+{
+    if (!ARKLogMessageRecordReadUInt32(reader, length) || reader->length - reader->offset < *length) {
+        return NULL;
+    }
+    
+    uint8_t const *const bytes = reader->bytes + reader->offset;
+    reader->offset += *length;
+    return bytes;
+}
+
+static NSString *ARKLogMessageRecordReadString(ARKLogMessageRecordReader *reader)
+{
+    uint32_t length = 0;
+    uint8_t const *const bytes = ARKLogMessageRecordReadBytes(reader, &length);
+    return (bytes != NULL) ? [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding] : nil;
+}
 
 
 @interface ARKLogMessage (Legacy)
@@ -31,8 +167,29 @@
 @end
 
 
+@interface ARKLogMessage () <ARKDataArchiveRecordCoding>
+
+/// The format and arguments that text is formatted from when the log message was created without text.
+@property (nullable, nonatomic, readonly) ARKDeferredLogText *deferredText;
+
+@property (nullable, nonatomic, copy, readonly) NSString *imageBlobKey;
+
+@property (nullable, atomic) ARKImageBlobStore *imageBlobStore;
+
+/// The scale of the image stored under imageBlobKey, or held in inlineImageData.
+@property (nonatomic) CGFloat imageScale;
+
+/// The PNG representation of the image, when the log message was read from a record that stores its image inline. The image is decoded each time it's read, so that log messages don't hold onto decoded images.
+@property (nullable, nonatomic, copy, readonly) NSData *inlineImageData;
+
+@end
+
+
 @implementation ARKLogMessage
 
+@synthesize text = _text;
+@synthesize image = _image;
+
 #pragma mark - Class Methods
 
 + (BOOL)supportsSecureCoding;
@@ -61,6 +218,77 @@
     return self;
 }
 
+- (instancetype)initWithDeferredText:(ARKDeferredLogText *)deferredText image:(UIImage *)image type:(ARKLogType)type parameters:(NSDictionary *)parameters userInfo:(NSDictionary *)userInfo date:(NSDate *)date;
+{
+    self = [self initWithText:@"" image:image type:type parameters:parameters userInfo:userInfo date:date];
+    
+    _text = nil;
+    _deferredText = deferredText;
+    
+    return self;
+}
+
+- (instancetype)initWithLogMessage:(ARKLogMessage *)logMessage imageBlobKey:(NSString *)imageBlobKey imageBlobStore:(ARKImageBlobStore *)imageBlobStore;
+{
+    self = [self initWithText:@"" image:nil type:logMessage.type parameters:logMessage.parameters userInfo:logMessage.userInfo date:logMessage.date];
+    
+    // Carry over deferred text as is, rather than formatting it here.
+    _text = logMessage->_text;
+    _deferredText = logMessage->_deferredText;
+    _imageBlobKey = [imageBlobKey copy];
+    _imageScale = (logMessage->_image != nil) ? logMessage->_image.scale : logMessage.imageScale;
+    _imageBlobStore = imageBlobStore;
+    
+    return self;
+}
+
+#pragma mark - Properties
+
+- (NSString *)text;
+{
+    return _text ?: self.deferredText.text;
+}
+
+- (UIImage *)image;
+{
+    if (_image != nil) {
+        return _image;
+    }
+    
+    if (self.inlineImageData != nil) {
+        return [UIImage imageWithData:self.inlineImageData scale:self.imageScale];
+    }
+    
+    if (self.imageBlobKey != nil) {
+        return [self.imageBlobStore imageWithKey:self.imageBlobKey scale:self.imageScale];
+    }
+    
+    return nil;
+}
+
+- (BOOL)hasImage;
+{
+    return (_image != nil || self.inlineImageData != nil || self.imageBlobKey != nil);
+}
+
+- (NSData *)imageData;
+{
+    NSData *const loggedImageData = self.userInfo[ARKLogMessageImageDataKey];
+    if (_image != nil && [loggedImageData isKindOfClass:[NSData class]]) {
+        return loggedImageData;
+    }
+    
+    if (self.inlineImageData != nil) {
+        return self.inlineImageData;
+    }
+    
+    if (self.imageBlobKey != nil) {
+        return [self.imageBlobStore imageDataWithKey:self.imageBlobKey];
+    }
+    
+    return nil;
+}
+
 #pragma mark - NSCoding
 
 - (instancetype)initWithCoder:(NSCoder *)aDecoder;
@@ -86,6 +314,192 @@
     [aCoder encodeObject:self.parameters forKey:ARKSelfKeyPath(parameters)];
 }
 
+#pragma mark - ARKDataArchiveRecordCoding
+
+- (nullable NSData *)archiveRecordRepresentation;
+{
+    // Subclasses may persist additional state, so they're archived with their keyed archive.
+    if (![self isMemberOfClass:[ARKLogMessage class]]) {
+        return nil;
+    }
+    
+    ARKLogMessageRecordImageStorage imageStorage = ARKLogMessageRecordImageStorageNone;
+    NSData *imageData = nil;
+    if (self.imageBlobKey != nil) {
+        imageStorage = ARKLogMessageRecordImageStorageBlobReference;
+        
+    } else if (self.inlineImageData != nil) {
+        imageStorage = ARKLogMessageRecordImageStorageInlinePNG;
+        imageData = self.inlineImageData;
+        
+    } else if (_image != nil) {
+        imageStorage = ARKLogMessageRecordImageStorageInlinePNG;
+        imageData = UIImagePNGRepresentation(_image);
+        if (imageData == nil) {
+            return nil;
+        }
+    }
+    
+    NSMutableData *const data = [NSMutableData dataWithCapacity:(64 + self.text.length + imageData.length)];
+    
+    ARKLogMessageRecordAppendUInt32(data, ARKLogMessageRecordMagic);
+    uint8_t const header[] = { ARKLogMessageRecordVersion, imageStorage };
+    [data appendBytes:header length:sizeof(header)];
+    ARKLogMessageRecordAppendUInt32(data, (uint32_t)self.type);
+    ARKLogMessageRecordAppendDouble(data, self.date.timeIntervalSinceReferenceDate);
+    ARKLogMessageRecordAppendString(data, self.text);
+    
+    ARKLogMessageRecordAppendUInt32(data, (uint32_t)self.parameters.count);
+    for (NSString *key in self.parameters) {
+        NSString *const value = self.parameters[key];
+        if (![key isKindOfClass:[NSString class]] || ![value isKindOfClass:[NSString class]]) {
+            return nil;
+        }
+        
+        ARKLogMessageRecordAppendString(data, key);
+        ARKLogMessageRecordAppendString(data, value);
+    }
+    
+    switch (imageStorage) {
+        case ARKLogMessageRecordImageStorageNone:
+            break;
+            
+        case ARKLogMessageRecordImageStorageInlinePNG:
+            ARKLogMessageRecordAppendDouble(data, (_image != nil) ? _image.scale : self.imageScale);
+            ARKLogMessageRecordAppendUInt32(data, (uint32_t)imageData.length);
+            [data appendData:imageData];
+            break;
+            
+        case ARKLogMessageRecordImageStorageBlobReference:
+            ARKLogMessageRecordAppendDouble(data, self.imageScale);
+            ARKLogMessageRecordAppendString(data, self.imageBlobKey);
+            break;
+    }
+    
+    return data;
+}
+
++ (nullable instancetype)objectWithArchiveRecordRepresentation:(nonnull NSData *)data;
+{
+    // Records are only written for ARKLogMessage itself, never for subclasses.
+    if (self != [ARKLogMessage class]) {
+        return nil;
+    }
+    
+    ARKLogMessageRecordReader reader = { data.bytes, data.length, 0 };
+    
+    uint32_t magic = 0;
+    uint8_t version = 0;
+    uint8_t imageStorage = 0;
+    if (!ARKLogMessageRecordReadUInt32(&reader, &magic) || magic != ARKLogMessageRecordMagic
+        || !ARKLogMessageRecordReadUInt8(&reader, &version) || version != ARKLogMessageRecordVersion
+        || !ARKLogMessageRecordReadUInt8(&reader, &imageStorage)) {
+        return nil;
+    }
+    
+    uint32_t type = 0;
+    double timeInterval = 0;
+    if (!ARKLogMessageRecordReadUInt32(&reader, &type) || !ARKLogMessageRecordReadDouble(&reader, &timeInterval)) {
+        return nil;
+    }
+    
+    NSString *const text = ARKLogMessageRecordReadString(&reader);
+    uint32_t parameterCount = 0;
+    if (text == nil || !ARKLogMessageRecordReadUInt32(&reader, &parameterCount)) {
+        return nil;
+    }
+    
+    NSMutableDictionary<NSString *, NSString *> *const parameters = [NSMutableDictionary dictionaryWithCapacity:MIN(parameterCount, 64)];
+    for (uint32_t i = 0; i < parameterCount; i++) {
+        NSString *const key = ARKLogMessageRecordReadString(&reader);
+        NSString *const value = ARKLogMessageRecordReadString(&reader);
+        if (key == nil || value == nil) {
+            return nil;
+        }
+        
+        parameters[key] = value;
+    }
+    
+    NSData *inlineImageData = nil;
+    NSString *imageBlobKey = nil;
+    double imageScale = 0;
+    switch ((ARKLogMessageRecordImageStorage)imageStorage) {
+        case ARKLogMessageRecordImageStorageNone:
+            break;
+            
+        case ARKLogMessageRecordImageStorageInlinePNG: {
+            uint32_t imageLength = 0;
+            uint8_t const *imageBytes = NULL;
+            if (!ARKLogMessageRecordReadDouble(&reader, &imageScale) || (imageBytes = ARKLogMessageRecordReadBytes(&reader, &imageLength)) == NULL) {
+                return nil;
+            }
+            
+            // Hold onto the encoded image, and only decode it if it's read.
+            inlineImageData = [NSData dataWithBytes:imageBytes length:imageLength];
+            break;
+        }
+            
+        case ARKLogMessageRecordImageStorageBlobReference:
+            if (!ARKLogMessageRecordReadDouble(&reader, &imageScale) || (imageBlobKey = ARKLogMessageRecordReadString(&reader)) == nil) {
+                return nil;
+            }
+            break;
+            
+        default:
+            return nil;
+    }
+    
+    if (reader.offset != reader.length) {
+        return nil;
+    }
+    
+    ARKLogMessage *const logMessage = [[self alloc] initWithText:text image:nil type:(ARKLogType)type parameters:parameters userInfo:nil date:[NSDate dateWithTimeIntervalSinceReferenceDate:timeInterval]];
+    logMessage->_imageBlobKey = [imageBlobKey copy];
+    logMessage->_imageScale = imageScale;
+    logMessage->_inlineImageData = inlineImageData;
+    
+    return logMessage;
+}
+
++ (nullable NSString *)imageBlobKeyInArchiveRecordRepresentation:(nonnull NSData *)data;
+{
+    // Check the image storage in the header before decoding the rest of the record.
+    ARKLogMessageRecordReader reader = { data.bytes, data.length, 0 };
+    
+    uint32_t magic = 0;
+    uint8_t version = 0;
+    uint8_t imageStorage = 0;
+    if (!ARKLogMessageRecordReadUInt32(&reader, &magic) || magic != ARKLogMessageRecordMagic
+        || !ARKLogMessageRecordReadUInt8(&reader, &version) || version != ARKLogMessageRecordVersion
+        || !ARKLogMessageRecordReadUInt8(&reader, &imageStorage) || imageStorage != ARKLogMessageRecordImageStorageBlobReference) {
+        return nil;
+    }
+    
+    return [[ARKLogMessage objectWithArchiveRecordRepresentation:data] imageBlobKey];
+}
+
++ (BOOL)getType:(nonnull ARKLogType *)type timeIntervalSinceReferenceDate:(nonnull NSTimeInterval *)timeInterval fromArchiveRecordRepresentation:(nonnull NSData *)data;
+{
+    ARKLogMessageRecordReader reader = { data.bytes, data.length, 0 };
+    
+    uint32_t magic = 0;
+    uint8_t version = 0;
+    uint8_t imageStorage = 0;
+    uint32_t recordType = 0;
+    double recordTimeInterval = 0;
+    if (!ARKLogMessageRecordReadUInt32(&reader, &magic) || magic != ARKLogMessageRecordMagic
+        || !ARKLogMessageRecordReadUInt8(&reader, &version) || version != ARKLogMessageRecordVersion
+        || !ARKLogMessageRecordReadUInt8(&reader, &imageStorage)
+        || !ARKLogMessageRecordReadUInt32(&reader, &recordType)
+        || !ARKLogMessageRecordReadDouble(&reader, &recordTimeInterval)) {
+        return NO;
+    }
+    
+    *type = (ARKLogType)recordType;
+    *timeInterval = recordTimeInterval;
+    return YES;
+}
+
 #pragma mark - NSCopying
 
 - (instancetype)copyWithZone:(NSZone *)zone;
@@ -107,7 +521,13 @@
         return NO;
     }
 
-    if (!(self.image == otherMessage.image || [self.image isEqual:otherMessage.image])) {
+    if (self.imageBlobKey != nil && otherMessage.imageBlobKey != nil) {
+        // Blobs are content-addressed, so comparing keys avoids loading both images.
+        if (![self.imageBlobKey isEqualToString:otherMessage.imageBlobKey]) {
+            return NO;
+        }
+        
+    } else if (!(self.image == otherMessage.image || [self.image isEqual:otherMessage.image])) {
         return NO;
     }
 
@@ -133,7 +553,7 @@
 
 - (NSString *)description;
 {
-    NSString *dateString = [NSDateFormatter localizedStringFromDate:self.date dateStyle:NSDateFormatterShortStyle timeStyle:NSDateFormatterMediumStyle];
+    NSString *dateString = ARKLogMessageLocalizedDateString(self.date);
 
     NSMutableString *parametersString = [NSMutableString new];
     for (NSString *key in [[self.parameters allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
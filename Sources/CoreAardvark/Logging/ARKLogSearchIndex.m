@@ -0,0 +1,397 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "ARKLogSearchIndex.h"
+
+#import "ARKLogMessage.h"
+
+
+/// Log messages are numbered in the order they're added, and posting lists hold these numbers. The numbering starts over whenever the index is compacted.
+typedef uint32_t ARKLogSearchIndexEntryNumber;
+
+/// Searchable text is indexed by every run of this many UTF-16 code units in it. Searches for shorter strings scan every log message.
+static NSUInteger const ARKLogSearchIndexTrigramLength = 3;
+
+/// The number of candidate log messages checked between checks for cancellation.
+static NSUInteger const ARKLogSearchIndexCancellationCheckInterval = 1024;
+
+/// Posting lists aren't trimmed as log messages are removed. Once they refer to more removed log messages than this (and more than there are log messages left), the index is rebuilt.
+static ARKLogSearchIndexEntryNumber const ARKLogSearchIndexMinimumRemovedEntryCountForCompaction = 1024;
+
+
+/// Returns the string that searchable text and search strings are compared in.
+static NSString *_Nonnull ARKLogSearchIndexFoldedString(NSString *_Nonnull string)
+{
+    return [string stringByFoldingWithOptions:NSCaseInsensitiveSearch locale:nil];
+}
+
+/// Returns the folded text and parameter values of the log message, separated by newlines.
+static NSString *_Nonnull ARKLogSearchIndexSearchableText(ARKLogMessage *_Nonnull logMessage)
+{
+    if (logMessage.parameters.count == 0) {
+        return ARKLogSearchIndexFoldedString(logMessage.text);
+    }
+    
+    NSMutableArray<NSString *> *const components = [NSMutableArray arrayWithObject:logMessage.text];
+    [components addObjectsFromArray:logMessage.parameters.allValues];
+    return ARKLogSearchIndexFoldedString([components componentsJoinedByString:@"\n"]);
+}
+
+static int ARKLogSearchIndexCompareTrigrams(const void *lhs, const void *rhs)
+{
+    uint64_t const lhsTrigram = *(const uint64_t *)lhs;
+    uint64_t const rhsTrigram = *(const uint64_t *)rhs;
+    return (lhsTrigram < rhsTrigram) ? -1 : (lhsTrigram > rhsTrigram) ? 1 : 0;
+}
+
+/// Returns the distinct trigrams in the folded string, each packed into a uint64_t.
+static NSData *_Nonnull ARKLogSearchIndexTrigramsInString(NSString *_Nonnull foldedString)
+{
+    NSUInteger const length = foldedString.length;
+    if (length < ARKLogSearchIndexTrigramLength) {
+        return [NSData data];
+    }
+    
+    unichar *const characters = malloc(length * sizeof(unichar));
+    [foldedString getCharacters:characters range:NSMakeRange(0, length)];
+    
+    NSUInteger const trigramCount = length - ARKLogSearchIndexTrigramLength + 1;
+    NSMutableData *const trigramData = [NSMutableData dataWithLength:trigramCount * sizeof(uint64_t)];
+    uint64_t *const trigrams = trigramData.mutableBytes;
+    for (NSUInteger i = 0; i < trigramCount; i++) {
+        trigrams[i] = ((uint64_t)characters[i] << 32) | ((uint64_t)characters[i + 1] << 16) | (uint64_t)characters[i + 2];
+    }
+    free(characters);
+    
+    qsort(trigrams, trigramCount, sizeof(uint64_t), ARKLogSearchIndexCompareTrigrams);
+    
+    NSUInteger distinctTrigramCount = 1;
+    for (NSUInteger i = 1; i < trigramCount; i++) {
+        if (trigrams[i] != trigrams[distinctTrigramCount - 1]) {
+            trigrams[distinctTrigramCount++] = trigrams[i];
+        }
+    }
+    trigramData.length = distinctTrigramCount * sizeof(uint64_t);
+    
+    return trigramData;
+}
+
+/// Returns the index of the first entry number in the sorted list that is at least entryNumber.
+static NSUInteger ARKLogSearchIndexLowerBound(ARKLogSearchIndexEntryNumber const *_Nonnull entryNumbers, NSUInteger count, ARKLogSearchIndexEntryNumber entryNumber)
+{
+    NSUInteger low = 0;
+    NSUInteger high = count;
+    while (low < high) {
+        NSUInteger const middle = low + (high - low) / 2;
+        if (entryNumbers[middle] < entryNumber) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    
+    return low;
+}
+
+
+@interface ARKLogSearchIndex ()
+
+/// Indexes and searches in the order they're requested.
+@property (nonnull, nonatomic, readonly) NSOperationQueue *indexQueue;
+
+@property (readwrite) NSUInteger logMessageCount;
+
+/// The indexed log messages, oldest first. Only accessed on the indexQueue.
+@property (nonnull, nonatomic, readonly) NSMutableArray<ARKLogMessage *> *logMessages;
+
+/// The searchable text of each of the logMessages. Only accessed on the indexQueue.
+@property (nonnull, nonatomic, readonly) NSMutableArray<NSString *> *searchableTexts;
+
+/// The sorted entry numbers of the log messages containing each trigram, keyed by the packed trigram. Only accessed on the indexQueue.
+@property (nonnull, nonatomic, readonly) NSMutableDictionary<NSNumber *, NSMutableData *> *postingLists;
+
+/// The entry number of the first of the logMessages. Entry numbers below this in the postingLists belong to removed log messages. Only accessed on the indexQueue.
+@property (nonatomic) ARKLogSearchIndexEntryNumber firstEntryNumber;
+
+@end
+
+
+@implementation ARKLogSearchIndex
+
+#pragma mark - Class Methods
+
++ (BOOL)logMessage:(nonnull ARKLogMessage *)logMessage matchesSearchString:(nonnull NSString *)searchString;
+{
+    if (searchString.length == 0) {
+        return YES;
+    }
+    
+    return [ARKLogSearchIndexSearchableText(logMessage) containsString:ARKLogSearchIndexFoldedString(searchString)];
+}
+
+#pragma mark - Initialization
+
+- (instancetype)init;
+{
+    self = [super init];
+    
+    _indexQueue = [NSOperationQueue new];
+    _indexQueue.name = [NSString stringWithFormat:@"%@ Index Queue (%p)", [self class], self];
+    _indexQueue.maxConcurrentOperationCount = 1;
+    _indexQueue.qualityOfService = NSQualityOfServiceUtility;
+    
+    _logMessages = [NSMutableArray new];
+    _searchableTexts = [NSMutableArray new];
+    _postingLists = [NSMutableDictionary new];
+    
+    return self;
+}
+
+- (void)dealloc;
+{
+    [_indexQueue cancelAllOperations];
+}
+
+#pragma mark - Public Methods
+
+- (void)appendLogMessages:(nonnull NSArray<ARKLogMessage *> *)logMessages;
+{
+    if (logMessages.count == 0) {
+        return;
+    }
+    
+    NSArray<ARKLogMessage *> *const appendedLogMessages = [logMessages copy];
+    @synchronized(self) {
+        self.logMessageCount += appendedLogMessages.count;
+        [self.indexQueue addOperationWithBlock:^{
+            for (ARKLogMessage *logMessage in appendedLogMessages) {
+                [self _indexLogMessage_inIndexQueue:logMessage];
+            }
+        }];
+    }
+}
+
+- (void)removeOldestLogMessages:(NSUInteger)logMessageCount;
+{
+    @synchronized(self) {
+        NSUInteger const removedLogMessageCount = MIN(logMessageCount, self.logMessageCount);
+        if (removedLogMessageCount == 0) {
+            return;
+        }
+        
+        self.logMessageCount -= removedLogMessageCount;
+        [self.indexQueue addOperationWithBlock:^{
+            [self _removeOldestLogMessages_inIndexQueue:removedLogMessageCount];
+        }];
+    }
+}
+
+- (void)removeAllLogMessages;
+{
+    @synchronized(self) {
+        self.logMessageCount = 0;
+        [self.indexQueue addOperationWithBlock:^{
+            [self _removeAllLogMessages_inIndexQueue];
+        }];
+    }
+}
+
+- (nonnull NSOperation *)searchForLogMessagesMatchingString:(nonnull NSString *)searchString completionHandler:(nonnull void (^)(NSArray<ARKLogMessage *> * _Nonnull matchingLogMessages))completionHandler;
+{
+    NSString *const foldedSearchString = ARKLogSearchIndexFoldedString(searchString);
+    
+    NSBlockOperation *const searchOperation = [NSBlockOperation new];
+    __weak NSBlockOperation *const weakSearchOperation = searchOperation;
+    [searchOperation addExecutionBlock:^{
+        NSBlockOperation *const strongSearchOperation = weakSearchOperation;
+        NSArray<ARKLogMessage *> *const matchingLogMessages = [self _logMessagesMatchingFoldedString_inIndexQueue:foldedSearchString searchOperation:strongSearchOperation];
+        if (matchingLogMessages == nil) {
+            return;
+        }
+        
+        [[NSOperationQueue mainQueue] addOperationWithBlock:^{
+            if (!strongSearchOperation.isCancelled) {
+                completionHandler(matchingLogMessages);
+            }
+        }];
+    }];
+    
+    // Set the QoS of this operation to be high, since searches are typically requested as the user types.
+    searchOperation.qualityOfService = NSQualityOfServiceUserInitiated;
+    
+    @synchronized(self) {
+        [self.indexQueue addOperation:searchOperation];
+    }
+    
+    return searchOperation;
+}
+
+#pragma mark - Private Methods
+
+- (void)_indexLogMessage_inIndexQueue:(nonnull ARKLogMessage *)logMessage;
+{
+    ARKLogSearchIndexEntryNumber const entryNumber = self.firstEntryNumber + (ARKLogSearchIndexEntryNumber)self.logMessages.count;
+    NSString *const searchableText = ARKLogSearchIndexSearchableText(logMessage);
+    
+    [self.logMessages addObject:logMessage];
+    [self.searchableTexts addObject:searchableText];
+    [self _addEntryNumber_inIndexQueue:entryNumber forTrigramsInString:searchableText];
+}
+
+- (void)_addEntryNumber_inIndexQueue:(ARKLogSearchIndexEntryNumber)entryNumber forTrigramsInString:(nonnull NSString *)searchableText;
+{
+    NSData *const trigramData = ARKLogSearchIndexTrigramsInString(searchableText);
+    uint64_t const *const trigrams = trigramData.bytes;
+    NSUInteger const trigramCount = trigramData.length / sizeof(uint64_t);
+    
+    for (NSUInteger i = 0; i < trigramCount; i++) {
+        NSNumber *const key = @(trigrams[i]);
+        NSMutableData *postingList = self.postingLists[key];
+        if (postingList == nil) {
+            postingList = [NSMutableData new];
+            self.postingLists[key] = postingList;
+        }
+        
+        [postingList appendBytes:&entryNumber length:sizeof(entryNumber)];
+    }
+}
+
+- (void)_removeOldestLogMessages_inIndexQueue:(NSUInteger)logMessageCount;
+{
+    NSUInteger const removedLogMessageCount = MIN(logMessageCount, self.logMessages.count);
+    [self.logMessages removeObjectsInRange:NSMakeRange(0, removedLogMessageCount)];
+    [self.searchableTexts removeObjectsInRange:NSMakeRange(0, removedLogMessageCount)];
+    self.firstEntryNumber += (ARKLogSearchIndexEntryNumber)removedLogMessageCount;
+    
+    if (self.firstEntryNumber >= ARKLogSearchIndexMinimumRemovedEntryCountForCompaction && self.firstEntryNumber > self.logMessages.count) {
+        [self _compact_inIndexQueue];
+    }
+}
+
+- (void)_removeAllLogMessages_inIndexQueue;
+{
+    [self.logMessages removeAllObjects];
+    [self.searchableTexts removeAllObjects];
+    [self.postingLists removeAllObjects];
+    self.firstEntryNumber = 0;
+}
+
+/// Rebuilds the posting lists without the entries of removed log messages, numbering the remaining log messages from zero.
+- (void)_compact_inIndexQueue;
+{
+    [self.postingLists removeAllObjects];
+    self.firstEntryNumber = 0;
+    
+    [self.searchableTexts enumerateObjectsUsingBlock:^(NSString *searchableText, NSUInteger index, BOOL *stop) {
+        [self _addEntryNumber_inIndexQueue:(ARKLogSearchIndexEntryNumber)index forTrigramsInString:searchableText];
+    }];
+}
+
+/// Returns the log messages whose searchable text contains the folded string, or nil if the search operation was cancelled.
+- (nullable NSArray<ARKLogMessage *> *)_logMessagesMatchingFoldedString_inIndexQueue:(nonnull NSString *)foldedString searchOperation:(nullable NSOperation *)searchOperation;
+{
+    if (searchOperation == nil || searchOperation.isCancelled) {
+        return nil;
+    }
+    
+    if (foldedString.length == 0) {
+        return [self.logMessages copy];
+    }
+    
+    NSMutableArray<ARKLogMessage *> *const matchingLogMessages = [NSMutableArray new];
+    
+    if (foldedString.length < ARKLogSearchIndexTrigramLength) {
+        // The string is too short to have any trigrams, so check every log message.
+        NSUInteger const logMessageCount = self.searchableTexts.count;
+        for (NSUInteger index = 0; index < logMessageCount; index++) {
+            if (index % ARKLogSearchIndexCancellationCheckInterval == 0 && searchOperation.isCancelled) {
+                return nil;
+            }
+            
+            if ([self.searchableTexts[index] containsString:foldedString]) {
+                [matchingLogMessages addObject:self.logMessages[index]];
+            }
+        }
+        
+        return matchingLogMessages;
+    }
+    
+    // Intersect the posting lists of the string's trigrams, starting with the shortest.
+    NSData *const trigramData = ARKLogSearchIndexTrigramsInString(foldedString);
+    uint64_t const *const trigrams = trigramData.bytes;
+    NSUInteger const trigramCount = trigramData.length / sizeof(uint64_t);
+    
+    NSMutableArray<NSData *> *const postingLists = [NSMutableArray arrayWithCapacity:trigramCount];
+    for (NSUInteger i = 0; i < trigramCount; i++) {
+        NSData *const postingList = self.postingLists[@(trigrams[i])];
+        if (postingList == nil) {
+            return matchingLogMessages;
+        }
+        
+        [postingLists addObject:postingList];
+    }
+    
+    [postingLists sortUsingComparator:^NSComparisonResult(NSData *lhs, NSData *rhs) {
+        return (lhs.length < rhs.length) ? NSOrderedAscending : (lhs.length > rhs.length) ? NSOrderedDescending : NSOrderedSame;
+    }];
+    
+    NSData *const shortestPostingList = postingLists.firstObject;
+    ARKLogSearchIndexEntryNumber const *const shortestEntryNumbers = shortestPostingList.bytes;
+    NSUInteger const shortestEntryCount = shortestPostingList.length / sizeof(ARKLogSearchIndexEntryNumber);
+    NSUInteger const firstLiveIndex = ARKLogSearchIndexLowerBound(shortestEntryNumbers, shortestEntryCount, self.firstEntryNumber);
+    
+    NSMutableData *const candidates = [NSMutableData dataWithBytes:(shortestEntryNumbers + firstLiveIndex) length:(shortestEntryCount - firstLiveIndex) * sizeof(ARKLogSearchIndexEntryNumber)];
+    for (NSUInteger listIndex = 1; listIndex < postingLists.count && candidates.length > 0; listIndex++) {
+        if (searchOperation.isCancelled) {
+            return nil;
+        }
+        
+        NSData *const postingList = postingLists[listIndex];
+        ARKLogSearchIndexEntryNumber const *const entryNumbers = postingList.bytes;
+        NSUInteger const entryCount = postingList.length / sizeof(ARKLogSearchIndexEntryNumber);
+        
+        // Candidates are usually far fewer than the entries in the longer lists, so search for each one rather than walking the whole list.
+        ARKLogSearchIndexEntryNumber *const candidateEntryNumbers = candidates.mutableBytes;
+        NSUInteger const candidateCount = candidates.length / sizeof(ARKLogSearchIndexEntryNumber);
+        NSUInteger keptCandidateCount = 0;
+        NSUInteger searchStart = 0;
+        for (NSUInteger i = 0; i < candidateCount; i++) {
+            searchStart += ARKLogSearchIndexLowerBound(entryNumbers + searchStart, entryCount - searchStart, candidateEntryNumbers[i]);
+            if (searchStart < entryCount && entryNumbers[searchStart] == candidateEntryNumbers[i]) {
+                candidateEntryNumbers[keptCandidateCount++] = candidateEntryNumbers[i];
+            }
+        }
+        candidates.length = keptCandidateCount * sizeof(ARKLogSearchIndexEntryNumber);
+    }
+    
+    // Every trigram matching doesn't mean the whole string does, so check each candidate's text.
+    ARKLogSearchIndexEntryNumber const *const candidateEntryNumbers = candidates.bytes;
+    NSUInteger const candidateCount = candidates.length / sizeof(ARKLogSearchIndexEntryNumber);
+    for (NSUInteger i = 0; i < candidateCount; i++) {
+        if (i % ARKLogSearchIndexCancellationCheckInterval == 0 && searchOperation.isCancelled) {
+            return nil;
+        }
+        
+        NSUInteger const index = candidateEntryNumbers[i] - self.firstEntryNumber;
+        if ([self.searchableTexts[index] containsString:foldedString]) {
+            [matchingLogMessages addObject:self.logMessages[index]];
+        }
+    }
+    
+    return matchingLogMessages;
+}
+
+@end
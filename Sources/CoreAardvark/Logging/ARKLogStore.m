@@ -15,21 +15,87 @@
 //
 
 #import "ARKLogStore.h"
+#import "ARKLogStore_Protected.h"
 #import "ARKLogStore_Testing.h"
 
 #import "ARKDataArchive.h"
+#import "ARKEmergencyLogBuffer.h"
+#import "ARKImageBlobStore.h"
 #import "ARKLogDistributor.h"
 #import "ARKLogDistributor_Protected.h"
 #import "ARKLogMessage.h"
+#import "ARKLogMessage_Private.h"
 #import "AardvarkDefines.h"
 #import "NSURL+ARKAdditions.h"
 
 
+/// The average number of bytes budgeted for each archived log message when sizing a circular archive.
+static unsigned long long const ARKLogStoreCircularArchiveBytesPerLogMessage = (4 * 1024);
+
+/// The default maximumImageByteCount.
+static unsigned long long const ARKLogStoreDefaultMaximumImageByteCount = (32 * 1024 * 1024);
+
+/// The size of the file that the most recently archived log messages are copied into, so they survive the app being terminated before they're written to the persisted log file.
+static NSUInteger const ARKLogStoreEmergencyLogBufferCapacity = (256 * 1024);
+
+/// The path extension of a segmented store's segment files, which are named with their zero-padded segment number so that they sort oldest first.
+static NSString *const ARKLogStoreSegmentPathExtension = @"segment";
+
+
+/// Follows the log store's data archives on behalf of a handler passed to addChangeObserverWithHandler:.
+@interface ARKLogStoreChangeObserver : NSObject
+
+- (nonnull instancetype)initWithHandler:(nonnull void (^)(NSArray<ARKLogMessage *> * _Nonnull appendedLogMessages, NSUInteger trimmedLogMessageCount))handler NS_DESIGNATED_INITIALIZER;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
++ (nonnull instancetype)new NS_UNAVAILABLE;
+
+@property (nonnull, nonatomic, copy, readonly) void (^handler)(NSArray<ARKLogMessage *> * _Nonnull appendedLogMessages, NSUInteger trimmedLogMessageCount);
+
+/// Reads each data archive oldest first, picking up where the last delivered change ended. Only accessed on the main queue.
+@property (nonnull, nonatomic, readonly) NSMapTable<ARKDataArchive *, ARKDataArchiveCursor *> *cursorsByDataArchive;
+
+/// The number of log messages read from each data archive that the handler has been passed and that haven't been trimmed since. Only accessed on the main queue.
+@property (nonnull, nonatomic, readonly) NSMapTable<ARKDataArchive *, NSNumber *> *deliveredLogMessageCountsByDataArchive;
+
+/// Set once the handler has been passed the initial contents of the store. Only accessed on the main queue.
+@property (nonatomic) BOOL hasDeliveredInitialContents;
+
+/// Set while changes are being read for the handler. Only accessed on the main queue.
+@property (nonatomic) BOOL isReadingChanges;
+
+/// Set when changes should be read again once the changes being read have been delivered. Only accessed on the main queue.
+@property (nonatomic) BOOL needsChangesRead;
+
+@end
+
+
 @interface ARKLogStore ()
 
-/// Stores all log messages.
+/// Stores all log messages, or the newest segment's log messages when the store is segmented. Log messages are appended here. Only changed within @synchronized(self).
 @property (nonnull) ARKDataArchive *dataArchive;
 
+/// The sealed segments of a segmented store, oldest first. Empty when the store isn't segmented. Guarded by @synchronized(self).
+@property (nonnull, nonatomic, copy) NSArray<ARKDataArchive *> *sealedDataArchives;
+
+/// The number of log messages appended to the newest segment of a segmented store. Guarded by @synchronized(self).
+@property (nonatomic) NSUInteger segmentLogMessageCount;
+
+/// The number given to the next segment of a segmented store. Guarded by @synchronized(self).
+@property (nonatomic) unsigned long long nextSegmentNumber;
+
+/// Stores the images of archived log messages, which are archived with a reference to their image.
+@property (nonnull, nonatomic, readonly) ARKImageBlobStore *imageBlobStore;
+
+/// Holds copies of the most recently archived log messages, which are appended back to the store when it's next opened if they were never written to the data archive. Nil if the buffer's file couldn't be opened.
+@property (nullable, nonatomic, readonly) ARKEmergencyLogBuffer *emergencyLogBuffer;
+
+/// The observers registered with addChangeObserverWithHandler:. Guarded by @synchronized(self).
+@property (nonnull, nonatomic, readonly) NSMutableArray<ARKLogStoreChangeObserver *> *changeObservers;
+
+/// Set while a delivery of changes to the changeObservers is on the main queue. Guarded by @synchronized(self).
+@property (nonatomic) BOOL changeDeliveryIsQueued;
+
 @end
 
 
@@ -46,7 +112,7 @@
     NSURL *const persistedLogFileURL = [NSURL ARK_fileURLWithApplicationSupportFilename:fileName];
     ARKCheckCondition(persistedLogFileURL != nil, nil, @"Could not create persisted log file URL with file name %@", fileName);
 
-    ARKDataArchive *const dataArchive = [[self class] _dataArchiveWithPersistedLogFileURL:persistedLogFileURL maximumLogMessageCount:maximumLogMessageCount];
+    ARKDataArchive *const dataArchive = [[self class] _dataArchiveWithPersistedLogFileURL:persistedLogFileURL maximumLogMessageCount:maximumLogMessageCount usesCircularArchive:NO];
     ARKCheckCondition(dataArchive != nil, nil, @"Could not instantiate data archive with persisted log file URL %@", persistedLogFileURL);
 
     self = [super init];
@@ -57,7 +123,14 @@
     _persistedLogFileURL = persistedLogFileURL;
     _maximumLogMessageCount = maximumLogMessageCount;
     _dataArchive = dataArchive;
+    _sealedDataArchives = @[];
+    _imageBlobStore = [[self class] _imageBlobStoreWithPersistedLogFileURL:_persistedLogFileURL];
+    _changeObservers = [NSMutableArray new];
+    
+    dataArchive.evictedObjectDataHandler = [[self class] _evictedObjectDataHandlerWithImageBlobStore:_imageBlobStore];
     _prefixNameWhenPrintingToConsole = YES;
+    
+    [self _openEmergencyLogBuffer];
 
 #if !TARGET_OS_WATCH
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_applicationWillTerminate:) name:UIApplicationWillTerminateNotification object:nil];
@@ -71,9 +144,9 @@
     return [self initWithPersistedLogFileName:fileName maximumLogMessageCount:2000];
 }
 
-- (nullable instancetype)initWithPersistedLogFileURL:(nonnull NSURL *)persistedLogFileURL maximumLogMessageCount:(NSUInteger)maximumLogMessageCount;
+- (nullable instancetype)initWithPersistedLogFileURL:(nonnull NSURL *)persistedLogFileURL maximumLogMessageCount:(NSUInteger)maximumLogMessageCount usesCircularArchive:(BOOL)usesCircularArchive;
 {
-    ARKDataArchive *const dataArchive = [[self class] _dataArchiveWithPersistedLogFileURL:persistedLogFileURL maximumLogMessageCount:maximumLogMessageCount];
+    ARKDataArchive *const dataArchive = [[self class] _dataArchiveWithPersistedLogFileURL:persistedLogFileURL maximumLogMessageCount:maximumLogMessageCount usesCircularArchive:usesCircularArchive];
     ARKCheckCondition(dataArchive != nil, nil, @"Could not instantiate data archive with persisted log file URL %@", persistedLogFileURL);
 
     self = [super init];
@@ -83,8 +156,16 @@
 
     _persistedLogFileURL = [persistedLogFileURL copy];
     _maximumLogMessageCount = maximumLogMessageCount;
+    _usesCircularArchive = usesCircularArchive;
     _dataArchive = dataArchive;
+    _sealedDataArchives = @[];
+    _imageBlobStore = [[self class] _imageBlobStoreWithPersistedLogFileURL:_persistedLogFileURL];
+    _changeObservers = [NSMutableArray new];
+    
+    dataArchive.evictedObjectDataHandler = [[self class] _evictedObjectDataHandlerWithImageBlobStore:_imageBlobStore];
     _prefixNameWhenPrintingToConsole = YES;
+    
+    [self _openEmergencyLogBuffer];
 
 #if !TARGET_OS_WATCH
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_applicationWillTerminate:) name:UIApplicationWillTerminateNotification object:nil];
@@ -93,6 +174,82 @@
     return self;
 }
 
+- (nullable instancetype)initWithPersistedLogFileURL:(nonnull NSURL *)persistedLogFileURL maximumLogMessageCount:(NSUInteger)maximumLogMessageCount;
+{
+    return [self initWithPersistedLogFileURL:persistedLogFileURL maximumLogMessageCount:maximumLogMessageCount usesCircularArchive:NO];
+}
+
+- (nullable instancetype)initWithPersistedLogsDirectoryURL:(nonnull NSURL *)directoryURL maximumLogMessageCount:(NSUInteger)maximumLogMessageCount segmentCount:(NSUInteger)segmentCount;
+{
+    ARKCheckCondition([directoryURL isFileURL], nil, @"Must provide a file URL");
+    ARKCheckCondition(maximumLogMessageCount > 0, nil, @"maximumLogMessageCount must be greater than zero");
+    ARKCheckCondition(segmentCount >= 2, nil, @"segmentCount must be at least 2");
+    
+    NSError *error = nil;
+    BOOL const createdDirectory = [[NSFileManager defaultManager] createDirectoryAtURL:directoryURL withIntermediateDirectories:YES attributes:nil error:&error];
+    ARKCheckCondition(createdDirectory, nil, @"Could not create directory at %@, got error %@", directoryURL, error);
+    
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+    
+    _persistedLogFileURL = [directoryURL copy];
+    _maximumLogMessageCount = maximumLogMessageCount;
+    _segmentCount = segmentCount;
+    _imageBlobStore = [[self class] _imageBlobStoreWithPersistedLogFileURL:_persistedLogFileURL];
+    _changeObservers = [NSMutableArray new];
+    _prefixNameWhenPrintingToConsole = YES;
+    
+    // Reopen the segments left by previous runs. A segment that can't be opened is skipped, so the damage is limited to its logs.
+    NSMutableArray<ARKDataArchive *> *const dataArchives = [NSMutableArray new];
+    for (NSNumber *segmentNumber in [[self class] _segmentNumbersInDirectoryURL:directoryURL]) {
+        ARKDataArchive *const dataArchive = [self _dataArchiveForSegmentNumber:segmentNumber.unsignedLongLongValue];
+        if (dataArchive != nil) {
+            [dataArchives addObject:dataArchive];
+        }
+        
+        _nextSegmentNumber = segmentNumber.unsignedLongLongValue + 1;
+    }
+    
+    // The segmentCount may be smaller than it was when the segments were written.
+    while (dataArchives.count > segmentCount) {
+        [dataArchives.firstObject removeArchiveWithCompletionHandler:NULL];
+        [dataArchives removeObjectAtIndex:0];
+    }
+    
+    if (dataArchives.count > 0) {
+        // Pick up appending to the newest segment where the last run left off.
+        _segmentLogMessageCount = [dataArchives.lastObject countObjectsAndWait];
+        
+        // A segment is started just before its first log messages are appended, so it's left empty if they were lost. Drop it, so that the newest log message is always in the segment being appended to.
+        while (_segmentLogMessageCount == 0 && dataArchives.count > 1) {
+            [dataArchives.lastObject removeArchiveWithCompletionHandler:NULL];
+            [dataArchives removeLastObject];
+            _segmentLogMessageCount = [dataArchives.lastObject countObjectsAndWait];
+        }
+        
+    } else {
+        ARKDataArchive *const dataArchive = [self _dataArchiveForSegmentNumber:_nextSegmentNumber];
+        ARKCheckCondition(dataArchive != nil, nil, @"Could not instantiate data archive in directory %@", directoryURL);
+        
+        [dataArchives addObject:dataArchive];
+        _nextSegmentNumber++;
+    }
+    
+    _dataArchive = dataArchives.lastObject;
+    [dataArchives removeLastObject];
+    _sealedDataArchives = [dataArchives copy];
+    
+    [self _openEmergencyLogBuffer];
+    
+#if !TARGET_OS_WATCH
+    [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_applicationWillTerminate:) name:UIApplicationWillTerminateNotification object:nil];
+#endif
+    
+    return self;
+}
+
 - (void)dealloc;
 {
     [[NSNotificationCenter defaultCenter] removeObserver:self];
@@ -102,20 +259,27 @@
 
 - (void)observeLogMessage:(nonnull ARKLogMessage *)logMessage;
 {
-    if (self.logFilterBlock && !self.logFilterBlock(logMessage)) {
-        // Predicate told us we should not observe this log. Bail out.
+    if (![self _shouldArchiveLogMessage:logMessage]) {
         return;
     }
     
-    if (self.printsLogsToConsole) {
-        if (self.name.length > 0 && self.prefixNameWhenPrintingToConsole) {
-            NSLog(@"%@: %@", self.name, logMessage.text);
-        } else {
-            NSLog(@"%@", logMessage.text);
+    [self _appendLogMessages:@[ [self _logMessageWithImageInBlobStore:logMessage] ]];
+    [self _queueDeliveryOfChanges];
+}
+
+- (void)observeLogMessages:(nonnull NSArray<ARKLogMessage *> *)logMessages;
+{
+    NSMutableArray<ARKLogMessage *> *const archivedLogMessages = [NSMutableArray arrayWithCapacity:logMessages.count];
+    for (ARKLogMessage *logMessage in logMessages) {
+        if ([self _shouldArchiveLogMessage:logMessage]) {
+            [archivedLogMessages addObject:[self _logMessageWithImageInBlobStore:logMessage]];
         }
     }
     
-    [self.dataArchive appendArchiveOfObject:logMessage];
+    if (archivedLogMessages.count > 0) {
+        [self _appendLogMessages:archivedLogMessages];
+        [self _queueDeliveryOfChanges];
+    }
 }
 
 - (void)processAllPendingLogsWithCompletionHandler:(nonnull dispatch_block_t)completionHandler;
@@ -123,9 +287,31 @@
     [self.dataArchive saveArchiveWithCompletionHandler:completionHandler];
 }
 
+#pragma mark - Properties
+
+- (unsigned long long)maximumImageByteCount;
+{
+    return self.imageBlobStore.maximumByteCount;
+}
+
+- (void)setMaximumImageByteCount:(unsigned long long)maximumImageByteCount;
+{
+    self.imageBlobStore.maximumByteCount = maximumImageByteCount;
+}
+
+- (BOOL)hasEmergencyLogBuffer;
+{
+    return (self.emergencyLogBuffer != nil);
+}
+
 #pragma mark - Public Methods
 
 - (void)retrieveAllLogMessagesWithCompletionHandler:(nonnull void (^)(NSArray<ARKLogMessage *> *logMessages))completionHandler;
+{
+    [self retrieveLogMessagesFromDate:nil toDate:nil types:ARKLogTypeMaskAll limit:0 newestFirst:NO completionHandler:completionHandler];
+}
+
+- (void)retrieveLogMessagesFromDate:(nullable NSDate *)startDate toDate:(nullable NSDate *)endDate types:(ARKLogTypeMask)typeMask limit:(NSUInteger)limit newestFirst:(BOOL)newestFirst completionHandler:(nonnull void (^)(NSArray<ARKLogMessage *> *logMessages))completionHandler;
 {
     ARKCheckCondition(completionHandler != NULL, , @"Can not retrieve log messages without a completion handler");
     if (self.logDistributor == nil) {
@@ -133,21 +319,102 @@
         ARKCheckCondition(NO, , @"Can not retrieve log messages without a log distributor");
     }
     
+    BOOL (^recordFilter)(NSData *) = NULL;
+    BOOL (^objectFilter)(id) = NULL;
+    if (startDate != nil || endDate != nil || typeMask != ARKLogTypeMaskAll) {
+        NSTimeInterval const startTimeInterval = (startDate != nil) ? startDate.timeIntervalSinceReferenceDate : -DBL_MAX;
+        NSTimeInterval const endTimeInterval = (endDate != nil) ? endDate.timeIntervalSinceReferenceDate : DBL_MAX;
+        BOOL (^const matches)(ARKLogType, NSTimeInterval) = ^BOOL(ARKLogType type, NSTimeInterval timeInterval) {
+            return (type < 8 * sizeof(ARKLogTypeMask) && (typeMask & ((ARKLogTypeMask)1 << type)) != 0
+                    && timeInterval >= startTimeInterval && timeInterval <= endTimeInterval);
+        };
+        
+        recordFilter = ^BOOL(NSData *objectData) {
+            ARKLogType type = ARKLogTypeDefault;
+            NSTimeInterval timeInterval = 0;
+            
+            // Keyed archives can only be matched once they're unarchived.
+            return (![ARKLogMessage getType:&type timeIntervalSinceReferenceDate:&timeInterval fromArchiveRecordRepresentation:objectData] || matches(type, timeInterval));
+        };
+        
+        objectFilter = ^BOOL(id object) {
+            ARKLogMessage *const logMessage = object;
+            return matches(logMessage.type, logMessage.date.timeIntervalSinceReferenceDate);
+        };
+    }
+    
+    ARKDataArchiveReadOptions const options = newestFirst ? ARKDataArchiveReadOptionsNewestFirst : ARKDataArchiveReadOptionsNone;
+    
     // Ensure we observe all log messages that have been queued by the distributor before we retrieve the our logs.
     [self.logDistributor distributeAllPendingLogsWithCompletionHandler:^{
-        [self.dataArchive readObjectsFromArchiveOfType:[ARKLogMessage class] completionHandler:^(NSArray *unarchivedObjects) {
-            completionHandler(unarchivedObjects);
-        }];
+        // Each data archive is read on its own queue, so the segments of a segmented store are read in parallel.
+        NSArray<ARKDataArchive *> *const dataArchives = [self _dataArchives];
+        NSMutableArray<NSArray<ARKLogMessage *> *> *const logMessagesByDataArchive = [NSMutableArray arrayWithCapacity:dataArchives.count];
+        dispatch_group_t const readGroup = dispatch_group_create();
+        
+        for (ARKDataArchive *dataArchive in dataArchives) {
+            NSUInteger const dataArchiveIndex = logMessagesByDataArchive.count;
+            [logMessagesByDataArchive addObject:@[]];
+            
+            dispatch_group_enter(readGroup);
+            [dataArchive readObjectsFromArchiveOfType:[ARKLogMessage class] options:options limit:limit recordFilter:recordFilter objectFilter:objectFilter completionHandler:^(NSArray *unarchivedObjects) {
+                // Completion handlers are called on the main queue, so they don't race each other.
+                logMessagesByDataArchive[dataArchiveIndex] = unarchivedObjects;
+                dispatch_group_leave(readGroup);
+            }];
+        }
+        
+        dispatch_group_notify(readGroup, dispatch_get_main_queue(), ^{
+            NSMutableArray<ARKLogMessage *> *const logMessages = [NSMutableArray new];
+            NSEnumerator<NSArray<ARKLogMessage *> *> *const enumerator = newestFirst ? logMessagesByDataArchive.reverseObjectEnumerator : logMessagesByDataArchive.objectEnumerator;
+            for (NSArray<ARKLogMessage *> *dataArchiveLogMessages in enumerator) {
+                [logMessages addObjectsFromArray:dataArchiveLogMessages];
+            }
+            
+            // Each data archive applied the limit on its own.
+            if (limit > 0 && logMessages.count > limit) {
+                [logMessages removeObjectsInRange:NSMakeRange(limit, logMessages.count - limit)];
+            }
+            
+            [self _attachImageBlobStoreToLogMessages:logMessages];
+            completionHandler(logMessages);
+        });
     }];
 }
 
+- (nonnull id)addChangeObserverWithHandler:(nonnull void (^)(NSArray<ARKLogMessage *> * _Nonnull appendedLogMessages, NSUInteger trimmedLogMessageCount))handler;
+{
+    ARKLogStoreChangeObserver *const changeObserver = [[ARKLogStoreChangeObserver alloc] initWithHandler:handler];
+    
+    @synchronized(self) {
+        [self.changeObservers addObject:changeObserver];
+    }
+    
+    if ([NSThread isMainThread]) {
+        [self _deliverChangesToObserver:changeObserver];
+    } else {
+        [[NSOperationQueue mainQueue] addOperationWithBlock:^{
+            [self _deliverChangesToObserver:changeObserver];
+        }];
+    }
+    
+    return changeObserver;
+}
+
+- (void)removeChangeObserver:(nonnull id)changeObserver;
+{
+    @synchronized(self) {
+        [self.changeObservers removeObjectIdenticalTo:changeObserver];
+    }
+}
+
 - (void)clearLogsWithCompletionHandler:(nullable dispatch_block_t)completionHandler;
 {
     if (self.logDistributor == nil) {
-        [self.dataArchive clearArchiveWithCompletionHandler:completionHandler];
+        [self _clearArchiveAndImagesWithCompletionHandler:completionHandler];
     } else {
         [self.logDistributor distributeAllPendingLogsWithCompletionHandler:^{
-            [self.dataArchive clearArchiveWithCompletionHandler:completionHandler];
+            [self _clearArchiveAndImagesWithCompletionHandler:completionHandler];
         }];
     }
 }
@@ -155,7 +422,9 @@
 - (void)waitUntilAllLogsAreConsumedAndArchiveSaved;
 {
     [self.logDistributor waitUntilAllPendingLogsHaveBeenDistributed];
-    [self.dataArchive saveArchiveAndWait:YES];
+    for (ARKDataArchive *dataArchive in [self _dataArchives]) {
+        [dataArchive saveArchiveAndWait:YES];
+    }
 }
 
 #pragma mark - Private Methods
@@ -165,13 +434,390 @@
     [self waitUntilAllLogsAreConsumedAndArchiveSaved];
 }
 
+/// Applies the logFilterBlock, and prints the log message to the console if it passes and printsLogsToConsole is set.
+- (BOOL)_shouldArchiveLogMessage:(nonnull ARKLogMessage *)logMessage;
+{
+    if (self.logFilterBlock && !self.logFilterBlock(logMessage)) {
+        // Predicate told us we should not observe this log. Bail out.
+        return NO;
+    }
+    
+    if (self.printsLogsToConsole) {
+        if (self.name.length > 0 && self.prefixNameWhenPrintingToConsole) {
+            NSLog(@"%@: %@", self.name, logMessage.text);
+        } else {
+            NSLog(@"%@", logMessage.text);
+        }
+    }
+    
+    return YES;
+}
+
+/// Returns a copy of logMessage that refers to its image in the imageBlobStore, or logMessage itself if it has no image or its image can't be stored.
+- (nonnull ARKLogMessage *)_logMessageWithImageInBlobStore:(nonnull ARKLogMessage *)logMessage;
+{
+    // Subclasses are archived with their keyed archive, which always contains the image.
+    if (logMessage.image == nil || ![logMessage isMemberOfClass:[ARKLogMessage class]]) {
+        return logMessage;
+    }
+    
+    NSData *const imageData = logMessage.userInfo[ARKLogMessageImageDataKey];
+    NSString *const imageBlobKey = [imageData isKindOfClass:[NSData class]] ? [self.imageBlobStore retainBlobWithImageData:imageData] : [self.imageBlobStore retainBlobWithImage:logMessage.image];
+    if (imageBlobKey == nil) {
+        return logMessage;
+    }
+    
+    return [[ARKLogMessage alloc] initWithLogMessage:logMessage imageBlobKey:imageBlobKey imageBlobStore:self.imageBlobStore];
+}
+
+- (void)_clearArchiveAndImagesWithCompletionHandler:(nullable dispatch_block_t)completionHandler;
+{
+    // The archive is about to drop every reference, so the images can go first.
+    [self.imageBlobStore removeAllBlobs];
+    
+    // The buffered copies of the log messages must not be appended back when the store is next opened.
+    [self.emergencyLogBuffer removeAllRecords];
+    
+    @synchronized(self) {
+        for (ARKDataArchive *sealedDataArchive in self.sealedDataArchives) {
+            // The images are already gone, and new log messages may add them back before the segment is removed.
+            sealedDataArchive.evictedObjectDataHandler = NULL;
+            [sealedDataArchive removeArchiveWithCompletionHandler:NULL];
+        }
+        
+        self.sealedDataArchives = @[];
+        self.segmentLogMessageCount = 0;
+        [self.dataArchive clearArchiveWithCompletionHandler:completionHandler];
+    }
+    
+    [self _queueDeliveryOfChanges];
+}
+
+/// Returns every data archive holding log messages, oldest first.
+- (nonnull NSArray<ARKDataArchive *> *)_dataArchives;
+{
+    @synchronized(self) {
+        return [self.sealedDataArchives arrayByAddingObject:self.dataArchive];
+    }
+}
+
+/// Appends the log messages to the data archive in order, starting new segments as they fill when the store is segmented.
+- (void)_appendLogMessages:(nonnull NSArray<ARKLogMessage *> *)logMessages;
+{
+    if (self.segmentCount == 0) {
+        [self.dataArchive appendArchivesOfObjects:logMessages];
+        return;
+    }
+    
+    NSUInteger const segmentCapacity = [self _segmentCapacity];
+    @synchronized(self) {
+        NSUInteger appendedCount = 0;
+        while (appendedCount < logMessages.count) {
+            if (self.segmentLogMessageCount >= segmentCapacity) {
+                [self _startNewSegment];
+            }
+            
+            NSRange const appendedRange = NSMakeRange(appendedCount, MIN(logMessages.count - appendedCount, segmentCapacity - self.segmentLogMessageCount));
+            [self.dataArchive appendArchivesOfObjects:[logMessages subarrayWithRange:appendedRange]];
+            
+            self.segmentLogMessageCount += appendedRange.length;
+            appendedCount += appendedRange.length;
+        }
+    }
+}
+
+/// The number of log messages appended to each segment of a segmented store before it's sealed.
+- (NSUInteger)_segmentCapacity;
+{
+    return MAX(self.maximumLogMessageCount / self.segmentCount, 1);
+}
+
+/// Seals the newest segment and starts a new one for appends, then deletes the oldest segments until there are no more than segmentCount. If the new segment can't be created, the newest segment keeps being appended to, and trims itself like a single-file store. Must be called within @synchronized(self).
+- (void)_startNewSegment;
+{
+    self.segmentLogMessageCount = 0;
+    
+    ARKDataArchive *const dataArchive = [self _dataArchiveForSegmentNumber:self.nextSegmentNumber];
+    if (dataArchive == nil) {
+        return;
+    }
+    
+    self.nextSegmentNumber++;
+    
+    // Sealed segments are never written again, so they only need to be saved once.
+    [self.dataArchive saveArchiveAndWait:NO];
+    
+    NSMutableArray<ARKDataArchive *> *const sealedDataArchives = [self.sealedDataArchives mutableCopy];
+    [sealedDataArchives addObject:self.dataArchive];
+    self.dataArchive = dataArchive;
+    
+    while (sealedDataArchives.count >= self.segmentCount) {
+        // Removing the segment reports its log messages as evicted, which releases their images.
+        [sealedDataArchives.firstObject removeArchiveWithCompletionHandler:NULL];
+        [sealedDataArchives removeObjectAtIndex:0];
+    }
+    
+    self.sealedDataArchives = sealedDataArchives;
+}
+
+/// Opens the file of a segmented store's segment, creating it if necessary.
+- (nullable ARKDataArchive *)_dataArchiveForSegmentNumber:(unsigned long long)segmentNumber;
+{
+    NSString *const fileName = [NSString stringWithFormat:@"%020llu.%@", segmentNumber, ARKLogStoreSegmentPathExtension];
+    NSURL *const fileURL = [self.persistedLogFileURL URLByAppendingPathComponent:fileName];
+    NSUInteger const segmentCapacity = [self _segmentCapacity];
+    
+    ARKDataArchive *const dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:segmentCapacity trimmedObjectCount:0.5 * segmentCapacity];
+    dataArchive.evictedObjectDataHandler = [[self class] _evictedObjectDataHandlerWithImageBlobStore:self.imageBlobStore];
+    dataArchive.appendedObjectDataHandler = [[self class] _appendedObjectDataHandlerWithEmergencyLogBuffer:self.emergencyLogBuffer];
+    
+    return dataArchive;
+}
+
+/// Opens the emergency log buffer alongside the persisted logs, starts copying log messages into it as they're appended, and queues appending the log messages it holds that never made it into the data archives. Called once, while the store is initialized.
+- (void)_openEmergencyLogBuffer;
+{
+    NSURL *const fileURL = [self.persistedLogFileURL URLByAppendingPathExtension:@"emergency"];
+    _emergencyLogBuffer = [[ARKEmergencyLogBuffer alloc] initWithFileURL:fileURL capacity:ARKLogStoreEmergencyLogBufferCapacity];
+    if (_emergencyLogBuffer == nil) {
+        return;
+    }
+    
+    // Take the records left by the previous run before any log messages are appended, since they're copied into the buffer from here on.
+    NSArray<NSData *> *const bufferedRecords = [_emergencyLogBuffer records];
+    self.dataArchive.appendedObjectDataHandler = [[self class] _appendedObjectDataHandlerWithEmergencyLogBuffer:_emergencyLogBuffer];
+    
+    if (bufferedRecords.count == 0) {
+        return;
+    }
+    
+    // The data archive is written in the order log messages are appended, so the ones lost are those buffered after the newest log message in the store. If that log message isn't buffered, every buffered log message is newer. The lost log messages are still in the buffer ahead of anything appended since, so they aren't copied into it again.
+    ARKDataArchive *const dataArchive = self.dataArchive;
+    [dataArchive appendObjectDataAfterNewestObjectUsingHandler:^NSArray<NSData *> *(NSData *newestObjectData) {
+        NSUInteger const newestRecordIndex = (newestObjectData != nil) ? [bufferedRecords indexOfObjectWithOptions:NSEnumerationReverse passingTest:^BOOL(NSData *record, NSUInteger index, BOOL *stop) {
+            return [record isEqualToData:newestObjectData];
+        }] : NSNotFound;
+        
+        NSUInteger const lostRecordIndex = (newestRecordIndex != NSNotFound) ? (newestRecordIndex + 1) : 0;
+        NSArray<NSData *> *const lostRecords = [bufferedRecords subarrayWithRange:NSMakeRange(lostRecordIndex, bufferedRecords.count - lostRecordIndex)];
+        
+        if (lostRecords.count > 0) {
+            @synchronized(self) {
+                if (self.segmentCount > 0 && self.dataArchive == dataArchive) {
+                    self.segmentLogMessageCount += lostRecords.count;
+                }
+            }
+            
+            [self _queueDeliveryOfChanges];
+        }
+        
+        return lostRecords;
+    }];
+}
+
+- (void)_attachImageBlobStoreToLogMessages:(nonnull NSArray<ARKLogMessage *> *)logMessages;
+{
+    for (ARKLogMessage *logMessage in logMessages) {
+        if (logMessage.imageBlobKey != nil) {
+            logMessage.imageBlobStore = self.imageBlobStore;
+        }
+    }
+}
+
+/// Queues a delivery of changes to every change observer on the main queue, unless one is already queued. Changes made before the queued delivery runs are delivered together.
+- (void)_queueDeliveryOfChanges;
+{
+    @synchronized(self) {
+        if (self.changeObservers.count == 0 || self.changeDeliveryIsQueued) {
+            return;
+        }
+        
+        self.changeDeliveryIsQueued = YES;
+    }
+    
+    [[NSOperationQueue mainQueue] addOperationWithBlock:^{
+        NSArray<ARKLogStoreChangeObserver *> *changeObservers = nil;
+        @synchronized(self) {
+            self.changeDeliveryIsQueued = NO;
+            changeObservers = [self.changeObservers copy];
+        }
+        
+        for (ARKLogStoreChangeObserver *changeObserver in changeObservers) {
+            [self _deliverChangesToObserver:changeObserver];
+        }
+    }];
+}
+
+/// Reads the log messages appended to the store since the observer's last delivery, along with how many of the log messages it was passed have been trimmed since, and passes them to its handler. Must be called on the main queue.
+- (void)_deliverChangesToObserver:(nonnull ARKLogStoreChangeObserver *)changeObserver;
+{
+    if (changeObserver.isReadingChanges) {
+        // Read again once the changes being read have been delivered, so that changes are delivered in order.
+        changeObserver.needsChangesRead = YES;
+        return;
+    }
+    
+    changeObserver.isReadingChanges = YES;
+    changeObserver.needsChangesRead = NO;
+    
+    // Every log message read from a segment that has since been deleted has been trimmed.
+    NSArray<ARKDataArchive *> *const dataArchives = [self _dataArchives];
+    NSUInteger trimmedLogMessageCount = 0;
+    for (ARKDataArchive *dataArchive in changeObserver.cursorsByDataArchive.keyEnumerator.allObjects) {
+        if ([dataArchives indexOfObjectIdenticalTo:dataArchive] == NSNotFound) {
+            trimmedLogMessageCount += [changeObserver.deliveredLogMessageCountsByDataArchive objectForKey:dataArchive].unsignedIntegerValue;
+            [changeObserver.cursorsByDataArchive removeObjectForKey:dataArchive];
+            [changeObserver.deliveredLogMessageCountsByDataArchive removeObjectForKey:dataArchive];
+        }
+    }
+    
+    [self _readChangesForObserver:changeObserver fromDataArchives:dataArchives atIndex:0 appendedLogMessages:[NSMutableArray new] trimmedLogMessageCount:trimmedLogMessageCount];
+}
+
+/// Reads the next page of the data archive at dataArchiveIndex for the observer, then moves on to the next newest data archive. The changes read are passed to the observer's handler once the newest data archive has been read, or as soon as a data archive has more to read than fits on a page.
+- (void)_readChangesForObserver:(nonnull ARKLogStoreChangeObserver *)changeObserver fromDataArchives:(nonnull NSArray<ARKDataArchive *> *)dataArchives atIndex:(NSUInteger)dataArchiveIndex appendedLogMessages:(nonnull NSMutableArray<ARKLogMessage *> *)appendedLogMessages trimmedLogMessageCount:(NSUInteger)trimmedLogMessageCount;
+{
+    if (dataArchiveIndex >= dataArchives.count) {
+        [self _finishDeliveringChangesToObserver:changeObserver appendedLogMessages:appendedLogMessages trimmedLogMessageCount:trimmedLogMessageCount];
+        return;
+    }
+    
+    ARKDataArchive *const dataArchive = dataArchives[dataArchiveIndex];
+    ARKDataArchiveCursor *cursor = [changeObserver.cursorsByDataArchive objectForKey:dataArchive];
+    if (cursor == nil) {
+        // Each page holds a whole data archive, so that the initial contents are delivered at once.
+        cursor = [dataArchive cursorForObjectsOfType:[ARKLogMessage class] options:ARKDataArchiveReadOptionsNone pageSize:self.maximumLogMessageCount];
+        [changeObserver.cursorsByDataArchive setObject:cursor forKey:dataArchive];
+    }
+    
+    [cursor readNextPageAndTrimmedObjectCountOnQueue:[NSOperationQueue mainQueue] completionHandler:^(NSArray *objects, NSUInteger trimmedObjectCount, BOOL hasMoreObjects) {
+        @synchronized(self) {
+            if ([self.changeObservers indexOfObjectIdenticalTo:changeObserver] == NSNotFound) {
+                // The observer was removed while the page was being read.
+                return;
+            }
+        }
+        
+        // Only one page is read from each data archive per delivery, so the trimmed objects were all delivered earlier.
+        NSUInteger const deliveredLogMessageCount = [changeObserver.deliveredLogMessageCountsByDataArchive objectForKey:dataArchive].unsignedIntegerValue;
+        [changeObserver.deliveredLogMessageCountsByDataArchive setObject:@(deliveredLogMessageCount - trimmedObjectCount + objects.count) forKey:dataArchive];
+        [appendedLogMessages addObjectsFromArray:objects];
+        
+        if (hasMoreObjects) {
+            // Newer data archives can't be read until this one has been read to the end.
+            changeObserver.needsChangesRead = YES;
+            [self _finishDeliveringChangesToObserver:changeObserver appendedLogMessages:appendedLogMessages trimmedLogMessageCount:(trimmedLogMessageCount + trimmedObjectCount)];
+        } else {
+            [self _readChangesForObserver:changeObserver fromDataArchives:dataArchives atIndex:(dataArchiveIndex + 1) appendedLogMessages:appendedLogMessages trimmedLogMessageCount:(trimmedLogMessageCount + trimmedObjectCount)];
+        }
+    }];
+}
+
+/// Passes the changes read for the observer to its handler, then reads changes again if another delivery was requested in the meantime.
+- (void)_finishDeliveringChangesToObserver:(nonnull ARKLogStoreChangeObserver *)changeObserver appendedLogMessages:(nonnull NSArray<ARKLogMessage *> *)appendedLogMessages trimmedLogMessageCount:(NSUInteger)trimmedLogMessageCount;
+{
+    if (appendedLogMessages.count > 0 || trimmedLogMessageCount > 0 || !changeObserver.hasDeliveredInitialContents) {
+        [self _attachImageBlobStoreToLogMessages:appendedLogMessages];
+        changeObserver.hasDeliveredInitialContents = YES;
+        changeObserver.handler([appendedLogMessages copy], trimmedLogMessageCount);
+    }
+    
+    changeObserver.isReadingChanges = NO;
+    if (changeObserver.needsChangesRead) {
+        [self _deliverChangesToObserver:changeObserver];
+    }
+}
+
 #pragma mark - Private Static Methods
 
-+ (ARKDataArchive *)_dataArchiveWithPersistedLogFileURL:(nonnull NSURL *)persistedLogFileURL maximumLogMessageCount:(NSUInteger)maximumLogMessageCount;
++ (ARKDataArchive *)_dataArchiveWithPersistedLogFileURL:(nonnull NSURL *)persistedLogFileURL maximumLogMessageCount:(NSUInteger)maximumLogMessageCount usesCircularArchive:(BOOL)usesCircularArchive;
 {
     ARKCheckCondition(maximumLogMessageCount > 0, nil, @"maximumLogMessageCount must be greater than zero");
 
+    if (usesCircularArchive) {
+        unsigned long long const capacity = maximumLogMessageCount * ARKLogStoreCircularArchiveBytesPerLogMessage;
+        return [[ARKDataArchive alloc] initWithURL:persistedLogFileURL maximumObjectCount:maximumLogMessageCount trimmedObjectCount:maximumLogMessageCount format:ARKDataArchiveFormatCircular circularArchiveCapacity:capacity];
+    }
+
     return [[ARKDataArchive alloc] initWithURL:persistedLogFileURL maximumObjectCount:maximumLogMessageCount trimmedObjectCount:0.5 * maximumLogMessageCount];
 }
 
++ (nonnull ARKImageBlobStore *)_imageBlobStoreWithPersistedLogFileURL:(nonnull NSURL *)persistedLogFileURL;
+{
+    NSURL *const directoryURL = [persistedLogFileURL URLByAppendingPathExtension:@"images"];
+    return [[ARKImageBlobStore alloc] initWithDirectoryURL:directoryURL maximumByteCount:ARKLogStoreDefaultMaximumImageByteCount];
+}
+
+/// Returns a handler that releases the images of log messages as they're trimmed from a data archive.
++ (nonnull void (^)(NSArray<NSData *> * _Nonnull))_evictedObjectDataHandlerWithImageBlobStore:(nonnull ARKImageBlobStore *)imageBlobStore;
+{
+    // The handler must not retain the log store, which owns the archive.
+    return ^(NSArray<NSData *> *evictedObjectData) {
+        NSMutableArray<NSString *> *const imageBlobKeys = [NSMutableArray new];
+        for (NSData *objectData in evictedObjectData) {
+            NSString *const imageBlobKey = [ARKLogMessage imageBlobKeyInArchiveRecordRepresentation:objectData];
+            if (imageBlobKey != nil) {
+                [imageBlobKeys addObject:imageBlobKey];
+            }
+        }
+        
+        if (imageBlobKeys.count > 0) {
+            [imageBlobStore releaseBlobsWithKeys:imageBlobKeys];
+        }
+    };
+}
+
+/// Returns a handler that copies the data of log messages into the emergency log buffer as they're appended to a data archive, or NULL if there's no buffer.
++ (nullable void (^)(NSArray<NSData *> * _Nonnull))_appendedObjectDataHandlerWithEmergencyLogBuffer:(nullable ARKEmergencyLogBuffer *)emergencyLogBuffer;
+{
+    if (emergencyLogBuffer == nil) {
+        return NULL;
+    }
+    
+    // The handler must not retain the log store, which owns the archive.
+    return ^(NSArray<NSData *> *appendedObjectData) {
+        [emergencyLogBuffer appendRecords:appendedObjectData];
+    };
+}
+
+/// Returns the numbers of the segment files in a segmented store's directory, oldest first.
++ (nonnull NSArray<NSNumber *> *)_segmentNumbersInDirectoryURL:(nonnull NSURL *)directoryURL;
+{
+    NSArray<NSURL *> *const fileURLs = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:directoryURL includingPropertiesForKeys:nil options:NSDirectoryEnumerationSkipsHiddenFiles error:NULL];
+    NSMutableArray<NSNumber *> *const segmentNumbers = [NSMutableArray new];
+    
+    for (NSURL *fileURL in fileURLs) {
+        if (![fileURL.pathExtension isEqualToString:ARKLogStoreSegmentPathExtension]) {
+            continue;
+        }
+        
+        NSScanner *const scanner = [NSScanner scannerWithString:fileURL.lastPathComponent.stringByDeletingPathExtension];
+        unsigned long long segmentNumber = 0;
+        if ([scanner scanUnsignedLongLong:&segmentNumber] && scanner.isAtEnd) {
+            [segmentNumbers addObject:@(segmentNumber)];
+        }
+    }
+    
+    [segmentNumbers sortUsingSelector:@selector(compare:)];
+    return segmentNumbers;
+}
+
+@end
+
+
+@implementation ARKLogStoreChangeObserver
+
+#pragma mark - Initialization
+
+- (nonnull instancetype)initWithHandler:(nonnull void (^)(NSArray<ARKLogMessage *> * _Nonnull appendedLogMessages, NSUInteger trimmedLogMessageCount))handler;
+{
+    self = [super init];
+    
+    _handler = [handler copy];
+    _cursorsByDataArchive = [NSMapTable strongToStrongObjectsMapTable];
+    _deliveredLogMessageCountsByDataArchive = [NSMapTable strongToStrongObjectsMapTable];
+    
+    return self;
+}
+
 @end
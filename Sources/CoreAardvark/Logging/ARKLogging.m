@@ -23,8 +23,27 @@
 #import "ARKLogDistributor.h"
 
 
+uint64_t ARKDefaultLogDistributorEnabledCategoriesByLevel[ARKLogLevelCount] = { UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX };
+
+
+void ARKLogWithLevel(ARKLogLevel level, ARKLogCategory category, NSString *format, ...)
+{
+    if (!ARKLogIsEnabled(level, category)) {
+        return;
+    }
+    
+    va_list argList;
+    va_start(argList, format);
+    [[ARKLogDistributor defaultDistributor] logWithLevel:level category:category format:format arguments:argList];
+    va_end(argList);
+}
+
 void ARKLog(NSString *format, ...)
 {
+    if (!ARKLogIsEnabled(ARKLogLevelDefault, ARKLogCategoryDefault)) {
+        return;
+    }
+    
     va_list argList;
     va_start(argList, format);
     [[ARKLogDistributor defaultDistributor] logWithFormat:format arguments:argList];
@@ -33,6 +52,10 @@ void ARKLog(NSString *format, ...)
 
 void ARKLogWithType(ARKLogType type, NSDictionary *userInfo, NSString *format, ...)
 {
+    if (!ARKLogIsEnabled(ARKLogLevelForLogType(type), ARKLogCategoryDefault)) {
+        return;
+    }
+    
     va_list argList;
     va_start(argList, format);
     [[ARKLogDistributor defaultDistributor] logWithType:type userInfo:userInfo format:format arguments:argList];
@@ -40,6 +63,10 @@ void ARKLogWithType(ARKLogType type, NSDictionary *userInfo, NSString *format, .
 }
 
 void ARKLogWithParameters(NSDictionary<NSString *, NSString *> *parameters, NSString *format, ...) {
+    if (!ARKLogIsEnabled(ARKLogLevelDefault, ARKLogCategoryDefault)) {
+        return;
+    }
+    
     va_list argList;
     va_start(argList, format);
     [[ARKLogDistributor defaultDistributor] logWithParameters:parameters format:format arguments:argList];
@@ -47,6 +74,10 @@ void ARKLogWithParameters(NSDictionary<NSString *, NSString *> *parameters, NSSt
 }
 
 void ARKLogWithTypeAndParameters(ARKLogType type, NSDictionary<NSString *, NSString *> *parameters, NSString *format, ...) {
+    if (!ARKLogIsEnabled(ARKLogLevelForLogType(type), ARKLogCategoryDefault)) {
+        return;
+    }
+    
     va_list argList;
     va_start(argList, format);
     [[ARKLogDistributor defaultDistributor] logWithType:type parameters:parameters format:format arguments:argList];
@@ -20,6 +20,12 @@
 
 #import <stdatomic.h>
 #import <stdbool.h>
+#import <sys/mman.h>
+#import <unistd.h>
+
+#if defined(__ARM_FEATURE_CRC32)
+#import <arm_acle.h>
+#endif
 
 
 NSUInteger const ARKInvalidDataBlockLength = NSUIntegerMax;
@@ -35,13 +41,150 @@ static _Atomic bool __ARKHasEncounteredDiskSizeException = false;
 static _Atomic bool __ARKPreventsWritesAfterException = false;
 
 
-/// Type convenience.
-typedef unsigned long long ARKFileOffset;
+/// Identifies the start of a data block ("ARKB"), so that a walk of a damaged file can find the next intact block.
+static uint32_t const ARKDataBlockMagic = 0x41524B42;
+
+/// A data block header holds the magic, the length of the contents, the sequence number, and the checksum (all big-endian). The checksum covers everything after the magic, up to the end of the contents. Changing the layout will render existing files unreadable.
+static NSUInteger const ARKDataBlockLengthOffset = sizeof(uint32_t);
+static NSUInteger const ARKDataBlockSequenceNumberOffset = 2 * sizeof(uint32_t);
+static NSUInteger const ARKDataBlockChecksumOffset = 2 * sizeof(uint32_t) + sizeof(uint64_t);
+
+NSUInteger const ARKDataBlockHeaderSize = 3 * sizeof(uint32_t) + sizeof(uint64_t);
+
+
+#pragma mark - Checksums
+
+#if !defined(__ARM_FEATURE_CRC32)
+
+/// Lookup tables for computing CRC-32C eight bytes at a time ("slicing-by-8"), built from the reversed Castagnoli polynomial.
+static uint32_t ARKChecksumTables[8][256];
+
+static void ARKBuildChecksumTables(void)
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t checksum = i;
+        for (NSUInteger bit = 0; bit < 8; bit++) {
+            checksum = (checksum >> 1) ^ ((checksum & 1) ? 0x82F63B78 : 0);
+        }
+        
+        ARKChecksumTables[0][i] = checksum;
+    }
+    
+    for (uint32_t i = 0; i < 256; i++) {
+        for (NSUInteger table = 1; table < 8; table++) {
+            uint32_t const previous = ARKChecksumTables[table - 1][i];
+            ARKChecksumTables[table][i] = (previous >> 8) ^ ARKChecksumTables[0][previous & 0xFF];
+        }
+    }
+}
+
+#endif
+
+uint32_t ARKChecksumData(uint32_t checksum, void const *bytes, NSUInteger length)
+{
+    uint8_t const *position = bytes;
+    uint32_t crc = ~checksum;
+    
+#if defined(__ARM_FEATURE_CRC32)
+    // Use the CRC-32C instructions when the processor has them.
+    for (; length >= sizeof(uint64_t); position += sizeof(uint64_t), length -= sizeof(uint64_t)) {
+        uint64_t word = 0;
+        memcpy(&word, position, sizeof(uint64_t));
+        crc = __crc32cd(crc, word);
+    }
+    
+    for (; length > 0; position++, length--) {
+        crc = __crc32cb(crc, *position);
+    }
+#else
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        ARKBuildChecksumTables();
+    });
+    
+    for (; length >= sizeof(uint64_t); position += sizeof(uint64_t), length -= sizeof(uint64_t)) {
+        uint32_t const low = OSReadLittleInt32(position, 0) ^ crc;
+        uint32_t const high = OSReadLittleInt32(position, sizeof(uint32_t));
+        crc = (ARKChecksumTables[7][low & 0xFF] ^ ARKChecksumTables[6][(low >> 8) & 0xFF] ^ ARKChecksumTables[5][(low >> 16) & 0xFF] ^ ARKChecksumTables[4][low >> 24]
+               ^ ARKChecksumTables[3][high & 0xFF] ^ ARKChecksumTables[2][(high >> 8) & 0xFF] ^ ARKChecksumTables[1][(high >> 16) & 0xFF] ^ ARKChecksumTables[0][high >> 24]);
+    }
+    
+    for (; length > 0; position++, length--) {
+        crc = (crc >> 8) ^ ARKChecksumTables[0][(crc ^ *position) & 0xFF];
+    }
+#endif
+    
+    return ~crc;
+}
+
+/// Returns the checksum of a data block, given its header and contents.
+static uint32_t ARKChecksumOfDataBlock(uint8_t const *headerBytes, uint8_t const *dataBytes, NSUInteger dataLength)
+{
+    uint32_t const headerChecksum = ARKChecksumData(0, headerBytes + ARKDataBlockLengthOffset, ARKDataBlockChecksumOffset - ARKDataBlockLengthOffset);
+    return ARKChecksumData(headerChecksum, dataBytes, dataLength);
+}
 
-/// These defines must all be kept in sync. Changing them will render files with differently-sized data block lengths unreadable.
-#define ARKBlockLengthBytes (sizeof(uint32_t))
-#define ARKWriteBigEndianBlockLength OSWriteBigInt32
-#define ARKReadBigEndianBlockLength OSReadBigInt32
+#pragma mark - Data Blocks
+
+void ARKWriteDataBlockHeader(uint8_t *blockBytes, NSUInteger dataLength, uint64_t sequenceNumber)
+{
+    OSWriteBigInt32(blockBytes, 0, ARKDataBlockMagic);
+    OSWriteBigInt32(blockBytes, ARKDataBlockLengthOffset, (uint32_t)dataLength);
+    OSWriteBigInt64(blockBytes, ARKDataBlockSequenceNumberOffset, sequenceNumber);
+    OSWriteBigInt32(blockBytes, ARKDataBlockChecksumOffset, ARKChecksumOfDataBlock(blockBytes, blockBytes + ARKDataBlockHeaderSize, dataLength));
+}
+
+BOOL ARKValidateDataBlock(uint8_t const *blockBytes, NSUInteger availableLength, NSUInteger *dataLength, uint64_t *sequenceNumber)
+{
+    if (availableLength < ARKDataBlockHeaderSize || OSReadBigInt32(blockBytes, 0) != ARKDataBlockMagic) {
+        return NO;
+    }
+    
+    NSUInteger const blockDataLength = OSReadBigInt32(blockBytes, ARKDataBlockLengthOffset);
+    if (blockDataLength == 0 || blockDataLength > availableLength - ARKDataBlockHeaderSize) {
+        return NO;
+    }
+    
+    if (ARKChecksumOfDataBlock(blockBytes, blockBytes + ARKDataBlockHeaderSize, blockDataLength) != OSReadBigInt32(blockBytes, ARKDataBlockChecksumOffset)) {
+        return NO;
+    }
+    
+    if (dataLength != NULL) {
+        *dataLength = blockDataLength;
+    }
+    if (sequenceNumber != NULL) {
+        *sequenceNumber = OSReadBigInt64(blockBytes, ARKDataBlockSequenceNumberOffset);
+    }
+    
+    return YES;
+}
+
+/// Returns the offset of the first intact data block at or after offset whose sequence number is at least minimumSequenceNumber, or NSNotFound if there isn't one.
+static NSUInteger ARKOffsetOfNextIntactDataBlock(uint8_t const *bytes, NSUInteger length, NSUInteger offset, uint64_t minimumSequenceNumber)
+{
+    uint8_t magicBytes[sizeof(uint32_t)] = { };
+    OSWriteBigInt32(magicBytes, 0, ARKDataBlockMagic);
+    
+    while (offset < length && length - offset >= ARKDataBlockHeaderSize) {
+        uint8_t const *const candidate = memchr(bytes + offset, magicBytes[0], length - offset - ARKDataBlockHeaderSize + 1);
+        if (candidate == NULL) {
+            break;
+        }
+        
+        offset = candidate - bytes;
+        
+        uint64_t sequenceNumber = 0;
+        if (memcmp(candidate, magicBytes, sizeof(magicBytes)) == 0
+            && ARKValidateDataBlock(candidate, length - offset, NULL, &sequenceNumber)
+            && sequenceNumber >= minimumSequenceNumber) {
+            return offset;
+        }
+        
+        offset++;
+    }
+    
+    return NSNotFound;
+}
 
 
 @implementation NSFileHandle (ARKAdditions)
@@ -66,28 +209,28 @@ typedef unsigned long long ARKFileOffset;
 
 @implementation NSFileHandle (ARKAdditions_Private)
 
-- (void)ARK_writeDataBlock:(NSData *)dataBlock;
+- (BOOL)ARK_writeDataBlock:(NSData *)dataBlock sequenceNumber:(uint64_t)sequenceNumber;
 {
     bool preventWritesAfterException = atomic_load(&__ARKPreventsWritesAfterException);
     if (preventWritesAfterException) {
         bool hasEncounteredException = atomic_load(&__ARKHasEncounteredDiskSizeException);
         if (hasEncounteredException) {
-            return;
+            return NO;
         }
     }
 
     NSUInteger dataBlockLength = dataBlock.length;
     
-    ARKCheckCondition(dataBlockLength > 0, , @"Can't write data block %@", dataBlock);
+    ARKCheckCondition(dataBlockLength > 0 && dataBlockLength <= UINT32_MAX, NO, @"Can't write data block %@", dataBlock);
     
-    // Be sure to store the length value as big-endian in the file.
-    uint8_t dataLengthBytes[ARKBlockLengthBytes] = { };
-    ARKWriteBigEndianBlockLength(dataLengthBytes, 0, dataBlockLength);
-    NSData *dataLengthData = [NSData dataWithBytes:dataLengthBytes length:ARKBlockLengthBytes];
+    // Write the header and the contents at once, so a crash can't leave a header without its contents.
+    NSMutableData *const framedDataBlock = [NSMutableData dataWithLength:ARKDataBlockHeaderSize];
+    [framedDataBlock appendData:dataBlock];
+    ARKWriteDataBlockHeader(framedDataBlock.mutableBytes, dataBlockLength, sequenceNumber);
     
     @try {
-        [self writeData:dataLengthData];
-        [self writeData:dataBlock];
+        [self writeData:framedDataBlock];
+        return YES;
     } @catch (NSException *exception) {
         NSLog(@"ERROR: -[%@ %@] Unable to write data block (%@ bytes) to disk: %@",
               NSStringFromClass([self class]), NSStringFromSelector(_cmd),
@@ -96,16 +239,22 @@ typedef unsigned long long ARKFileOffset;
         if ([exception.name isEqualToString:NSFileHandleOperationException]) {
             atomic_store(&__ARKHasEncounteredDiskSizeException, true);
         }
+
+        return NO;
     }
 }
 
+- (BOOL)ARK_writeDataBlock:(NSData *)dataBlock;
+{
+    return [self ARK_writeDataBlock:dataBlock sequenceNumber:0];
+}
+
 - (void)ARK_appendDataBlock:(NSData *)dataBlock;
 {
     (void)[self seekToEndOfFile];
     [self ARK_writeDataBlock:dataBlock];
 }
 
-/// Seeks forward from the beginning of the file, and returns blockIndex on success, or the index of the last block it reached without detecting corruption.
 - (NSUInteger)ARK_seekToDataBlockAtIndex:(NSUInteger)blockIndex;
 {
     // Simple case.
@@ -114,45 +263,56 @@ typedef unsigned long long ARKFileOffset;
         return 0;
     }
     
-    ARKFileOffset endOffset = [self seekToEndOfFile];
-    ARKFileOffset currentBlockOffset = 0;
-    [self seekToFileOffset:0];
-    
-    NSUInteger currentBlockIndex = 0;
-    while (currentBlockIndex < blockIndex) {
-        // Read the block length and break if we're done.
-        NSUInteger dataBlockLength = [self _ARK_readDataBlockLength];
-        if (dataBlockLength == 0) {
-            break;
-        }
-        
-        // If we've detected corruption, seek back and bail out.
-        if (dataBlockLength == ARKInvalidDataBlockLength || dataBlockLength > endOffset - self.offsetInFile) {
-            [self seekToFileOffset:currentBlockOffset];
-            break;
-        }
-        
-        // Seek forward.
-        currentBlockIndex++;
-        currentBlockOffset = self.offsetInFile + dataBlockLength;
-        [self seekToFileOffset:currentBlockOffset];
+    // Walk one block further than asked, so that we land at the start of the block even if damaged bytes precede it.
+    ARKFileOffset endOffset = 0;
+    ARKFileOffset lastBlockOffset = 0;
+    NSUInteger const maximumBlockCount = (blockIndex < NSUIntegerMax) ? blockIndex + 1 : NSUIntegerMax;
+    NSUInteger const blockCount = [self _ARK_walkDataBlocksFromOffset:0 maximumBlockCount:maximumBlockCount blockOffsets:nil lastBlockOffset:&lastBlockOffset endOffset:&endOffset];
+    
+    if (blockCount > blockIndex) {
+        [self seekToFileOffset:lastBlockOffset];
+        return blockIndex;
     }
     
-    return currentBlockIndex;
+    [self seekToFileOffset:endOffset];
+    return blockCount;
 }
 
-- (NSData *)ARK_readDataBlock:(out BOOL *)success;
+- (NSUInteger)ARK_indexDataBlocksIntoOffsets:(NSMutableData *)blockOffsets;
+{
+    ARKFileOffset endOffset = 0;
+    NSUInteger const indexedBlockCount = [self _ARK_walkDataBlocksFromOffset:self.offsetInFile maximumBlockCount:NSUIntegerMax blockOffsets:blockOffsets lastBlockOffset:NULL endOffset:&endOffset];
+    
+    [self seekToFileOffset:endOffset];
+    return indexedBlockCount;
+}
+
+- (NSData *)ARK_readDataBlock:(out BOOL *)success sequenceNumber:(out uint64_t *)sequenceNumber;
 {
     // Check the length of the file before doing anything.
     ARKFileOffset currentOffset = self.offsetInFile;
     ARKFileOffset endOffset = [self seekToEndOfFile];
     [self seekToFileOffset:currentOffset];
     
-    // Read the block length.
-    NSUInteger dataBlockLength = [self _ARK_readDataBlockLength];
+    if (currentOffset >= endOffset) {
+        // We're at the end of the file.
+        if (success != NULL) {
+            *success = YES;
+        }
+        
+        return nil;
+    }
+    
+    // Read the header and the contents, and bail out if the header was invalid, there isn't enough remaining data in the file, or the contents don't match the checksum.
+    NSData *const headerData = [self readDataOfLength:ARKDataBlockHeaderSize];
+    NSUInteger const dataBlockLength = [self _ARK_dataBlockLengthInHeader:headerData];
     
-    // Bail out if the length itself was invalid, or there isn't enough remaining data in the file.
-    if (dataBlockLength == ARKInvalidDataBlockLength || dataBlockLength > endOffset - self.offsetInFile) {
+    NSData *dataBlock = nil;
+    if (dataBlockLength != 0 && dataBlockLength != ARKInvalidDataBlockLength && dataBlockLength <= endOffset - self.offsetInFile) {
+        dataBlock = [self readDataOfLength:dataBlockLength];
+    }
+    
+    if (dataBlock.length != dataBlockLength || ARKChecksumOfDataBlock(headerData.bytes, dataBlock.bytes, dataBlock.length) != OSReadBigInt32(headerData.bytes, ARKDataBlockChecksumOffset)) {
         [self seekToFileOffset:currentOffset];
         if (success != NULL) {
             *success = NO;
@@ -164,8 +324,87 @@ typedef unsigned long long ARKFileOffset;
     if (success != NULL) {
         *success = YES;
     }
+    if (sequenceNumber != NULL) {
+        *sequenceNumber = OSReadBigInt64(headerData.bytes, ARKDataBlockSequenceNumberOffset);
+    }
+    
+    return dataBlock;
+}
+
+- (NSData *)ARK_readDataBlock:(out BOOL *)success;
+{
+    return [self ARK_readDataBlock:success sequenceNumber:NULL];
+}
+
+- (NSUInteger)ARK_readDataBlockLengthAtOffset:(unsigned long long)offset;
+{
+    [self seekToFileOffset:offset];
+    
+    NSData *const headerData = [self readDataOfLength:ARKDataBlockHeaderSize];
+    if (headerData.length == ARKDataBlockHeaderSize && OSReadBigInt32(headerData.bytes, 0) == 0 && OSReadBigInt32(headerData.bytes, ARKDataBlockLengthOffset) == 0) {
+        // The header was zeroed out, which marks the end of the blocks.
+        return 0;
+    }
+    
+    return [self _ARK_dataBlockLengthInHeader:headerData];
+}
+
+- (BOOL)ARK_writeData:(NSData *)data;
+{
+    bool preventWritesAfterException = atomic_load(&__ARKPreventsWritesAfterException);
+    if (preventWritesAfterException) {
+        bool hasEncounteredException = atomic_load(&__ARKHasEncounteredDiskSizeException);
+        if (hasEncounteredException) {
+            return NO;
+        }
+    }
+    
+    @try {
+        [self writeData:data];
+        return YES;
+    } @catch (NSException *exception) {
+        NSLog(@"ERROR: -[%@ %@] Unable to write data (%@ bytes) to disk: %@",
+              NSStringFromClass([self class]), NSStringFromSelector(_cmd),
+              @(data.length), exception);
+        
+        if ([exception.name isEqualToString:NSFileHandleOperationException]) {
+            atomic_store(&__ARKHasEncounteredDiskSizeException, true);
+        }
+        
+        return NO;
+    }
+}
+
+- (void)ARK_moveDataFromOffset:(unsigned long long)sourceOffset toOffset:(unsigned long long)destinationOffset length:(unsigned long long)length maximumChunkSize:(NSUInteger)maximumChunkSize;
+{
+    if (sourceOffset == destinationOffset || length == 0) {
+        return;
+    }
+    
+    if (maximumChunkSize == 0) {
+        maximumChunkSize = NSUIntegerMax;
+    }
+    
+    // When moving data towards the end of the file, copy the last chunk first so we never overwrite data we haven't copied yet.
+    BOOL const movingForward = (destinationOffset > sourceOffset);
+    ARKFileOffset copiedLength = 0;
     
-    return (dataBlockLength > 0) ? [self readDataOfLength:dataBlockLength] : nil;
+    while (copiedLength < length) {
+        @autoreleasepool {
+            // Enforce the maximum block size, and avoid loss of accuracy when casting from ARKFileOffset to NSUInteger.
+            ARKFileOffset remainingDataLength = length - copiedLength;
+            NSUInteger chunkLength = (remainingDataLength < maximumChunkSize) ? (NSUInteger)remainingDataLength : maximumChunkSize;
+            ARKFileOffset chunkStart = movingForward ? (length - copiedLength - chunkLength) : copiedLength;
+            
+            [self seekToFileOffset:(sourceOffset + chunkStart)];
+            NSData *dataChunk = [self readDataOfLength:chunkLength];
+            
+            [self seekToFileOffset:(destinationOffset + chunkStart)];
+            [self writeData:dataChunk];
+            
+            copiedLength += chunkLength;
+        }
+    }
 }
 
 - (void)ARK_truncateFileToOffset:(unsigned long long)offset maximumChunkSize:(NSUInteger)maximumChunkSize;
@@ -217,24 +456,100 @@ typedef unsigned long long ARKFileOffset;
 
 #pragma mark - Private Methods
 
-- (NSUInteger)_ARK_readDataBlockLength;
+/// Returns the length of the contents recorded in headerData, 0 if headerData is empty because it was read at the end of the file, or ARKInvalidDataBlockLength if headerData isn't a whole header.
+- (NSUInteger)_ARK_dataBlockLengthInHeader:(nonnull NSData *)headerData;
 {
-    NSData *dataBlockLengthData = [self readDataOfLength:ARKBlockLengthBytes];
-    
-    if (dataBlockLengthData.length == 0) {
+    if (headerData.length == 0) {
         // We're at the end of the file.
         return 0;
     }
     
-    if (dataBlockLengthData.length != ARKBlockLengthBytes) {
-        // Something went wrong, we read a portion of a block length.
+    if (headerData.length != ARKDataBlockHeaderSize || OSReadBigInt32(headerData.bytes, 0) != ARKDataBlockMagic) {
+        // Something went wrong, we read a portion of a header or something that isn't a header at all.
         return ARKInvalidDataBlockLength;
     }
     
     // The value is stored big-endian in the file.
-    uint8_t dataBlockLengthBytes[ARKBlockLengthBytes] = { };
-    [dataBlockLengthData getBytes:&dataBlockLengthBytes length:ARKBlockLengthBytes];
-    return ARKReadBigEndianBlockLength(dataBlockLengthBytes, 0);
+    NSUInteger const dataBlockLength = OSReadBigInt32(headerData.bytes, ARKDataBlockLengthOffset);
+    return (dataBlockLength > 0) ? dataBlockLength : ARKInvalidDataBlockLength;
+}
+
+/// Returns the contents of the file from offset to the end of the file, mapped into memory where possible.
+- (nullable NSData *)_ARK_contentsOfFileFromOffset:(ARKFileOffset)offset;
+{
+    ARKFileOffset const endOffset = [self seekToEndOfFile];
+    if (offset >= endOffset || endOffset - offset > NSUIntegerMax) {
+        return nil;
+    }
+    
+    // Mappings have to start on a page boundary, so map from the start of the page holding offset.
+    ARKFileOffset const mappedOffset = offset - (offset % (ARKFileOffset)getpagesize());
+    NSUInteger const leadingLength = (NSUInteger)(offset - mappedOffset);
+    NSUInteger const length = (NSUInteger)(endOffset - offset);
+    
+    if (length <= NSUIntegerMax - leadingLength) {
+        NSUInteger const mappedLength = leadingLength + length;
+        uint8_t *const mappedBytes = mmap(NULL, mappedLength, PROT_READ, MAP_SHARED, self.fileDescriptor, (off_t)mappedOffset);
+        if (mappedBytes != MAP_FAILED) {
+            return [[NSData alloc] initWithBytesNoCopy:(mappedBytes + leadingLength) length:length deallocator:^(void *bytes, NSUInteger bytesLength) {
+                munmap(mappedBytes, mappedLength);
+            }];
+        }
+    }
+    
+    [self seekToFileOffset:offset];
+    return [self readDataOfLength:length];
+}
+
+/// Walks forward from offset through up to maximumBlockCount intact data blocks, appending the offset of each to blockOffsets (if provided). When a block is damaged, skips ahead to the next intact block whose sequence number isn't lower than that of the last intact block. Returns the number of blocks walked, passing back the offset of the last of them and the offset at which it ends (or offset itself if none were found).
+- (NSUInteger)_ARK_walkDataBlocksFromOffset:(ARKFileOffset)offset maximumBlockCount:(NSUInteger)maximumBlockCount blockOffsets:(nullable NSMutableData *)blockOffsets lastBlockOffset:(nullable ARKFileOffset *)lastBlockOffset endOffset:(nonnull ARKFileOffset *)endOffset;
+{
+    *endOffset = offset;
+    
+    // Positions within contents are relative to offset.
+    NSData *const contents = [self _ARK_contentsOfFileFromOffset:offset];
+    NSUInteger const length = contents.length;
+    if (length == 0) {
+        return 0;
+    }
+    
+    uint8_t const *const bytes = contents.bytes;
+    NSUInteger position = 0;
+    NSUInteger blockCount = 0;
+    uint64_t minimumSequenceNumber = 0;
+    
+    while (blockCount < maximumBlockCount && position < length) {
+        NSUInteger dataLength = 0;
+        uint64_t sequenceNumber = 0;
+        
+        if (!ARKValidateDataBlock(bytes + position, length - position, &dataLength, &sequenceNumber) || sequenceNumber < minimumSequenceNumber) {
+            NSUInteger const nextPosition = ARKOffsetOfNextIntactDataBlock(bytes, length, position + 1, minimumSequenceNumber);
+            if (nextPosition == NSNotFound) {
+                // Whatever remains is a partially written block, or damaged beyond recovery.
+                break;
+            }
+            
+            NSLog(@"ERROR: -[%@ %@] skipping %@ damaged bytes at offset %@ of %@.",
+                  NSStringFromClass([self class]), NSStringFromSelector(_cmd),
+                  @(nextPosition - position), @(offset + position), @(offset + length));
+            
+            position = nextPosition;
+            continue;
+        }
+        
+        ARKFileOffset const blockOffset = offset + position;
+        [blockOffsets appendBytes:&blockOffset length:sizeof(ARKFileOffset)];
+        if (lastBlockOffset != NULL) {
+            *lastBlockOffset = blockOffset;
+        }
+        
+        blockCount++;
+        minimumSequenceNumber = sequenceNumber;
+        position += ARKDataBlockHeaderSize + dataLength;
+        *endOffset = offset + position;
+    }
+    
+    return blockCount;
 }
 
 @end
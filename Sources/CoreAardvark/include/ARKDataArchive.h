@@ -17,11 +17,56 @@
 @import Foundation;
 
 
+/// The layout of an ARKDataArchive's file.
+typedef NS_ENUM(NSUInteger, ARKDataArchiveFormat) {
+    /// Objects are appended to the end of the file. Once maximumObjectCount is exceeded, the file is rewritten to keep only the newest trimmedObjectCount objects.
+    ARKDataArchiveFormatAppendOnly = 0,
+    
+    /// Objects are written into a fixed-capacity region of the file that wraps around, evicting the oldest objects in place. The file is never rewritten, so every append costs the same regardless of how full the archive is.
+    ARKDataArchiveFormatCircular,
+    
+    /// Objects are appended to the end of the file in compressed frames of up to 64KB of objects each, and trimmed like an append-only archive. Each frame holds the objects written together, so the archive is smallest when appends are grouped (see groupCommitInterval). Frames are trimmed whole, so slightly more or fewer than trimmedObjectCount objects may be kept.
+    ARKDataArchiveFormatCompressed,
+};
+
+
+/// Options for reading a subset of an archive's objects.
+typedef NS_OPTIONS(NSUInteger, ARKDataArchiveReadOptions) {
+    ARKDataArchiveReadOptionsNone = 0,
+    
+    /// Objects are visited, and returned, newest first. Combined with a limit, this reads only as many of the newest objects as are needed.
+    ARKDataArchiveReadOptionsNewestFirst = (1 << 0),
+};
+
+
+@class ARKDataArchiveCursor;
+
+
+/// Implemented by objects that can archive themselves in a compact binary representation, which ARKDataArchive stores in place of a keyed archive. Representations must begin with a tag identifying their format, so that they're never mistaken for keyed archives (which begin with "bplist").
+@protocol ARKDataArchiveRecordCoding <NSSecureCoding>
+
+/// Returns the binary representation of the receiver, or nil if the receiver should be archived with NSKeyedArchiver instead.
+- (nullable NSData *)archiveRecordRepresentation;
+
+/// Returns an object decoded from the binary representation, or nil if the data isn't a binary representation this class understands.
++ (nullable instancetype)objectWithArchiveRecordRepresentation:(nonnull NSData *)data;
+
+@end
+
+
 /// Incrementally persists data to disk. All methods and properties on this class are threadsafe.
 @interface ARKDataArchive : NSObject
 
-/// Creates a file at the supplied URL if necessary, or reads in (and validates) the file if it already exists from a previous run.
-- (nullable instancetype)initWithURL:(nonnull NSURL *)fileURL maximumObjectCount:(NSUInteger)maximumObjectCount trimmedObjectCount:(NSUInteger)trimmedObjectCount NS_DESIGNATED_INITIALIZER;
+/// Creates a file at the supplied URL if necessary, or reads in (and validates) the file if it already exists from a previous run. An existing file written in a different format is migrated, keeping as many of its newest objects as fit. The circularArchiveCapacity is the number of bytes of archived objects (including their framing) a circular archive holds, and is ignored by append-only archives. Circular archives evict objects one at a time as needed rather than trimming down to trimmedObjectCount.
+///
+/// When sharedAcrossProcesses is YES, archives in several processes (such as an app and its extensions, with the file in an App Group container) can append to and read the same file at once. Each operation on the file holds an advisory lock on a companion lock file, and starts by picking up the objects other processes have appended and any trimming they've done, so every object is written whole and read in order. Shared archives must be append-only, and don't persist their block index.
+- (nullable instancetype)initWithURL:(nonnull NSURL *)fileURL maximumObjectCount:(NSUInteger)maximumObjectCount trimmedObjectCount:(NSUInteger)trimmedObjectCount format:(ARKDataArchiveFormat)format circularArchiveCapacity:(unsigned long long)circularArchiveCapacity sharedAcrossProcesses:(BOOL)sharedAcrossProcesses NS_DESIGNATED_INITIALIZER;
+
+/// Creates an archive at the supplied URL that isn't shared across processes.
+- (nullable instancetype)initWithURL:(nonnull NSURL *)fileURL maximumObjectCount:(NSUInteger)maximumObjectCount trimmedObjectCount:(NSUInteger)trimmedObjectCount format:(ARKDataArchiveFormat)format circularArchiveCapacity:(unsigned long long)circularArchiveCapacity;
+
+/// Creates an append-only archive at the supplied URL.
+- (nullable instancetype)initWithURL:(nonnull NSURL *)fileURL maximumObjectCount:(NSUInteger)maximumObjectCount trimmedObjectCount:(NSUInteger)trimmedObjectCount;
 
 - (nonnull instancetype)init NS_UNAVAILABLE;
 + (nonnull instancetype)new NS_UNAVAILABLE;
@@ -32,18 +77,62 @@
 /// The number of objects to keep when trimming down from the maximumObjectCount.
 @property (nonatomic, readonly) NSUInteger trimmedObjectCount;
 
+/// The layout of the archive file.
+@property (nonatomic, readonly) ARKDataArchiveFormat format;
+
+/// The number of bytes available to archived objects in a circular archive. Zero for append-only archives.
+@property (nonatomic, readonly) unsigned long long circularArchiveCapacity;
+
+/// Whether archives in other processes may use the same file.
+@property (nonatomic, readonly) BOOL sharedAcrossProcesses;
+
+/// The longest time, in seconds, that appended objects are held in memory before being written to the file, so that objects appended in quick succession are written together. Reading, clearing, or saving the archive always writes held objects first. Defaults to 0, which writes as soon as the archive is free; objects appended while it is busy are still written together.
+@property (atomic) NSTimeInterval groupCommitInterval;
+
+/// The number of bytes of held objects that causes them to be written without waiting for the groupCommitInterval to elapse. Defaults to 64KB.
+@property (atomic) NSUInteger groupCommitThreshold;
+
 /// The URL of the archive file.
 @property (nonnull, nonatomic, copy, readonly) NSURL *archiveFileURL;
 
-/// Archives the provided object (on the calling thread), and queues appending it to the archive.
+/// Called with the archived data of objects dropped to stay under the maximumObjectCount or circularArchiveCapacity, oldest first, so that resources they refer to can be released. Called on a background queue. Not called when the archive is cleared.
+@property (nullable, atomic, copy) void (^evictedObjectDataHandler)(NSArray<NSData *> * _Nonnull evictedObjectData);
+
+/// Called with the archived data of objects as they're appended, oldest first, so that it can be copied elsewhere before it's written to the file. Called on the thread appending the objects, before the append returns.
+@property (nullable, atomic, copy) void (^appendedObjectDataHandler)(NSArray<NSData *> * _Nonnull appendedObjectData);
+
+/// Archives the provided object (on the calling thread), and queues appending it to the archive. Objects that conform to ARKDataArchiveRecordCoding are archived using their binary representation when they provide one.
 - (void)appendArchiveOfObject:(nonnull id <NSSecureCoding>)object;
 
-/// Reads in all contents of the archive, unarchives each object, and returns them on the main thread.
+/// Archives the provided objects (on the calling thread), and queues appending them to the archive in order as a single write.
+- (void)appendArchivesOfObjects:(nonnull NSArray<id <NSSecureCoding>> *)objects;
+
+/// Queues an operation that passes the archived data of the newest object in the archive (or nil if it's empty) to the handler, then appends the archived object data the handler returns ahead of any objects appended since this was called. The appended data isn't passed to the appendedObjectDataHandler. Handler is called on a background queue.
+- (void)appendObjectDataAfterNewestObjectUsingHandler:(nonnull NSArray<NSData *> * _Nonnull (^)(NSData * _Nullable newestObjectData))handler;
+
+/// Reads in all contents of the archive, unarchives each object, and returns them on the main thread. If objectType conforms to ARKDataArchiveRecordCoding, binary representations are decoded by objectType, and any other records are unarchived with NSKeyedUnarchiver.
 - (void)readObjectsFromArchiveOfType:(nonnull Class)objectType completionHandler:(nonnull void (^)(NSArray * _Nonnull unarchivedObjects))completionHandler;
 
+/// Reads in the objects that pass both filters, stopping once limit objects have been found (pass 0 for no limit), and returns them on the main thread. The recordFilter is called with each object's archived data before it is unarchived, so objects it rejects are never decoded; it should return YES for data it can't judge. The data is only valid for the duration of the call. The objectFilter is called with each unarchived object. Filters are called on a background queue.
+- (void)readObjectsFromArchiveOfType:(nonnull Class)objectType
+                             options:(ARKDataArchiveReadOptions)options
+                               limit:(NSUInteger)limit
+                        recordFilter:(nullable BOOL (^)(NSData * _Nonnull objectData))recordFilter
+                        objectFilter:(nullable BOOL (^)(id _Nonnull object))objectFilter
+                   completionHandler:(nonnull void (^)(NSArray * _Nonnull unarchivedObjects))completionHandler;
+
+/// Returns a cursor that reads the archive's objects in pages of up to pageSize objects, starting from the newest object when options include ARKDataArchiveReadOptionsNewestFirst and from the oldest otherwise. The starting point is fixed when the first page is read. Reading a page only touches the objects on it, no matter how many objects the archive holds.
+- (nonnull ARKDataArchiveCursor *)cursorForObjectsOfType:(nonnull Class)objectType options:(ARKDataArchiveReadOptions)options pageSize:(NSUInteger)pageSize;
+
 /// Empties the archive (but does not remove the file). Completion handler is called on the main queue.
 - (void)clearArchiveWithCompletionHandler:(nullable dispatch_block_t)completionHandler;
 
+/// Removes the archive file (and its index) from the file system, first passing the archived data of every object it holds to the evictedObjectDataHandler. The archive holds no objects afterwards, and should not be used again. Completion handler is called on the main queue.
+- (void)removeArchiveWithCompletionHandler:(nullable dispatch_block_t)completionHandler;
+
+/// Waits for all of the archive's queued operations, including writing held objects, to finish and returns the number of objects it holds.
+- (NSUInteger)countObjectsAndWait;
+
 /// Ensures the archive is persisted on the file system, synchronously if requested.
 - (void)saveArchiveAndWait:(BOOL)wait;
 
@@ -51,3 +140,30 @@
 - (void)saveArchiveWithCompletionHandler:(nullable dispatch_block_t)completionHandler;
 
 @end
+
+
+/// Reads the objects of an ARKDataArchive a page at a time. A cursor keeps its place as objects are appended and trimmed: reading newest first continues with the next older objects until it passes the oldest object in the archive, and reading oldest first picks up where the last page ended, skipping any objects trimmed since. All methods on this class are threadsafe, and pages are read in the order they're requested.
+@interface ARKDataArchiveCursor : NSObject
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
++ (nonnull instancetype)new NS_UNAVAILABLE;
+
+/// The archive the cursor reads from.
+@property (nonnull, nonatomic, readonly) ARKDataArchive *dataArchive;
+
+/// The class of the objects the cursor reads, which is passed to NSKeyedUnarchiver (or decodes binary records, if it conforms to ARKDataArchiveRecordCoding).
+@property (nonnull, nonatomic, readonly) Class objectType;
+
+/// The direction the cursor reads in.
+@property (nonatomic, readonly) ARKDataArchiveReadOptions options;
+
+/// The most objects delivered in each page.
+@property (nonatomic, readonly) NSUInteger pageSize;
+
+/// Reads the next page of objects, in the cursor's order, and calls the completion handler on the provided queue. Objects that can't be unarchived are left out, so a page may be short even when there's more to read. hasMoreObjects is NO once the cursor has reached the end of the archive; when reading oldest first, objects appended later can still be read by asking for another page.
+- (void)readNextPageOnQueue:(nonnull NSOperationQueue *)queue completionHandler:(nonnull void (^)(NSArray * _Nonnull objects, BOOL hasMoreObjects))completionHandler;
+
+/// Reads the next page of objects like readNextPageOnQueue:completionHandler:, and also passes the number of objects the cursor read on earlier pages that have since been trimmed from the archive. Trimmed objects are always the oldest ones read, so a copy of the objects read so far stays in sync with the archive by dropping that many of its oldest objects and adding the new page.
+- (void)readNextPageAndTrimmedObjectCountOnQueue:(nonnull NSOperationQueue *)queue completionHandler:(nonnull void (^)(NSArray * _Nonnull objects, NSUInteger trimmedObjectCount, BOOL hasMoreObjects))completionHandler;
+
+@end
@@ -25,10 +25,13 @@
 
 @interface ARKDefaultLogFormatter : NSObject <ARKLogFormatter>
 
-/// The string that is prepended to error logs.
-@property (nonnull, nonatomic, copy) NSString *errorLogPrefix;
+/// The string that is prepended to error logs. Atomic, so that it can be changed while logs are being formatted.
+@property (nonnull, atomic, copy) NSString *errorLogPrefix;
 
-/// The string that is prepended to separator logs.
-@property (nonnull, nonatomic, copy) NSString *separatorLogPrefix;
+/// The string that is prepended to separator logs. Atomic, so that it can be changed while logs are being formatted.
+@property (nonnull, atomic, copy) NSString *separatorLogPrefix;
+
+/// Returns YES, since the only mutable state that formatting reads is the atomic prefix properties. A prefix changed during concurrent formatting may be applied to some of the messages being formatted and not others. Returns NO for subclasses, which must override this to opt in to concurrent formatting.
+@property (nonatomic, readonly) BOOL supportsConcurrentFormatting;
 
 @end
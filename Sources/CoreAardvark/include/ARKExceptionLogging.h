@@ -30,3 +30,6 @@ OBJC_EXTERN void ARKDisableLogOnUncaughtException(void);
 
 /// Disables logging uncaught exceptions to the specified log distributor.  Restores the uncaught exception handler set prior to enabling Aardvark exception logging if one was set. Can be called from any thread.
 OBJC_EXTERN void ARKDisableLogOnUncaughtExceptionToLogDistributor(ARKLogDistributor *_Nonnull logDistributor);
+
+/// Forces the logs that every ARKLogStore has recently archived to storage, including logs that haven't yet been written to the store's persisted log file, so that they're recovered the next time the store is opened. Only makes async-signal-safe calls and doesn't wait on any other thread, so it can be called from a signal handler or crash reporter callback.
+OBJC_EXTERN void ARKFlushEmergencyLogBuffers(void);
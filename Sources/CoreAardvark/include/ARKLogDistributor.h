@@ -43,6 +43,15 @@
 /// Returns all instances of `ARKLogStore` that are currently registered as observers on this log distributor.
 @property (nonnull, atomic, copy, readonly) NSSet *logStores;
 
+/// Logs below this level are discarded before they are created. Logs that do not specify a level use ARKLogLevelForLogType(). Defaults to ARKLogLevelDebug.
+@property (atomic) ARKLogLevel minimumLogLevel;
+
+/// Enables or disables logs in the provided category. All categories are enabled by default.
+- (void)setLogsEnabled:(BOOL)enabled forCategory:(ARKLogCategory)category;
+
+/// Returns whether logs of the provided level and category are distributed.
+- (BOOL)logsAreEnabledForLevel:(ARKLogLevel)level category:(ARKLogCategory)category;
+
 /// Retains an object that handles logging. Log observers are sent observeLogMessage: every time a log is appended. Allows for easy logging to third party services (i.e. Crashlytics, Mixpanel, etc).
 - (void)addLogObserver:(nonnull id <ARKLogObserver>)logObserver;
 
@@ -93,4 +102,12 @@ NS_ASSUME_NONNULL_END
 /// Creates a log message and distributes the log to the log observers.
 - (void)logWithType:(ARKLogType)type parameters:(nonnull NSDictionary<NSString *, NSString*> *)parameters format:(nonnull NSString *)format, ... NS_FORMAT_FUNCTION(3,4);
 
+NS_ASSUME_NONNULL_BEGIN
+/// Creates a log message of the provided level and category and distributes the log to the log observers. Logs at ARKLogLevelError are of type ARKLogTypeError.
+- (void)logWithLevel:(ARKLogLevel)level category:(ARKLogCategory)category format:(nonnull NSString *)format arguments:(va_list)argList;
+NS_ASSUME_NONNULL_END
+
+/// Creates a log message of the provided level and category and distributes the log to the log observers.
+- (void)logWithLevel:(ARKLogLevel)level category:(ARKLogCategory)category format:(nonnull NSString *)format, ... NS_FORMAT_FUNCTION(3,4);
+
 @end
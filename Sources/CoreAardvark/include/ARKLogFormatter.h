@@ -27,4 +27,9 @@
 /// Return a string that represents the log.
 - (nonnull NSString *)formattedLogMessage:(nonnull ARKLogMessage *)logMessage;
 
+@optional
+
+/// Return YES if formattedLogMessage: may be called from multiple threads at once, which allows large logs to be formatted in parallel. Treated as NO when not implemented.
+@property (nonatomic, readonly) BOOL supportsConcurrentFormatting;
+
 @end
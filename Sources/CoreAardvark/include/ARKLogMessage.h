@@ -23,6 +23,10 @@
 #endif
 
 
+/// A userInfo key whose value is the encoded representation (such as JPEG or HEIC data) of a log message's image. Observers that persist images, such as ARKLogStore, store this data rather than re-encoding the image as PNG.
+OBJC_EXTERN NSString *const _Nonnull ARKLogMessageImageDataKey;
+
+
 @interface ARKLogMessage : NSObject <NSCopying, NSSecureCoding>
 
 /// Creates an ARKLogMessage with the provided parameters, created at the current date.
@@ -52,6 +56,12 @@
 /// An optional image associated with the log message. Typically used for logs of type `ARKLogTypeScreenshot`.
 @property (nullable, nonatomic, readonly) UIImage *image;
 
+/// Whether the log message has an image, checked without loading or decoding it. Unlike checking image, this is cheap enough to call while scrolling through log messages.
+@property (nonatomic, readonly) BOOL hasImage;
+
+/// The encoded representation of the image as it was logged or stored, such as PNG, JPEG, or HEIC data, or nil if there's no image or it was never encoded. Reading this doesn't decode the image.
+@property (nullable, nonatomic, readonly) NSData *imageData;
+
 /// The type of the log message.
 @property (nonatomic, readonly) ARKLogType type;
 
@@ -30,6 +30,9 @@
 - (void)observeLogMessage:(nonnull ARKLogMessage *)logMessage;
 
 @optional
+/// Called on a background operation queue with logs appended to the log distributor, oldest first. When implemented, this method is called instead of observeLogMessage:, so that a batch of logs can be processed at once.
+- (void)observeLogMessages:(nonnull NSArray<ARKLogMessage *> *)logMessages;
+
 /// Called to indicate that the observer should finish processing any pending logs in preparation for the app execution
 /// terminating. Any asynchronous tasks should be prioritized and completed before calling the completion handler.
 - (void)processAllPendingLogsWithCompletionHandler:(nonnull dispatch_block_t)completionHandler;
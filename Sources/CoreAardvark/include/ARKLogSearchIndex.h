@@ -0,0 +1,44 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import Foundation;
+
+
+@class ARKLogMessage;
+
+
+/// Indexes the text and parameter values of a sequence of log messages for fast, case-insensitive substring search. Log messages are added to the end of the sequence and trimmed from its start, mirroring an ARKLogStore change observer. Indexing and searching happen on a private serial queue, in the order they're requested. All methods on this class are threadsafe.
+@interface ARKLogSearchIndex : NSObject
+
+/// Returns YES if the log message's text or one of its parameter values contains searchString, ignoring case. Search results match exactly the log messages this returns YES for.
++ (BOOL)logMessage:(nonnull ARKLogMessage *)logMessage matchesSearchString:(nonnull NSString *)searchString;
+
+/// The number of log messages in the index, including any still waiting to be indexed.
+@property (readonly) NSUInteger logMessageCount;
+
+/// Adds log messages to the end of the index.
+- (void)appendLogMessages:(nonnull NSArray<ARKLogMessage *> *)logMessages;
+
+/// Removes the oldest logMessageCount log messages from the index.
+- (void)removeOldestLogMessages:(NSUInteger)logMessageCount;
+
+/// Removes all log messages from the index.
+- (void)removeAllLogMessages;
+
+/// Finds the indexed log messages that match searchString, in the order they were added, and calls the completion handler on the main queue. Messages added or removed before this method is called are reflected in the results. Cancelling the returned operation stops the search and keeps the completion handler from being called.
+- (nonnull NSOperation *)searchForLogMessagesMatchingString:(nonnull NSString *)searchString completionHandler:(nonnull void (^)(NSArray<ARKLogMessage *> * _Nonnull matchingLogMessages))completionHandler;
+
+@end
@@ -16,8 +16,10 @@
 
 #if SWIFT_PACKAGE
 #import "ARKLogObserver.h"
+#import "ARKLogTypes.h"
 #else
 #import <CoreAardvark/ARKLogObserver.h>
+#import <CoreAardvark/ARKLogTypes.h>
 #endif
 
 
@@ -30,18 +32,30 @@
 /// Creates an ARKLogStore with persistedLogsFileURL set to the supplied fileName within the application support directory that keeps a maximum of 2000 logs persisted.
 - (nullable instancetype)initWithPersistedLogFileName:(nonnull NSString *)fileName;
 
+/// Creates an ARKLogStore with persistedLogsFileURL set to the supplied file URL. When usesCircularArchive is YES, logs are persisted in a fixed-size file that evicts the oldest log as each new one is added, rather than periodically rewriting the file to trim it. An existing file is migrated to the requested format.
+- (nullable instancetype)initWithPersistedLogFileURL:(nonnull NSURL *)fileURL maximumLogMessageCount:(NSUInteger)maximumLogMessageCount usesCircularArchive:(BOOL)usesCircularArchive NS_DESIGNATED_INITIALIZER;
+
 /// Creates an ARKLogStore with persistedLogsFileURL set to the supplied file URL.
-- (nullable instancetype)initWithPersistedLogFileURL:(nonnull NSURL *)fileURL maximumLogMessageCount:(NSUInteger)maximumLogMessageCount NS_DESIGNATED_INITIALIZER;
+- (nullable instancetype)initWithPersistedLogFileURL:(nonnull NSURL *)fileURL maximumLogMessageCount:(NSUInteger)maximumLogMessageCount;
+
+/// Creates an ARKLogStore with persistedLogsFileURL set to the supplied directory URL, which holds the logs in up to segmentCount segment files rather than in a single file. Logs are appended to the newest segment until it holds its share of the maximumLogMessageCount, at which point it is sealed and a new segment is started; once there are more than segmentCount segments, the oldest is deleted whole rather than trimmed by rewriting it. Each segment is read on its own queue, so sealed segments are read in parallel with each other and with appends, and damage to one segment's file only loses logs from that segment. segmentCount must be at least 2.
+- (nullable instancetype)initWithPersistedLogsDirectoryURL:(nonnull NSURL *)directoryURL maximumLogMessageCount:(NSUInteger)maximumLogMessageCount segmentCount:(NSUInteger)segmentCount NS_DESIGNATED_INITIALIZER;
 
 - (nonnull instancetype)init NS_UNAVAILABLE;
 + (nonnull instancetype)new NS_UNAVAILABLE;
 
-/// Path to the file on disk that contains peristed logs.
+/// Path to the file on disk that contains peristed logs, or to the directory of segment files when segmentCount is nonzero.
 @property (nonnull, nonatomic, copy, readonly) NSURL *persistedLogFileURL;
 
 /// The maximum number of logs retrieveAllLogMessagesWithCompletionHandler: should return. Old messages are trimmed once this limit is hit.
 @property (nonatomic, readonly) NSUInteger maximumLogMessageCount;
 
+/// Whether logs are persisted in a circular archive. Defaults to NO.
+@property (nonatomic, readonly) BOOL usesCircularArchive;
+
+/// The number of segment files logs are persisted in, or zero when logs are persisted in a single file. Defaults to zero.
+@property (nonatomic, readonly) NSUInteger segmentCount;
+
 /// Convenience property that allows bug reporters to prefix logs with the name of the store they came from. Defaults to nil.
 @property (atomic, nonnull, copy) NSString *name;
 
@@ -51,12 +65,29 @@
 /// Controls whether, when printing logs to the console, the name of the log store is included. Defaults to YES.
 @property (atomic) BOOL prefixNameWhenPrintingToConsole;
 
+/// The number of bytes of logged images to keep on disk. Images are stored once in a directory alongside the persistedLogFileURL, no matter how many log messages refer to them, and the oldest images are dropped once this limit is hit. Defaults to 32MB.
+@property (atomic) unsigned long long maximumImageByteCount;
+
 /// Block that allows for filtering logs. Return YES if the receiver should observe the supplied log.
 @property (nullable, atomic, copy) BOOL (^logFilterBlock)(ARKLogMessage * _Nonnull logMessage);
 
 /// Retrieves an array of ARKLogMessage objects. Completion handler is called on the main queue.
 - (void)retrieveAllLogMessagesWithCompletionHandler:(nonnull void (^)(NSArray<ARKLogMessage *> * _Nonnull logMessages))completionHandler;
 
+/// Retrieves the log messages dated between startDate and endDate (inclusive, and unbounded when nil) whose type is in typeMask, up to limit messages (pass 0 for no limit). When newestFirst is YES, the newest matching messages are returned newest first; otherwise the oldest are returned oldest first. Messages are matched on the type and date at the start of their archived record, so the rest of the store is never decoded. Completion handler is called on the main queue.
+- (void)retrieveLogMessagesFromDate:(nullable NSDate *)startDate
+                             toDate:(nullable NSDate *)endDate
+                              types:(ARKLogTypeMask)typeMask
+                              limit:(NSUInteger)limit
+                        newestFirst:(BOOL)newestFirst
+                  completionHandler:(nonnull void (^)(NSArray<ARKLogMessage *> * _Nonnull logMessages))completionHandler;
+
+/// Registers a handler that follows the store's contents as logs are added and trimmed. The handler is called on the main queue, first with every log message in the store and then, as the store changes, with the log messages appended since its last call and the number of the oldest log messages it was passed that have since been trimmed (or cleared). Changes that happen in quick succession are delivered together. Returns an object to pass to removeChangeObserver: when the handler should stop being called.
+- (nonnull id)addChangeObserverWithHandler:(nonnull void (^)(NSArray<ARKLogMessage *> * _Nonnull appendedLogMessages, NSUInteger trimmedLogMessageCount))handler;
+
+/// Stops calling the handler of a change observer returned by addChangeObserverWithHandler:. Once this is called on the main queue, the handler is not called again.
+- (void)removeChangeObserver:(nonnull id)changeObserver;
+
 /// Removes all logs. Completion handler is called on the main queue.
 - (void)clearLogsWithCompletionHandler:(nullable dispatch_block_t)completionHandler;
 
@@ -27,3 +27,46 @@ typedef NS_ENUM(NSUInteger, ARKLogType) {
     /// Marks a log that has a screenshot attached.
     ARKLogTypeScreenshot,
 };
+
+
+/// A set of log types, used to retrieve only the logs of those types.
+typedef NS_OPTIONS(NSUInteger, ARKLogTypeMask) {
+    ARKLogTypeMaskDefault = (1 << ARKLogTypeDefault),
+    ARKLogTypeMaskSeparator = (1 << ARKLogTypeSeparator),
+    ARKLogTypeMaskError = (1 << ARKLogTypeError),
+    ARKLogTypeMaskScreenshot = (1 << ARKLogTypeScreenshot),
+    ARKLogTypeMaskAll = NSUIntegerMax,
+};
+
+
+/// The severity of a log. Log distributors discard logs below their minimumLogLevel.
+typedef NS_ENUM(NSUInteger, ARKLogLevel) {
+    /// Detailed logs that are only useful while debugging.
+    ARKLogLevelDebug,
+    /// Informational logs.
+    ARKLogLevelInfo,
+    /// The level of logs that do not specify one, other than errors.
+    ARKLogLevelDefault,
+    /// The level of logs of type ARKLogTypeError.
+    ARKLogLevelError,
+};
+
+/// The number of log levels.
+#define ARKLogLevelCount (ARKLogLevelError + 1)
+
+
+/// An area of an app whose logs can be enabled or disabled independently. Categories are app-defined values from 0 to 63.
+typedef NSUInteger ARKLogCategory;
+
+/// The category of logs that do not specify one.
+static ARKLogCategory const ARKLogCategoryDefault = 0;
+
+/// The number of log categories.
+#define ARKLogCategoryCount 64
+
+
+/// Returns the level of logs of the provided type that do not specify one.
+NS_INLINE ARKLogLevel ARKLogLevelForLogType(ARKLogType type)
+{
+    return (type == ARKLogTypeError) ? ARKLogLevelError : ARKLogLevelDefault;
+}
@@ -21,7 +21,44 @@
 #endif
 
 
-/// Logs a log with default type to the default log distributor.
+/// Log statements below this level are removed at compile time from the ARKLogAtLevel(), ARKLogDebug(), and ARKLogInfo() macros.
+/// Define it in a release build's preprocessor flags, for example `ARK_LOG_MINIMUM_LEVEL=ARKLogLevelDefault`, to strip debug and info logs.
+#ifndef ARK_LOG_MINIMUM_LEVEL
+#define ARK_LOG_MINIMUM_LEVEL ARKLogLevelDebug
+#endif
+
+
+/// A mask of the enabled categories for each log level on the default log distributor. Maintained by ARKLogDistributor; read it through ARKLogIsEnabled().
+OBJC_EXTERN uint64_t ARKDefaultLogDistributorEnabledCategoriesByLevel[ARKLogLevelCount];
+
+/// Returns whether the default log distributor distributes logs of the provided level and category. When both are constants, this compiles to a single load and branch.
+NS_INLINE BOOL ARKLogIsEnabled(ARKLogLevel level, ARKLogCategory category)
+{
+    return ((NSInteger)level >= (NSInteger)ARK_LOG_MINIMUM_LEVEL
+            && level < ARKLogLevelCount
+            && category < ARKLogCategoryCount
+            && ((__atomic_load_n(&ARKDefaultLogDistributorEnabledCategoriesByLevel[level], __ATOMIC_RELAXED) >> category) & 1));
+}
+
+/// Logs to the default log distributor at the provided level and category. Neither the format nor its arguments are evaluated when the level or category is disabled.
+#define ARKLogAtLevel(level, category, format, ...) \
+    do { \
+        if (ARKLogIsEnabled((level), (category))) { \
+            ARKLogWithLevel((level), (category), (format), ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+/// Logs a debug log to the default log distributor. Neither the format nor its arguments are evaluated when debug logs are disabled.
+#define ARKLogDebug(format, ...) ARKLogAtLevel(ARKLogLevelDebug, ARKLogCategoryDefault, format, ##__VA_ARGS__)
+
+/// Logs an informational log to the default log distributor. Neither the format nor its arguments are evaluated when informational logs are disabled.
+#define ARKLogInfo(format, ...) ARKLogAtLevel(ARKLogLevelInfo, ARKLogCategoryDefault, format, ##__VA_ARGS__)
+
+
+/// Logs a log with the provided level and category to the default log distributor. Prefer ARKLogAtLevel(), which skips evaluating its arguments when the log is disabled.
+OBJC_EXTERN void ARKLogWithLevel(ARKLogLevel level, ARKLogCategory category, NSString * _Nonnull format, ...) NS_FORMAT_FUNCTION(3,4);
+
+/// Logs a log with default type to the default log distributor. The text is formatted when a log observer first reads it, rather than on the calling thread.
 OBJC_EXTERN void ARKLog(NSString * _Nonnull format, ...) NS_FORMAT_FUNCTION(1,2);
 
 /// Logs a log with customized type and userInfo to the default log distributor.
@@ -32,6 +32,7 @@ FOUNDATION_EXPORT const unsigned char CoreAardvark_iOSVersionString[];
 #import "ARKLogFormatter.h"
 #import "ARKLogMessage.h"
 #import "ARKLogObserver.h"
+#import "ARKLogSearchIndex.h"
 #import "ARKLogStore.h"
 #import "ARKLogTypes.h"
 #import "ARKExceptionLogging.h"
@@ -45,6 +46,7 @@ FOUNDATION_EXPORT const unsigned char CoreAardvark_iOSVersionString[];
 #import <CoreAardvark/ARKLogFormatter.h>
 #import <CoreAardvark/ARKLogMessage.h>
 #import <CoreAardvark/ARKLogObserver.h>
+#import <CoreAardvark/ARKLogSearchIndex.h>
 #import <CoreAardvark/ARKLogStore.h>
 #import <CoreAardvark/ARKLogTypes.h>
 #import <CoreAardvark/ARKExceptionLogging.h>
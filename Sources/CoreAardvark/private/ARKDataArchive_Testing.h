@@ -27,6 +27,8 @@
 
 @property (nonatomic, readonly) NSFileHandle *fileHandle;
 
+@property (nonatomic, copy, readonly) NSURL *blockIndexFileURL;
+
 - (void)waitUntilAllOperationsAreFinished;
 
 @end
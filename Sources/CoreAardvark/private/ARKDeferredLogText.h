@@ -0,0 +1,33 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import Foundation;
+
+
+/// The format and arguments of a log, captured on the logging thread so that its text can be formatted later, on another thread, and only if the text is read.
+@interface ARKDeferredLogText : NSObject
+
+/// Captures the arguments described by format. Returns nil without reading argList if format uses a conversion that cannot be captured, such as positional or `*` arguments.
+/// String and immutable value arguments are kept to be formatted later; any other object is described immediately, since it may change or may not be safe to describe on another thread.
+- (nullable instancetype)initWithFormat:(nonnull NSString *)format arguments:(va_list)argList NS_FORMAT_FUNCTION(1,0) NS_DESIGNATED_INITIALIZER;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
++ (nonnull instancetype)new NS_UNAVAILABLE;
+
+/// The formatted text. Formatted the first time it is read, from any thread.
+@property (nonnull, nonatomic, readonly) NSString *text;
+
+@end
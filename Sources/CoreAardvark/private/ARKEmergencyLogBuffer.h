@@ -0,0 +1,44 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import Foundation;
+
+
+/// A fixed-size file, mapped into memory, that holds copies of the most recently appended records, overwriting the oldest records as it fills. Records are copied into the mapping as they're appended, so they're in the file as soon as the append returns, even if the process is killed before they're written anywhere else; ARKFlushEmergencyLogBuffers() forces them to storage from a crash handler. All methods and properties on this class are threadsafe.
+@interface ARKEmergencyLogBuffer : NSObject
+
+/// Opens the buffer in the file at fileURL, creating the file if necessary and keeping the records it holds from a previous run. The capacity is the size of the file in bytes, including each record's header.
+- (nullable instancetype)initWithFileURL:(nonnull NSURL *)fileURL capacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
++ (nonnull instancetype)new NS_UNAVAILABLE;
+
+/// The file holding the buffer.
+@property (nonnull, nonatomic, copy, readonly) NSURL *fileURL;
+
+/// The size of the file in bytes.
+@property (nonatomic, readonly) NSUInteger capacity;
+
+/// Copies the records into the buffer in order, overwriting the oldest records to make room. Records too large to ever fit are skipped.
+- (void)appendRecords:(nonnull NSArray<NSData *> *)records;
+
+/// Returns the intact records in the buffer, oldest first.
+- (nonnull NSArray<NSData *> *)records;
+
+/// Removes every record from the buffer.
+- (void)removeAllRecords;
+
+@end
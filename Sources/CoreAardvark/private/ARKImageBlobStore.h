@@ -0,0 +1,55 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import UIKit;
+
+
+/// Stores images as content-addressed files in a directory, so that archived log messages can refer to an image rather than contain it. Each blob is reference counted, and the oldest blobs are evicted when the store grows past its maximumByteCount. All methods and properties on this class are threadsafe.
+@interface ARKImageBlobStore : NSObject
+
+- (nonnull instancetype)initWithDirectoryURL:(nonnull NSURL *)directoryURL maximumByteCount:(unsigned long long)maximumByteCount NS_DESIGNATED_INITIALIZER;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
++ (nonnull instancetype)new NS_UNAVAILABLE;
+
+/// The directory containing the blobs.
+@property (nonnull, nonatomic, copy, readonly) NSURL *directoryURL;
+
+/// The number of bytes of blobs to keep. When storing an image exceeds this, the oldest blobs are evicted even if they are still referenced.
+@property (atomic) unsigned long long maximumByteCount;
+
+/// The number of bytes of blobs in the store.
+@property (atomic, readonly) unsigned long long byteCount;
+
+/// Stores the PNG representation of image if an identical image isn't already stored, and adds a reference to it. Returns the blob's key, or nil if the image could not be stored.
+- (nullable NSString *)retainBlobWithImage:(nonnull UIImage *)image;
+
+/// Stores already encoded image data, such as a JPEG or HEIC, if identical data isn't already stored, and adds a reference to it. Returns the blob's key, or nil if the data could not be stored.
+- (nullable NSString *)retainBlobWithImageData:(nonnull NSData *)imageData;
+
+/// Removes a reference to each of the blobs. A blob is deleted once no references to it remain.
+- (void)releaseBlobsWithKeys:(nonnull NSArray<NSString *> *)keys;
+
+/// Returns the image stored for key, or nil if its blob has been evicted. Recently loaded images are cached.
+- (nullable UIImage *)imageWithKey:(nonnull NSString *)key scale:(CGFloat)scale;
+
+/// Returns the encoded image data stored for key, as it was stored, or nil if its blob has been evicted.
+- (nullable NSData *)imageDataWithKey:(nonnull NSString *)key;
+
+/// Deletes every blob.
+- (void)removeAllBlobs;
+
+@end
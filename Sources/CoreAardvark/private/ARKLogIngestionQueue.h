@@ -0,0 +1,54 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import UIKit;
+
+#if SWIFT_PACKAGE
+#import "ARKLogTypes.h"
+#else
+#import <CoreAardvark/ARKLogTypes.h>
+#endif
+
+
+@class ARKDeferredLogText;
+@class ARKLogMessage;
+
+
+/// A bounded, lock-free queue of pending log messages. Any number of threads may enqueue concurrently, but only one thread at a time may dequeue. When the ring of pending logs is full, logs spill into a locked overflow list rather than being dropped or blocking the caller, and logs are dequeued in the order each thread enqueued them.
+@interface ARKLogIngestionQueue : NSObject
+
+/// Creates a queue whose ring holds capacity logs. The capacity is rounded up to a power of two.
+- (nonnull instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
++ (nonnull instancetype)new NS_UNAVAILABLE;
+
+/// The number of logs the ring holds before spilling into the overflow list.
+@property (nonatomic, readonly) NSUInteger capacity;
+
+/// Enqueues an existing log message. Returns YES if the caller needs to schedule a drain, which is the case for the first log enqueued after the last call to dequeueLogMessagesWithMaximumCount:.
+- (BOOL)enqueueLogMessage:(nonnull ARKLogMessage *)logMessage;
+
+/// Enqueues the contents of a log message, which is created when it is dequeued with the date it was enqueued. Returns YES if the caller needs to schedule a drain.
+- (BOOL)enqueueLogMessageOfClass:(nonnull Class)logMessageClass text:(nonnull NSString *)text image:(nullable UIImage *)image type:(ARKLogType)type parameters:(nullable NSDictionary<NSString *, NSString *> *)parameters userInfo:(nullable NSDictionary *)userInfo;
+
+/// Enqueues the contents of an ARKLogMessage whose text is formatted when first read. Returns YES if the caller needs to schedule a drain.
+- (BOOL)enqueueLogMessageWithDeferredText:(nonnull ARKDeferredLogText *)deferredText image:(nullable UIImage *)image type:(ARKLogType)type parameters:(nullable NSDictionary<NSString *, NSString *> *)parameters userInfo:(nullable NSDictionary *)userInfo;
+
+/// Dequeues up to maximumCount log messages, oldest first. Must not be called concurrently with itself.
+- (nonnull NSArray<ARKLogMessage *> *)dequeueLogMessagesWithMaximumCount:(NSUInteger)maximumCount;
+
+@end
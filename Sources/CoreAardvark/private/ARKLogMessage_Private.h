@@ -0,0 +1,55 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import Foundation;
+
+#if SWIFT_PACKAGE
+#import "ARKLogMessage.h"
+#else
+#import <CoreAardvark/ARKLogMessage.h>
+#endif
+
+
+@class ARKDeferredLogText;
+@class ARKImageBlobStore;
+
+
+@interface ARKLogMessage (Private)
+
+/// Creates an ARKLogMessage whose text is formatted from deferredText the first time it is read.
+- (nonnull instancetype)initWithDeferredText:(nonnull ARKDeferredLogText *)deferredText
+                                       image:(nullable UIImage *)image
+                                        type:(ARKLogType)type
+                                  parameters:(nullable NSDictionary<NSString *, NSString *> *)parameters
+                                    userInfo:(nullable NSDictionary *)userInfo
+                                        date:(nonnull NSDate *)date;
+
+/// Creates a copy of logMessage whose image is stored in imageBlobStore under imageBlobKey, so that its record refers to the blob rather than containing the image.
+- (nonnull instancetype)initWithLogMessage:(nonnull ARKLogMessage *)logMessage imageBlobKey:(nonnull NSString *)imageBlobKey imageBlobStore:(nonnull ARKImageBlobStore *)imageBlobStore;
+
+/// Returns the imageBlobKey of the log message in a binary archive record, or nil if the record doesn't refer to a blob.
++ (nullable NSString *)imageBlobKeyInArchiveRecordRepresentation:(nonnull NSData *)data;
+
+/// Reads the type and date of the log message from the header of a binary archive record, without decoding the rest of the record. Returns NO if the data isn't a binary record.
++ (BOOL)getType:(nonnull ARKLogType *)type timeIntervalSinceReferenceDate:(nonnull NSTimeInterval *)timeInterval fromArchiveRecordRepresentation:(nonnull NSData *)data;
+
+/// The key of the blob holding the image, if the image is stored out of line.
+@property (nullable, nonatomic, copy, readonly) NSString *imageBlobKey;
+
+/// The store that the image is loaded from when imageBlobKey is set. Decoded log messages must have their store set before their image can be read.
+@property (nullable, atomic) ARKImageBlobStore *imageBlobStore;
+
+@end
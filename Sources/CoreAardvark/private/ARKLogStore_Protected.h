@@ -0,0 +1,31 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import Foundation;
+
+#if SWIFT_PACKAGE
+#import "ARKLogStore.h"
+#else
+#import <CoreAardvark/ARKLogStore.h>
+#endif
+
+
+@interface ARKLogStore (Protected)
+
+/// Whether log messages are copied into an emergency log buffer as they're appended, so that they're recovered on the next launch even if they're never written to the store.
+@property (readonly) BOOL hasEmergencyLogBuffer;
+
+@end
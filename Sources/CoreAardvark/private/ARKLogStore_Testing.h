@@ -15,10 +15,18 @@
 //
 
 @class ARKDataArchive;
+@class ARKEmergencyLogBuffer;
+@class ARKImageBlobStore;
 
 
 @interface ARKLogStore (Private)
 
 @property ARKDataArchive *dataArchive;
 
+@property (readonly) NSArray<ARKDataArchive *> *sealedDataArchives;
+
+@property (readonly) ARKImageBlobStore *imageBlobStore;
+
+@property (readonly) ARKEmergencyLogBuffer *emergencyLogBuffer;
+
 @end
@@ -18,21 +18,55 @@
 
 extern NSUInteger const ARKInvalidDataBlockLength;
 
+/// The number of bytes of header that precede the contents of each data block: a magic number, the length of the contents, a sequence number, and a CRC-32C checksum of the length, the sequence number, and the contents.
+extern NSUInteger const ARKDataBlockHeaderSize;
+
+/// Type convenience.
+typedef unsigned long long ARKFileOffset;
+
+
+/// Returns the CRC-32C (Castagnoli) checksum of length bytes, continuing from the checksum of the bytes that precede them. Pass 0 as the checksum to start.
+extern uint32_t ARKChecksumData(uint32_t checksum, void const * _Nullable bytes, NSUInteger length);
+
+/// Fills in the header of a data block whose dataLength bytes of contents directly follow the header in blockBytes.
+extern void ARKWriteDataBlockHeader(uint8_t * _Nonnull blockBytes, NSUInteger dataLength, uint64_t sequenceNumber);
+
+/// Returns YES if an intact data block starts at blockBytes and ends within availableLength bytes, passing back the length of its contents and its sequence number.
+extern BOOL ARKValidateDataBlock(uint8_t const * _Nonnull blockBytes, NSUInteger availableLength, NSUInteger * _Nullable dataLength, uint64_t * _Nullable sequenceNumber);
+
 
 @interface NSFileHandle (ARKAdditions_Private)
 
-/// Writes the length of dataBlock, and then its contents. Note: this writes (or over-writes) at the current offsetInFile.
-- (void)ARK_writeDataBlock:(nonnull NSData *)dataBlock;
+/// Writes the header of dataBlock, and then its contents, in a single write. Note: this writes (or over-writes) at the current offsetInFile. Returns NO if the write was skipped or failed.
+- (BOOL)ARK_writeDataBlock:(nonnull NSData *)dataBlock sequenceNumber:(uint64_t)sequenceNumber;
+
+/// Writes dataBlock with a sequence number of 0.
+- (BOOL)ARK_writeDataBlock:(nonnull NSData *)dataBlock;
 
 /// Seeks to the end of the file before writing.
 - (void)ARK_appendDataBlock:(nonnull NSData *)dataBlock;
 
-/// Seeks forward from the beginning of the file, and returns blockIndex on success, or the index of the last block it reached without detecting corruption.
+/// Seeks forward from the beginning of the file, and returns blockIndex on success, or the number of intact blocks it found before reaching the end of the file. Damaged blocks are skipped, as by ARK_indexDataBlocksIntoOffsets:, and aren't counted.
 - (NSUInteger)ARK_seekToDataBlockAtIndex:(NSUInteger)blockIndex;
 
-/// Reads the length of the data block, followed by the data itself. Returns nil at the end of the file, and passes back NO if corruption was detected (without changing the current offsetInFile).
+/// Seeks forward from the current offsetInFile, appending the file offset of each intact data block to blockOffsets (as ARKFileOffset values). When a block is damaged, skips ahead to the next intact block whose sequence number isn't lower than that of the last intact block. Returns the number of blocks indexed, leaving the offsetInFile at the end of the last intact block.
+- (NSUInteger)ARK_indexDataBlocksIntoOffsets:(nonnull NSMutableData *)blockOffsets;
+
+/// Reads the header of the data block, followed by the data itself, and verifies its checksum. Returns nil at the end of the file, and passes back NO if corruption was detected (without changing the current offsetInFile).
+- (nullable NSData *)ARK_readDataBlock:(nonnull out BOOL *)success sequenceNumber:(nullable out uint64_t *)sequenceNumber;
+
+/// Reads the data block without passing back its sequence number.
 - (nullable NSData *)ARK_readDataBlock:(nonnull out BOOL *)success;
 
+/// Reads the length of the data block at the specified offset from its header, without reading or verifying its contents. Returns 0 at the end of the file or where the header has been zeroed out, or ARKInvalidDataBlockLength if there's no valid header at the offset. On return, the offsetInFile is positioned at the start of the block's contents.
+- (NSUInteger)ARK_readDataBlockLengthAtOffset:(unsigned long long)offset;
+
+/// Writes raw data at the current offsetInFile, with the same exception handling as ARK_writeDataBlock:. Returns NO if the write was skipped or failed.
+- (BOOL)ARK_writeData:(nonnull NSData *)data;
+
+/// Copies length bytes from sourceOffset to destinationOffset in chunks no larger than maximumChunkSize, correctly handling overlapping ranges. Pass 0 or NSUIntegerMax to impose no limit.
+- (void)ARK_moveDataFromOffset:(unsigned long long)sourceOffset toOffset:(unsigned long long)destinationOffset length:(unsigned long long)length maximumChunkSize:(NSUInteger)maximumChunkSize;
+
 /// Truncates the file from the beginning to the specified offset, moving data in chunks no larger than maximumChunkSize (to constrain the memory usage of the operation, at the expense of more processor and I/O time). Pass 0 or NSUIntegerMax to impose no limit.
 - (void)ARK_truncateFileToOffset:(unsigned long long)offset maximumChunkSize:(NSUInteger)maximumChunkSize;
 
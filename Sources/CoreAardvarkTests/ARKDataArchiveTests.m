@@ -89,6 +89,7 @@
     NSURL *fileURL = [NSURL ARK_fileURLWithApplicationSupportFilename:@"archive.data"];
 
     [[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+    [[NSFileManager defaultManager] removeItemAtURL:[fileURL URLByAppendingPathExtension:@"index"] error:NULL];
 
     self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:8 trimmedObjectCount:5];
 }
@@ -341,6 +342,568 @@
     [self waitForExpectationsWithTimeout:30.0 handler:nil];
 }
 
+- (void)test_initWithURL_recoversObjectsAfterDamagedBlock;
+{
+    // Populate with data.
+    [self.dataArchive appendArchiveOfObject:@[ @1, @2 ]];
+    [self.dataArchive appendArchiveOfObject:@[ @3, @4 ]];
+    [self.dataArchive appendArchiveOfObject:@[ @5, @6 ]];
+
+    // Damage the contents of the middle block, leaving its length intact (flushing the queue first, since we use the fileHandle directly to corrupt the data).
+    [self.dataArchive saveArchiveAndWait:YES];
+    NSFileHandle *fileHandle = self.dataArchive.fileHandle;
+    [fileHandle ARK_seekToDataBlockAtIndex:1];
+    unsigned long long const damagedOffset = fileHandle.offsetInFile + ARKDataBlockHeaderSize + 1;
+    [fileHandle seekToFileOffset:damagedOffset];
+    uint8_t damagedByte = ~*(uint8_t const *)[fileHandle readDataOfLength:1].bytes;
+    [fileHandle seekToFileOffset:damagedOffset];
+    [fileHandle writeData:[NSData dataWithBytes:&damagedByte length:1]];
+
+    // Reload from scratch, re-indexing the archive rather than trusting the index persisted before the damage.
+    [[NSFileManager defaultManager] removeItemAtURL:self.dataArchive.blockIndexFileURL error:NULL];
+    NSURL *fileURL = self.dataArchive.archiveFileURL;
+    self.dataArchive = nil;
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:10 trimmedObjectCount:5];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSArray class] completionHandler:^(NSArray *unarchivedObjects) {
+        NSArray *expectedObjects = @[ @[ @1, @2 ], @[ @5, @6 ] ];
+        XCTAssertEqualObjects(unarchivedObjects, expectedObjects, @"Archive didn't recover the objects after a damaged block.");
+
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+}
+
+- (void)test_initWithURL_continuesSequenceNumbersOfOldestBlock;
+{
+    [self.dataArchive appendArchiveOfObject:@1];
+    [self.dataArchive appendArchiveOfObject:@2];
+    [self.dataArchive appendArchiveOfObject:@3];
+
+    // Drop the oldest block the way trimming does, which leaves the remaining blocks numbered 1 and 2.
+    [self.dataArchive saveArchiveAndWait:YES];
+    NSFileHandle *fileHandle = self.dataArchive.fileHandle;
+    [fileHandle ARK_seekToDataBlockAtIndex:1];
+    [fileHandle ARK_truncateFileToOffset:fileHandle.offsetInFile maximumChunkSize:0];
+
+    NSURL *fileURL = self.dataArchive.archiveFileURL;
+    self.dataArchive = nil;
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:10 trimmedObjectCount:5];
+    [self.dataArchive appendArchiveOfObject:@4];
+    [self.dataArchive saveArchiveAndWait:YES];
+
+    NSMutableArray *sequenceNumbers = [NSMutableArray new];
+    fileHandle = self.dataArchive.fileHandle;
+    [fileHandle seekToFileOffset:0];
+    while (YES) {
+        BOOL success = NO;
+        uint64_t sequenceNumber = 0;
+        if ([fileHandle ARK_readDataBlock:&success sequenceNumber:&sequenceNumber] == nil) {
+            break;
+        }
+
+        [sequenceNumbers addObject:@(sequenceNumber)];
+    }
+
+    NSArray *expectedSequenceNumbers = @[ @1, @2, @3 ];
+    XCTAssertEqualObjects(sequenceNumbers, expectedSequenceNumbers, @"Re-opened archive didn't number new blocks on from its oldest block.");
+}
+
+- (void)test_initWithURL_rewritesUnchecksummedArchive;
+{
+    NSURL *fileURL = self.dataArchive.archiveFileURL;
+    self.dataArchive = nil;
+
+    // Write blocks framed only by their lengths, as previous versions did.
+    NSMutableData *unchecksummedArchive = [NSMutableData new];
+    for (NSString *string in @[ @"One", @"Two" ]) {
+        NSData *data = [NSKeyedArchiver archivedDataWithRootObject:string requiringSecureCoding:NO error:NULL];
+        uint8_t lengthBytes[] = { 0, 0, (data.length >> 8) & 0xFF, data.length & 0xFF };
+        [unchecksummedArchive appendBytes:lengthBytes length:sizeof(lengthBytes)];
+        [unchecksummedArchive appendData:data];
+    }
+
+    [unchecksummedArchive writeToURL:fileURL atomically:YES];
+
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:10 trimmedObjectCount:5];
+    [self.dataArchive appendArchiveOfObject:@"Three"];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSString class] completionHandler:^(NSArray *unarchivedObjects) {
+        NSArray *expectedObjects = @[ @"One", @"Two", @"Three" ];
+        XCTAssertEqualObjects(unarchivedObjects, expectedObjects, @"Archive didn't read the objects of an unchecksummed archive.");
+
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+
+    // Every block now has a checksummed header.
+    [self.dataArchive saveArchiveAndWait:YES];
+    [self.dataArchive.fileHandle seekToFileOffset:0];
+    XCTAssertEqual([self.dataArchive.fileHandle ARK_indexDataBlocksIntoOffsets:[NSMutableData new]], 3);
+    XCTAssertEqual(self.dataArchive.fileHandle.offsetInFile, [self.dataArchive.fileHandle seekToEndOfFile]);
+}
+
+- (void)test_saveArchive_persistsBlockIndex;
+{
+    NSURL *fileURL = self.dataArchive.archiveFileURL;
+    NSURL *blockIndexFileURL = self.dataArchive.blockIndexFileURL;
+
+    [self.dataArchive appendArchiveOfObject:@"One"];
+    [self.dataArchive appendArchiveOfObject:@"Two"];
+    [self.dataArchive appendArchiveOfObject:@"Three"];
+
+    [self.dataArchive saveArchiveAndWait:YES];
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:blockIndexFileURL.path], @"Saving didn't persist the block index.");
+
+    // Appending makes the persisted index stale, so it should be removed until the next save.
+    [self.dataArchive appendArchiveOfObject:@"Four"];
+    [self.dataArchive waitUntilAllOperationsAreFinished];
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:blockIndexFileURL.path], @"Appending didn't remove the stale block index.");
+
+    [self.dataArchive saveArchiveAndWait:YES];
+    self.dataArchive = nil;
+
+    // Re-opening with a smaller maximum trims using the persisted index.
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:3 trimmedObjectCount:2];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSString class] completionHandler:^(NSArray *unarchivedObjects) {
+        NSArray *expectedObjects = @[ @"Three", @"Four" ];
+        XCTAssertEqualObjects(unarchivedObjects, expectedObjects, @"Re-opened archive didn't trim using the persisted block index!");
+
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+}
+
+- (void)test_initWithURL_ignoresStaleBlockIndex;
+{
+    NSURL *fileURL = self.dataArchive.archiveFileURL;
+    NSURL *blockIndexFileURL = self.dataArchive.blockIndexFileURL;
+
+    [self.dataArchive appendArchiveOfObject:@"One"];
+    [self.dataArchive appendArchiveOfObject:@"Two"];
+    [self.dataArchive saveArchiveAndWait:YES];
+
+    NSData *staleBlockIndexData = [NSData dataWithContentsOfURL:blockIndexFileURL];
+    XCTAssertNotNil(staleBlockIndexData);
+
+    [self.dataArchive appendArchiveOfObject:@"Three"];
+    [self.dataArchive saveArchiveAndWait:YES];
+    self.dataArchive = nil;
+
+    // Put back an index that describes a shorter archive.
+    [staleBlockIndexData writeToURL:blockIndexFileURL atomically:YES];
+
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:10 trimmedObjectCount:5];
+    [self.dataArchive appendArchiveOfObject:@"Four"];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSString class] completionHandler:^(NSArray *unarchivedObjects) {
+        NSArray *expectedObjects = @[ @"One", @"Two", @"Three", @"Four" ];
+        XCTAssertEqualObjects(unarchivedObjects, expectedObjects, @"Re-opened archive trusted a stale block index!");
+
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+}
+
+- (void)test_circularArchive_evictsOldestObjects;
+{
+    NSURL *fileURL = self.dataArchive.archiveFileURL;
+    self.dataArchive = nil;
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:5 trimmedObjectCount:5 format:ARKDataArchiveFormatCircular circularArchiveCapacity:(64 * 1024)];
+
+    for (NSUInteger i = 1; i <= 8; i++) {
+        [self.dataArchive appendArchiveOfObject:@(i)];
+    }
+
+    XCTestExpectation *expectation0 = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSNumber class] completionHandler:^(NSArray *unarchivedObjects) {
+        NSArray *expectedObjects = @[ @4, @5, @6, @7, @8 ];
+        XCTAssertEqualObjects(unarchivedObjects, expectedObjects, @"Circular archive didn't evict the oldest objects!");
+
+        [expectation0 fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+
+    [self.dataArchive saveArchiveAndWait:YES];
+    self.dataArchive = nil;
+
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:5 trimmedObjectCount:5 format:ARKDataArchiveFormatCircular circularArchiveCapacity:(64 * 1024)];
+    [self.dataArchive appendArchiveOfObject:@9];
+
+    XCTestExpectation *expectation1 = [self expectationWithDescription:[NSString stringWithFormat:@"%@-1", NSStringFromSelector(_cmd)]];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSNumber class] completionHandler:^(NSArray *unarchivedObjects) {
+        NSArray *expectedObjects = @[ @5, @6, @7, @8, @9 ];
+        XCTAssertEqualObjects(unarchivedObjects, expectedObjects, @"Re-opened circular archive didn't have expected objects!");
+
+        [expectation1 fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+}
+
+- (void)test_circularArchive_wrapsAroundWhenFull;
+{
+    NSURL *fileURL = self.dataArchive.archiveFileURL;
+    self.dataArchive = nil;
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:0 trimmedObjectCount:0 format:ARKDataArchiveFormatCircular circularArchiveCapacity:2048];
+
+    NSMutableArray *appendedObjects = [NSMutableArray new];
+    for (NSUInteger i = 0; i < 100; i++) {
+        NSString *object = [NSString stringWithFormat:@"Object %@", @(i)];
+        [appendedObjects addObject:object];
+        [self.dataArchive appendArchiveOfObject:object];
+    }
+
+    __block NSArray *wrappedObjects = nil;
+    XCTestExpectation *expectation0 = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSString class] completionHandler:^(NSArray *unarchivedObjects) {
+        XCTAssertGreaterThan(unarchivedObjects.count, 1);
+        XCTAssertLessThan(unarchivedObjects.count, appendedObjects.count, @"Circular archive didn't evict objects once it filled up!");
+
+        NSArray *newestObjects = [appendedObjects subarrayWithRange:NSMakeRange(appendedObjects.count - unarchivedObjects.count, unarchivedObjects.count)];
+        XCTAssertEqualObjects(unarchivedObjects, newestObjects, @"Circular archive didn't keep the newest objects in order!");
+
+        wrappedObjects = unarchivedObjects;
+        [expectation0 fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+
+    [self.dataArchive saveArchiveAndWait:YES];
+    self.dataArchive = nil;
+
+    unsigned long long fileSize = [[[NSFileManager defaultManager] attributesOfItemAtPath:fileURL.path error:NULL] fileSize];
+    XCTAssertLessThanOrEqual(fileSize, 2048 + 64, @"Circular archive grew beyond its capacity!");
+
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:0 trimmedObjectCount:0 format:ARKDataArchiveFormatCircular circularArchiveCapacity:2048];
+
+    XCTestExpectation *expectation1 = [self expectationWithDescription:[NSString stringWithFormat:@"%@-1", NSStringFromSelector(_cmd)]];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSString class] completionHandler:^(NSArray *unarchivedObjects) {
+        XCTAssertEqualObjects(unarchivedObjects, wrappedObjects, @"Re-opened circular archive didn't have expected objects!");
+
+        [expectation1 fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+}
+
+- (void)test_circularArchive_migratesAppendOnlyArchive;
+{
+    NSURL *fileURL = self.dataArchive.archiveFileURL;
+
+    [self.dataArchive appendArchiveOfObject:@"One"];
+    [self.dataArchive appendArchiveOfObject:@"Two"];
+    [self.dataArchive appendArchiveOfObject:@"Three"];
+    [self.dataArchive appendArchiveOfObject:@"Four"];
+
+    [self.dataArchive saveArchiveAndWait:YES];
+    self.dataArchive = nil;
+
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:3 trimmedObjectCount:3 format:ARKDataArchiveFormatCircular circularArchiveCapacity:(64 * 1024)];
+    [self.dataArchive appendArchiveOfObject:@"Five"];
+
+    XCTestExpectation *expectation0 = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSString class] completionHandler:^(NSArray *unarchivedObjects) {
+        NSArray *expectedObjects = @[ @"Three", @"Four", @"Five" ];
+        XCTAssertEqualObjects(unarchivedObjects, expectedObjects, @"Migrated circular archive didn't have expected objects!");
+
+        [expectation0 fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+
+    [self.dataArchive saveArchiveAndWait:YES];
+    self.dataArchive = nil;
+
+    // Opening the file as an append-only archive again migrates it back.
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:10 trimmedObjectCount:5];
+    [self.dataArchive appendArchiveOfObject:@"Six"];
+
+    XCTestExpectation *expectation1 = [self expectationWithDescription:[NSString stringWithFormat:@"%@-1", NSStringFromSelector(_cmd)]];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSString class] completionHandler:^(NSArray *unarchivedObjects) {
+        NSArray *expectedObjects = @[ @"Three", @"Four", @"Five", @"Six" ];
+        XCTAssertEqualObjects(unarchivedObjects, expectedObjects, @"Append-only archive migrated from a circular archive didn't have expected objects!");
+
+        [expectation1 fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+}
+
+- (void)test_readObjectsFromArchive_filtersAndLimitsNewestFirst;
+{
+    [self.dataArchive appendArchivesOfObjects:@[ @1, @2, @3, @4, @5, @6, @7 ]];
+
+    __block NSUInteger recordFilterCallCount = 0;
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSNumber class] options:ARKDataArchiveReadOptionsNewestFirst limit:2 recordFilter:^BOOL(NSData *objectData) {
+        recordFilterCallCount++;
+        return YES;
+    } objectFilter:^BOOL(NSNumber *number) {
+        return (number.integerValue % 2 == 1);
+    } completionHandler:^(NSArray *unarchivedObjects) {
+        NSArray *expectedObjects = @[ @7, @5 ];
+        XCTAssertEqualObjects(unarchivedObjects, expectedObjects, @"Archive didn't return the newest matching objects!");
+        XCTAssertEqual(recordFilterCallCount, 3, @"Archive read past the newest matching objects!");
+
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+}
+
+- (void)test_cursor_readsPagesNewestFirst;
+{
+    [self.dataArchive appendArchivesOfObjects:@[ @1, @2, @3, @4, @5, @6, @7 ]];
+
+    ARKDataArchiveCursor *cursor = [self.dataArchive cursorForObjectsOfType:[NSNumber class] options:ARKDataArchiveReadOptionsNewestFirst pageSize:3];
+    NSArray *expectedPages = @[ @[ @7, @6, @5 ], @[ @4, @3, @2 ], @[ @1 ] ];
+
+    [expectedPages enumerateObjectsUsingBlock:^(NSArray *expectedObjects, NSUInteger pageIndex, BOOL *stop) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"%@-%@", NSStringFromSelector(_cmd), @(pageIndex)]];
+        [cursor readNextPageOnQueue:[NSOperationQueue mainQueue] completionHandler:^(NSArray *objects, BOOL hasMoreObjects) {
+            XCTAssertEqualObjects(objects, expectedObjects, @"Cursor didn't read the expected page!");
+            XCTAssertEqual(hasMoreObjects, pageIndex < expectedPages.count - 1, @"Cursor didn't report whether there were more objects!");
+
+            [expectation fulfill];
+        }];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [cursor readNextPageOnQueue:[NSOperationQueue mainQueue] completionHandler:^(NSArray *objects, BOOL hasMoreObjects) {
+        XCTAssertEqual(objects.count, 0, @"Cursor read past the oldest object!");
+        XCTAssertFalse(hasMoreObjects);
+
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+}
+
+- (void)test_cursor_readsAppendedObjectsOldestFirstAcrossTrims;
+{
+    [self.dataArchive appendArchivesOfObjects:@[ @1, @2, @3, @4 ]];
+
+    ARKDataArchiveCursor *cursor = [self.dataArchive cursorForObjectsOfType:[NSNumber class] options:ARKDataArchiveReadOptionsNone pageSize:3];
+
+    XCTestExpectation *expectation0 = [self expectationWithDescription:[NSString stringWithFormat:@"%@-0", NSStringFromSelector(_cmd)]];
+    [cursor readNextPageOnQueue:[NSOperationQueue mainQueue] completionHandler:^(NSArray *objects, BOOL hasMoreObjects) {
+        NSArray *expectedObjects = @[ @1, @2, @3 ];
+        XCTAssertEqualObjects(objects, expectedObjects);
+        XCTAssertTrue(hasMoreObjects);
+
+        [expectation0 fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+
+    // Push the archive past its maximum object count, so that it trims @4 before the cursor gets to it.
+    [self.dataArchive appendArchivesOfObjects:@[ @5, @6, @7, @8, @9 ]];
+
+    XCTestExpectation *expectation1 = [self expectationWithDescription:[NSString stringWithFormat:@"%@-1", NSStringFromSelector(_cmd)]];
+    [cursor readNextPageOnQueue:[NSOperationQueue mainQueue] completionHandler:^(NSArray *objects, BOOL hasMoreObjects) {
+        NSArray *expectedObjects = @[ @5, @6, @7 ];
+        XCTAssertEqualObjects(objects, expectedObjects, @"Cursor didn't skip past the trimmed objects!");
+        XCTAssertTrue(hasMoreObjects);
+
+        [expectation1 fulfill];
+    }];
+
+    XCTestExpectation *expectation2 = [self expectationWithDescription:[NSString stringWithFormat:@"%@-2", NSStringFromSelector(_cmd)]];
+    [cursor readNextPageOnQueue:[NSOperationQueue mainQueue] completionHandler:^(NSArray *objects, BOOL hasMoreObjects) {
+        NSArray *expectedObjects = @[ @8, @9 ];
+        XCTAssertEqualObjects(objects, expectedObjects);
+        XCTAssertFalse(hasMoreObjects);
+
+        [expectation2 fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+
+    [self.dataArchive appendArchiveOfObject:@10];
+
+    XCTestExpectation *expectation3 = [self expectationWithDescription:[NSString stringWithFormat:@"%@-3", NSStringFromSelector(_cmd)]];
+    [cursor readNextPageOnQueue:[NSOperationQueue mainQueue] completionHandler:^(NSArray *objects, BOOL hasMoreObjects) {
+        NSArray *expectedObjects = @[ @10 ];
+        XCTAssertEqualObjects(objects, expectedObjects, @"Cursor didn't pick up the newly appended object!");
+        XCTAssertFalse(hasMoreObjects);
+
+        [expectation3 fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+}
+
+- (void)test_compressedArchive_trimsWholeFrames;
+{
+    NSURL *fileURL = self.dataArchive.archiveFileURL;
+    self.dataArchive = nil;
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:8 trimmedObjectCount:5 format:ARKDataArchiveFormatCompressed circularArchiveCapacity:0];
+
+    // Write each group separately, so that each is compressed into its own frame.
+    [self.dataArchive appendArchivesOfObjects:@[ @1, @2, @3, @4 ]];
+    [self.dataArchive waitUntilAllOperationsAreFinished];
+    [self.dataArchive appendArchivesOfObjects:@[ @5, @6, @7, @8 ]];
+    [self.dataArchive waitUntilAllOperationsAreFinished];
+    [self.dataArchive appendArchiveOfObject:@9];
+
+    XCTestExpectation *expectation0 = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSNumber class] completionHandler:^(NSArray *unarchivedObjects) {
+        NSArray *expectedObjects = @[ @5, @6, @7, @8, @9 ];
+        XCTAssertEqualObjects(unarchivedObjects, expectedObjects, @"Compressed archive didn't trim its oldest frame!");
+
+        [expectation0 fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+
+    [self.dataArchive saveArchiveAndWait:YES];
+    self.dataArchive = nil;
+
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:8 trimmedObjectCount:5 format:ARKDataArchiveFormatCompressed circularArchiveCapacity:0];
+    [self.dataArchive appendArchiveOfObject:@10];
+
+    XCTestExpectation *expectation1 = [self expectationWithDescription:[NSString stringWithFormat:@"%@-1", NSStringFromSelector(_cmd)]];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSNumber class] completionHandler:^(NSArray *unarchivedObjects) {
+        NSArray *expectedObjects = @[ @5, @6, @7, @8, @9, @10 ];
+        XCTAssertEqualObjects(unarchivedObjects, expectedObjects, @"Re-opened compressed archive didn't have expected objects!");
+
+        [expectation1 fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+}
+
+- (void)test_compressedArchive_isSmallerThanAppendOnlyArchive;
+{
+    NSMutableArray *objects = [NSMutableArray new];
+    for (NSUInteger i = 0; i < 500; i++) {
+        [objects addObject:[NSString stringWithFormat:@"Fetched %@ items from the server in %@ms", @(i), @(i % 7)]];
+    }
+
+    NSURL *fileURL = self.dataArchive.archiveFileURL;
+    self.dataArchive = nil;
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:1000 trimmedObjectCount:500];
+    [self.dataArchive appendArchivesOfObjects:objects];
+    [self.dataArchive saveArchiveAndWait:YES];
+    unsigned long long const appendOnlyFileSize = [[[NSFileManager defaultManager] attributesOfItemAtPath:fileURL.path error:NULL] fileSize];
+    self.dataArchive = nil;
+
+    // Opening the file as a compressed archive migrates its objects into frames.
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:1000 trimmedObjectCount:500 format:ARKDataArchiveFormatCompressed circularArchiveCapacity:0];
+    [self.dataArchive saveArchiveAndWait:YES];
+    unsigned long long const compressedFileSize = [[[NSFileManager defaultManager] attributesOfItemAtPath:fileURL.path error:NULL] fileSize];
+
+    XCTAssertLessThan(compressedFileSize * 3, appendOnlyFileSize, @"Compressed archive wasn't much smaller than the append-only archive!");
+
+    XCTestExpectation *expectation0 = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSString class] completionHandler:^(NSArray *unarchivedObjects) {
+        XCTAssertEqualObjects(unarchivedObjects, objects, @"Migrated compressed archive didn't have expected objects!");
+
+        [expectation0 fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+
+    self.dataArchive = nil;
+
+    // Opening the file as an append-only archive again migrates it back.
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:1000 trimmedObjectCount:500];
+
+    XCTestExpectation *expectation1 = [self expectationWithDescription:[NSString stringWithFormat:@"%@-1", NSStringFromSelector(_cmd)]];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSString class] completionHandler:^(NSArray *unarchivedObjects) {
+        XCTAssertEqualObjects(unarchivedObjects, objects, @"Append-only archive migrated from a compressed archive didn't have expected objects!");
+
+        [expectation1 fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+}
+
+- (void)test_compressedArchive_detectsPartiallyCorruptedArchive;
+{
+    NSURL *fileURL = self.dataArchive.archiveFileURL;
+    self.dataArchive = nil;
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:10 trimmedObjectCount:5 format:ARKDataArchiveFormatCompressed circularArchiveCapacity:0];
+    [self.dataArchive appendArchivesOfObjects:@[ @1, @2 ]];
+    [self.dataArchive waitUntilAllOperationsAreFinished];
+    [self.dataArchive appendArchivesOfObjects:@[ @3, @4 ]];
+
+    // Truncate the file partway into the last frame (flushing the queue first, since we use the fileHandle directly to corrupt the data).
+    [self.dataArchive saveArchiveAndWait:YES];
+    unsigned long long const fileLength = [self.dataArchive.fileHandle seekToEndOfFile];
+    [self.dataArchive.fileHandle truncateFileAtOffset:(fileLength - 2)];
+
+    [self.dataArchive saveArchiveAndWait:YES];
+    self.dataArchive = nil;
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:10 trimmedObjectCount:5 format:ARKDataArchiveFormatCompressed circularArchiveCapacity:0];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSNumber class] completionHandler:^(NSArray *unarchivedObjects) {
+        NSArray *expectedObjects = @[ @1, @2 ];
+        XCTAssertEqualObjects(unarchivedObjects, expectedObjects, @"Compressed archive didn't drop its corrupted frame after re-initialization.");
+
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+}
+
+- (void)test_appendArchiveOfObject_readsCompactAndKeyedLogMessages;
+{
+    NSURL *fileURL = self.dataArchive.archiveFileURL;
+    self.dataArchive = nil;
+
+    // Write a keyed archive, as previous versions did for every log message.
+    ARKLogMessage *keyedLogMessage = [[ARKLogMessage alloc] initWithText:@"Keyed" image:nil type:ARKLogTypeError parameters:@{ @"key" : @"value" } userInfo:nil];
+    NSData *keyedData = [NSKeyedArchiver archivedDataWithRootObject:keyedLogMessage requiringSecureCoding:NO error:NULL];
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForUpdatingURL:fileURL error:NULL];
+    [fileHandle truncateFileAtOffset:0];
+    [fileHandle ARK_appendDataBlock:keyedData];
+    [fileHandle closeFile];
+
+    ARKLogMessage *compactLogMessage = [[ARKLogMessage alloc] initWithText:@"Compact \u00e9\U0001F600" image:nil type:ARKLogTypeSeparator parameters:@{ @"first" : @"1", @"second" : @"two\nlines" } userInfo:@{ @"ignored" : @YES }];
+    NSData *compactData = [(id <ARKDataArchiveRecordCoding>)compactLogMessage archiveRecordRepresentation];
+    XCTAssertNotNil(compactData);
+    XCTAssertLessThan(compactData.length, [NSKeyedArchiver archivedDataWithRootObject:compactLogMessage requiringSecureCoding:NO error:NULL].length);
+    XCTAssertNil([ARKLogMessage objectWithArchiveRecordRepresentation:keyedData], @"Keyed archive mistaken for a binary record!");
+
+    self.dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:8 trimmedObjectCount:5];
+    [self.dataArchive appendArchiveOfObject:compactLogMessage];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.dataArchive readObjectsFromArchiveOfType:[ARKLogMessage class] completionHandler:^(NSArray *unarchivedObjects) {
+        NSArray *expectedObjects = @[ keyedLogMessage, compactLogMessage ];
+        XCTAssertEqualObjects(unarchivedObjects, expectedObjects, @"Archive didn't read both keyed and binary log messages!");
+
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+}
+
 - (void)test_readObjectsFromArchive_excludesFaultyUnarchives;
 {
     XCTestExpectation *expectation0 = [self expectationWithDescription:NSStringFromSelector(_cmd)];
@@ -419,6 +982,149 @@
     [self waitForExpectationsWithTimeout:30.0 handler:nil];
 }
 
+- (void)test_appendedObjectDataHandler_receivesArchivedDataInOrder;
+{
+    NSMutableArray<NSData *> *const appendedObjectData = [NSMutableArray new];
+    self.dataArchive.appendedObjectDataHandler = ^(NSArray<NSData *> *objectData) {
+        [appendedObjectData addObjectsFromArray:objectData];
+    };
+    
+    [self.dataArchive appendArchiveOfObject:@"One"];
+    [self.dataArchive appendArchivesOfObjects:@[ @"Two", @"Three" ]];
+    
+    // The handler is called before the appends return.
+    NSMutableArray *const unarchivedObjects = [NSMutableArray new];
+    for (NSData *objectData in appendedObjectData) {
+        [unarchivedObjects addObject:([NSKeyedUnarchiver unarchivedObjectOfClass:[NSString class] fromData:objectData error:NULL] ?: [NSNull null])];
+    }
+    
+    NSArray *const expectedObjects = @[ @"One", @"Two", @"Three" ];
+    XCTAssertEqualObjects(unarchivedObjects, expectedObjects);
+}
+
+- (void)test_appendObjectDataAfterNewestObject_appendsAheadOfLaterObjects;
+{
+    [self.dataArchive appendArchiveOfObject:@1];
+    [self.dataArchive waitUntilAllOperationsAreFinished];
+
+    NSMutableArray<NSData *> *const appendedObjectData = [NSMutableArray new];
+    self.dataArchive.appendedObjectDataHandler = ^(NSArray<NSData *> *objectData) {
+        [appendedObjectData addObjectsFromArray:objectData];
+    };
+
+    __block NSNumber *newestObject = nil;
+    [self.dataArchive appendObjectDataAfterNewestObjectUsingHandler:^NSArray<NSData *> *(NSData *newestObjectData) {
+        newestObject = [NSKeyedUnarchiver unarchivedObjectOfClass:[NSNumber class] fromData:newestObjectData error:NULL];
+        return @[ [NSKeyedArchiver archivedDataWithRootObject:@2 requiringSecureCoding:YES error:NULL] ];
+    }];
+    [self.dataArchive appendArchiveOfObject:@3];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSNumber class] completionHandler:^(NSArray *unarchivedObjects) {
+        XCTAssertEqualObjects(newestObject, @1);
+
+        NSArray *const expectedObjects = @[ @1, @2, @3 ];
+        XCTAssertEqualObjects(unarchivedObjects, expectedObjects);
+
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+
+    // Only the object appended through appendArchiveOfObject: is reported.
+    XCTAssertEqual(appendedObjectData.count, 1);
+}
+
+- (void)test_removeArchiveWithCompletionHandler_reportsObjectsAndRemovesFiles;
+{
+    NSURL *fileURL = [NSURL ARK_fileURLWithApplicationSupportFilename:@"archive-removal.data"];
+    ARKDataArchive *dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:10 trimmedObjectCount:5];
+    
+    NSMutableArray<NSData *> *const evictedObjectData = [NSMutableArray new];
+    dataArchive.evictedObjectDataHandler = ^(NSArray<NSData *> *objectData) {
+        [evictedObjectData addObjectsFromArray:objectData];
+    };
+    
+    [dataArchive appendArchiveOfObject:@1];
+    [dataArchive appendArchiveOfObject:@2];
+    [dataArchive appendArchiveOfObject:@3];
+    XCTAssertEqual([dataArchive countObjectsAndWait], 3);
+    
+    [dataArchive saveArchiveAndWait:YES];
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:dataArchive.blockIndexFileURL.path]);
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [dataArchive removeArchiveWithCompletionHandler:^{
+        XCTAssertTrue([NSThread isMainThread]);
+        XCTAssertEqual(evictedObjectData.count, 3);
+        XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:fileURL.path]);
+        XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:dataArchive.blockIndexFileURL.path]);
+        
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+    
+    XCTAssertEqual([dataArchive countObjectsAndWait], 0);
+}
+
+- (void)test_sharedArchive_readsObjectsAppendedByOtherArchives;
+{
+    NSURL *const fileURL = [NSURL ARK_fileURLWithApplicationSupportFilename:@"shared-archive.data"];
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+    [[NSFileManager defaultManager] removeItemAtURL:[fileURL URLByAppendingPathExtension:@"lock"] error:NULL];
+    
+    // Each archive opens its own file descriptors, so they coordinate through the lock file just as archives in separate processes do.
+    ARKDataArchive *const appArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:10 trimmedObjectCount:5 format:ARKDataArchiveFormatAppendOnly circularArchiveCapacity:0 sharedAcrossProcesses:YES];
+    ARKDataArchive *const extensionArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:10 trimmedObjectCount:5 format:ARKDataArchiveFormatAppendOnly circularArchiveCapacity:0 sharedAcrossProcesses:YES];
+    XCTAssertTrue(appArchive.sharedAcrossProcesses);
+    
+    [appArchive appendArchiveOfObject:@1];
+    [appArchive waitUntilAllOperationsAreFinished];
+    [extensionArchive appendArchiveOfObject:@2];
+    [extensionArchive waitUntilAllOperationsAreFinished];
+    [appArchive appendArchiveOfObject:@3];
+    
+    XCTAssertEqual([appArchive countObjectsAndWait], 3);
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [extensionArchive readObjectsFromArchiveOfType:[NSNumber class] completionHandler:^(NSArray *unarchivedObjects) {
+        XCTAssertEqualObjects(unarchivedObjects, (@[ @1, @2, @3 ]));
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+}
+
+- (void)test_sharedArchive_picksUpTrimmingByOtherArchives;
+{
+    NSURL *const fileURL = [NSURL ARK_fileURLWithApplicationSupportFilename:@"shared-trimmed-archive.data"];
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+    [[NSFileManager defaultManager] removeItemAtURL:[fileURL URLByAppendingPathExtension:@"lock"] error:NULL];
+    
+    ARKDataArchive *const appArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:4 trimmedObjectCount:2 format:ARKDataArchiveFormatAppendOnly circularArchiveCapacity:0 sharedAcrossProcesses:YES];
+    ARKDataArchive *const extensionArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:4 trimmedObjectCount:2 format:ARKDataArchiveFormatAppendOnly circularArchiveCapacity:0 sharedAcrossProcesses:YES];
+    
+    for (NSUInteger i = 0; i < 4; i++) {
+        [appArchive appendArchiveOfObject:@(i)];
+    }
+    XCTAssertEqual([appArchive countObjectsAndWait], 4);
+    
+    // Going over the maximumObjectCount trims the file out from under the other archive.
+    [extensionArchive appendArchiveOfObject:@4];
+    XCTAssertEqual([extensionArchive countObjectsAndWait], 2);
+    
+    [appArchive appendArchiveOfObject:@5];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [extensionArchive readObjectsFromArchiveOfType:[NSNumber class] completionHandler:^(NSArray *unarchivedObjects) {
+        XCTAssertEqualObjects(unarchivedObjects, (@[ @3, @4, @5 ]));
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+}
+
 - (void)test_saveArchiveWithCompletionHandler_synchronizesFileBeforeCallingCompletionHandler;
 {
     NSURL *fileURL = [NSURL ARK_fileURLWithApplicationSupportFilename:@"archive-synchronizes-before-calling-completion.data"];
@@ -435,6 +1141,35 @@
     [self waitForExpectations:@[expectation] timeout:5];
 }
 
+- (void)test_groupCommitInterval_holdsAppendsUntilSaved;
+{
+    self.dataArchive.groupCommitInterval = 60.0;
+
+    [self.dataArchive appendArchiveOfObject:@1];
+    [self.dataArchive appendArchiveOfObject:@2];
+    [self.dataArchive appendArchiveOfObject:@3];
+
+    NSString *path = self.dataArchive.archiveFileURL.path;
+    XCTAssertEqual([[[NSFileManager defaultManager] attributesOfItemAtPath:path error:NULL] fileSize], 0, @"Appended objects were written before the group commit interval elapsed!");
+
+    [self.dataArchive saveArchiveAndWait:YES];
+    XCTAssertGreaterThan([[[NSFileManager defaultManager] attributesOfItemAtPath:path error:NULL] fileSize], 0, @"Saving didn't write held objects!");
+
+    // Crossing the threshold writes without waiting for the interval.
+    self.dataArchive.groupCommitThreshold = 1;
+    [self.dataArchive appendArchiveOfObject:@4];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.dataArchive readObjectsFromArchiveOfType:[NSNumber class] completionHandler:^(NSArray *unarchivedObjects) {
+        NSArray *expectedObjects = @[ @1, @2, @3, @4 ];
+        XCTAssertEqualObjects(unarchivedObjects, expectedObjects);
+
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+}
+
 #pragma mark - Performance Tests
 
 - (void)test_appendArchiveOfObject_performance;
@@ -509,6 +1244,31 @@
     }];
 }
 
+- (void)test_readObjectsFromArchive_performance;
+{
+    // Start fresh.
+    NSURL *fileURL = [NSURL ARK_fileURLWithApplicationSupportFilename:@"archive-performance.data"];
+    ARKDataArchive *dataArchive = [[ARKDataArchive alloc] initWithURL:fileURL maximumObjectCount:500 trimmedObjectCount:500];
+    [dataArchive.fileHandle truncateFileAtOffset:0];
+    [dataArchive saveArchiveAndWait:YES];
+
+    for (NSUInteger i  = 0; i < dataArchive.maximumObjectCount; i++) {
+        [dataArchive appendArchiveOfObject:[[ARKLogMessage alloc] initWithText:[NSString stringWithFormat:@"%@", @(i)] image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil]];
+    }
+
+    [dataArchive saveArchiveAndWait:YES];
+
+    [self measureBlock:^{
+        XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+        [dataArchive readObjectsFromArchiveOfType:[ARKLogMessage class] completionHandler:^(NSArray *unarchivedObjects) {
+            XCTAssertEqual(unarchivedObjects.count, dataArchive.maximumObjectCount);
+            [expectation fulfill];
+        }];
+
+        [self waitForExpectationsWithTimeout:30.0 handler:nil];
+    }];
+}
+
 - (void)test_initWithURL_performance;
 {
     // Start fresh.
@@ -27,6 +27,14 @@
 #import "ARKLogStore_Testing.h"
 
 
+@interface ARKDefaultLogFormatterTestsSubclass : ARKDefaultLogFormatter
+@end
+
+
+@implementation ARKDefaultLogFormatterTestsSubclass
+@end
+
+
 @interface ARKDefaultLogFormatterTests : XCTestCase
 
 @property (nonatomic) ARKLogDistributor *defaultLogDistributor;
@@ -315,6 +323,12 @@
     [self waitForExpectationsWithTimeout:5.0 handler:nil];
 }
 
+- (void)test_supportsConcurrentFormatting_onlyForDefaultLogFormatter;
+{
+    XCTAssertTrue(self.logFormatter.supportsConcurrentFormatting);
+    XCTAssertFalse([ARKDefaultLogFormatterTestsSubclass new].supportsConcurrentFormatting);
+}
+
 #pragma mark - Performance Tests
 
 - (void)test_formattedLogMessage_performance;
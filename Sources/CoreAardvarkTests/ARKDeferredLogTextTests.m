@@ -0,0 +1,143 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import XCTest;
+
+#import "ARKDeferredLogText.h"
+#import "ARKLogDistributor.h"
+#import "ARKLogDistributor_Protected.h"
+#import "ARKLogMessage.h"
+#import "ARKLogObserver.h"
+
+
+static ARKDeferredLogText *ARKDeferredLogTextWithFormat(NSString *format, ...) NS_FORMAT_FUNCTION(1,2);
+static ARKDeferredLogText *ARKDeferredLogTextWithFormat(NSString *format, ...)
+{
+    va_list argList;
+    va_start(argList, format);
+    ARKDeferredLogText *const deferredText = [[ARKDeferredLogText alloc] initWithFormat:format arguments:argList];
+    va_end(argList);
+    
+    return deferredText;
+}
+
+#define ARKAssertDeferredTextMatchesFormat(format, ...) XCTAssertEqualObjects(ARKDeferredLogTextWithFormat(format, __VA_ARGS__).text, ([NSString stringWithFormat:format, __VA_ARGS__]))
+
+
+@interface ARKDeferredLogTextTestLogObserver : NSObject <ARKLogObserver>
+
+@property (nonatomic, copy) NSMutableArray<ARKLogMessage *> *observedLogs;
+
+@end
+
+
+@implementation ARKDeferredLogTextTestLogObserver
+
+@synthesize logDistributor;
+
+- (instancetype)init;
+{
+    self = [super init];
+    
+    _observedLogs = [NSMutableArray new];
+    
+    return self;
+}
+
+- (void)observeLogMessage:(ARKLogMessage *)logMessage;
+{
+    [self.observedLogs addObject:logMessage];
+}
+
+@end
+
+
+@interface ARKDeferredLogTextTests : XCTestCase
+@end
+
+
+@implementation ARKDeferredLogTextTests
+
+#pragma mark - Behavior Tests
+
+- (void)test_text_matchesEagerFormatting;
+{
+    ARKAssertDeferredTextMatchesFormat(@"No arguments%@", @"");
+    ARKAssertDeferredTextMatchesFormat(@"%d %i %5d %-5d| %+d %05d", -42, 7, 12, 34, 5, -6);
+    ARKAssertDeferredTextMatchesFormat(@"%hhd %hd %hhu %hu", (char)-3, (short)-1234, (unsigned char)200, (unsigned short)60000);
+    ARKAssertDeferredTextMatchesFormat(@"%ld %lu %lld %llu %qd", LONG_MIN, ULONG_MAX, LLONG_MIN, ULLONG_MAX, 9LL);
+    ARKAssertDeferredTextMatchesFormat(@"%zu %zd %td %jd", (size_t)SIZE_MAX, (ssize_t)-1, (ptrdiff_t)-2, (intmax_t)INTMAX_MIN);
+    ARKAssertDeferredTextMatchesFormat(@"%x %X %#x %o %08lx", 255u, 255u, 255u, 8u, 0xABCDUL);
+    ARKAssertDeferredTextMatchesFormat(@"%f %.2f %e %E %g %G %a %lf", 3.14159, 2.71828, 1e10, 1e-10, 0.0001, 123456789.0, 1.0, -0.5);
+    ARKAssertDeferredTextMatchesFormat(@"%c%C %s %.3s %s", 'A', (unichar)0x00E9, "C string", "truncated", (char *)NULL);
+    ARKAssertDeferredTextMatchesFormat(@"%p %@ %@ %@ %@", (void *)0x1234, @"string", @42, nil, @[ @1, @2 ]);
+    ARKAssertDeferredTextMatchesFormat(@"100%% %@%%", @"done");
+}
+
+- (void)test_initWithFormat_returnsNilForArgumentsThatCannotBeCaptured;
+{
+    XCTAssertNil(ARKDeferredLogTextWithFormat(@"%2$@ %1$@", @"first", @"second"));
+    XCTAssertNil(ARKDeferredLogTextWithFormat(@"%*d", 5, 42));
+    XCTAssertNil(ARKDeferredLogTextWithFormat(@"%.*f", 2, 3.14159));
+    XCTAssertNil(ARKDeferredLogTextWithFormat(@"%Lf", (long double)1.0));
+}
+
+- (void)test_text_capturesMutableArgumentsWhenLogged;
+{
+    NSMutableString *const mutableString = [@"before" mutableCopy];
+    NSMutableArray *const mutableArray = [@[ @"before" ] mutableCopy];
+    char cString[] = "before";
+    
+    ARKDeferredLogText *const deferredText = ARKDeferredLogTextWithFormat(@"%@ %@ %s", mutableString, mutableArray, cString);
+    NSString *const expectedText = [NSString stringWithFormat:@"%@ %@ %s", mutableString, mutableArray, cString];
+    
+    [mutableString setString:@"after"];
+    [mutableArray replaceObjectAtIndex:0 withObject:@"after"];
+    strlcpy(cString, "after", sizeof(cString));
+    
+    XCTAssertEqualObjects(deferredText.text, expectedText);
+}
+
+- (void)test_text_readsUnterminatedCStringOnlyUpToPrecision;
+{
+    char const unterminated[4] = { 'a', 'b', 'c', 'd' };
+    
+    ARKDeferredLogText *const deferredText = ARKDeferredLogTextWithFormat(@"%.4s|%.2s|%.s", unterminated, unterminated, unterminated);
+    XCTAssertEqualObjects(deferredText.text, @"abcd|ab|");
+}
+
+- (void)test_logWithFormat_distributesFormattedText;
+{
+    ARKLogDistributor *const logDistributor = [ARKLogDistributor new];
+    ARKDeferredLogTextTestLogObserver *const logObserver = [ARKDeferredLogTextTestLogObserver new];
+    [logDistributor addLogObserver:logObserver];
+    
+    [logDistributor logWithFormat:@"Log %@ of %d", @"one", 2];
+    [logDistributor logWithType:ARKLogTypeError userInfo:@{ @"key" : @"value" } format:@"%s", "Error"];
+    [logDistributor logWithFormat:@"%1$@", @"Positional"];
+    [logDistributor waitUntilAllPendingLogsHaveBeenDistributed];
+    
+    XCTAssertEqual(logObserver.observedLogs.count, 3);
+    XCTAssertEqualObjects(logObserver.observedLogs[0].text, @"Log one of 2");
+    XCTAssertEqualObjects(logObserver.observedLogs[1].text, @"Error");
+    XCTAssertEqual(logObserver.observedLogs[1].type, ARKLogTypeError);
+    XCTAssertEqualObjects(logObserver.observedLogs[1].userInfo, @{ @"key" : @"value" });
+    XCTAssertEqualObjects(logObserver.observedLogs[2].text, @"Positional");
+    
+    [logDistributor removeLogObserver:logObserver];
+}
+
+@end
@@ -0,0 +1,143 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import XCTest;
+
+#import "ARKEmergencyLogBuffer.h"
+#import "ARKExceptionLogging.h"
+#import "NSFileHandle+ARKAdditions.h"
+
+
+/// Room for three records of ten bytes after the file's eight byte header.
+static NSUInteger const ARKEmergencyLogBufferTestsCapacity = (8 + 3 * 30);
+
+
+@interface ARKEmergencyLogBufferTests : XCTestCase
+
+@property (nonatomic) NSURL *fileURL;
+
+@end
+
+
+@implementation ARKEmergencyLogBufferTests
+
+#pragma mark - Setup
+
+- (void)setUp;
+{
+    [super setUp];
+    
+    NSString *const fileName = [NSString stringWithFormat:@"%@-%@", NSStringFromClass([self class]), [NSUUID UUID].UUIDString];
+    self.fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+}
+
+- (void)tearDown;
+{
+    [[NSFileManager defaultManager] removeItemAtURL:self.fileURL error:NULL];
+    
+    [super tearDown];
+}
+
+#pragma mark - Behavior Tests
+
+- (void)test_records_returnsAppendedRecordsInOrder;
+{
+    ARKEmergencyLogBuffer *const emergencyLogBuffer = [[ARKEmergencyLogBuffer alloc] initWithFileURL:self.fileURL capacity:ARKEmergencyLogBufferTestsCapacity];
+    XCTAssertEqualObjects([emergencyLogBuffer records], @[]);
+    
+    [emergencyLogBuffer appendRecords:@[ [self _recordWithNumber:0], [self _recordWithNumber:1] ]];
+    
+    NSArray *const expectedRecords = @[ [self _recordWithNumber:0], [self _recordWithNumber:1] ];
+    XCTAssertEqualObjects([emergencyLogBuffer records], expectedRecords);
+}
+
+- (void)test_appendRecords_overwritesOldestRecordsOnceFull;
+{
+    ARKEmergencyLogBuffer *const emergencyLogBuffer = [[ARKEmergencyLogBuffer alloc] initWithFileURL:self.fileURL capacity:ARKEmergencyLogBufferTestsCapacity];
+    for (NSUInteger i = 0; i < 5; i++) {
+        [emergencyLogBuffer appendRecords:@[ [self _recordWithNumber:i] ]];
+    }
+    
+    NSArray *const expectedRecords = @[ [self _recordWithNumber:2], [self _recordWithNumber:3], [self _recordWithNumber:4] ];
+    XCTAssertEqualObjects([emergencyLogBuffer records], expectedRecords);
+}
+
+- (void)test_appendRecords_skipsRecordsThatCanNeverFit;
+{
+    ARKEmergencyLogBuffer *const emergencyLogBuffer = [[ARKEmergencyLogBuffer alloc] initWithFileURL:self.fileURL capacity:ARKEmergencyLogBufferTestsCapacity];
+    [emergencyLogBuffer appendRecords:@[ [self _recordWithNumber:0], [NSMutableData dataWithLength:ARKEmergencyLogBufferTestsCapacity], [self _recordWithNumber:1] ]];
+    
+    NSArray *const expectedRecords = @[ [self _recordWithNumber:0], [self _recordWithNumber:1] ];
+    XCTAssertEqualObjects([emergencyLogBuffer records], expectedRecords);
+}
+
+- (void)test_initWithFileURL_continuesAfterNewestRecordOfPreviousRun;
+{
+    ARKEmergencyLogBuffer *emergencyLogBuffer = [[ARKEmergencyLogBuffer alloc] initWithFileURL:self.fileURL capacity:ARKEmergencyLogBufferTestsCapacity];
+    for (NSUInteger i = 0; i < 4; i++) {
+        [emergencyLogBuffer appendRecords:@[ [self _recordWithNumber:i] ]];
+    }
+    
+    // Flushing is what a crash handler does before the process goes away.
+    ARKFlushEmergencyLogBuffers();
+    emergencyLogBuffer = nil;
+    
+    // The fourth record wrapped around, so the next record overwrites the second.
+    emergencyLogBuffer = [[ARKEmergencyLogBuffer alloc] initWithFileURL:self.fileURL capacity:ARKEmergencyLogBufferTestsCapacity];
+    NSArray *expectedRecords = @[ [self _recordWithNumber:1], [self _recordWithNumber:2], [self _recordWithNumber:3] ];
+    XCTAssertEqualObjects([emergencyLogBuffer records], expectedRecords);
+    
+    [emergencyLogBuffer appendRecords:@[ [self _recordWithNumber:4] ]];
+    
+    expectedRecords = @[ [self _recordWithNumber:2], [self _recordWithNumber:3], [self _recordWithNumber:4] ];
+    XCTAssertEqualObjects([emergencyLogBuffer records], expectedRecords);
+}
+
+- (void)test_records_skipsDamagedRecord;
+{
+    ARKEmergencyLogBuffer *const emergencyLogBuffer = [[ARKEmergencyLogBuffer alloc] initWithFileURL:self.fileURL capacity:ARKEmergencyLogBufferTestsCapacity];
+    [emergencyLogBuffer appendRecords:@[ [self _recordWithNumber:0], [self _recordWithNumber:1] ]];
+    
+    // Damage the data of the first record, as a crash partway through copying it would.
+    NSFileHandle *const fileHandle = [NSFileHandle fileHandleForUpdatingURL:self.fileURL error:NULL];
+    [fileHandle seekToFileOffset:(8 + ARKDataBlockHeaderSize + 1)];
+    [fileHandle writeData:[@"X" dataUsingEncoding:NSUTF8StringEncoding]];
+    [fileHandle closeFile];
+    
+    XCTAssertEqualObjects([emergencyLogBuffer records], @[ [self _recordWithNumber:1] ]);
+}
+
+- (void)test_removeAllRecords_emptiesFile;
+{
+    ARKEmergencyLogBuffer *emergencyLogBuffer = [[ARKEmergencyLogBuffer alloc] initWithFileURL:self.fileURL capacity:ARKEmergencyLogBufferTestsCapacity];
+    [emergencyLogBuffer appendRecords:@[ [self _recordWithNumber:0], [self _recordWithNumber:1] ]];
+    [emergencyLogBuffer removeAllRecords];
+    XCTAssertEqualObjects([emergencyLogBuffer records], @[]);
+    
+    emergencyLogBuffer = nil;
+    emergencyLogBuffer = [[ARKEmergencyLogBuffer alloc] initWithFileURL:self.fileURL capacity:ARKEmergencyLogBufferTestsCapacity];
+    XCTAssertEqualObjects([emergencyLogBuffer records], @[]);
+}
+
+#pragma mark - Private Methods
+
+/// Returns a ten byte record.
+- (NSData *)_recordWithNumber:(NSUInteger)number;
+{
+    return [[NSString stringWithFormat:@"Record %03lu", (unsigned long)number] dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+@end
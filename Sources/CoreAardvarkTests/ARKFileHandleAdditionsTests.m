@@ -269,6 +269,64 @@
     [self _assert_seekToDataBlockAtIndex:NSUIntegerMax seeksToIndex:0 atFileOffset:offset0];
 }
 
+- (void)test_indexDataBlocksIntoOffsets;
+{
+    // Define these up front for convenience.
+    unsigned long long offset0 = 0;
+    unsigned long long offset1 = offset0 + self.block_6.length;
+    unsigned long long offset2 = offset1 + self.block_9.length;
+    unsigned long long offset3 = offset2 + self.block_7.length;
+    
+    NSMutableData *blockOffsets = [NSMutableData new];
+    XCTAssertEqual([self.fileHandle ARK_indexDataBlocksIntoOffsets:blockOffsets], 0, @"Empty file shouldn't have any blocks.");
+    XCTAssertEqual(blockOffsets.length, 0);
+    
+    [self.fileHandle ARK_appendDataBlock:self.data_6];
+    [self.fileHandle ARK_appendDataBlock:self.data_9];
+    [self.fileHandle ARK_appendDataBlock:self.data_7];
+    
+    [self.fileHandle seekToFileOffset:0];
+    XCTAssertEqual([self.fileHandle ARK_indexDataBlocksIntoOffsets:blockOffsets], 3, @"Didn't index every block.");
+    XCTAssertEqual(self.fileHandle.offsetInFile, offset3, @"Didn't leave the offset at the end of the last block.");
+    
+    unsigned long long expectedOffsets[] = { offset0, offset1, offset2 };
+    XCTAssertEqualObjects(blockOffsets, [NSData dataWithBytes:expectedOffsets length:sizeof(expectedOffsets)], @"Didn't index the expected block offsets.");
+    
+    // Indexing from the middle of the file only appends the remaining blocks.
+    [self.fileHandle seekToFileOffset:offset2];
+    XCTAssertEqual([self.fileHandle ARK_indexDataBlocksIntoOffsets:blockOffsets], 1);
+    XCTAssertEqual(blockOffsets.length, 4 * sizeof(unsigned long long));
+}
+
+- (void)test_indexDataBlocksIntoOffsets_detectsCorruptedData;
+{
+    // Define these up front for convenience.
+    unsigned long long offset1 = self.block_4.length;
+    unsigned long long offset2 = offset1 + self.block_9.length;
+    
+    [self.fileHandle ARK_appendDataBlock:self.data_4];
+    [self.fileHandle ARK_appendDataBlock:self.data_9];
+    [self.fileHandle ARK_appendDataBlock:self.data_6];
+    
+    // Truncate part of the last data block.
+    [self.fileHandle truncateFileAtOffset:(offset2 + 5)];
+    
+    NSMutableData *blockOffsets = [NSMutableData new];
+    [self.fileHandle seekToFileOffset:0];
+    XCTAssertEqual([self.fileHandle ARK_indexDataBlocksIntoOffsets:blockOffsets], 2, @"Indexed a corrupted block.");
+    XCTAssertEqual(self.fileHandle.offsetInFile, offset2, @"Didn't leave the offset at the end of the last valid block.");
+    
+    // Zero out the last length marker, which is not valid in the middle of a file.
+    [self.fileHandle truncateFileAtOffset:offset2];
+    uint8_t zeroBytes[] = { 0, 0, 0, 0, 1 };
+    [self.fileHandle writeData:[NSData dataWithBytes:zeroBytes length:sizeof(zeroBytes)]];
+    
+    [blockOffsets setLength:0];
+    [self.fileHandle seekToFileOffset:0];
+    XCTAssertEqual([self.fileHandle ARK_indexDataBlocksIntoOffsets:blockOffsets], 2, @"Indexed a zero-length block.");
+    XCTAssertEqual(self.fileHandle.offsetInFile, offset2, @"Didn't seek back past the zero-length marker.");
+}
+
 - (void)_assert_readDataBlock_returnsData:(NSData *)expectedData;
 {
     BOOL success = NO;
@@ -323,6 +381,92 @@
     }
 }
 
+- (void)test_checksumData_matchesKnownValues;
+{
+    char const *const digits = "123456789";
+    XCTAssertEqual(ARKChecksumData(0, digits, 9), 0xE3069283);
+    XCTAssertEqual(ARKChecksumData(ARKChecksumData(0, digits, 4), digits + 4, 5), 0xE3069283, @"Checksumming in pieces didn't match checksumming at once.");
+    
+    uint8_t zeroBytes[32] = { };
+    XCTAssertEqual(ARKChecksumData(0, zeroBytes, sizeof(zeroBytes)), 0x8A9136AA);
+    XCTAssertEqual(ARKChecksumData(0, NULL, 0), 0);
+}
+
+- (void)test_readDataBlock_detectsDamagedContents;
+{
+    [self.fileHandle ARK_appendDataBlock:self.data_7];
+    [self.fileHandle ARK_appendDataBlock:self.data_9];
+    
+    // Damage the last byte of the second block, which leaves its length intact.
+    [self _flipByteAtOffset:(self.block_7.length + self.block_9.length - 1)];
+    
+    [self.fileHandle seekToFileOffset:0];
+    [self _assert_readDataBlock_returnsData:self.data_7];
+    
+    BOOL success = YES;
+    XCTAssertNil([self.fileHandle ARK_readDataBlock:&success]);
+    XCTAssertFalse(success, @"ARK_readDataBlock didn't detect a checksum mismatch.");
+    XCTAssertEqual(self.fileHandle.offsetInFile, self.block_7.length, @"ARK_readDataBlock moved the offset after detecting a checksum mismatch.");
+}
+
+- (void)test_readDataBlock_passesBackSequenceNumber;
+{
+    [self.fileHandle ARK_writeDataBlock:self.data_6 sequenceNumber:42];
+    
+    BOOL success = NO;
+    uint64_t sequenceNumber = 0;
+    [self.fileHandle seekToFileOffset:0];
+    XCTAssertEqualObjects([self.fileHandle ARK_readDataBlock:&success sequenceNumber:&sequenceNumber], self.data_6);
+    XCTAssertTrue(success);
+    XCTAssertEqual(sequenceNumber, 42);
+}
+
+- (void)test_indexDataBlocksIntoOffsets_skipsDamagedBlock;
+{
+    // Define these up front for convenience.
+    unsigned long long offset0 = 0;
+    unsigned long long offset1 = offset0 + self.block_4.length;
+    unsigned long long offset2 = offset1 + self.block_9.length;
+    unsigned long long offset3 = offset2 + self.block_6.length;
+    
+    [self.fileHandle ARK_writeDataBlock:self.data_4 sequenceNumber:1];
+    [self.fileHandle ARK_writeDataBlock:self.data_9 sequenceNumber:2];
+    [self.fileHandle ARK_writeDataBlock:self.data_6 sequenceNumber:3];
+    
+    // Damage the contents of the middle block, as a torn write would.
+    [self _flipByteAtOffset:(offset2 - 2)];
+    
+    NSMutableData *blockOffsets = [NSMutableData new];
+    [self.fileHandle seekToFileOffset:0];
+    XCTAssertEqual([self.fileHandle ARK_indexDataBlocksIntoOffsets:blockOffsets], 2, @"Didn't skip past the damaged block.");
+    XCTAssertEqual(self.fileHandle.offsetInFile, offset3, @"Didn't leave the offset at the end of the last intact block.");
+    
+    unsigned long long expectedOffsets[] = { offset0, offset2 };
+    XCTAssertEqualObjects(blockOffsets, [NSData dataWithBytes:expectedOffsets length:sizeof(expectedOffsets)], @"Didn't index the intact blocks.");
+    
+    // Blocks are counted as though the damaged block weren't there.
+    [self _assert_seekToDataBlockAtIndex:1 seeksToIndex:1 atFileOffset:offset2];
+    [self _assert_seekToDataBlockAtIndex:2 seeksToIndex:2 atFileOffset:offset3];
+}
+
+- (void)test_indexDataBlocksIntoOffsets_doesNotSkipToOlderBlock;
+{
+    unsigned long long offset1 = self.block_4.length;
+    unsigned long long offset2 = offset1 + self.block_9.length;
+    
+    [self.fileHandle ARK_writeDataBlock:self.data_4 sequenceNumber:5];
+    [self.fileHandle ARK_writeDataBlock:self.data_9 sequenceNumber:6];
+    [self.fileHandle ARK_writeDataBlock:self.data_6 sequenceNumber:2];
+    
+    // The block after the damaged one is older than the last intact block, so it's stale data rather than a block to recover.
+    [self _flipByteAtOffset:(offset2 - 2)];
+    
+    NSMutableData *blockOffsets = [NSMutableData new];
+    [self.fileHandle seekToFileOffset:0];
+    XCTAssertEqual([self.fileHandle ARK_indexDataBlocksIntoOffsets:blockOffsets], 1, @"Skipped to a block with an older sequence number.");
+    XCTAssertEqual(self.fileHandle.offsetInFile, offset1, @"Didn't leave the offset at the end of the last intact block.");
+}
+
 - (void)_test_truncateFileWithData:(NSData *)data toOffset:(unsigned long long)offset;
 {
     NSData *expectedData = (offset > data.length) ? [NSData data] : [data subdataWithRange:NSMakeRange((NSUInteger)offset, data.length - (NSUInteger)offset)];
@@ -455,12 +599,26 @@
 {
     NSAssert1(data.length > 0 && data.length <= UINT8_MAX, @"Not set up to create data block of size %@", @(data.length));
     
-    uint8_t lengthBytes[] = { 0, 0, 0, data.length };
-    NSMutableData *block = [NSMutableData dataWithBytes:lengthBytes length:4];
+    // The magic, the length, and a sequence number of 0, followed by the checksum of everything after the magic.
+    uint8_t headerBytes[] = { 'A', 'R', 'K', 'B', 0, 0, 0, data.length, 0, 0, 0, 0, 0, 0, 0, 0 };
+    uint32_t checksum = ARKChecksumData(0, headerBytes + 4, sizeof(headerBytes) - 4);
+    checksum = ARKChecksumData(checksum, data.bytes, data.length);
+    uint8_t checksumBytes[] = { checksum >> 24, (checksum >> 16) & 0xFF, (checksum >> 8) & 0xFF, checksum & 0xFF };
     
+    NSMutableData *block = [NSMutableData dataWithBytes:headerBytes length:sizeof(headerBytes)];
+    [block appendBytes:checksumBytes length:sizeof(checksumBytes)];
     [block appendData:data];
     
     return block;
 }
 
+- (void)_flipByteAtOffset:(unsigned long long)offset;
+{
+    [self.fileHandle seekToFileOffset:offset];
+    uint8_t byte = ~*(uint8_t const *)[self.fileHandle readDataOfLength:1].bytes;
+    
+    [self.fileHandle seekToFileOffset:offset];
+    [self.fileHandle writeData:[NSData dataWithBytes:&byte length:1]];
+}
+
 @end
@@ -0,0 +1,161 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import XCTest;
+
+#import "ARKImageBlobStore.h"
+
+
+@interface ARKImageBlobStoreTests : XCTestCase
+
+@property (nonatomic) NSURL *directoryURL;
+
+@end
+
+
+@implementation ARKImageBlobStoreTests
+
+#pragma mark - Setup
+
+- (void)setUp;
+{
+    [super setUp];
+    
+    NSString *const directoryName = [NSString stringWithFormat:@"%@-%@", NSStringFromClass([self class]), [NSUUID UUID].UUIDString];
+    self.directoryURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:directoryName] isDirectory:YES];
+}
+
+- (void)tearDown;
+{
+    [[NSFileManager defaultManager] removeItemAtURL:self.directoryURL error:NULL];
+    
+    [super tearDown];
+}
+
+#pragma mark - Behavior Tests
+
+- (void)test_retainBlobWithImage_storesIdenticalImagesOnce;
+{
+    ARKImageBlobStore *const imageBlobStore = [[ARKImageBlobStore alloc] initWithDirectoryURL:self.directoryURL maximumByteCount:ULLONG_MAX];
+    
+    NSString *const key = [imageBlobStore retainBlobWithImage:[self _imageWithColor:[UIColor redColor]]];
+    unsigned long long const byteCount = imageBlobStore.byteCount;
+    XCTAssertNotNil(key);
+    XCTAssertGreaterThan(byteCount, 0);
+    
+    XCTAssertEqualObjects([imageBlobStore retainBlobWithImage:[self _imageWithColor:[UIColor redColor]]], key);
+    XCTAssertEqual(imageBlobStore.byteCount, byteCount);
+    
+    XCTAssertNotEqualObjects([imageBlobStore retainBlobWithImage:[self _imageWithColor:[UIColor blueColor]]], key);
+    XCTAssertGreaterThan(imageBlobStore.byteCount, byteCount);
+}
+
+- (void)test_releaseBlobsWithKeys_deletesBlobOnceUnreferenced;
+{
+    ARKImageBlobStore *const imageBlobStore = [[ARKImageBlobStore alloc] initWithDirectoryURL:self.directoryURL maximumByteCount:ULLONG_MAX];
+    
+    NSString *const key = [imageBlobStore retainBlobWithImage:[self _imageWithColor:[UIColor redColor]]];
+    [imageBlobStore retainBlobWithImage:[self _imageWithColor:[UIColor redColor]]];
+    
+    [imageBlobStore releaseBlobsWithKeys:@[key]];
+    XCTAssertNotNil([imageBlobStore imageWithKey:key scale:1.0]);
+    
+    [imageBlobStore releaseBlobsWithKeys:@[key]];
+    XCTAssertNil([imageBlobStore imageWithKey:key scale:1.0]);
+    XCTAssertEqual(imageBlobStore.byteCount, 0);
+    
+    // Releasing a blob that no longer exists is ignored.
+    [imageBlobStore releaseBlobsWithKeys:@[key]];
+    XCTAssertEqual(imageBlobStore.byteCount, 0);
+}
+
+- (void)test_retainBlobWithImage_evictsOldestBlobsOverMaximumByteCount;
+{
+    ARKImageBlobStore *const imageBlobStore = [[ARKImageBlobStore alloc] initWithDirectoryURL:self.directoryURL maximumByteCount:ULLONG_MAX];
+    
+    NSString *const redKey = [imageBlobStore retainBlobWithImage:[self _imageWithColor:[UIColor redColor]]];
+    imageBlobStore.maximumByteCount = imageBlobStore.byteCount;
+    
+    NSString *const blueKey = [imageBlobStore retainBlobWithImage:[self _imageWithColor:[UIColor blueColor]]];
+    XCTAssertNil([imageBlobStore imageWithKey:redKey scale:1.0]);
+    XCTAssertNotNil([imageBlobStore imageWithKey:blueKey scale:1.0]);
+}
+
+- (void)test_retainBlobWithImage_evictsLeastRecentlyRetainedBlob;
+{
+    ARKImageBlobStore *const imageBlobStore = [[ARKImageBlobStore alloc] initWithDirectoryURL:self.directoryURL maximumByteCount:ULLONG_MAX];
+    
+    NSString *const redKey = [imageBlobStore retainBlobWithImage:[self _imageWithColor:[UIColor redColor]]];
+    NSString *const blueKey = [imageBlobStore retainBlobWithImage:[self _imageWithColor:[UIColor blueColor]]];
+    
+    // Retaining the red blob again makes the blue blob the first to be evicted. Leave room for the two blobs, but not a third.
+    [imageBlobStore retainBlobWithImage:[self _imageWithColor:[UIColor redColor]]];
+    imageBlobStore.maximumByteCount = imageBlobStore.byteCount + imageBlobStore.byteCount / 4;
+    
+    NSString *const greenKey = [imageBlobStore retainBlobWithImage:[self _imageWithColor:[UIColor greenColor]]];
+    XCTAssertNotNil([imageBlobStore imageWithKey:redKey scale:1.0]);
+    XCTAssertNil([imageBlobStore imageWithKey:blueKey scale:1.0]);
+    XCTAssertNotNil([imageBlobStore imageWithKey:greenKey scale:1.0]);
+}
+
+- (void)test_imageWithKey_loadsBlobsStoredByPreviousStore;
+{
+    ARKImageBlobStore *imageBlobStore = [[ARKImageBlobStore alloc] initWithDirectoryURL:self.directoryURL maximumByteCount:ULLONG_MAX];
+    NSString *const key = [imageBlobStore retainBlobWithImage:[self _imageWithColor:[UIColor redColor]]];
+    unsigned long long const byteCount = imageBlobStore.byteCount;
+    
+    imageBlobStore = [[ARKImageBlobStore alloc] initWithDirectoryURL:self.directoryURL maximumByteCount:ULLONG_MAX];
+    XCTAssertEqual(imageBlobStore.byteCount, byteCount);
+    
+    UIImage *const image = [imageBlobStore imageWithKey:key scale:2.0];
+    XCTAssertNotNil(image);
+    XCTAssertEqual(image.scale, 2.0);
+}
+
+- (void)test_imageWithKey_rejectsKeysOutsideOfStore;
+{
+    ARKImageBlobStore *const imageBlobStore = [[ARKImageBlobStore alloc] initWithDirectoryURL:self.directoryURL maximumByteCount:ULLONG_MAX];
+    
+    XCTAssertNil([imageBlobStore imageWithKey:@"../Manifest" scale:1.0]);
+    XCTAssertNil([imageBlobStore imageWithKey:@"" scale:1.0]);
+}
+
+- (void)test_removeAllBlobs_emptiesStore;
+{
+    ARKImageBlobStore *const imageBlobStore = [[ARKImageBlobStore alloc] initWithDirectoryURL:self.directoryURL maximumByteCount:ULLONG_MAX];
+    NSString *const key = [imageBlobStore retainBlobWithImage:[self _imageWithColor:[UIColor redColor]]];
+    
+    [imageBlobStore removeAllBlobs];
+    
+    XCTAssertEqual(imageBlobStore.byteCount, 0);
+    XCTAssertNil([imageBlobStore imageWithKey:key scale:1.0]);
+}
+
+#pragma mark - Private Methods
+
+- (UIImage *)_imageWithColor:(UIColor *)color;
+{
+    UIGraphicsImageRendererFormat *const format = [UIGraphicsImageRendererFormat preferredFormat];
+    format.scale = 1.0;
+    
+    UIGraphicsImageRenderer *const renderer = [[UIGraphicsImageRenderer alloc] initWithSize:CGSizeMake(8.0, 8.0) format:format];
+    return [renderer imageWithActions:^(UIGraphicsImageRendererContext *context) {
+        [color setFill];
+        [context fillRect:CGRectMake(0.0, 0.0, 8.0, 8.0)];
+    }];
+}
+
+@end
@@ -24,6 +24,7 @@
 #import "ARKDataArchive_Testing.h"
 #import "ARKLogMessage.h"
 #import "ARKLogObserver.h"
+#import "ARKLogging.h"
 #import "ARKLogStore.h"
 #import "ARKLogStore_Testing.h"
 
@@ -67,6 +68,50 @@
 @end
 
 
+@interface ARKTestBatchLogObserver : ARKTestLogObserver
+
+@property (nonatomic) NSUInteger observedBatchCount;
+@property (nonatomic) NSUInteger singleLogObservationCount;
+
+@end
+
+
+@implementation ARKTestBatchLogObserver
+
+- (void)observeLogMessage:(ARKLogMessage *)logMessage;
+{
+    self.singleLogObservationCount++;
+    [super observeLogMessage:logMessage];
+}
+
+- (void)observeLogMessages:(NSArray<ARKLogMessage *> *)logMessages;
+{
+    self.observedBatchCount++;
+    [self.observedLogs addObjectsFromArray:logMessages];
+}
+
+@end
+
+
+@interface ARKCountingLogObserver : NSObject <ARKLogObserver>
+
+@property (nonatomic) NSUInteger observedLogCount;
+
+@end
+
+
+@implementation ARKCountingLogObserver
+
+@synthesize logDistributor;
+
+- (void)observeLogMessage:(ARKLogMessage *)logMessage;
+{
+    self.observedLogCount++;
+}
+
+@end
+
+
 @interface ARKLogMessageTestSubclass : ARKLogMessage
 @end
 
@@ -180,6 +225,113 @@
     [self.logDistributor removeLogObserver:testLogObserver];
 }
 
+- (void)test_addLogObserver_deliversBatchesToObserversImplementingObserveLogMessages;
+{
+    ARKTestBatchLogObserver *const testLogObserver = [ARKTestBatchLogObserver new];
+    [self.logDistributor addLogObserver:testLogObserver];
+    
+    NSUInteger const logCount = 100;
+    for (NSUInteger i  = 0; i < logCount; i++) {
+        [self.logDistributor logWithFormat:@"Log %@", @(i)];
+    }
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.logDistributor distributeAllPendingLogsWithCompletionHandler:^{
+        XCTAssertEqual(testLogObserver.singleLogObservationCount, 0);
+        XCTAssertGreaterThan(testLogObserver.observedBatchCount, 0);
+        XCTAssertLessThanOrEqual(testLogObserver.observedBatchCount, logCount);
+        
+        XCTAssertEqual(testLogObserver.observedLogs.count, logCount);
+        [testLogObserver.observedLogs enumerateObjectsUsingBlock:^(ARKLogMessage *logMessage, NSUInteger idx, BOOL *stop) {
+            XCTAssertEqualObjects(logMessage.text, ([NSString stringWithFormat:@"Log %@", @(idx)]));
+        }];
+        
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+    
+    [self.logDistributor removeLogObserver:testLogObserver];
+}
+
+- (void)test_minimumLogLevel_discardsLogsBelowMinimumLevel;
+{
+    ARKLogDistributor *const logDistributor = [ARKLogDistributor new];
+    ARKTestLogObserver *const testLogObserver = [ARKTestLogObserver new];
+    [logDistributor addLogObserver:testLogObserver];
+    
+    XCTAssertEqual(logDistributor.minimumLogLevel, ARKLogLevelDebug);
+    logDistributor.minimumLogLevel = ARKLogLevelDefault;
+    XCTAssertFalse([logDistributor logsAreEnabledForLevel:ARKLogLevelInfo category:ARKLogCategoryDefault]);
+    XCTAssertTrue([logDistributor logsAreEnabledForLevel:ARKLogLevelDefault category:ARKLogCategoryDefault]);
+    
+    [logDistributor logWithLevel:ARKLogLevelDebug category:ARKLogCategoryDefault format:@"Debug"];
+    [logDistributor logWithLevel:ARKLogLevelInfo category:ARKLogCategoryDefault format:@"Info"];
+    [logDistributor logWithLevel:ARKLogLevelDefault category:ARKLogCategoryDefault format:@"Default"];
+    [logDistributor logWithLevel:ARKLogLevelError category:ARKLogCategoryDefault format:@"Error"];
+    [logDistributor logWithFormat:@"Format"];
+    
+    logDistributor.minimumLogLevel = ARKLogLevelError;
+    [logDistributor logWithFormat:@"Discarded"];
+    [logDistributor logWithText:@"Discarded" image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil];
+    [logDistributor logWithType:ARKLogTypeError userInfo:nil format:@"Error Type"];
+    
+    [logDistributor waitUntilAllPendingLogsHaveBeenDistributed];
+    
+    XCTAssertEqualObjects([testLogObserver.observedLogs valueForKey:@"text"], (@[ @"Default", @"Error", @"Format", @"Error Type" ]));
+    XCTAssertEqual([testLogObserver.observedLogs[1] type], ARKLogTypeError);
+    
+    [logDistributor removeLogObserver:testLogObserver];
+}
+
+- (void)test_setLogsEnabledForCategory_discardsLogsInDisabledCategory;
+{
+    ARKLogDistributor *const logDistributor = [ARKLogDistributor new];
+    ARKTestLogObserver *const testLogObserver = [ARKTestLogObserver new];
+    [logDistributor addLogObserver:testLogObserver];
+    
+    ARKLogCategory const networkingCategory = 3;
+    [logDistributor setLogsEnabled:NO forCategory:networkingCategory];
+    XCTAssertFalse([logDistributor logsAreEnabledForLevel:ARKLogLevelError category:networkingCategory]);
+    XCTAssertTrue([logDistributor logsAreEnabledForLevel:ARKLogLevelDebug category:ARKLogCategoryDefault]);
+    XCTAssertFalse([logDistributor logsAreEnabledForLevel:ARKLogLevelDebug category:ARKLogCategoryCount]);
+    
+    [logDistributor logWithLevel:ARKLogLevelError category:networkingCategory format:@"Discarded"];
+    [logDistributor logWithLevel:ARKLogLevelInfo category:ARKLogCategoryDefault format:@"Kept"];
+    
+    [logDistributor setLogsEnabled:YES forCategory:networkingCategory];
+    [logDistributor logWithLevel:ARKLogLevelInfo category:networkingCategory format:@"Networking"];
+    
+    [logDistributor waitUntilAllPendingLogsHaveBeenDistributed];
+    
+    XCTAssertEqualObjects([testLogObserver.observedLogs valueForKey:@"text"], (@[ @"Kept", @"Networking" ]));
+    
+    [logDistributor removeLogObserver:testLogObserver];
+}
+
+- (void)test_logIsEnabled_reflectsDefaultDistributorAndSkipsArgumentEvaluation;
+{
+    ARKLogDistributor *const defaultDistributor = [ARKLogDistributor defaultDistributor];
+    XCTAssertTrue(ARKLogIsEnabled(ARKLogLevelDebug, ARKLogCategoryDefault));
+    
+    defaultDistributor.minimumLogLevel = ARKLogLevelError;
+    XCTAssertFalse(ARKLogIsEnabled(ARKLogLevelDefault, ARKLogCategoryDefault));
+    XCTAssertTrue(ARKLogIsEnabled(ARKLogLevelError, ARKLogCategoryDefault));
+    
+    __block NSUInteger evaluationCount = 0;
+    NSString *(^evaluateArgument)(void) = ^{
+        evaluationCount++;
+        return @"argument";
+    };
+    ARKLogDebug(@"%@", evaluateArgument());
+    ARKLogInfo(@"%@", evaluateArgument());
+    ARKLogAtLevel(ARKLogLevelDefault, ARKLogCategoryDefault, @"%@", evaluateArgument());
+    XCTAssertEqual(evaluationCount, 0);
+    
+    defaultDistributor.minimumLogLevel = ARKLogLevelDebug;
+    XCTAssertTrue(ARKLogIsEnabled(ARKLogLevelDebug, ARKLogCategoryDefault));
+}
+
 - (void)test_removeLogObserver_removesLogObserver;
 {
     ARKLogDistributor *logDistributor = [ARKLogDistributor new];
@@ -242,6 +394,21 @@
 
 #pragma mark - Performance Tests
 
+- (void)test_logMessage_performanceWithOneObserver;
+{
+    [self _measureLogMessageDistributionWithObserverCount:1];
+}
+
+- (void)test_logMessage_performanceWithFourObservers;
+{
+    [self _measureLogMessageDistributionWithObserverCount:4];
+}
+
+- (void)test_logMessage_performanceWithSixteenObservers;
+{
+    [self _measureLogMessageDistributionWithObserverCount:16];
+}
+
 // This test is disabled because it has been observed to be flaky on CI builds. Specifically, the `tearDown` method
 // times out while trying to clear the log store after running this test.
 - (void)disabled_test_logDistribution_performance;
@@ -267,4 +434,36 @@
     }];
 }
 
+#pragma mark - Private Methods
+
+- (void)_measureLogMessageDistributionWithObserverCount:(NSUInteger)observerCount;
+{
+    // Use a distributor without a log store, so that only the cost of distribution is measured.
+    ARKLogDistributor *const logDistributor = [ARKLogDistributor new];
+    NSMutableArray<ARKCountingLogObserver *> *const logObservers = [NSMutableArray new];
+    for (NSUInteger i  = 0; i < observerCount; i++) {
+        ARKCountingLogObserver *const logObserver = [ARKCountingLogObserver new];
+        [logDistributor addLogObserver:logObserver];
+        [logObservers addObject:logObserver];
+    }
+    
+    NSMutableArray<ARKLogMessage *> *const logMessages = [NSMutableArray new];
+    for (NSUInteger i  = 0; i < 10000; i++) {
+        [logMessages addObject:[[ARKLogMessage alloc] initWithText:[NSString stringWithFormat:@"%@", @(i)] image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil]];
+    }
+    
+    [self measureBlock:^{
+        for (ARKLogMessage *logMessage in logMessages) {
+            [logDistributor logMessage:logMessage];
+        }
+        
+        [logDistributor waitUntilAllPendingLogsHaveBeenDistributed];
+    }];
+    
+    for (ARKCountingLogObserver *logObserver in logObservers) {
+        XCTAssertGreaterThan(logObserver.observedLogCount, 0);
+        [logDistributor removeLogObserver:logObserver];
+    }
+}
+
 @end
@@ -0,0 +1,127 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import XCTest;
+
+#import "ARKLogIngestionQueue.h"
+
+#import "ARKLogMessage.h"
+
+
+@interface ARKLogIngestionQueueTests : XCTestCase
+@end
+
+
+@implementation ARKLogIngestionQueueTests
+
+#pragma mark - Behavior Tests
+
+- (void)test_initWithCapacity_roundsCapacityUpToPowerOfTwo;
+{
+    XCTAssertEqual([[ARKLogIngestionQueue alloc] initWithCapacity:0].capacity, 2);
+    XCTAssertEqual([[ARKLogIngestionQueue alloc] initWithCapacity:5].capacity, 8);
+    XCTAssertEqual([[ARKLogIngestionQueue alloc] initWithCapacity:1024].capacity, 1024);
+}
+
+- (void)test_enqueueLogMessage_requestsDrainOnlyOncePerDequeue;
+{
+    ARKLogIngestionQueue *const ingestionQueue = [[ARKLogIngestionQueue alloc] initWithCapacity:8];
+    ARKLogMessage *const logMessage = [[ARKLogMessage alloc] initWithText:@"log" image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil];
+    
+    XCTAssertTrue([ingestionQueue enqueueLogMessage:logMessage]);
+    XCTAssertFalse([ingestionQueue enqueueLogMessage:logMessage]);
+    
+    XCTAssertEqual([ingestionQueue dequeueLogMessagesWithMaximumCount:NSUIntegerMax].count, 2);
+    XCTAssertTrue([ingestionQueue enqueueLogMessage:logMessage]);
+}
+
+- (void)test_dequeueLogMessagesWithMaximumCount_preservesOrderBeyondCapacity;
+{
+    ARKLogIngestionQueue *const ingestionQueue = [[ARKLogIngestionQueue alloc] initWithCapacity:4];
+    for (NSUInteger i = 0; i < 10; i++) {
+        [ingestionQueue enqueueLogMessageOfClass:[ARKLogMessage class] text:[NSString stringWithFormat:@"%@", @(i)] image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil];
+    }
+    
+    NSMutableArray *const dequeuedText = [NSMutableArray new];
+    NSArray<ARKLogMessage *> *logMessages = nil;
+    while ((logMessages = [ingestionQueue dequeueLogMessagesWithMaximumCount:3]).count > 0) {
+        XCTAssertLessThanOrEqual(logMessages.count, 3);
+        for (ARKLogMessage *logMessage in logMessages) {
+            [dequeuedText addObject:logMessage.text];
+        }
+    }
+    
+    XCTAssertEqualObjects(dequeuedText, (@[ @"0", @"1", @"2", @"3", @"4", @"5", @"6", @"7", @"8", @"9" ]));
+}
+
+- (void)test_enqueueLogMessageOfClass_datesLogMessageWhenEnqueued;
+{
+    ARKLogIngestionQueue *const ingestionQueue = [[ARKLogIngestionQueue alloc] initWithCapacity:4];
+    NSDate *const dateBeforeEnqueue = [NSDate date];
+    [ingestionQueue enqueueLogMessageOfClass:[ARKLogMessage class] text:@"log" image:nil type:ARKLogTypeError parameters:@{ @"key" : @"value" } userInfo:nil];
+    NSDate *const dateAfterEnqueue = [NSDate date];
+    
+    [NSThread sleepForTimeInterval:0.1];
+    
+    ARKLogMessage *const logMessage = [ingestionQueue dequeueLogMessagesWithMaximumCount:NSUIntegerMax].firstObject;
+    XCTAssertEqualObjects(logMessage.text, @"log");
+    XCTAssertEqual(logMessage.type, ARKLogTypeError);
+    XCTAssertEqualObjects(logMessage.parameters, @{ @"key" : @"value" });
+    XCTAssertGreaterThanOrEqual(logMessage.date.timeIntervalSinceReferenceDate, dateBeforeEnqueue.timeIntervalSinceReferenceDate);
+    XCTAssertLessThanOrEqual(logMessage.date.timeIntervalSinceReferenceDate, dateAfterEnqueue.timeIntervalSinceReferenceDate);
+}
+
+- (void)test_enqueueLogMessage_concurrentProducersPreservePerThreadOrder;
+{
+    NSUInteger const producerCount = 8;
+    NSUInteger const logsPerProducer = 2000;
+    ARKLogIngestionQueue *const ingestionQueue = [[ARKLogIngestionQueue alloc] initWithCapacity:64];
+    
+    NSMutableArray<ARKLogMessage *> *const dequeuedLogMessages = [NSMutableArray new];
+    __block BOOL producersFinished = NO;
+    dispatch_semaphore_t const consumerFinished = dispatch_semaphore_create(0);
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        while (YES) {
+            BOOL const finished = __atomic_load_n(&producersFinished, __ATOMIC_ACQUIRE);
+            NSArray<ARKLogMessage *> *const logMessages = [ingestionQueue dequeueLogMessagesWithMaximumCount:100];
+            [dequeuedLogMessages addObjectsFromArray:logMessages];
+            if (finished && logMessages.count == 0) {
+                break;
+            }
+        }
+        dispatch_semaphore_signal(consumerFinished);
+    });
+    
+    dispatch_apply(producerCount, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t producer) {
+        for (NSUInteger i = 0; i < logsPerProducer; i++) {
+            [ingestionQueue enqueueLogMessageOfClass:[ARKLogMessage class] text:[NSString stringWithFormat:@"%@", @(i)] image:nil type:ARKLogTypeDefault parameters:@{} userInfo:@{ @"producer" : @(producer) }];
+        }
+    });
+    __atomic_store_n(&producersFinished, YES, __ATOMIC_RELEASE);
+    
+    dispatch_semaphore_wait(consumerFinished, DISPATCH_TIME_FOREVER);
+    XCTAssertEqual(dequeuedLogMessages.count, producerCount * logsPerProducer);
+    
+    NSMutableDictionary<NSNumber *, NSNumber *> *const nextIndexByProducer = [NSMutableDictionary new];
+    for (ARKLogMessage *logMessage in dequeuedLogMessages) {
+        NSNumber *const producer = logMessage.userInfo[@"producer"];
+        NSInteger const expectedIndex = [nextIndexByProducer[producer] integerValue];
+        XCTAssertEqual(logMessage.text.integerValue, expectedIndex);
+        nextIndexByProducer[producer] = @(expectedIndex + 1);
+    }
+}
+
+@end
@@ -0,0 +1,155 @@
+//
+//  Copyright 2026 Square, Inc.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import XCTest;
+
+#import "ARKLogSearchIndex.h"
+
+#import "ARKLogMessage.h"
+
+
+@interface ARKLogSearchIndexTests : XCTestCase
+
+@property (nonatomic) ARKLogSearchIndex *searchIndex;
+
+@end
+
+
+@implementation ARKLogSearchIndexTests
+
+#pragma mark - Setup
+
+- (void)setUp;
+{
+    [super setUp];
+    
+    self.searchIndex = [ARKLogSearchIndex new];
+}
+
+#pragma mark - Behavior Tests
+
+- (void)test_search_matchesTextAndParametersIgnoringCase;
+{
+    [self.searchIndex appendLogMessages:@[
+        [self _logMessageWithText:@"Loaded Checkout screen" parameters:@{}],
+        [self _logMessageWithText:@"Tapped button" parameters:@{ @"screen" : @"checkout" }],
+        [self _logMessageWithText:@"Loaded settings" parameters:@{}],
+    ]];
+    
+    XCTAssertEqualObjects([self _textsOfLogMessagesMatchingString:@"CHECKOUT"], (@[ @"Loaded Checkout screen", @"Tapped button" ]));
+    XCTAssertEqualObjects([self _textsOfLogMessagesMatchingString:@"loaded"], (@[ @"Loaded Checkout screen", @"Loaded settings" ]));
+    XCTAssertEqualObjects([self _textsOfLogMessagesMatchingString:@"ck"], (@[ @"Loaded Checkout screen", @"Tapped button" ]));
+    XCTAssertEqualObjects([self _textsOfLogMessagesMatchingString:@"checkouts"], @[]);
+    XCTAssertEqual([self _textsOfLogMessagesMatchingString:@""].count, 3);
+}
+
+- (void)test_search_matchesSameMessagesAsLogMessageMatchesSearchString;
+{
+    NSArray<NSString *> *const words = @[ @"alpha", @"beta", @"gamma", @"delta", @"Epsilon", @"zeta" ];
+    NSMutableArray<ARKLogMessage *> *const logMessages = [NSMutableArray new];
+    for (NSUInteger i = 0; i < 500; i++) {
+        NSString *const text = [NSString stringWithFormat:@"%@ %@ %@", words[i % words.count], words[(i / words.count) % words.count], @(i)];
+        [logMessages addObject:[self _logMessageWithText:text parameters:@{}]];
+    }
+    [self.searchIndex appendLogMessages:logMessages];
+    
+    for (NSString *searchString in @[ @"alpha beta", @"epsilon", @"ta 1", @"a", @"42", @"gamma gamma" ]) {
+        NSMutableArray<NSString *> *const expectedTexts = [NSMutableArray new];
+        for (ARKLogMessage *logMessage in logMessages) {
+            if ([ARKLogSearchIndex logMessage:logMessage matchesSearchString:searchString]) {
+                [expectedTexts addObject:logMessage.text];
+            }
+        }
+        
+        XCTAssertEqualObjects([self _textsOfLogMessagesMatchingString:searchString], expectedTexts, @"Search for \"%@\" didn't match expected messages", searchString);
+    }
+}
+
+- (void)test_removeOldestLogMessages_dropsRemovedMessagesFromResults;
+{
+    NSMutableArray<ARKLogMessage *> *const logMessages = [NSMutableArray new];
+    for (NSUInteger i = 0; i < 3000; i++) {
+        [logMessages addObject:[self _logMessageWithText:[NSString stringWithFormat:@"Log %@", @(i)] parameters:@{}]];
+    }
+    [self.searchIndex appendLogMessages:logMessages];
+    
+    // Remove enough to compact the index, then check that the renumbered entries still resolve.
+    [self.searchIndex removeOldestLogMessages:2500];
+    XCTAssertEqual(self.searchIndex.logMessageCount, 500);
+    
+    XCTAssertEqualObjects([self _textsOfLogMessagesMatchingString:@"Log 259"], (@[ @"Log 2590", @"Log 2591", @"Log 2592", @"Log 2593", @"Log 2594", @"Log 2595", @"Log 2596", @"Log 2597", @"Log 2598", @"Log 2599" ]));
+    XCTAssertEqualObjects([self _textsOfLogMessagesMatchingString:@"Log 2999"], @[ @"Log 2999" ]);
+    
+    [self.searchIndex appendLogMessages:@[ [self _logMessageWithText:@"Log 3000" parameters:@{}] ]];
+    XCTAssertEqualObjects([self _textsOfLogMessagesMatchingString:@"Log 300"], (@[ @"Log 3000" ]));
+    
+    [self.searchIndex removeAllLogMessages];
+    XCTAssertEqual(self.searchIndex.logMessageCount, 0);
+    XCTAssertEqualObjects([self _textsOfLogMessagesMatchingString:@"Log"], @[]);
+}
+
+- (void)test_searchOperation_cancelledSearchDoesNotCallCompletionHandler;
+{
+    [self.searchIndex appendLogMessages:@[ [self _logMessageWithText:@"Log" parameters:@{}] ]];
+    
+    NSOperation *const searchOperation = [self.searchIndex searchForLogMessagesMatchingString:@"Log" completionHandler:^(NSArray<ARKLogMessage *> *matchingLogMessages) {
+        XCTFail(@"Cancelled search called its completion handler!");
+    }];
+    [searchOperation cancel];
+    
+    // Searches complete in order, so once a later search completes the cancelled one never will.
+    XCTAssertEqualObjects([self _textsOfLogMessagesMatchingString:@"Log"], @[ @"Log" ]);
+}
+
+#pragma mark - Performance Tests
+
+- (void)test_search_performance;
+{
+    NSMutableArray<ARKLogMessage *> *const logMessages = [NSMutableArray new];
+    for (NSUInteger i = 0; i < 100000; i++) {
+        [logMessages addObject:[self _logMessageWithText:[NSString stringWithFormat:@"Request %@ finished with status %@", @(i), @(200 + i % 5)] parameters:@{}]];
+    }
+    [self.searchIndex appendLogMessages:logMessages];
+    [self _textsOfLogMessagesMatchingString:@""];
+    
+    [self measureBlock:^{
+        [self _textsOfLogMessagesMatchingString:@"request 4242"];
+        [self _textsOfLogMessagesMatchingString:@"status 203"];
+    }];
+}
+
+#pragma mark - Private Methods
+
+- (ARKLogMessage *)_logMessageWithText:(NSString *)text parameters:(NSDictionary<NSString *, NSString *> *)parameters;
+{
+    return [[ARKLogMessage alloc] initWithText:text image:nil type:ARKLogTypeDefault parameters:parameters userInfo:nil];
+}
+
+- (NSArray<NSString *> *)_textsOfLogMessagesMatchingString:(NSString *)searchString;
+{
+    __block NSArray<NSString *> *texts = nil;
+    XCTestExpectation *const expectation = [self expectationWithDescription:searchString];
+    [self.searchIndex searchForLogMessagesMatchingString:searchString completionHandler:^(NSArray<ARKLogMessage *> *matchingLogMessages) {
+        texts = [matchingLogMessages valueForKey:@"text"];
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    
+    return texts;
+}
+
+@end
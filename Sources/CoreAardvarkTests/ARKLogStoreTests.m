@@ -21,6 +21,8 @@
 
 #import "ARKDataArchive.h"
 #import "ARKDataArchive_Testing.h"
+#import "ARKEmergencyLogBuffer.h"
+#import "ARKImageBlobStore.h"
 #import "ARKLogDistributor.h"
 #import "ARKLogDistributor_Testing.h"
 #import "ARKLogMessage.h"
@@ -108,6 +110,30 @@
     [self waitForExpectationsWithTimeout:5.0 handler:nil];
 }
 
+- (void)test_observeLogMessages_logsFilteredBatchInOrder;
+{
+    NSString *const ARKLogStoreTestShouldLogKey = @"ARKLogStoreTestShouldLog";
+    
+    self.logStore.logFilterBlock = ^(ARKLogMessage *logMessage) {
+        return [logMessage.userInfo[ARKLogStoreTestShouldLogKey] boolValue];
+    };
+    
+    NSMutableArray *const logMessages = [NSMutableArray new];
+    for (NSUInteger i  = 0; i < 10; i++) {
+        [logMessages addObject:[[ARKLogMessage alloc] initWithText:[NSString stringWithFormat:@"Log %@", @(i)] image:nil type:ARKLogTypeDefault parameters:@{} userInfo:@{ ARKLogStoreTestShouldLogKey : @(i % 2 == 0) }]];
+    }
+    [self.logStore observeLogMessages:logMessages];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.logStore retrieveAllLogMessagesWithCompletionHandler:^(NSArray *logMessages) {
+        XCTAssertEqualObjects([logMessages valueForKey:@"text"], (@[ @"Log 0", @"Log 2", @"Log 4", @"Log 6", @"Log 8" ]));
+        
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
 - (void)test_observeLogMessage_trimsOldestLogs;
 {
     NSString *lastLogText = nil;
@@ -127,6 +153,207 @@
     [self waitForExpectationsWithTimeout:5.0 handler:nil];
 }
 
+- (void)test_observeLogMessage_evictsOldestLogsFromCircularArchive;
+{
+    NSURL *const archiveURL = [self.logStore.persistedLogFileURL URLByAppendingPathExtension:@"circular"];
+    [[NSFileManager defaultManager] removeItemAtURL:archiveURL error:NULL];
+    
+    ARKLogStore *const logStore = [[ARKLogStore alloc] initWithPersistedLogFileURL:archiveURL maximumLogMessageCount:10 usesCircularArchive:YES];
+    XCTAssertTrue(logStore.usesCircularArchive);
+    XCTAssertEqual(logStore.dataArchive.format, ARKDataArchiveFormatCircular);
+    [self.logDistributor addLogObserver:logStore];
+    
+    for (NSUInteger i  = 0; i < 15; i++) {
+        [logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:[NSString stringWithFormat:@"Log %@", @(i)] image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil]];
+    }
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [logStore retrieveAllLogMessagesWithCompletionHandler:^(NSArray *logMessages) {
+        XCTAssertEqual(logMessages.count, 10);
+        XCTAssertEqualObjects([logMessages.firstObject text], @"Log 5");
+        XCTAssertEqualObjects([logMessages.lastObject text], @"Log 14");
+        
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    
+    [self.logDistributor removeLogObserver:logStore];
+}
+
+- (void)test_observeLogMessage_storesImagesOutOfLine;
+{
+    UIImage *const image = [self _imageWithColor:[UIColor redColor]];
+    [self.logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:@"Screenshot" image:image type:ARKLogTypeScreenshot parameters:@{} userInfo:nil]];
+    [self.logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:@"Screenshot" image:image type:ARKLogTypeScreenshot parameters:@{} userInfo:nil]];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.logStore retrieveAllLogMessagesWithCompletionHandler:^(NSArray *logMessages) {
+        XCTAssertEqual(logMessages.count, 2);
+        XCTAssertTrue([logMessages.firstObject hasImage]);
+        
+        UIImage *const retrievedImage = [logMessages.firstObject image];
+        XCTAssertNotNil(retrievedImage);
+        XCTAssertTrue(CGSizeEqualToSize(retrievedImage.size, image.size));
+        XCTAssertEqual(retrievedImage.scale, image.scale);
+        
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    
+    // Both log messages refer to the same blob.
+    NSData *const imageData = UIImagePNGRepresentation(image);
+    XCTAssertEqual(self.logStore.imageBlobStore.byteCount, imageData.length);
+}
+
+- (void)test_observeLogMessage_releasesImagesOfEvictedLogs;
+{
+    NSURL *const archiveURL = [self.logStore.persistedLogFileURL URLByAppendingPathExtension:@"images-circular"];
+    [[NSFileManager defaultManager] removeItemAtURL:archiveURL error:NULL];
+    
+    ARKLogStore *const logStore = [[ARKLogStore alloc] initWithPersistedLogFileURL:archiveURL maximumLogMessageCount:2 usesCircularArchive:YES];
+    
+    [logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:@"Screenshot" image:[self _imageWithColor:[UIColor redColor]] type:ARKLogTypeScreenshot parameters:@{} userInfo:nil]];
+    [logStore.dataArchive saveArchiveAndWait:YES];
+    XCTAssertGreaterThan(logStore.imageBlobStore.byteCount, 0);
+    
+    for (NSUInteger i  = 0; i < 2; i++) {
+        [logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:[NSString stringWithFormat:@"Log %@", @(i)] image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil]];
+    }
+    
+    [logStore.dataArchive saveArchiveAndWait:YES];
+    XCTAssertEqual(logStore.imageBlobStore.byteCount, 0);
+}
+
+- (void)test_segmentedStore_deletesOldestSegmentsAsNewestFill;
+{
+    NSURL *const directoryURL = [self.logStore.persistedLogFileURL URLByAppendingPathExtension:@"segments"];
+    [[NSFileManager defaultManager] removeItemAtURL:directoryURL error:NULL];
+    
+    ARKLogStore *const logStore = [[ARKLogStore alloc] initWithPersistedLogsDirectoryURL:directoryURL maximumLogMessageCount:10 segmentCount:5];
+    XCTAssertEqual(logStore.segmentCount, 5);
+    [self.logDistributor addLogObserver:logStore];
+    
+    for (NSUInteger i  = 0; i < 15; i++) {
+        [logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:[NSString stringWithFormat:@"Log %@", @(i)] image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil]];
+    }
+    
+    // Each segment holds 2 logs, so the segments holding logs 0 through 5 have been deleted.
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [logStore retrieveAllLogMessagesWithCompletionHandler:^(NSArray *logMessages) {
+        XCTAssertEqual(logMessages.count, 9);
+        XCTAssertEqualObjects([logMessages.firstObject text], @"Log 6");
+        XCTAssertEqualObjects([logMessages.lastObject text], @"Log 14");
+        
+        [expectation fulfill];
+    }];
+    
+    XCTestExpectation *newestFirstExpectation = [self expectationWithDescription:@"newest first"];
+    [logStore retrieveLogMessagesFromDate:nil toDate:nil types:ARKLogTypeMaskAll limit:3 newestFirst:YES completionHandler:^(NSArray *logMessages) {
+        XCTAssertEqualObjects([logMessages valueForKey:@"text"], (@[ @"Log 14", @"Log 13", @"Log 12" ]));
+        
+        [newestFirstExpectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    
+    [self expectationForPredicate:[NSPredicate predicateWithBlock:^BOOL(id evaluatedObject, NSDictionary *bindings) {
+        NSArray<NSString *> *const fileNames = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:directoryURL.path error:NULL];
+        return ([fileNames filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"pathExtension == 'segment'"]].count == 5);
+    }] evaluatedWithObject:directoryURL handler:nil];
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    
+    [self.logDistributor removeLogObserver:logStore];
+}
+
+- (void)test_segmentedStore_reopenedStoreOnlyLosesLogsFromDamagedSegment;
+{
+    NSURL *const directoryURL = [self.logStore.persistedLogFileURL URLByAppendingPathExtension:@"damaged-segments"];
+    [[NSFileManager defaultManager] removeItemAtURL:directoryURL error:NULL];
+    
+    ARKLogStore *logStore = [[ARKLogStore alloc] initWithPersistedLogsDirectoryURL:directoryURL maximumLogMessageCount:10 segmentCount:5];
+    for (NSUInteger i  = 0; i < 6; i++) {
+        [logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:[NSString stringWithFormat:@"Log %@", @(i)] image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil]];
+    }
+    [logStore waitUntilAllLogsAreConsumedAndArchiveSaved];
+    XCTAssertEqual(logStore.sealedDataArchives.count, 2);
+    
+    // Truncate the oldest segment partway into its last log.
+    NSFileHandle *const fileHandle = logStore.sealedDataArchives.firstObject.fileHandle;
+    [fileHandle truncateFileAtOffset:([fileHandle seekToEndOfFile] - 2)];
+    logStore = nil;
+    
+    ARKLogStore *const reopenedLogStore = [[ARKLogStore alloc] initWithPersistedLogsDirectoryURL:directoryURL maximumLogMessageCount:10 segmentCount:5];
+    [self.logDistributor addLogObserver:reopenedLogStore];
+    [reopenedLogStore observeLogMessage:[[ARKLogMessage alloc] initWithText:@"Log 6" image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil]];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [reopenedLogStore retrieveAllLogMessagesWithCompletionHandler:^(NSArray *logMessages) {
+        XCTAssertEqualObjects([logMessages valueForKey:@"text"], (@[ @"Log 0", @"Log 2", @"Log 3", @"Log 4", @"Log 5", @"Log 6" ]));
+        
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    
+    [self.logDistributor removeLogObserver:reopenedLogStore];
+}
+
+- (void)test_initWithPersistedLogFileURL_recoversLogsLostBeforeBeingWritten;
+{
+    NSURL *const fileURL = [self.logStore.persistedLogFileURL URLByAppendingPathExtension:@"lost-logs"];
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+    [[NSFileManager defaultManager] removeItemAtURL:[fileURL URLByAppendingPathExtension:@"emergency"] error:NULL];
+    
+    ARKLogStore *logStore = [[ARKLogStore alloc] initWithPersistedLogFileURL:fileURL maximumLogMessageCount:10];
+    XCTAssertNotNil(logStore.emergencyLogBuffer);
+    for (NSUInteger i  = 0; i < 2; i++) {
+        [logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:[NSString stringWithFormat:@"Log %@", @(i)] image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil]];
+    }
+    [logStore waitUntilAllLogsAreConsumedAndArchiveSaved];
+    
+    // Buffer a log message without writing it to the archive, as happens when the app crashes right after it's logged.
+    ARKLogMessage *const lostLogMessage = [[ARKLogMessage alloc] initWithText:@"Log 2" image:nil type:ARKLogTypeError parameters:@{} userInfo:nil];
+    [logStore.emergencyLogBuffer appendRecords:@[ [(id <ARKDataArchiveRecordCoding>)lostLogMessage archiveRecordRepresentation] ]];
+    logStore = nil;
+    
+    // Re-opening a second time shows the recovered log message isn't appended again.
+    for (NSUInteger i  = 0; i < 2; i++) {
+        ARKLogStore *const reopenedLogStore = [[ARKLogStore alloc] initWithPersistedLogFileURL:fileURL maximumLogMessageCount:10];
+        [self.logDistributor addLogObserver:reopenedLogStore];
+        
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"%@ %@", NSStringFromSelector(_cmd), @(i)]];
+        [reopenedLogStore retrieveAllLogMessagesWithCompletionHandler:^(NSArray *logMessages) {
+            XCTAssertEqualObjects([logMessages valueForKey:@"text"], (@[ @"Log 0", @"Log 1", @"Log 2" ]));
+            
+            [expectation fulfill];
+        }];
+        
+        [self waitForExpectationsWithTimeout:5.0 handler:nil];
+        
+        [reopenedLogStore waitUntilAllLogsAreConsumedAndArchiveSaved];
+        [self.logDistributor removeLogObserver:reopenedLogStore];
+    }
+}
+
+- (void)test_clearLogsWithCompletionHandler_removesBufferedLogs;
+{
+    NSURL *const fileURL = [self.logStore.persistedLogFileURL URLByAppendingPathExtension:@"cleared-logs"];
+    
+    ARKLogStore *const logStore = [[ARKLogStore alloc] initWithPersistedLogFileURL:fileURL maximumLogMessageCount:10];
+    [logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:@"Log 0" image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil]];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [logStore clearLogsWithCompletionHandler:^{
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    
+    XCTAssertEqualObjects([logStore.emergencyLogBuffer records], @[]);
+}
+
 - (void)test_logFilterBlock_preventsLogsFromBeingObserved;
 {
     NSString *const ARKLogStoreTestShouldLogKey = @"ARKLogStoreTestShouldLog";
@@ -207,6 +434,41 @@
     [self waitForExpectationsWithTimeout:5.0 handler:nil];
 }
 
+- (void)test_retrieveLogMessages_returnsNewestMatchingLogsFirst;
+{
+    NSDate *const startDate = [NSDate dateWithTimeIntervalSinceReferenceDate:1000];
+    for (NSUInteger i = 0; i < 10; i++) {
+        ARKLogType const type = (i % 2 == 0) ? ARKLogTypeError : ARKLogTypeDefault;
+        NSDate *const date = [startDate dateByAddingTimeInterval:i];
+        [self.logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:[NSString stringWithFormat:@"%@", @(i)] image:nil type:type parameters:@{} userInfo:nil date:date]];
+    }
+    
+    XCTestExpectation *const expectation0 = [self expectationWithDescription:NSStringFromSelector(_cmd)];
+    [self.logStore retrieveLogMessagesFromDate:nil toDate:nil types:ARKLogTypeMaskError limit:3 newestFirst:YES completionHandler:^(NSArray<ARKLogMessage *> *logMessages) {
+        NSArray *const expectedTexts = @[ @"8", @"6", @"4" ];
+        XCTAssertEqualObjects([logMessages valueForKey:@"text"], expectedTexts);
+        
+        [expectation0 fulfill];
+    }];
+    
+    XCTestExpectation *const expectation1 = [self expectationWithDescription:[NSString stringWithFormat:@"%@-1", NSStringFromSelector(_cmd)]];
+    [self.logStore retrieveLogMessagesFromDate:[startDate dateByAddingTimeInterval:3] toDate:[startDate dateByAddingTimeInterval:6] types:(ARKLogTypeMaskDefault | ARKLogTypeMaskError) limit:0 newestFirst:NO completionHandler:^(NSArray<ARKLogMessage *> *logMessages) {
+        NSArray *const expectedTexts = @[ @"3", @"4", @"5", @"6" ];
+        XCTAssertEqualObjects([logMessages valueForKey:@"text"], expectedTexts);
+        
+        [expectation1 fulfill];
+    }];
+    
+    XCTestExpectation *const expectation2 = [self expectationWithDescription:[NSString stringWithFormat:@"%@-2", NSStringFromSelector(_cmd)]];
+    [self.logStore retrieveLogMessagesFromDate:nil toDate:nil types:ARKLogTypeMaskScreenshot limit:0 newestFirst:YES completionHandler:^(NSArray<ARKLogMessage *> *logMessages) {
+        XCTAssertEqual(logMessages.count, 0);
+        
+        [expectation2 fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
 - (void)test_clearLogsWithCompletionHandler_removesAllLogMessages;
 {
     // Fill in some logs.
@@ -226,6 +488,84 @@
     [self waitForExpectationsWithTimeout:5.0 handler:nil];
 }
 
+- (void)test_addChangeObserver_followsAppendedAndClearedLogs;
+{
+    [self.logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:@"Log 0" image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil]];
+    
+    // Mirror the store's contents by applying each change as it's delivered.
+    NSMutableArray<NSString *> *const logTexts = [NSMutableArray new];
+    __block NSUInteger totalTrimmedLogMessageCount = 0;
+    id const changeObserver = [self.logStore addChangeObserverWithHandler:^(NSArray<ARKLogMessage *> *appendedLogMessages, NSUInteger trimmedLogMessageCount) {
+        XCTAssertTrue([NSThread isMainThread]);
+        
+        [logTexts removeObjectsInRange:NSMakeRange(0, MIN(trimmedLogMessageCount, logTexts.count))];
+        [logTexts addObjectsFromArray:[appendedLogMessages valueForKey:@"text"]];
+        totalTrimmedLogMessageCount += trimmedLogMessageCount;
+    }];
+    
+    [self expectationForPredicate:[NSPredicate predicateWithBlock:^BOOL(id evaluatedObject, NSDictionary *bindings) {
+        return [logTexts isEqualToArray:@[ @"Log 0" ]];
+    }] evaluatedWithObject:logTexts handler:nil];
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    
+    [self.logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:@"Log 1" image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil]];
+    [self.logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:@"Log 2" image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil]];
+    
+    [self expectationForPredicate:[NSPredicate predicateWithBlock:^BOOL(id evaluatedObject, NSDictionary *bindings) {
+        return [logTexts isEqualToArray:@[ @"Log 0", @"Log 1", @"Log 2" ]];
+    }] evaluatedWithObject:logTexts handler:nil];
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    
+    [self.logStore clearLogsWithCompletionHandler:NULL];
+    
+    [self expectationForPredicate:[NSPredicate predicateWithBlock:^BOOL(id evaluatedObject, NSDictionary *bindings) {
+        return (logTexts.count == 0 && totalTrimmedLogMessageCount == 3);
+    }] evaluatedWithObject:logTexts handler:nil];
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    
+    [self.logStore removeChangeObserver:changeObserver];
+}
+
+- (void)test_addChangeObserver_followsLogsAcrossSegments;
+{
+    NSURL *const directoryURL = [self.logStore.persistedLogFileURL URLByAppendingPathExtension:@"observed-segments"];
+    [[NSFileManager defaultManager] removeItemAtURL:directoryURL error:NULL];
+    
+    ARKLogStore *const logStore = [[ARKLogStore alloc] initWithPersistedLogsDirectoryURL:directoryURL maximumLogMessageCount:4 segmentCount:2];
+    [self.logDistributor addLogObserver:logStore];
+    [logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:@"Log 0" image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil]];
+    
+    // Mirror the store's contents by applying each change as it's delivered.
+    NSMutableArray<NSString *> *const logTexts = [NSMutableArray new];
+    __block NSUInteger totalTrimmedLogMessageCount = 0;
+    id const changeObserver = [logStore addChangeObserverWithHandler:^(NSArray<ARKLogMessage *> *appendedLogMessages, NSUInteger trimmedLogMessageCount) {
+        [logTexts removeObjectsInRange:NSMakeRange(0, MIN(trimmedLogMessageCount, logTexts.count))];
+        [logTexts addObjectsFromArray:[appendedLogMessages valueForKey:@"text"]];
+        totalTrimmedLogMessageCount += trimmedLogMessageCount;
+    }];
+    
+    // Log 2 starts a second segment.
+    [logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:@"Log 1" image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil]];
+    [logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:@"Log 2" image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil]];
+    
+    [self expectationForPredicate:[NSPredicate predicateWithBlock:^BOOL(id evaluatedObject, NSDictionary *bindings) {
+        return [logTexts isEqualToArray:@[ @"Log 0", @"Log 1", @"Log 2" ]];
+    }] evaluatedWithObject:logTexts handler:nil];
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    
+    // Log 4 starts a third segment, which deletes the first.
+    [logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:@"Log 3" image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil]];
+    [logStore observeLogMessage:[[ARKLogMessage alloc] initWithText:@"Log 4" image:nil type:ARKLogTypeDefault parameters:@{} userInfo:nil]];
+    
+    [self expectationForPredicate:[NSPredicate predicateWithBlock:^BOOL(id evaluatedObject, NSDictionary *bindings) {
+        return ([logTexts isEqualToArray:@[ @"Log 2", @"Log 3", @"Log 4" ]] && totalTrimmedLogMessageCount == 2);
+    }] evaluatedWithObject:logTexts handler:nil];
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    
+    [logStore removeChangeObserver:changeObserver];
+    [self.logDistributor removeLogObserver:logStore];
+}
+
 - (void)test_waitUntilAllOperationsAreFinished_completionHandlerCalledOnMainQueue;
 {
     XCTestExpectation *expectation = [self expectationWithDescription:NSStringFromSelector(_cmd)];
@@ -356,4 +696,18 @@
     }];
 }
 
+#pragma mark - Private Methods
+
+- (UIImage *)_imageWithColor:(UIColor *)color;
+{
+    UIGraphicsImageRendererFormat *const format = [UIGraphicsImageRendererFormat preferredFormat];
+    format.scale = 1.0;
+    
+    UIGraphicsImageRenderer *const renderer = [[UIGraphicsImageRenderer alloc] initWithSize:CGSizeMake(8.0, 8.0) format:format];
+    return [renderer imageWithActions:^(UIGraphicsImageRendererContext *context) {
+        [color setFill];
+        [context fillRect:CGRectMake(0.0, 0.0, 8.0, 8.0)];
+    }];
+}
+
 @end